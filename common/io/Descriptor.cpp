@@ -465,7 +465,7 @@ int ConnectedDescriptor::Receive(
         return 0;
       }
       data_read += ret;
-      data += data_read;
+      data += ret;
     } else {
       OLA_WARN << "Descriptor type not implemented for reading: "
                << ReadDescriptor().m_type;
@@ -484,7 +484,7 @@ int ConnectedDescriptor::Receive(
       return 0;
     }
     data_read += ret;
-    data += data_read;
+    data += ret;
   }
 #endif
   return 0;
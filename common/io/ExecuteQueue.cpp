@@ -0,0 +1,119 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * ExecuteQueue.cpp
+ * A lock-free queue of callbacks to be run in the SelectServer thread.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#include "common/io/ExecuteQueue.h"
+
+#include <stdint.h>
+
+#include <vector>
+
+namespace ola {
+namespace io {
+
+ExecuteQueue::ExecuteQueue()
+    : m_head(NULL) {
+}
+
+ExecuteQueue::~ExecuteQueue() {
+  DeleteList(__sync_lock_test_and_set(&m_head, static_cast<Node*>(NULL)));
+}
+
+bool ExecuteQueue::Init(ola::Callback0<void> *on_ready) {
+  if (!m_wake_up_descriptor.Init()) {
+    delete on_ready;
+    return false;
+  }
+  m_wake_up_descriptor.SetOnData(on_ready);
+  return true;
+}
+
+void ExecuteQueue::Push(ola::BaseCallback0<void> *callback) {
+  Node *node = new Node;
+  node->callback = callback;
+
+  // __sync_val_compare_and_swap is a full barrier, so the node contents are
+  // visible to the consumer before the node is.
+  Node *head = m_head;
+  while (true) {
+    node->next = head;
+    Node *previous = __sync_val_compare_and_swap(&m_head, head, node);
+    if (previous == head) {
+      break;
+    }
+    head = previous;
+  }
+
+  // Only the producer that makes the queue non-empty needs to wake the
+  // consumer, everyone else piggybacks on that wake up.
+  if (head == NULL) {
+    WakeUp();
+  }
+}
+
+void ExecuteQueue::ClearWakeUp() {
+  while (m_wake_up_descriptor.DataRemaining()) {
+    // try to get everything in one read
+    uint8_t message[100];
+    unsigned int size;
+    m_wake_up_descriptor.Receive(reinterpret_cast<uint8_t*>(&message),
+                                 sizeof(message), size);
+  }
+}
+
+bool ExecuteQueue::PopAll(Callbacks *callbacks) {
+  Node *node = __sync_lock_test_and_set(&m_head, static_cast<Node*>(NULL));
+  if (!node) {
+    return false;
+  }
+
+  // The list is in LIFO order, reverse it so callbacks run in the order they
+  // were pushed.
+  Node *reversed = NULL;
+  while (node) {
+    Node *next = node->next;
+    node->next = reversed;
+    reversed = node;
+    node = next;
+  }
+
+  while (reversed) {
+    Node *next = reversed->next;
+    callbacks->push_back(reversed->callback);
+    delete reversed;
+    reversed = next;
+  }
+  return true;
+}
+
+void ExecuteQueue::WakeUp() {
+  uint8_t wake_up = 'a';
+  m_wake_up_descriptor.Send(&wake_up, sizeof(wake_up));
+}
+
+void ExecuteQueue::DeleteList(Node *node) {
+  while (node) {
+    Node *next = node->next;
+    delete node->callback;
+    delete node;
+    node = next;
+  }
+}
+}  // namespace io
+}  // namespace ola
@@ -0,0 +1,121 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * ExecuteQueue.h
+ * A lock-free queue of callbacks to be run in the SelectServer thread.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#ifndef COMMON_IO_EXECUTEQUEUE_H_
+#define COMMON_IO_EXECUTEQUEUE_H_
+
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/base/Macro.h"
+#include "ola/io/Descriptor.h"
+
+namespace ola {
+namespace io {
+
+/**
+ * @class ExecuteQueue
+ * @brief A multi-producer, single-consumer queue of callbacks.
+ *
+ * This backs SelectServer::Execute(). Push() may be called from any thread
+ * and doesn't take a lock; callbacks are added to a singly linked list using
+ * compare-and-swap. The consumer takes the entire list in one atomic exchange,
+ * which avoids the ABA problem that single element pops suffer from.
+ *
+ * The consumer is woken via a LoopbackDescriptor, which the owner adds to
+ * the SelectServer. The descriptor is only signalled when the queue
+ * transitions from empty to non-empty, so a burst of Push() calls costs at
+ * most a single write() syscall.
+ */
+class ExecuteQueue {
+ public:
+  typedef std::vector<ola::BaseCallback0<void>*> Callbacks;
+
+  ExecuteQueue();
+
+  /**
+   * @brief Destructor.
+   *
+   * Any callbacks remaining in the queue are deleted without being run.
+   * The owner should call PopAll() and run them first if that matters.
+   */
+  ~ExecuteQueue();
+
+  /**
+   * @brief Setup the wake up descriptor.
+   * @param on_ready the callback to run, in the poller thread, when callbacks
+   *   are available. Ownership is transferred.
+   * @returns true if the descriptor was created, false otherwise.
+   */
+  bool Init(ola::Callback0<void> *on_ready);
+
+  /**
+   * @brief Return the wake up descriptor.
+   *
+   * This should be added to the SelectServer with AddReadDescriptor().
+   */
+  ConnectedDescriptor *WakeUpDescriptor() { return &m_wake_up_descriptor; }
+
+  /**
+   * @brief Add a callback to the queue.
+   * @param callback the callback to add, ownership is transferred to the
+   *   consumer once it's removed with PopAll().
+   *
+   * This can be called from any thread.
+   */
+  void Push(ola::BaseCallback0<void> *callback);
+
+  /**
+   * @brief Acknowledge a wake up.
+   *
+   * This must be called, from the consumer thread, before PopAll() when
+   * responding to a wake up. Clearing first means a Push() that races with
+   * PopAll() will always re-signal the descriptor.
+   */
+  void ClearWakeUp();
+
+  /**
+   * @brief Remove all callbacks from the queue.
+   * @param[out] callbacks the callbacks are appended to this vector in the
+   *   order they were pushed.
+   * @returns true if any callbacks were removed.
+   *
+   * This must only be called from the consumer thread.
+   */
+  bool PopAll(Callbacks *callbacks);
+
+ private:
+  struct Node {
+    ola::BaseCallback0<void> *callback;
+    Node *next;
+  };
+
+  Node *volatile m_head;
+
+  LoopbackDescriptor m_wake_up_descriptor;
+
+  void WakeUp();
+  static void DeleteList(Node *node);
+
+  DISALLOW_COPY_AND_ASSIGN(ExecuteQueue);
+};
+}  // namespace io
+}  // namespace ola
+#endif  // COMMON_IO_EXECUTEQUEUE_H_
@@ -4,6 +4,8 @@ common_libolacommon_la_SOURCES += \
     common/io/Descriptor.cpp \
     common/io/ExtendedSerial.cpp \
     common/io/EPoller.h \
+    common/io/ExecuteQueue.cpp \
+    common/io/ExecuteQueue.h \
     common/io/IOQueue.cpp \
     common/io/IOStack.cpp \
     common/io/IOUtils.cpp \
@@ -38,6 +40,13 @@ common_libolacommon_la_SOURCES += \
     common/io/KQueuePoller.cpp
 endif
 
+# PROGRAMS
+##################################################
+noinst_PROGRAMS += common/io/execute_loadtest
+
+common_io_execute_loadtest_SOURCES = common/io/execute_loadtest.cpp
+common_io_execute_loadtest_LDADD = common/libolacommon.la
+
 # TESTS
 ##################################################
 test_programs += \
@@ -47,6 +47,7 @@
 #include "common/io/SelectPoller.h"
 #endif
 
+#include "common/io/ExecuteQueue.h"
 #include "ola/io/Descriptor.h"
 #include "ola/Logging.h"
 #include "ola/network/Socket.h"
@@ -251,30 +252,18 @@ void SelectServer::RunInLoop(Callback0<void> *callback) {
 }
 
 void SelectServer::Execute(ola::BaseCallback0<void> *callback) {
-  {
-    ola::thread::MutexLocker locker(&m_incoming_mutex);
-    m_incoming_callbacks.push_back(callback);
-  }
-
-  // kick select(), we do this even if we're in the same thread as select() is
-  // called. If we don't do this there is a race condition because a callback
-  // may be added just prior to select(). Without this kick, select() will
-  // sleep for the poll_interval before executing the callback.
-  uint8_t wake_up = 'a';
-  m_incoming_descriptor.Send(&wake_up, sizeof(wake_up));
+  // The queue kicks the poller when it goes from empty to non-empty. We rely
+  // on this even if we're in the same thread as select() is called. Without
+  // the kick there is a race condition because a callback may be added just
+  // prior to select(), and select() will sleep for the poll_interval before
+  // executing the callback.
+  m_incoming_queue->Push(callback);
 }
 
 
 void SelectServer::DrainCallbacks() {
   Callbacks callbacks_to_run;
-  while (true) {
-    {
-      ola::thread::MutexLocker locker(&m_incoming_mutex);
-      if (m_incoming_callbacks.empty()) {
-        return;
-      }
-      callbacks_to_run.swap(m_incoming_callbacks);
-    }
+  while (m_incoming_queue->PopAll(&callbacks_to_run)) {
     RunCallbacks(&callbacks_to_run);
   }
 }
@@ -325,12 +314,12 @@ void SelectServer::Init(const Options &options) {
 
   // TODO(simon): this should really be in an Init() method that returns a
   // bool.
-  if (!m_incoming_descriptor.Init()) {
-    OLA_FATAL << "Failed to init LoopbackDescriptor, Execute() won't work!";
+  m_incoming_queue.reset(new ExecuteQueue());
+  if (!m_incoming_queue->Init(
+          ola::NewCallback(this, &SelectServer::DrainAndExecute))) {
+    OLA_FATAL << "Failed to init the ExecuteQueue, Execute() won't work!";
   }
-  m_incoming_descriptor.SetOnData(
-      ola::NewCallback(this, &SelectServer::DrainAndExecute));
-  AddReadDescriptor(&m_incoming_descriptor);
+  AddReadDescriptor(m_incoming_queue->WakeUpDescriptor());
 }
 
 /*
@@ -355,23 +344,15 @@ bool SelectServer::CheckForEvents(const TimeInterval &poll_interval) {
 }
 
 void SelectServer::DrainAndExecute() {
-  while (m_incoming_descriptor.DataRemaining()) {
-    // try to get everything in one read
-    uint8_t message[100];
-    unsigned int size;
-    m_incoming_descriptor.Receive(reinterpret_cast<uint8_t*>(&message),
-                                  sizeof(message), size);
-  }
+  // The wake up must be cleared before we take the callbacks, otherwise a
+  // callback added in between would be left in the queue without a pending
+  // wake up.
+  m_incoming_queue->ClearWakeUp();
 
-  // We can't hold the mutex while we execute the callback, so instead we swap
-  // out the vector under a lock, release the lock and then run all the
-  // callbacks.
+  // Callbacks run by RunCallbacks() may themselves call Execute(), these will
+  // trigger another wake up so they run on the next pass through the loop.
   Callbacks callbacks_to_run;
-  {
-    thread::MutexLocker lock(&m_incoming_mutex);
-    callbacks_to_run.swap(m_incoming_callbacks);
-  }
-
+  m_incoming_queue->PopAll(&callbacks_to_run);
   RunCallbacks(&callbacks_to_run);
 }
 
@@ -20,6 +20,7 @@
  */
 
 #include <cppunit/extensions/HelperMacros.h>
+#include <vector>
 
 #include "ola/testing/TestUtils.h"
 
@@ -28,6 +29,7 @@
 #include "ola/thread/Thread.h"
 #include "ola/io/SelectServer.h"
 #include "ola/network/Socket.h"
+#include "ola/stl/STLUtils.h"
 
 using ola::io::SelectServer;
 using ola::network::UDPSocket;
@@ -64,18 +66,55 @@ class TestThread: public ola::thread::Thread {
 };
 
 
+/**
+ * A thread that calls Execute() many times.
+ */
+class BurstThread: public ola::thread::Thread {
+ public:
+    BurstThread(SelectServer *ss, unsigned int count, unsigned int *executed)
+        : m_ss(ss),
+          m_count(count),
+          m_executed(executed) {
+    }
+
+    void *Run() {
+      for (unsigned int i = 0; i < m_count; i++) {
+        m_ss->Execute(
+            ola::NewSingleCallback(this, &BurstThread::Increment));
+      }
+      return NULL;
+    }
+
+ private:
+    SelectServer *m_ss;
+    unsigned int m_count;
+    unsigned int *m_executed;
+
+    // Runs in the SelectServer thread.
+    void Increment() { (*m_executed)++; }
+};
+
+
 class SelectServerThreadTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(SelectServerThreadTest);
   CPPUNIT_TEST(testSameThreadCallback);
   CPPUNIT_TEST(testDifferentThreadCallback);
+  CPPUNIT_TEST(testManyThreadCallbacks);
   CPPUNIT_TEST_SUITE_END();
 
  public:
   void testSameThreadCallback();
   void testDifferentThreadCallback();
+  void testManyThreadCallbacks();
 
  private:
   SelectServer m_ss;
+
+  void CheckExecuted(unsigned int *executed, unsigned int expected) {
+    if (*executed == expected) {
+      m_ss.Terminate();
+    }
+  }
 };
 
 
@@ -106,3 +145,36 @@ void SelectServerThreadTest::testDifferentThreadCallback() {
   test_thread.Join();
   OLA_ASSERT_TRUE(test_thread.CallbackRun());
 }
+
+
+/*
+ * Check that callbacks from many threads are all executed.
+ */
+void SelectServerThreadTest::testManyThreadCallbacks() {
+  const unsigned int THREADS = 4;
+  const unsigned int CALLBACKS_PER_THREAD = 1000;
+  unsigned int executed = 0;
+
+  std::vector<BurstThread*> threads;
+  for (unsigned int i = 0; i < THREADS; i++) {
+    threads.push_back(
+        new BurstThread(&m_ss, CALLBACKS_PER_THREAD, &executed));
+  }
+
+  m_ss.RunInLoop(ola::NewCallback(
+      this, &SelectServerThreadTest::CheckExecuted, &executed,
+      THREADS * CALLBACKS_PER_THREAD));
+  m_ss.RegisterSingleTimeout(
+      10000, ola::NewSingleCallback(&m_ss, &SelectServer::Terminate));
+
+  for (unsigned int i = 0; i < THREADS; i++) {
+    threads[i]->Start();
+  }
+  m_ss.Run();
+
+  for (unsigned int i = 0; i < THREADS; i++) {
+    threads[i]->Join();
+  }
+  ola::STLDeleteElements(&threads);
+  OLA_ASSERT_EQ(THREADS * CALLBACKS_PER_THREAD, executed);
+}
@@ -0,0 +1,170 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * execute_loadtest.cpp
+ * Measure the latency of handing callbacks to the SelectServer thread with
+ * Execute().
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#include <stdint.h>
+#include <unistd.h>
+
+#include <iostream>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/Logging.h"
+#include "ola/base/Flags.h"
+#include "ola/base/Init.h"
+#include "ola/io/SelectServer.h"
+#include "ola/stl/STLUtils.h"
+#include "ola/thread/Thread.h"
+
+using ola::Clock;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::io::SelectServer;
+using std::cout;
+using std::endl;
+using std::vector;
+
+DEFINE_s_uint32(threads, t, 4, "The number of producer threads");
+DEFINE_s_uint32(count, c, 100000, "The number of callbacks per thread");
+DEFINE_s_uint32(delay, d, 0,
+                "Micro-seconds to sleep between Execute() calls, 0 for none");
+
+/**
+ * Records the hand-off latency of each callback. All methods other than
+ * Send() are run in the SelectServer thread.
+ */
+class Tracker {
+ public:
+  Tracker(SelectServer *ss, uint64_t expected)
+      : m_ss(ss),
+        m_expected(expected),
+        m_count(0),
+        m_sum(0) {
+  }
+
+  void Send() {
+    TimeStamp now;
+    m_clock.CurrentTime(&now);
+    m_ss->Execute(ola::NewSingleCallback(this, &Tracker::Received, now));
+  }
+
+  void Received(TimeStamp sent) {
+    TimeStamp now;
+    m_clock.CurrentTime(&now);
+    TimeInterval delta = now - sent;
+    if (m_count == 0 || delta < m_min) {
+      m_min = delta;
+    }
+    if (delta > m_max) {
+      m_max = delta;
+    }
+    m_sum += delta.AsInt();
+    if (++m_count == m_expected) {
+      m_ss->Terminate();
+    }
+  }
+
+  void PrintStats(const TimeInterval &duration) const {
+    cout << "Executed " << m_count << " callbacks in " << duration << endl;
+    if (!m_count) {
+      return;
+    }
+    cout << "Min was " << m_min.AsInt() << " microseconds" << endl;
+    cout << "Max was " << m_max.AsInt() << " microseconds" << endl;
+    cout << "Mean " << m_sum / m_count << " microseconds" << endl;
+    if (duration.AsInt()) {
+      cout << "Throughput " << (m_count * 1000000 / duration.AsInt())
+           << " callbacks/s" << endl;
+    }
+  }
+
+ private:
+  SelectServer *m_ss;
+  const uint64_t m_expected;
+  uint64_t m_count;
+  uint64_t m_sum;
+  TimeInterval m_min;
+  TimeInterval m_max;
+  Clock m_clock;
+};
+
+
+class ProducerThread: public ola::thread::Thread {
+ public:
+  ProducerThread(Tracker *tracker, unsigned int count, unsigned int delay)
+      : m_tracker(tracker),
+        m_count(count),
+        m_delay(delay) {
+  }
+
+  void *Run() {
+    for (unsigned int i = 0; i < m_count; i++) {
+      m_tracker->Send();
+      if (m_delay) {
+        usleep(m_delay);
+      }
+    }
+    return NULL;
+  }
+
+ private:
+  Tracker *m_tracker;
+  const unsigned int m_count;
+  const unsigned int m_delay;
+};
+
+
+int main(int argc, char* argv[]) {
+  ola::AppInit(&argc, argv, "[options]",
+               "Measure the latency of SelectServer::Execute().");
+
+  if (FLAGS_threads == 0 || FLAGS_count == 0) {
+    return -1;
+  }
+
+  SelectServer ss;
+  Tracker tracker(&ss, static_cast<uint64_t>(FLAGS_threads) * FLAGS_count);
+
+  vector<ProducerThread*> threads;
+  for (unsigned int i = 0; i < FLAGS_threads; i++) {
+    threads.push_back(new ProducerThread(&tracker, FLAGS_count, FLAGS_delay));
+  }
+
+  cout << "Starting loadtester: " << FLAGS_threads << " thread(s), "
+       << FLAGS_count << " callbacks per thread" << endl;
+
+  Clock clock;
+  TimeStamp start, end;
+  clock.CurrentTime(&start);
+  for (unsigned int i = 0; i < threads.size(); i++) {
+    threads[i]->Start();
+  }
+  ss.Run();
+  clock.CurrentTime(&end);
+
+  for (unsigned int i = 0; i < threads.size(); i++) {
+    threads[i]->Join();
+  }
+  ola::STLDeleteElements(&threads);
+
+  tracker.PrintStats(end - start);
+  return 0;
+}
@@ -18,11 +18,15 @@
  * Copyright (C) 2011 Simon Newton
  */
 
+#include <stdint.h>
+#include <algorithm>
+
 #include "ola/Callback.h"
 #include "ola/Logging.h"
 #include "ola/rdm/DiscoveryAgent.h"
 #include "ola/rdm/UID.h"
 #include "ola/rdm/UIDSet.h"
+#include "ola/stl/STLUtils.h"
 #include "ola/strings/Format.h"
 #include "ola/util/Utils.h"
 
@@ -31,13 +35,23 @@ namespace rdm {
 
 using ola::utils::JoinUInt8;
 
+namespace {
+
+uint64_t UIDToUInt64(const UID &uid) {
+  return (static_cast<uint64_t>(uid.ManufacturerId()) << 32) | uid.DeviceId();
+}
+
+UID UInt64ToUID(uint64_t value) {
+  return UID(static_cast<uint16_t>(value >> 32),
+             static_cast<uint32_t>(value & 0xffffffff));
+}
+}  // namespace
+
 DiscoveryAgent::DiscoveryAgent(DiscoveryTargetInterface *target)
     : m_target(target),
       m_on_complete(NULL),
       m_unmute_callback(
           ola::NewCallback(this, &DiscoveryAgent::UnMuteComplete)),
-      m_incremental_mute_callback(
-        ola::NewCallback(this, &DiscoveryAgent::IncrementalMuteComplete)),
       m_branch_mute_callback(
         ola::NewCallback(this, &DiscoveryAgent::BranchMuteComplete)),
       m_branch_callback(
@@ -45,11 +59,15 @@ DiscoveryAgent::DiscoveryAgent(DiscoveryTargetInterface *target)
       m_muting_uid(0, 0),
       m_unmute_count(0),
       m_mute_attempts(0),
+      m_mutes_in_flight(0),
+      m_generation(0),
+      m_sending_mutes(false),
       m_tree_corrupt(false) {
 }
 
 DiscoveryAgent::~DiscoveryAgent() {
   Abort();
+  STLDeleteElements(&m_incremental_mutes);
 }
 
 void DiscoveryAgent::Abort() {
@@ -59,6 +77,14 @@ void DiscoveryAgent::Abort() {
     m_uid_ranges.pop();
   }
 
+  // Any mutes still outstanding belong to this run, ignore them when they
+  // complete.
+  while (!m_uids_to_mute.empty()) {
+    m_uids_to_mute.pop();
+  }
+  m_mutes_in_flight = 0;
+  m_generation++;
+
   if (m_on_complete) {
     DiscoveryCompleteCallback *callback = m_on_complete;
     m_on_complete = NULL;
@@ -108,16 +134,25 @@ void DiscoveryAgent::InitDiscovery(
     for (; iter != m_uids.End(); ++iter) {
       m_uids_to_mute.push(*iter);
     }
+    // The known devices are muted, so the whole range only needs a single
+    // DUB unless new devices have appeared.
+    m_uid_ranges.push(new UIDRange(UID(0, 0), UID::AllDevices(), NULL));
   } else {
+    // Most of the devices are likely to still be there, so start from the
+    // branches that isolated them last time, rather than repeating the
+    // collisions at the top of the tree.
+    if (m_tree_corrupt) {
+      m_uids.Clear();
+    }
+    PushKnownDeviceRanges(m_uids);
     m_uids.Clear();
   }
 
   m_bad_uids.Clear();
   m_tree_corrupt = false;
-
-  // push the first range on to the branch stack
-  UID lower(0, 0);
-  m_uid_ranges.push(new UIDRange(lower, UID::AllDevices(), NULL));
+  m_stats = DiscoveryStats();
+  m_mutes_in_flight = 0;
+  m_generation++;
 
   m_unmute_count = 0;
   m_target->UnMuteAll(m_unmute_callback.get());
@@ -145,27 +180,74 @@ void DiscoveryAgent::UnMuteComplete() {
 /*
  * If we're in incremental mode, mute previously discovered devices. Otherwise
  * proceed to the branch stage.
+ *
+ * If the target completes mutes synchronously, this loops rather than
+ * recursing.
  */
 void DiscoveryAgent::MaybeMuteNextDevice() {
-  if (m_uids_to_mute.empty()) {
-    SendDiscovery();
-  } else {
-    m_muting_uid = m_uids_to_mute.front();
+  if (m_sending_mutes) {
+    return;
+  }
+
+  m_sending_mutes = true;
+  const unsigned int max_in_flight = std::max(1u,
+                                              m_target->MaxMutesInFlight());
+  while (!m_uids_to_mute.empty() && m_mutes_in_flight < max_in_flight) {
+    UID uid = m_uids_to_mute.front();
     m_uids_to_mute.pop();
-    OLA_DEBUG << "Muting previously discovered responder: " << m_muting_uid;
-    m_target->MuteDevice(m_muting_uid, m_incremental_mute_callback.get());
+    OLA_DEBUG << "Muting previously discovered responder: " << uid;
+    m_mutes_in_flight++;
+    m_stats.mutes++;
+    IncrementalMute *mute = FreeIncrementalMute();
+    mute->uid = uid;
+    mute->generation = m_generation;
+    mute->in_flight = true;
+    m_target->MuteDevice(uid, mute->callback.get());
+  }
+  m_sending_mutes = false;
+
+  if (m_uids_to_mute.empty() && m_mutes_in_flight == 0) {
+    SendDiscovery();
+  }
+}
+
+/*
+ * Return an IncrementalMute that isn't outstanding, creating one if required.
+ * Mutes from an aborted run may never complete, so these aren't limited to
+ * MaxMutesInFlight().
+ */
+DiscoveryAgent::IncrementalMute *DiscoveryAgent::FreeIncrementalMute() {
+  IncrementalMutes::iterator iter = m_incremental_mutes.begin();
+  for (; iter != m_incremental_mutes.end(); ++iter) {
+    if (!(*iter)->in_flight) {
+      return *iter;
+    }
   }
+  IncrementalMute *mute = new IncrementalMute();
+  mute->callback.reset(
+      NewCallback(this, &DiscoveryAgent::IncrementalMuteComplete, mute));
+  m_incremental_mutes.push_back(mute);
+  return mute;
 }
 
 /**
  * Called when we mute a device during incremental discovery.
  */
-void DiscoveryAgent::IncrementalMuteComplete(bool status) {
+void DiscoveryAgent::IncrementalMuteComplete(IncrementalMute *mute,
+                                             bool status) {
+  mute->in_flight = false;
+  if (mute->generation != m_generation || m_mutes_in_flight == 0) {
+    OLA_DEBUG << "Ignoring mute of " << mute->uid
+              << " from an earlier discovery run";
+    return;
+  }
+
+  m_mutes_in_flight--;
   if (!status) {
-    m_uids.RemoveUID(m_muting_uid);
-    OLA_WARN << "Unable to mute " << m_muting_uid << ", device has gone";
+    m_uids.RemoveUID(mute->uid);
+    OLA_WARN << "Unable to mute " << mute->uid << ", device has gone";
   } else {
-    OLA_DEBUG << "Muted " << m_muting_uid;
+    OLA_DEBUG << "Muted " << mute->uid;
   }
   MaybeMuteNextDevice();
 }
@@ -177,8 +259,12 @@ void DiscoveryAgent::SendDiscovery() {
   if (m_uid_ranges.empty()) {
     // we're hit the end of the stack, now we're done
     if (m_on_complete) {
-      m_on_complete->Run(!m_tree_corrupt, m_uids);
+      OLA_INFO << "Discovery found " << m_uids.Size() << " UIDs using "
+               << m_stats.branches << " branches, " << m_stats.collisions
+               << " collisions and " << m_stats.mutes << " mutes";
+      DiscoveryCompleteCallback *callback = m_on_complete;
       m_on_complete = NULL;
+      callback->Run(!m_tree_corrupt, m_uids);
     } else {
       OLA_WARN << "Discovery complete but no callback";
     }
@@ -204,6 +290,7 @@ void DiscoveryAgent::SendDiscovery() {
               << ", attempt " << range->attempt << ", uids found: "
               << range->uids_discovered << ", failures " << range->failures
               << ", corrupted " << range->branch_corrupt;
+    m_stats.branches++;
     m_target->Branch(range->lower, range->upper, m_branch_callback.get());
   }
 }
@@ -319,6 +406,7 @@ void DiscoveryAgent::BranchComplete(const uint8_t *data, unsigned int length) {
     m_muting_uid = located_uid;
     m_mute_attempts = 0;
     OLA_INFO << "Muting " << m_muting_uid;
+    m_stats.mutes++;
     m_target->MuteDevice(m_muting_uid, m_branch_mute_callback.get());
   }
 }
@@ -335,6 +423,7 @@ void DiscoveryAgent::BranchMuteComplete(bool status) {
     // failed to mute, if we haven't reached the limit try it again
     if (m_mute_attempts < MAX_MUTE_ATTEMPTS) {
       OLA_INFO << "Muting " << m_muting_uid;
+      m_stats.mutes++;
       m_target->MuteDevice(m_muting_uid, m_branch_mute_callback.get());
       return;
     } else {
@@ -351,6 +440,7 @@ void DiscoveryAgent::BranchMuteComplete(bool status) {
  * Handle a DUB collision.
  */
 void DiscoveryAgent::HandleCollision() {
+  m_stats.collisions++;
   UIDRange *range = m_uid_ranges.top();
   UID lower_uid = range->lower;
   UID upper_uid = range->upper;
@@ -386,8 +476,8 @@ void DiscoveryAgent::HandleCollision() {
  */
 void DiscoveryAgent::FreeCurrentRange() {
   UIDRange *range = m_uid_ranges.top();
-  if (m_uid_ranges.size() == 1) {
-    // top of stack
+  if (!range->parent) {
+    // top of the tree
     if (range->branch_corrupt) {
       OLA_INFO << "Discovery tree is corrupted";
       m_tree_corrupt = true;
@@ -398,5 +488,30 @@ void DiscoveryAgent::FreeCurrentRange() {
   delete range;
   m_uid_ranges.pop();
 }
+
+/*
+ * Push ranges covering all UIDs onto the stack, with one of the given UIDs in
+ * each. The ranges are split at the mid point between neighbouring UIDs.
+ */
+void DiscoveryAgent::PushKnownDeviceRanges(const UIDSet &uids) {
+  if (uids.Empty()) {
+    m_uid_ranges.push(new UIDRange(UID(0, 0), UID::AllDevices(), NULL));
+    return;
+  }
+
+  // The stack is LIFO, so push the ranges from the top down.
+  UID upper = UID::AllDevices();
+  UIDSet::Iterator iter = uids.End();
+  UIDSet::Iterator previous = iter;
+  --previous;
+  while (previous != uids.Begin()) {
+    iter = previous;
+    --previous;
+    uint64_t mid = (UIDToUInt64(*previous) + UIDToUInt64(*iter)) / 2;
+    m_uid_ranges.push(new UIDRange(UInt64ToUID(mid + 1), upper, NULL));
+    upper = UInt64ToUID(mid);
+  }
+  m_uid_ranges.push(new UIDRange(UID(0, 0), upper, NULL));
+}
 }  // namespace rdm
 }  // namespace ola
@@ -44,6 +44,8 @@ class DiscoveryAgentTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testSingleResponder);
   CPPUNIT_TEST(testResponderWithBroadcastUID);
   CPPUNIT_TEST(testMultipleResponders);
+  CPPUNIT_TEST(testLargeUniverse);
+  CPPUNIT_TEST(testAbortWithMutesInFlight);
   CPPUNIT_TEST(testObnoxiousResponder);
   CPPUNIT_TEST(testRamblingResponder);
   CPPUNIT_TEST(testBipolarResponder);
@@ -62,6 +64,8 @@ class DiscoveryAgentTest: public CppUnit::TestFixture {
     void testSingleResponder();
     void testResponderWithBroadcastUID();
     void testMultipleResponders();
+    void testLargeUniverse();
+    void testAbortWithMutesInFlight();
     void testObnoxiousResponder();
     void testRamblingResponder();
     void testBriefResponder();
@@ -248,6 +252,120 @@ void DiscoveryAgentTest::testMultipleResponders() {
 }
 
 
+/**
+ * Test a large universe, and that repeated discovery uses the UIDs that are
+ * already known.
+ */
+void DiscoveryAgentTest::testLargeUniverse() {
+  UIDSet uids;
+  ResponderList responders;
+  for (unsigned int i = 0; i < 512; i++) {
+    uids.AddUID(UID(0x7a70 + (i % 4), 0x00001000 + i * 977));
+  }
+  PopulateResponderListFromUIDs(uids, &responders);
+  MockDiscoveryTarget target(responders);
+  target.SetMaxMutesInFlight(4);
+
+  DiscoveryAgent agent(&target);
+  agent.StartFullDiscovery(
+      ola::NewSingleCallback(this,
+                             &DiscoveryAgentTest::DiscoverySuccessful,
+                             static_cast<const UIDSet*>(&uids)));
+  OLA_ASSERT_TRUE(m_callback_run);
+  m_callback_run = false;
+  const unsigned int initial_branches = agent.Stats().branches;
+  OLA_ASSERT_TRUE(agent.Stats().collisions > 0);
+  OLA_ASSERT_EQ(512u, agent.Stats().mutes);
+
+  // The second run starts with one range per known device, so there are no
+  // collisions.
+  agent.StartFullDiscovery(
+      ola::NewSingleCallback(this,
+                             &DiscoveryAgentTest::DiscoverySuccessful,
+                             static_cast<const UIDSet*>(&uids)));
+  OLA_ASSERT_TRUE(m_callback_run);
+  m_callback_run = false;
+  OLA_ASSERT_EQ(0u, agent.Stats().collisions);
+  OLA_ASSERT_TRUE(agent.Stats().branches < initial_branches);
+
+  // Incremental discovery mutes the known devices, then only needs to check
+  // the entire range once.
+  UID uid_to_remove = *uids.Begin();
+  UID uid_to_add(0x7a70, 0x00000001);
+  uids.RemoveUID(uid_to_remove);
+  uids.AddUID(uid_to_add);
+  target.RemoveResponder(uid_to_remove);
+  target.AddResponder(new MockResponder(uid_to_add));
+
+  agent.StartIncrementalDiscovery(
+      ola::NewSingleCallback(this,
+                             &DiscoveryAgentTest::DiscoverySuccessful,
+                             static_cast<const UIDSet*>(&uids)));
+  OLA_ASSERT_TRUE(m_callback_run);
+  OLA_ASSERT_EQ(513u, agent.Stats().mutes);
+  OLA_ASSERT_TRUE(agent.Stats().branches < initial_branches);
+}
+
+
+/**
+ * Test that mutes which complete after Abort() don't affect the next run.
+ */
+void DiscoveryAgentTest::testAbortWithMutesInFlight() {
+  UIDSet uids;
+  ResponderList responders;
+  for (unsigned int i = 0; i < 10; i++) {
+    uids.AddUID(UID(0x7a70, 0x00002000 + i * 101));
+  }
+  PopulateResponderListFromUIDs(uids, &responders);
+  MockDiscoveryTarget target(responders);
+  target.SetMaxMutesInFlight(4);
+
+  DiscoveryAgent agent(&target);
+  agent.StartFullDiscovery(
+      ola::NewSingleCallback(this,
+                             &DiscoveryAgentTest::DiscoverySuccessful,
+                             static_cast<const UIDSet*>(&uids)));
+  OLA_ASSERT_TRUE(m_callback_run);
+  m_callback_run = false;
+
+  // Abort incremental discovery while the first mutes are outstanding.
+  target.SetAsyncMutes(true);
+  const UIDSet empty_set;
+  agent.StartIncrementalDiscovery(
+      ola::NewSingleCallback(this,
+                             &DiscoveryAgentTest::DiscoveryFailed,
+                             static_cast<const UIDSet*>(&empty_set)));
+  OLA_ASSERT_EQ(4u, target.PendingMuteCount());
+  agent.Abort();
+  OLA_ASSERT_TRUE(m_callback_run);
+  m_callback_run = false;
+
+  // The late completions don't send the remaining mutes.
+  OLA_ASSERT_TRUE(target.CompleteNextMute());
+  OLA_ASSERT_TRUE(target.CompleteNextMute());
+  OLA_ASSERT_EQ(2u, target.PendingMuteCount());
+
+  // Restart, and complete the old mutes before the new ones.
+  agent.StartIncrementalDiscovery(
+      ola::NewSingleCallback(this,
+                             &DiscoveryAgentTest::DiscoverySuccessful,
+                             static_cast<const UIDSet*>(&uids)));
+  OLA_ASSERT_EQ(6u, target.PendingMuteCount());
+  while (target.CompleteNextMute()) {
+  }
+  OLA_ASSERT_TRUE(m_callback_run);
+  OLA_ASSERT_EQ(10u, agent.Stats().mutes);
+
+  // And the agent is destroyed with mutes outstanding.
+  m_callback_run = false;
+  agent.StartIncrementalDiscovery(
+      ola::NewSingleCallback(this,
+                             &DiscoveryAgentTest::DiscoveryFailed,
+                             static_cast<const UIDSet*>(&empty_set)));
+  OLA_ASSERT_EQ(4u, target.PendingMuteCount());
+}
+
+
 /**
  * Test a responder that continues to responder when muted.
  */
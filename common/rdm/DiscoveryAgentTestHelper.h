@@ -24,6 +24,8 @@
 #include <cppunit/extensions/HelperMacros.h>
 #include <string.h>
 #include <algorithm>
+#include <queue>
+#include <utility>
 #include <vector>
 
 #include "ola/Logging.h"
@@ -340,7 +342,9 @@ class MockDiscoveryTarget: public ola::rdm::DiscoveryTargetInterface {
  public:
     explicit MockDiscoveryTarget(const ResponderList &responders)
         : m_responders(responders),
-          m_unmute_calls(0) {
+          m_unmute_calls(0),
+          m_max_mutes_in_flight(1),
+          m_async_mutes(false) {
     }
 
     ~MockDiscoveryTarget() {
@@ -357,18 +361,43 @@ class MockDiscoveryTarget: public ola::rdm::DiscoveryTargetInterface {
       return m_unmute_calls;
     }
 
+    void SetMaxMutesInFlight(unsigned int max_mutes_in_flight) {
+      m_max_mutes_in_flight = max_mutes_in_flight;
+    }
+
+    unsigned int MaxMutesInFlight() const {
+      return m_max_mutes_in_flight;
+    }
+
+    // Queue the mutes until CompleteNextMute() is called, rather than
+    // completing them within MuteDevice().
+    void SetAsyncMutes(bool async_mutes) {
+      m_async_mutes = async_mutes;
+    }
+
+    unsigned int PendingMuteCount() const {
+      return m_pending_mutes.size();
+    }
+
+    // Complete the oldest queued mute, returns false if there were none.
+    bool CompleteNextMute() {
+      if (m_pending_mutes.empty()) {
+        return false;
+      }
+      PendingMute mute = m_pending_mutes.front();
+      m_pending_mutes.pop();
+      RunMute(mute.first, mute.second);
+      return true;
+    }
+
     // Mute a device
     void MuteDevice(const ola::rdm::UID &target,
                     MuteDeviceCallback *mute_complete) {
-      ResponderList::const_iterator iter = m_responders.begin();
-      for (; iter != m_responders.end(); ++iter) {
-        if ((*iter)->Mute(target)) {
-          mute_complete->Run(true);
-          return;
-        }
+      if (m_async_mutes) {
+        m_pending_mutes.push(PendingMute(target, mute_complete));
+      } else {
+        RunMute(target, mute_complete);
       }
-      // if we made it this far the responder has gone
-      mute_complete->Run(false);
     }
 
     // Un Mute all devices
@@ -424,7 +453,25 @@ class MockDiscoveryTarget: public ola::rdm::DiscoveryTargetInterface {
     }
 
  private:
+    typedef std::pair<ola::rdm::UID, MuteDeviceCallback*> PendingMute;
+
     ResponderList m_responders;
     unsigned int m_unmute_calls;
+    unsigned int m_max_mutes_in_flight;
+    bool m_async_mutes;
+    std::queue<PendingMute> m_pending_mutes;
+
+    void RunMute(const ola::rdm::UID &target,
+                 MuteDeviceCallback *mute_complete) {
+      ResponderList::const_iterator iter = m_responders.begin();
+      for (; iter != m_responders.end(); ++iter) {
+        if ((*iter)->Mute(target)) {
+          mute_complete->Run(true);
+          return;
+        }
+      }
+      // if we made it this far the responder has gone
+      mute_complete->Run(false);
+    }
 };
 #endif  // COMMON_RDM_DISCOVERYAGENTTESTHELPER_H_
@@ -58,6 +58,27 @@ EXTRA_DIST += common/rdm/Pids.proto
 common/rdm/Pids.pb.cc common/rdm/Pids.pb.h: common/rdm/Makefile.mk common/rdm/Pids.proto
 	$(PROTOC) --cpp_out common/rdm --proto_path $(srcdir)/common/rdm $(srcdir)/common/rdm/Pids.proto
 
+# PROGRAMS
+##################################################
+noinst_PROGRAMS += \
+    common/rdm/message_codec_loadtest \
+    common/rdm/pid_store_loadtest \
+    common/rdm/uid_set_loadtest
+
+common_rdm_message_codec_loadtest_SOURCES = \
+    common/rdm/MessageCodec.cpp \
+    common/rdm/MessageCodec.h \
+    common/rdm/message_codec_loadtest.cpp
+common_rdm_message_codec_loadtest_LDADD = common/libolacommon.la
+
+common_rdm_pid_store_loadtest_SOURCES = \
+    common/rdm/pid_store_loadtest.cpp
+common_rdm_pid_store_loadtest_LDADD = common/libolacommon.la
+
+common_rdm_uid_set_loadtest_SOURCES = \
+    common/rdm/uid_set_loadtest.cpp
+common_rdm_uid_set_loadtest_LDADD = common/libolacommon.la
+
 # TESTS_DATA
 ##################################################
 
@@ -104,6 +125,9 @@ common_rdm_RDMHelperTester_LDADD = $(COMMON_TESTING_LIBS)
 
 common_rdm_RDMMessageTester_SOURCES = \
     common/rdm/GroupSizeCalculatorTest.cpp \
+    common/rdm/MessageCodec.cpp \
+    common/rdm/MessageCodec.h \
+    common/rdm/MessageCodecTest.cpp \
     common/rdm/MessageSerializerTest.cpp \
     common/rdm/MessageDeserializerTest.cpp \
     common/rdm/RDMMessageInterationTest.cpp \
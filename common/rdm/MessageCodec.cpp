@@ -0,0 +1,482 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * MessageCodec.cpp
+ * Encode & decode RDM parameter data using a compiled descriptor.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#include <string.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+
+#include "common/rdm/MessageCodec.h"
+#include "ola/messaging/Descriptor.h"
+#include "ola/messaging/DescriptorVisitor.h"
+
+namespace ola {
+namespace rdm {
+
+using ola::messaging::FieldDescriptor;
+using ola::messaging::FieldDescriptorGroup;
+using std::string;
+
+namespace {
+
+/*
+ * Read an integer of size bytes, sign extending if required.
+ */
+int64_t ReadInt(const uint8_t *data, unsigned int size, bool little_endian,
+                MessageCodec::FieldType type) {
+  uint32_t value = 0;
+  if (little_endian) {
+    for (unsigned int i = size; i > 0; i--) {
+      value = (value << 8) | data[i - 1];
+    }
+  } else {
+    for (unsigned int i = 0; i < size; i++) {
+      value = (value << 8) | data[i];
+    }
+  }
+
+  switch (type) {
+    case MessageCodec::INT8_FIELD:
+      return static_cast<int8_t>(value);
+    case MessageCodec::INT16_FIELD:
+      return static_cast<int16_t>(value);
+    case MessageCodec::INT32_FIELD:
+      return static_cast<int32_t>(value);
+    default:
+      return value;
+  }
+}
+
+/*
+ * Write the low size bytes of an integer.
+ */
+void WriteInt(int64_t int_value, unsigned int size, bool little_endian,
+              uint8_t *data) {
+  uint32_t value = static_cast<uint32_t>(int_value);
+  for (unsigned int i = 0; i < size; i++) {
+    unsigned int shift = 8 * (little_endian ? i : size - 1 - i);
+    data[i] = static_cast<uint8_t>(value >> shift);
+  }
+}
+}  // namespace
+
+
+/**
+ * Flattens a Descriptor into the fields of a MessageCodec.
+ */
+class MessageCodecCompiler: public ola::messaging::FieldDescriptorVisitor {
+ public:
+  explicit MessageCodecCompiler(MessageCodec::Fields *fields)
+      : m_fields(fields) {
+  }
+
+  // we handle decending into groups ourself
+  bool Descend() const { return false; }
+
+  void Visit(const ola::messaging::BoolFieldDescriptor *descriptor) {
+    AddField(MessageCodec::BOOL_FIELD, descriptor->MaxSize());
+  }
+
+  void Visit(const ola::messaging::IPV4FieldDescriptor *descriptor) {
+    AddField(MessageCodec::IPV4_FIELD, descriptor->MaxSize());
+  }
+
+  void Visit(const ola::messaging::MACFieldDescriptor *descriptor) {
+    AddField(MessageCodec::MAC_FIELD, descriptor->MaxSize());
+  }
+
+  void Visit(const ola::messaging::UIDFieldDescriptor *descriptor) {
+    AddField(MessageCodec::UID_FIELD, descriptor->MaxSize());
+  }
+
+  void Visit(const ola::messaging::StringFieldDescriptor *descriptor) {
+    MessageCodec::Field &field = AddField(MessageCodec::STRING_FIELD,
+                                          descriptor->MaxSize());
+    field.min_size = descriptor->MinSize();
+  }
+
+  void Visit(const ola::messaging::UInt8FieldDescriptor *descriptor) {
+    AddIntField(MessageCodec::UINT8_FIELD, descriptor);
+  }
+
+  void Visit(const ola::messaging::UInt16FieldDescriptor *descriptor) {
+    AddIntField(MessageCodec::UINT16_FIELD, descriptor);
+  }
+
+  void Visit(const ola::messaging::UInt32FieldDescriptor *descriptor) {
+    AddIntField(MessageCodec::UINT32_FIELD, descriptor);
+  }
+
+  void Visit(const ola::messaging::Int8FieldDescriptor *descriptor) {
+    AddIntField(MessageCodec::INT8_FIELD, descriptor);
+  }
+
+  void Visit(const ola::messaging::Int16FieldDescriptor *descriptor) {
+    AddIntField(MessageCodec::INT16_FIELD, descriptor);
+  }
+
+  void Visit(const ola::messaging::Int32FieldDescriptor *descriptor) {
+    AddIntField(MessageCodec::INT32_FIELD, descriptor);
+  }
+
+  void Visit(const FieldDescriptorGroup *descriptor) {
+    unsigned int index = m_fields->size();
+    MessageCodec::Field &field = AddField(MessageCodec::GROUP_FIELD, 0);
+    field.block_size = descriptor->BlockSize();
+    field.min_blocks = descriptor->MinBlocks();
+    field.max_blocks = descriptor->MaxBlocks();
+
+    for (unsigned int i = 0; i < descriptor->FieldCount(); ++i) {
+      descriptor->GetField(i)->Accept(this);
+    }
+    (*m_fields)[index].end = m_fields->size();
+  }
+
+  void PostVisit(const FieldDescriptorGroup*) {}
+
+ private:
+  MessageCodec::Fields *m_fields;
+
+  MessageCodec::Field &AddField(MessageCodec::FieldType type,
+                                unsigned int size) {
+    MessageCodec::Field field;
+    field.type = type;
+    field.size = size;
+    field.min_size = size;
+    field.little_endian = false;
+    field.end = 0;
+    field.block_size = 0;
+    field.min_blocks = 0;
+    field.max_blocks = 0;
+    m_fields->push_back(field);
+    return m_fields->back();
+  }
+
+  template <typename int_type>
+  void AddIntField(
+      MessageCodec::FieldType type,
+      const ola::messaging::IntegerFieldDescriptor<int_type> *descriptor) {
+    MessageCodec::Field &field = AddField(type, descriptor->MaxSize());
+    field.little_endian = descriptor->IsLittleEndian();
+  }
+};
+
+
+ola::network::IPV4Address MessageCodec::Values::IPV4(
+    unsigned int index) const {
+  uint32_t address;
+  memcpy(&address, &m_data[m_values[index].offset], sizeof(address));
+  return ola::network::IPV4Address(address);
+}
+
+ola::network::MACAddress MessageCodec::Values::MAC(unsigned int index) const {
+  return ola::network::MACAddress(&m_data[m_values[index].offset]);
+}
+
+UID MessageCodec::Values::GetUID(unsigned int index) const {
+  return UID(&m_data[m_values[index].offset]);
+}
+
+string MessageCodec::Values::String(unsigned int index) const {
+  unsigned int length;
+  const uint8_t *data = StringData(index, &length);
+  return length ? string(reinterpret_cast<const char*>(data), length) :
+                  string();
+}
+
+const uint8_t *MessageCodec::Values::StringData(unsigned int index,
+                                                unsigned int *length) const {
+  const Value &value = m_values[index];
+  *length = value.length;
+  return m_data.empty() ? NULL : &m_data[0] + value.offset;
+}
+
+void MessageCodec::Values::AddIPV4(const ola::network::IPV4Address &address) {
+  uint32_t value = address.AsInt();
+  AddData(IPV4_FIELD, reinterpret_cast<const uint8_t*>(&value), sizeof(value));
+}
+
+void MessageCodec::Values::AddMAC(const ola::network::MACAddress &address) {
+  uint8_t data[ola::network::MACAddress::LENGTH];
+  address.Pack(data, sizeof(data));
+  AddData(MAC_FIELD, data, sizeof(data));
+}
+
+void MessageCodec::Values::AddUID(const UID &uid) {
+  uint8_t data[UID::LENGTH];
+  uid.Pack(data, sizeof(data));
+  AddData(UID_FIELD, data, sizeof(data));
+}
+
+void MessageCodec::Values::AddString(const string &value) {
+  AddData(STRING_FIELD, reinterpret_cast<const uint8_t*>(value.data()),
+          value.size());
+}
+
+void MessageCodec::Values::AddValue(FieldType type, int64_t int_value) {
+  Value value;
+  value.type = type;
+  value.value = int_value;
+  value.offset = 0;
+  value.length = 0;
+  m_values.push_back(value);
+}
+
+void MessageCodec::Values::AddData(FieldType type, const uint8_t *data,
+                                   unsigned int length) {
+  Value value;
+  value.type = type;
+  value.value = 0;
+  value.offset = m_data.size();
+  value.length = length;
+  m_values.push_back(value);
+  m_data.insert(m_data.end(), data, data + length);
+}
+
+
+MessageCodec *MessageCodec::Compile(
+    const ola::messaging::Descriptor *descriptor) {
+  std::auto_ptr<MessageCodec> codec(new MessageCodec());
+  MessageCodecCompiler compiler(&codec->m_fields);
+
+  for (unsigned int i = 0; i < descriptor->FieldCount(); ++i) {
+    const FieldDescriptor *field = descriptor->GetField(i);
+    unsigned int index = codec->m_fields.size();
+    field->Accept(&compiler);
+
+    if (field->FixedSize()) {
+      codec->m_fixed_size += field->MaxSize();
+      continue;
+    }
+
+    // The same restrictions as the VariableFieldSizeCalculator, otherwise
+    // the field boundaries can't be determined.
+    if (codec->m_variable_field >= 0) {
+      return NULL;
+    }
+    const Field &compiled = codec->m_fields[index];
+    if (compiled.type == GROUP_FIELD && compiled.block_size == 0) {
+      // BlockSize() is 0 if the blocks vary in size
+      return NULL;
+    }
+    codec->m_variable_field = index;
+  }
+  return codec.release();
+}
+
+
+bool MessageCodec::Decode(const uint8_t *data, unsigned int length,
+                          Values *values) const {
+  values->Clear();
+  if ((!data && length) || length < m_fixed_size) {
+    return false;
+  }
+
+  // Work out the length of the string, or the number of blocks in the group.
+  unsigned int remaining = length - m_fixed_size;
+  unsigned int variable_size = 0;
+  if (m_variable_field < 0) {
+    if (remaining) {
+      return false;
+    }
+  } else {
+    const Field &field = m_fields[m_variable_field];
+    if (field.type == STRING_FIELD) {
+      if (remaining < field.min_size || remaining > field.size) {
+        return false;
+      }
+      variable_size = remaining;
+    } else {
+      if (remaining % field.block_size) {
+        return false;
+      }
+      variable_size = remaining / field.block_size;
+      if (variable_size < field.min_blocks ||
+          (field.max_blocks != FieldDescriptorGroup::UNLIMITED_BLOCKS &&
+           variable_size > static_cast<unsigned int>(field.max_blocks))) {
+        return false;
+      }
+    }
+  }
+
+  unsigned int offset = 0;
+  return DecodeFields(0, m_fields.size(), variable_size, data, &offset,
+                      values);
+}
+
+
+bool MessageCodec::Encode(const Values &values, uint8_t *data,
+                          unsigned int *length) const {
+  unsigned int value_index = 0;
+  unsigned int offset = 0;
+  if (!EncodeFields(0, m_fields.size(), values, &value_index, data, *length,
+                    &offset) ||
+      value_index != values.Size()) {
+    return false;
+  }
+  *length = offset;
+  return true;
+}
+
+
+/*
+ * Decode the fields in [begin, end). The length of the data has already been
+ * checked.
+ */
+bool MessageCodec::DecodeFields(unsigned int begin, unsigned int end,
+                                unsigned int variable_size,
+                                const uint8_t *data, unsigned int *offset,
+                                Values *values) const {
+  unsigned int i = begin;
+  while (i < end) {
+    const Field &field = m_fields[i];
+    const uint8_t *ptr = data + *offset;
+    bool is_variable = static_cast<int>(i) == m_variable_field;
+
+    switch (field.type) {
+      case BOOL_FIELD:
+        values->AddValue(field.type, *ptr != 0);
+        break;
+      case UINT8_FIELD:
+      case UINT16_FIELD:
+      case UINT32_FIELD:
+      case INT8_FIELD:
+      case INT16_FIELD:
+      case INT32_FIELD:
+        values->AddValue(
+            field.type,
+            ReadInt(ptr, field.size, field.little_endian, field.type));
+        break;
+      case IPV4_FIELD:
+      case MAC_FIELD:
+      case UID_FIELD:
+        values->AddData(field.type, ptr, field.size);
+        break;
+      case STRING_FIELD:
+        {
+          unsigned int size = is_variable ? variable_size : field.size;
+          // strings are truncated at the first NULL
+          const void *null = memchr(ptr, 0, size);
+          values->AddData(field.type, ptr,
+                          null ? static_cast<const uint8_t*>(null) - ptr :
+                                 size);
+          *offset += size;
+          i++;
+          continue;
+        }
+      case GROUP_FIELD:
+        {
+          unsigned int blocks = is_variable ? variable_size : field.min_blocks;
+          values->AddValue(field.type, blocks);
+          for (unsigned int block = 0; block < blocks; block++) {
+            if (!DecodeFields(i + 1, field.end, 0, data, offset, values)) {
+              return false;
+            }
+          }
+          i = field.end;
+          continue;
+        }
+    }
+    *offset += field.size;
+    i++;
+  }
+  return true;
+}
+
+
+/*
+ * Encode the fields in [begin, end), consuming values from value_index
+ * onwards.
+ */
+bool MessageCodec::EncodeFields(unsigned int begin, unsigned int end,
+                                const Values &values,
+                                unsigned int *value_index,
+                                uint8_t *data, unsigned int length,
+                                unsigned int *offset) const {
+  unsigned int i = begin;
+  while (i < end) {
+    const Field &field = m_fields[i];
+    if (*value_index >= values.Size()) {
+      return false;
+    }
+    const Values::Value &value = values.m_values[(*value_index)++];
+    if (value.type != field.type) {
+      return false;
+    }
+
+    if (field.type == GROUP_FIELD) {
+      if (value.value < field.min_blocks ||
+          (field.max_blocks != FieldDescriptorGroup::UNLIMITED_BLOCKS &&
+           value.value > field.max_blocks)) {
+        return false;
+      }
+      for (int64_t block = 0; block < value.value; block++) {
+        if (!EncodeFields(i + 1, field.end, values, value_index, data, length,
+                          offset)) {
+          return false;
+        }
+      }
+      i = field.end;
+      continue;
+    }
+
+    unsigned int size = field.size;
+    unsigned int used_size = field.size;
+    if (field.type == STRING_FIELD) {
+      // strings are truncated to the max size, and padded to the min size
+      size = std::min(value.length, field.size);
+      used_size = std::max(size, field.min_size);
+    }
+    if (length - *offset < used_size) {
+      return false;
+    }
+
+    uint8_t *ptr = data + *offset;
+    switch (field.type) {
+      case BOOL_FIELD:
+        *ptr = value.value ? 1 : 0;
+        break;
+      case UINT8_FIELD:
+      case UINT16_FIELD:
+      case UINT32_FIELD:
+      case INT8_FIELD:
+      case INT16_FIELD:
+      case INT32_FIELD:
+        WriteInt(value.value, field.size, field.little_endian, ptr);
+        break;
+      case IPV4_FIELD:
+      case MAC_FIELD:
+      case UID_FIELD:
+      case STRING_FIELD:
+        if (size) {
+          memcpy(ptr, &values.m_data[0] + value.offset, size);
+        }
+        memset(ptr + size, 0, used_size - size);
+        break;
+      case GROUP_FIELD:
+        break;
+    }
+    *offset += used_size;
+    i++;
+  }
+  return true;
+}
+}  // namespace rdm
+}  // namespace ola
@@ -0,0 +1,257 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * MessageCodec.h
+ * Encode & decode RDM parameter data using a compiled descriptor.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#ifndef COMMON_RDM_MESSAGECODEC_H_
+#define COMMON_RDM_MESSAGECODEC_H_
+
+#include <stdint.h>
+#include <ola/base/Macro.h>
+#include <ola/messaging/Descriptor.h>
+#include <ola/network/IPV4Address.h>
+#include <ola/network/MACAddress.h>
+#include <ola/rdm/UID.h>
+#include <string>
+#include <vector>
+
+namespace ola {
+namespace rdm {
+
+/**
+ * @brief Encodes & decodes parameter data for a single Descriptor.
+ *
+ * MessageSerializer and MessageDeserializer walk the Descriptor with a
+ * visitor, and build a tree of heap allocated Message fields for every
+ * message. A MessageCodec flattens the Descriptor once, into a list of
+ * fields with their sizes & byte order, and the size of each group's blocks.
+ * Messages are then encoded from, and decoded into, a flat list of values.
+ *
+ * Once a MessageCodec::Values has grown to fit the largest message, encoding
+ * and decoding don't allocate any memory.
+ *
+ * The encoding matches MessageSerializer & MessageDeserializer.
+ */
+class MessageCodec {
+ public:
+  /**
+   * @brief The type of a field.
+   */
+  typedef enum {
+    BOOL_FIELD,
+    UINT8_FIELD,
+    UINT16_FIELD,
+    UINT32_FIELD,
+    INT8_FIELD,
+    INT16_FIELD,
+    INT32_FIELD,
+    IPV4_FIELD,
+    MAC_FIELD,
+    UID_FIELD,
+    STRING_FIELD,
+    GROUP_FIELD
+  } FieldType;
+
+  /**
+   * @brief The values of a message.
+   *
+   * The values are in the order the fields appear in the Descriptor. A group
+   * is a GROUP_FIELD value holding the number of blocks, followed by the
+   * values for each block in turn.
+   *
+   * Clear() keeps the memory that has been allocated, so a Values object
+   * should be reused.
+   */
+  class Values {
+   public:
+    Values() {}
+
+    /**
+     * @brief Remove all values.
+     */
+    void Clear() {
+      m_values.clear();
+      m_data.clear();
+    }
+
+    /**
+     * @brief The number of values.
+     */
+    unsigned int Size() const { return m_values.size(); }
+
+    /**
+     * @brief The type of a value.
+     */
+    FieldType Type(unsigned int index) const {
+      return m_values[index].type;
+    }
+
+    /**
+     * @brief Return a bool, integer or group value.
+     * @param index the index of the value.
+     * @returns the value. For a group this is the number of blocks.
+     */
+    int64_t Int(unsigned int index) const { return m_values[index].value; }
+
+    /**
+     * @brief Return a bool value.
+     */
+    bool Bool(unsigned int index) const { return m_values[index].value; }
+
+    /**
+     * @brief Return an IPV4 value.
+     */
+    ola::network::IPV4Address IPV4(unsigned int index) const;
+
+    /**
+     * @brief Return a MAC address value.
+     */
+    ola::network::MACAddress MAC(unsigned int index) const;
+
+    /**
+     * @brief Return a UID value.
+     */
+    ola::rdm::UID GetUID(unsigned int index) const;
+
+    /**
+     * @brief Return a string value.
+     *
+     * This allocates, use StringData() to avoid a copy.
+     */
+    std::string String(unsigned int index) const;
+
+    /**
+     * @brief Return the raw data of an IPV4, MAC, UID or string value.
+     * @param index the index of the value.
+     * @param[out] length the length of the data.
+     * @returns a pointer to the data, which is valid until the Values are
+     *   changed.
+     */
+    const uint8_t *StringData(unsigned int index, unsigned int *length) const;
+
+    void AddBool(bool value) { AddValue(BOOL_FIELD, value); }
+    void AddUInt8(uint8_t value) { AddValue(UINT8_FIELD, value); }
+    void AddUInt16(uint16_t value) { AddValue(UINT16_FIELD, value); }
+    void AddUInt32(uint32_t value) { AddValue(UINT32_FIELD, value); }
+    void AddInt8(int8_t value) { AddValue(INT8_FIELD, value); }
+    void AddInt16(int16_t value) { AddValue(INT16_FIELD, value); }
+    void AddInt32(int32_t value) { AddValue(INT32_FIELD, value); }
+    void AddIPV4(const ola::network::IPV4Address &address);
+    void AddMAC(const ola::network::MACAddress &address);
+    void AddUID(const ola::rdm::UID &uid);
+    void AddString(const std::string &value);
+
+    /**
+     * @brief Start a group.
+     * @param blocks the number of blocks that follow.
+     */
+    void AddGroup(unsigned int blocks) { AddValue(GROUP_FIELD, blocks); }
+
+   private:
+    struct Value {
+      FieldType type;
+      int64_t value;
+      unsigned int offset;
+      unsigned int length;
+    };
+
+    std::vector<Value> m_values;
+    std::vector<uint8_t> m_data;
+
+    void AddValue(FieldType type, int64_t value);
+    void AddData(FieldType type, const uint8_t *data, unsigned int length);
+
+    friend class MessageCodec;
+
+    DISALLOW_COPY_AND_ASSIGN(Values);
+  };
+
+  /**
+   * @brief Compile a Descriptor.
+   * @param descriptor the Descriptor to compile, ownership is not
+   *   transferred. The MessageCodec doesn't reference it once this returns.
+   * @returns a new MessageCodec, or NULL if the descriptor has more than one
+   *   variable sized field, or groups of variable sized blocks.
+   */
+  static MessageCodec *Compile(
+      const ola::messaging::Descriptor *descriptor);
+
+  /**
+   * @brief Decode parameter data.
+   * @param data the parameter data.
+   * @param length the length of the data.
+   * @param[out] values the decoded values.
+   * @returns true if the data matched the descriptor, false otherwise.
+   */
+  bool Decode(const uint8_t *data, unsigned int length, Values *values) const;
+
+  /**
+   * @brief Encode parameter data.
+   * @param values the values to encode.
+   * @param[out] data the buffer to encode into.
+   * @param[in,out] length the size of the buffer, set to the length of the
+   *   encoded data.
+   * @returns true if the values matched the descriptor and fit in the buffer,
+   *   false otherwise.
+   */
+  bool Encode(const Values &values, uint8_t *data,
+              unsigned int *length) const;
+
+  /**
+   * @brief The number of fields, including groups.
+   */
+  unsigned int FieldCount() const { return m_fields.size(); }
+
+ private:
+  struct Field {
+    FieldType type;
+    unsigned int size;  // the size of the field, or the max size for strings
+    unsigned int min_size;  // strings only
+    bool little_endian;
+    // groups only
+    unsigned int end;  // the index of the first field after the group
+    unsigned int block_size;
+    uint16_t min_blocks;
+    int16_t max_blocks;
+  };
+
+  typedef std::vector<Field> Fields;
+
+  Fields m_fields;
+  unsigned int m_fixed_size;
+  // The index of the variable sized top level field, or -1 if there isn't one
+  int m_variable_field;
+
+  MessageCodec() : m_fixed_size(0), m_variable_field(-1) {}
+
+  bool DecodeFields(unsigned int begin, unsigned int end,
+                    unsigned int variable_size,
+                    const uint8_t *data, unsigned int *offset,
+                    Values *values) const;
+  bool EncodeFields(unsigned int begin, unsigned int end,
+                    const Values &values, unsigned int *value_index,
+                    uint8_t *data, unsigned int length,
+                    unsigned int *offset) const;
+
+  friend class MessageCodecCompiler;
+
+  DISALLOW_COPY_AND_ASSIGN(MessageCodec);
+};
+}  // namespace rdm
+}  // namespace ola
+#endif  // COMMON_RDM_MESSAGECODEC_H_
@@ -0,0 +1,354 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * MessageCodecTest.cpp
+ * Test fixture for the MessageCodec class.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/rdm/MessageCodec.h"
+#include "ola/Logging.h"
+#include "ola/messaging/Descriptor.h"
+#include "ola/messaging/Message.h"
+#include "ola/network/IPV4Address.h"
+#include "ola/network/MACAddress.h"
+#include "ola/rdm/MessageDeserializer.h"
+#include "ola/rdm/MessageSerializer.h"
+#include "ola/rdm/UID.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::messaging::BoolFieldDescriptor;
+using ola::messaging::Descriptor;
+using ola::messaging::FieldDescriptor;
+using ola::messaging::FieldDescriptorGroup;
+using ola::messaging::IPV4FieldDescriptor;
+using ola::messaging::Int16FieldDescriptor;
+using ola::messaging::Int32FieldDescriptor;
+using ola::messaging::Int8FieldDescriptor;
+using ola::messaging::MACFieldDescriptor;
+using ola::messaging::Message;
+using ola::messaging::StringFieldDescriptor;
+using ola::messaging::UIDFieldDescriptor;
+using ola::messaging::UInt16FieldDescriptor;
+using ola::messaging::UInt32FieldDescriptor;
+using ola::messaging::UInt8FieldDescriptor;
+using ola::network::IPV4Address;
+using ola::network::MACAddress;
+using ola::rdm::MessageCodec;
+using ola::rdm::MessageDeserializer;
+using ola::rdm::MessageSerializer;
+using ola::rdm::UID;
+using std::auto_ptr;
+using std::string;
+using std::vector;
+
+
+class MessageCodecTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(MessageCodecTest);
+  CPPUNIT_TEST(testEmpty);
+  CPPUNIT_TEST(testIntegers);
+  CPPUNIT_TEST(testAddresses);
+  CPPUNIT_TEST(testString);
+  CPPUNIT_TEST(testGroups);
+  CPPUNIT_TEST(testUnsupported);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void testEmpty();
+    void testIntegers();
+    void testAddresses();
+    void testString();
+    void testGroups();
+    void testUnsupported();
+
+ private:
+    MessageCodec::Values m_values;
+    uint8_t m_buffer[256];
+
+    void CheckMatchesSerializer(const Descriptor &descriptor,
+                                const uint8_t *data,
+                                unsigned int length);
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(MessageCodecTest);
+
+
+/*
+ * Check that the data encoded by the codec matches the MessageSerializer,
+ * after the data is decoded with the MessageDeserializer.
+ */
+void MessageCodecTest::CheckMatchesSerializer(const Descriptor &descriptor,
+                                              const uint8_t *data,
+                                              unsigned int length) {
+  MessageDeserializer deserializer;
+  auto_ptr<const Message> message(
+      deserializer.InflateMessage(&descriptor, data, length));
+  OLA_ASSERT_NOT_NULL(message.get());
+
+  MessageSerializer serializer;
+  unsigned int serialized_length;
+  const uint8_t *serialized_data = serializer.SerializeMessage(
+      message.get(), &serialized_length);
+
+  auto_ptr<MessageCodec> codec(MessageCodec::Compile(&descriptor));
+  OLA_ASSERT_NOT_NULL(codec.get());
+  OLA_ASSERT_TRUE(codec->Decode(data, length, &m_values));
+  unsigned int encoded_length = sizeof(m_buffer);
+  OLA_ASSERT_TRUE(codec->Encode(m_values, m_buffer, &encoded_length));
+  OLA_ASSERT_DATA_EQUALS(serialized_data, serialized_length,
+                         m_buffer, encoded_length);
+}
+
+
+/**
+ * Check that empty messages work.
+ */
+void MessageCodecTest::testEmpty() {
+  vector<const FieldDescriptor*> fields;
+  Descriptor descriptor("Empty Descriptor", fields);
+
+  auto_ptr<MessageCodec> codec(MessageCodec::Compile(&descriptor));
+  OLA_ASSERT_NOT_NULL(codec.get());
+  OLA_ASSERT_EQ(0u, codec->FieldCount());
+
+  OLA_ASSERT_TRUE(codec->Decode(NULL, 0, &m_values));
+  OLA_ASSERT_EQ(0u, m_values.Size());
+
+  const uint8_t data[] = {0, 1, 2};
+  OLA_ASSERT_FALSE(codec->Decode(data, sizeof(data), &m_values));
+
+  unsigned int length = sizeof(m_buffer);
+  OLA_ASSERT_TRUE(codec->Encode(m_values, m_buffer, &length));
+  OLA_ASSERT_EQ(0u, length);
+}
+
+
+/**
+ * Test integers, in both byte orders.
+ */
+void MessageCodecTest::testIntegers() {
+  vector<const FieldDescriptor*> fields;
+  fields.push_back(new BoolFieldDescriptor("bool"));
+  fields.push_back(new UInt8FieldDescriptor("uint8"));
+  fields.push_back(new Int8FieldDescriptor("int8"));
+  fields.push_back(new UInt16FieldDescriptor("uint16"));
+  fields.push_back(new Int16FieldDescriptor("int16"));
+  fields.push_back(new UInt32FieldDescriptor("uint32"));
+  fields.push_back(new Int32FieldDescriptor("int32"));
+  fields.push_back(new UInt16FieldDescriptor("uint16 le", true));
+  fields.push_back(new Int32FieldDescriptor("int32 le", true));
+  Descriptor descriptor("Test Descriptor", fields);
+
+  const uint8_t data[] = {
+    1, 10, 246, 1, 0x2c, 0xfe, 10,
+    1, 2, 3, 4, 0xfe, 6, 7, 8,
+    0x2c, 1, 0xf8, 0xff, 0xff, 0xff};
+
+  auto_ptr<MessageCodec> codec(MessageCodec::Compile(&descriptor));
+  OLA_ASSERT_NOT_NULL(codec.get());
+  OLA_ASSERT_FALSE(codec->Decode(NULL, 0, &m_values));
+  OLA_ASSERT_FALSE(codec->Decode(data, sizeof(data) - 1, &m_values));
+  OLA_ASSERT_TRUE(codec->Decode(data, sizeof(data), &m_values));
+
+  OLA_ASSERT_EQ(9u, m_values.Size());
+  OLA_ASSERT_EQ(MessageCodec::BOOL_FIELD, m_values.Type(0));
+  OLA_ASSERT_TRUE(m_values.Bool(0));
+  OLA_ASSERT_EQ(MessageCodec::UINT8_FIELD, m_values.Type(1));
+  OLA_ASSERT_EQ(static_cast<int64_t>(10), m_values.Int(1));
+  OLA_ASSERT_EQ(static_cast<int64_t>(-10), m_values.Int(2));
+  OLA_ASSERT_EQ(static_cast<int64_t>(300), m_values.Int(3));
+  OLA_ASSERT_EQ(static_cast<int64_t>(-502), m_values.Int(4));
+  OLA_ASSERT_EQ(static_cast<int64_t>(16909060), m_values.Int(5));
+  OLA_ASSERT_EQ(static_cast<int64_t>(-33159416), m_values.Int(6));
+  OLA_ASSERT_EQ(static_cast<int64_t>(300), m_values.Int(7));
+  OLA_ASSERT_EQ(MessageCodec::INT32_FIELD, m_values.Type(8));
+  OLA_ASSERT_EQ(static_cast<int64_t>(-8), m_values.Int(8));
+
+  CheckMatchesSerializer(descriptor, data, sizeof(data));
+
+  // Values of the wrong type are rejected
+  m_values.Clear();
+  m_values.AddUInt8(1);
+  unsigned int length = sizeof(m_buffer);
+  OLA_ASSERT_FALSE(codec->Encode(m_values, m_buffer, &length));
+
+  // as is a buffer that's too small to hold the data
+  OLA_ASSERT_TRUE(codec->Decode(data, sizeof(data), &m_values));
+  length = sizeof(data) - 1;
+  OLA_ASSERT_FALSE(codec->Encode(m_values, m_buffer, &length));
+}
+
+
+/**
+ * Test IPV4, MAC & UID fields.
+ */
+void MessageCodecTest::testAddresses() {
+  vector<const FieldDescriptor*> fields;
+  fields.push_back(new IPV4FieldDescriptor("ip"));
+  fields.push_back(new MACFieldDescriptor("mac"));
+  fields.push_back(new UIDFieldDescriptor("uid"));
+  Descriptor descriptor("Test Descriptor", fields);
+
+  const uint8_t data[] = {
+    10, 0, 0, 1,
+    0x01, 0x23, 0x45, 0x67, 0x89, 0xab,
+    0x7a, 0x70, 0, 0, 0, 1};
+
+  auto_ptr<MessageCodec> codec(MessageCodec::Compile(&descriptor));
+  OLA_ASSERT_NOT_NULL(codec.get());
+  OLA_ASSERT_TRUE(codec->Decode(data, sizeof(data), &m_values));
+  OLA_ASSERT_EQ(3u, m_values.Size());
+  OLA_ASSERT_EQ(IPV4Address::FromStringOrDie("10.0.0.1"), m_values.IPV4(0));
+  OLA_ASSERT_EQ(MACAddress::FromStringOrDie("01:23:45:67:89:ab"),
+                m_values.MAC(1));
+  OLA_ASSERT_EQ(UID(0x7a70, 1), m_values.GetUID(2));
+
+  CheckMatchesSerializer(descriptor, data, sizeof(data));
+
+  m_values.Clear();
+  m_values.AddIPV4(IPV4Address::FromStringOrDie("10.0.0.1"));
+  m_values.AddMAC(MACAddress::FromStringOrDie("01:23:45:67:89:ab"));
+  m_values.AddUID(UID(0x7a70, 1));
+  unsigned int length = sizeof(m_buffer);
+  OLA_ASSERT_TRUE(codec->Encode(m_values, m_buffer, &length));
+  OLA_ASSERT_DATA_EQUALS(data, sizeof(data), m_buffer, length);
+}
+
+
+/**
+ * Test variable length strings.
+ */
+void MessageCodecTest::testString() {
+  vector<const FieldDescriptor*> fields;
+  fields.push_back(new StringFieldDescriptor("fixed", 4, 4));
+  fields.push_back(new StringFieldDescriptor("variable", 2, 8));
+  Descriptor descriptor("Test Descriptor", fields);
+
+  auto_ptr<MessageCodec> codec(MessageCodec::Compile(&descriptor));
+  OLA_ASSERT_NOT_NULL(codec.get());
+
+  const uint8_t data[] = {'a', 'b', 0, 0, 'c', 'd', 'e', 0, 'f'};
+  OLA_ASSERT_TRUE(codec->Decode(data, sizeof(data), &m_values));
+  OLA_ASSERT_EQ(2u, m_values.Size());
+  OLA_ASSERT_EQ(string("ab"), m_values.String(0));
+  // strings are truncated at the first NULL
+  OLA_ASSERT_EQ(string("cde"), m_values.String(1));
+  CheckMatchesSerializer(descriptor, data, sizeof(data));
+
+  // too short & too long
+  OLA_ASSERT_FALSE(codec->Decode(data, 5, &m_values));
+  const uint8_t long_data[13] = {'a', 'b', 'c', 'd'};
+  OLA_ASSERT_FALSE(codec->Decode(long_data, sizeof(long_data), &m_values));
+
+  // Strings are truncated to the max size, and padded to the min size.
+  m_values.Clear();
+  m_values.AddString("abcdef");
+  m_values.AddString("g");
+  unsigned int length = sizeof(m_buffer);
+  OLA_ASSERT_TRUE(codec->Encode(m_values, m_buffer, &length));
+  const uint8_t expected[] = {'a', 'b', 'c', 'd', 'g', 0};
+  OLA_ASSERT_DATA_EQUALS(expected, sizeof(expected), m_buffer, length);
+}
+
+
+/**
+ * Test a variable sized group, which contains a fixed size group.
+ */
+void MessageCodecTest::testGroups() {
+  vector<const FieldDescriptor*> inner_fields;
+  inner_fields.push_back(new UInt8FieldDescriptor("uint8"));
+  inner_fields.push_back(new BoolFieldDescriptor("bool"));
+
+  vector<const FieldDescriptor*> group_fields;
+  group_fields.push_back(new UInt16FieldDescriptor("uint16"));
+  group_fields.push_back(new FieldDescriptorGroup("inner", inner_fields, 2, 2));
+
+  vector<const FieldDescriptor*> fields;
+  fields.push_back(new UInt8FieldDescriptor("count"));
+  fields.push_back(new FieldDescriptorGroup("group", group_fields, 1, 3));
+  Descriptor descriptor("Test Descriptor", fields);
+
+  auto_ptr<MessageCodec> codec(MessageCodec::Compile(&descriptor));
+  OLA_ASSERT_NOT_NULL(codec.get());
+  OLA_ASSERT_EQ(6u, codec->FieldCount());
+
+  const uint8_t data[] = {
+    2,
+    0, 1, 10, 1, 11, 0,
+    0, 2, 20, 0, 21, 1};
+  OLA_ASSERT_TRUE(codec->Decode(data, sizeof(data), &m_values));
+  // count, group, (uint16, inner, (uint8, bool) * 2) * 2
+  OLA_ASSERT_EQ(14u, m_values.Size());
+  OLA_ASSERT_EQ(static_cast<int64_t>(2), m_values.Int(0));
+  OLA_ASSERT_EQ(MessageCodec::GROUP_FIELD, m_values.Type(1));
+  OLA_ASSERT_EQ(static_cast<int64_t>(2), m_values.Int(1));
+  OLA_ASSERT_EQ(static_cast<int64_t>(1), m_values.Int(2));
+  OLA_ASSERT_EQ(MessageCodec::GROUP_FIELD, m_values.Type(3));
+  OLA_ASSERT_EQ(static_cast<int64_t>(2), m_values.Int(3));
+  OLA_ASSERT_EQ(static_cast<int64_t>(10), m_values.Int(4));
+  OLA_ASSERT_TRUE(m_values.Bool(5));
+  OLA_ASSERT_EQ(static_cast<int64_t>(2), m_values.Int(8));
+  OLA_ASSERT_EQ(static_cast<int64_t>(21), m_values.Int(12));
+  OLA_ASSERT_TRUE(m_values.Bool(13));
+  CheckMatchesSerializer(descriptor, data, sizeof(data));
+
+  // partial blocks, too few & too many blocks
+  OLA_ASSERT_FALSE(codec->Decode(data, sizeof(data) - 1, &m_values));
+  OLA_ASSERT_FALSE(codec->Decode(data, 1, &m_values));
+  const uint8_t long_data[1 + 4 * 6] = {0};
+  OLA_ASSERT_FALSE(codec->Decode(long_data, sizeof(long_data), &m_values));
+
+  // the block count of a fixed group can't change
+  m_values.Clear();
+  m_values.AddUInt8(1);
+  m_values.AddGroup(1);
+  m_values.AddUInt16(1);
+  m_values.AddGroup(1);
+  m_values.AddUInt8(1);
+  m_values.AddBool(true);
+  unsigned int length = sizeof(m_buffer);
+  OLA_ASSERT_FALSE(codec->Encode(m_values, m_buffer, &length));
+
+  // and a trailing value is rejected
+  OLA_ASSERT_TRUE(codec->Decode(data, sizeof(data), &m_values));
+  m_values.AddUInt8(1);
+  length = sizeof(m_buffer);
+  OLA_ASSERT_FALSE(codec->Encode(m_values, m_buffer, &length));
+}
+
+
+/**
+ * Check that descriptors the MessageDeserializer can't handle aren't compiled.
+ */
+void MessageCodecTest::testUnsupported() {
+  vector<const FieldDescriptor*> fields;
+  fields.push_back(new StringFieldDescriptor("string1", 0, 4));
+  fields.push_back(new StringFieldDescriptor("string2", 0, 4));
+  Descriptor descriptor("Test Descriptor", fields);
+  OLA_ASSERT_NULL(MessageCodec::Compile(&descriptor));
+
+  vector<const FieldDescriptor*> group_fields;
+  group_fields.push_back(new StringFieldDescriptor("string", 0, 4));
+  vector<const FieldDescriptor*> fields2;
+  fields2.push_back(new FieldDescriptorGroup("group", group_fields, 0, 2));
+  Descriptor descriptor2("Test Descriptor", fields2);
+  OLA_ASSERT_NULL(MessageCodec::Compile(&descriptor2));
+}
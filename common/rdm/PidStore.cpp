@@ -18,6 +18,7 @@
  * Copyright (C) 2011 Simon Newton
  */
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -33,6 +34,29 @@ namespace rdm {
 using std::string;
 using std::vector;
 
+namespace {
+
+struct PidValueLessThan {
+  bool operator()(const PidDescriptor *a, const PidDescriptor *b) const {
+    return a->Value() < b->Value();
+  }
+
+  bool operator()(const PidDescriptor *a, uint16_t pid_value) const {
+    return a->Value() < pid_value;
+  }
+};
+
+struct PidNameLessThan {
+  bool operator()(const PidDescriptor *a, const PidDescriptor *b) const {
+    return a->Name() < b->Name();
+  }
+
+  bool operator()(const PidDescriptor *a, const string &pid_name) const {
+    return a->Name() < pid_name;
+  }
+};
+}  // namespace
+
 RootPidStore::~RootPidStore() {
   m_esta_store.reset();
   STLDeleteValues(&m_manufacturer_store);
@@ -114,13 +138,14 @@ const RootPidStore *RootPidStore::LoadFromFile(const string &file,
 
 const RootPidStore *RootPidStore::LoadFromDirectory(
     const string &directory,
-    bool validate) {
+    bool validate,
+    const string &cache_file) {
   PidStoreLoader loader;
   string data_source = directory;
   if (directory.empty()) {
     data_source = DataLocation();
   }
-  return loader.LoadFromDirectory(data_source, validate);
+  return loader.LoadFromDirectory(data_source, validate, cache_file);
 }
 
 const string RootPidStore::DataLocation() {
@@ -128,26 +153,21 @@ const string RootPidStore::DataLocation() {
   return PID_DATA_DIR;
 }
 
-PidStore::PidStore(const vector<const PidDescriptor*> &pids) {
-  vector<const PidDescriptor*>::const_iterator iter = pids.begin();
-  for (; iter != pids.end(); ++iter) {
-    m_pid_by_value[(*iter)->Value()] = *iter;
-    m_pid_by_name[(*iter)->Name()] = *iter;
-  }
+PidStore::PidStore(const vector<const PidDescriptor*> &pids)
+    : m_pid_by_value(pids),
+      m_pid_by_name(pids) {
+  std::sort(m_pid_by_value.begin(), m_pid_by_value.end(),
+            PidValueLessThan());
+  std::sort(m_pid_by_name.begin(), m_pid_by_name.end(), PidNameLessThan());
 }
 
 PidStore::~PidStore() {
-  STLDeleteValues(&m_pid_by_value);
+  STLDeleteElements(&m_pid_by_value);
   m_pid_by_name.clear();
 }
 
 void PidStore::AllPids(vector<const PidDescriptor*> *pids) const {
-  pids->reserve(pids->size() + m_pid_by_value.size());
-
-  PidMap::const_iterator iter = m_pid_by_value.begin();
-  for (; iter != m_pid_by_value.end(); ++iter) {
-    pids->push_back(iter->second);
-  }
+  pids->insert(pids->end(), m_pid_by_value.begin(), m_pid_by_value.end());
 }
 
 
@@ -167,11 +187,13 @@ PidDescriptor::~PidDescriptor() {
  * @param pid_value the 16 bit pid value.
  */
 const PidDescriptor *PidStore::LookupPID(uint16_t pid_value) const {
-  PidMap::const_iterator iter = m_pid_by_value.find(pid_value);
-  if (iter == m_pid_by_value.end())
+  PidList::const_iterator iter = std::lower_bound(
+      m_pid_by_value.begin(), m_pid_by_value.end(), pid_value,
+      PidValueLessThan());
+  if (iter == m_pid_by_value.end() || (*iter)->Value() != pid_value)
     return NULL;
   else
-    return iter->second;
+    return *iter;
 }
 
 
@@ -180,11 +202,13 @@ const PidDescriptor *PidStore::LookupPID(uint16_t pid_value) const {
  * @param pid_name the name of the pid.
  */
 const PidDescriptor *PidStore::LookupPID(const string &pid_name) const {
-  PidNameMap::const_iterator iter = m_pid_by_name.find(pid_name);
-  if (iter == m_pid_by_name.end())
+  PidList::const_iterator iter = std::lower_bound(
+      m_pid_by_name.begin(), m_pid_by_name.end(), pid_name,
+      PidNameLessThan());
+  if (iter == m_pid_by_name.end() || (*iter)->Name() != pid_name)
     return NULL;
   else
-    return iter->second;
+    return *iter;
 }
 
 
@@ -21,6 +21,15 @@
 #include <errno.h>
 #include <google/protobuf/io/zero_copy_stream_impl.h>
 #include <google/protobuf/text_format.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif  // _WIN32
+#include <algorithm>
 #include <fstream>
 #include <set>
 #include <sstream>
@@ -31,6 +40,8 @@
 #include "common/rdm/Pids.pb.h"
 #include "ola/Logging.h"
 #include "ola/StringUtils.h"
+#include "ola/base/Macro.h"
+#include "ola/base/Version.h"
 #include "ola/file/Util.h"
 #include "ola/rdm/PidStore.h"
 #include "ola/rdm/RDMEnums.h"
@@ -49,7 +60,123 @@ using std::set;
 using std::string;
 using std::vector;
 
+namespace {
+
+/*
+ * A read-only view of a file. Where possible the file is mapped into memory,
+ * so the cached protobufs are parsed straight from the page cache.
+ */
+class MappedFile {
+ public:
+  MappedFile() : m_data(NULL), m_size(0) {}
+  ~MappedFile();
+
+  bool Open(const string &path);
+
+  const uint8_t *Data() const { return m_data; }
+  unsigned int Size() const { return m_size; }
+
+ private:
+  const uint8_t *m_data;
+  unsigned int m_size;
+#ifdef _WIN32
+  string m_contents;
+#endif  // _WIN32
+
+  DISALLOW_COPY_AND_ASSIGN(MappedFile);
+};
+
+MappedFile::~MappedFile() {
+#ifndef _WIN32
+  if (m_data) {
+    munmap(const_cast<uint8_t*>(m_data), m_size);
+  }
+#endif  // _WIN32
+}
+
+bool MappedFile::Open(const string &path) {
+#ifdef _WIN32
+  std::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
+  if (!file.is_open()) {
+    return false;
+  }
+  ostringstream contents;
+  contents << file.rdbuf();
+  m_contents = contents.str();
+  m_data = reinterpret_cast<const uint8_t*>(m_contents.data());
+  m_size = m_contents.size();
+  return true;
+#else
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) || file_stat.st_size == 0) {
+    close(fd);
+    return false;
+  }
+
+  void *data = mmap(NULL, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    OLA_WARN << "Failed to map " << path << ": " << strerror(errno);
+    return false;
+  }
+  m_data = static_cast<const uint8_t*>(data);
+  m_size = file_stat.st_size;
+  return true;
+#endif  // _WIN32
+}
+
+/*
+ * The 32 bit FNV-1a hash of some data.
+ */
+uint32_t HashData(const uint8_t *data, unsigned int size) {
+  uint32_t hash = 2166136261u;
+  for (unsigned int i = 0; i < size; i++) {
+    hash ^= data[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+/*
+ * Cache blocks are a 4 byte, big endian length followed by the data.
+ */
+void AppendBlock(const string &block, string *output) {
+  const uint32_t length = block.size();
+  output->push_back(static_cast<char>(length >> 24));
+  output->push_back(static_cast<char>(length >> 16));
+  output->push_back(static_cast<char>(length >> 8));
+  output->push_back(static_cast<char>(length));
+  output->append(block);
+}
+
+bool ReadBlock(const uint8_t *data, unsigned int size, unsigned int *offset,
+               const uint8_t **block, unsigned int *block_size) {
+  if (size - *offset < 4) {
+    return false;
+  }
+  const uint8_t *ptr = data + *offset;
+  const uint32_t length = (static_cast<uint32_t>(ptr[0]) << 24) |
+                          (static_cast<uint32_t>(ptr[1]) << 16) |
+                          (static_cast<uint32_t>(ptr[2]) << 8) |
+                          ptr[3];
+  *offset += 4;
+  if (size - *offset < length) {
+    return false;
+  }
+  *block = data + *offset;
+  *block_size = length;
+  *offset += length;
+  return true;
+}
+}  // namespace
+
 const char PidStoreLoader::OVERRIDE_FILE_NAME[] = "overrides.proto";
+const char PidStoreLoader::CACHE_MAGIC[] = "OLAPIDS1";
 const uint16_t PidStoreLoader::ESTA_MANUFACTURER_ID = 0;
 const uint16_t PidStoreLoader::MANUFACTURER_PID_MIN = 0x8000;
 const uint16_t PidStoreLoader::MANUFACTURER_PID_MAX = 0xffe0;
@@ -70,18 +197,18 @@ const RootPidStore *PidStoreLoader::LoadFromFile(const string &file,
 
 const RootPidStore *PidStoreLoader::LoadFromDirectory(
     const string &directory,
-    bool validate) {
+    bool validate,
+    const string &cache_file) {
   vector<string> files;
-
   string override_file;
-  vector<string> all_files;
-  ola::file::ListDirectory(directory, &all_files);
-  vector<string>::const_iterator file_iter = all_files.begin();
-  for (; file_iter != all_files.end(); ++file_iter) {
-    if (ola::file::FilenameFromPath(*file_iter) == OVERRIDE_FILE_NAME) {
-      override_file = *file_iter;
-    } else if (StringEndsWith(*file_iter, ".proto")) {
-      files.push_back(*file_iter);
+  ListPidFiles(directory, &files, &override_file);
+
+  string cache_key;
+  if (!cache_file.empty()) {
+    cache_key = CacheKey(files, override_file);
+    const RootPidStore *store = ReadCache(cache_file, cache_key, validate);
+    if (store) {
+      return store;
     }
   }
 
@@ -112,7 +239,20 @@ const RootPidStore *PidStoreLoader::LoadFromDirectory(
     }
   }
 
-  return BuildStore(pid_store_pb, override_pb, validate);
+  const RootPidStore *store = BuildStore(pid_store_pb, override_pb, validate);
+  if (store && !cache_file.empty()) {
+    WriteCache(cache_file, cache_key, validate, pid_store_pb, override_pb);
+  }
+  return store;
+}
+
+const RootPidStore *PidStoreLoader::LoadFromCache(const string &cache_file,
+                                                  const string &directory,
+                                                  bool validate) {
+  vector<string> files;
+  string override_file;
+  ListPidFiles(directory, &files, &override_file);
+  return ReadCache(cache_file, CacheKey(files, override_file), validate);
 }
 
 const RootPidStore *PidStoreLoader::LoadFromStream(std::istream *data,
@@ -146,6 +286,155 @@ bool PidStoreLoader::ReadFile(const std::string &file_path,
   return ok;
 }
 
+/*
+ * Find the PID files in a directory. The files are sorted so that they're
+ * always merged, and appear in the cache key, in the same order.
+ */
+void PidStoreLoader::ListPidFiles(const string &directory,
+                                  vector<string> *files,
+                                  string *override_file) {
+  vector<string> all_files;
+  ola::file::ListDirectory(directory, &all_files);
+  vector<string>::const_iterator file_iter = all_files.begin();
+  for (; file_iter != all_files.end(); ++file_iter) {
+    if (ola::file::FilenameFromPath(*file_iter) == OVERRIDE_FILE_NAME) {
+      *override_file = *file_iter;
+    } else if (StringEndsWith(*file_iter, ".proto")) {
+      files->push_back(*file_iter);
+    }
+  }
+  std::sort(files->begin(), files->end());
+}
+
+/*
+ * The cache key is the version of OLA, and the path, size and modification
+ * time of each of the PID files.
+ */
+string PidStoreLoader::CacheKey(const vector<string> &files,
+                                const string &override_file) {
+  vector<string> all_files(files);
+  if (!override_file.empty()) {
+    all_files.push_back(override_file);
+  }
+
+  ostringstream key;
+  key << ola::base::Version::GetVersion() << "\n";
+  // The modification time doesn't change if a file is rewritten within the
+  // timestamp granularity, so we hash the contents instead. This is much
+  // cheaper than parsing the text protobufs.
+  vector<string>::const_iterator iter = all_files.begin();
+  for (; iter != all_files.end(); ++iter) {
+    MappedFile file;
+    key << *iter;
+    if (file.Open(*iter)) {
+      key << " " << file.Size() << " "
+          << ola::strings::ToHex(HashData(file.Data(), file.Size()), false);
+    }
+    key << "\n";
+  }
+  return key.str();
+}
+
+const RootPidStore *PidStoreLoader::ReadCache(const string &cache_file,
+                                              const string &key,
+                                              bool validate) {
+  MappedFile file;
+  if (!file.Open(cache_file)) {
+    OLA_INFO << "No PID cache at " << cache_file;
+    return NULL;
+  }
+
+  const uint8_t *data = file.Data();
+  const unsigned int size = file.Size();
+  const unsigned int magic_size = sizeof(CACHE_MAGIC) - 1;
+  if (size < magic_size || memcmp(data, CACHE_MAGIC, magic_size)) {
+    OLA_WARN << cache_file << " isn't a PID cache";
+    return NULL;
+  }
+
+  unsigned int offset = magic_size;
+  const uint8_t *block;
+  unsigned int block_size;
+  if (!ReadBlock(data, size, &offset, &block, &block_size) ||
+      block_size != key.size() || memcmp(block, key.data(), block_size)) {
+    OLA_INFO << "PID cache " << cache_file << " is out of date";
+    return NULL;
+  }
+
+  if (offset == size) {
+    OLA_WARN << "PID cache " << cache_file << " is truncated";
+    return NULL;
+  }
+  const bool validated = data[offset++];
+  if (validate && !validated) {
+    OLA_INFO << "PID cache " << cache_file << " wasn't validated";
+    return NULL;
+  }
+
+  ola::rdm::pid::PidStore store_pb;
+  ola::rdm::pid::PidStore override_pb;
+  if (!ReadBlock(data, size, &offset, &block, &block_size) ||
+      !store_pb.ParsePartialFromArray(block, block_size) ||
+      !ReadBlock(data, size, &offset, &block, &block_size) ||
+      !override_pb.ParsePartialFromArray(block, block_size)) {
+    OLA_WARN << "PID cache " << cache_file << " is corrupt";
+    return NULL;
+  }
+
+  OLA_DEBUG << "Loading PIDs from " << cache_file;
+  // The data was validated before it was written to the cache.
+  return BuildStore(store_pb, override_pb, false);
+}
+
+/*
+ * Write the cache to a temporary file and rename it, so a reader never sees a
+ * partially written cache. Failing to write the cache isn't fatal.
+ */
+void PidStoreLoader::WriteCache(const string &cache_file,
+                                const string &key,
+                                bool validated,
+                                const ola::rdm::pid::PidStore &store_pb,
+                                const ola::rdm::pid::PidStore &override_pb) {
+  string store_data, override_data;
+  if (!store_pb.SerializePartialToString(&store_data) ||
+      !override_pb.SerializePartialToString(&override_data)) {
+    OLA_WARN << "Failed to serialize the PID data";
+    return;
+  }
+
+  string output(CACHE_MAGIC, sizeof(CACHE_MAGIC) - 1);
+  AppendBlock(key, &output);
+  output.push_back(validated ? 1 : 0);
+  AppendBlock(store_data, &output);
+  AppendBlock(override_data, &output);
+
+  const string temp_file = cache_file + ".tmp";
+  std::ofstream file(temp_file.c_str(),
+                     std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!file.is_open()) {
+    OLA_WARN << "Failed to open " << temp_file << ": " << strerror(errno);
+    return;
+  }
+  file.write(output.data(), output.size());
+  file.close();
+  if (file.fail()) {
+    OLA_WARN << "Failed to write " << temp_file;
+    remove(temp_file.c_str());
+    return;
+  }
+
+#ifdef _WIN32
+  // rename() doesn't replace an existing file on Windows.
+  remove(cache_file.c_str());
+#endif  // _WIN32
+  if (rename(temp_file.c_str(), cache_file.c_str())) {
+    OLA_WARN << "Failed to rename " << temp_file << ": " << strerror(errno);
+    remove(temp_file.c_str());
+    return;
+  }
+  OLA_INFO << "Wrote PID cache " << cache_file;
+}
+
 /*
  * Build the RootPidStore from a protocol buffer.
  */
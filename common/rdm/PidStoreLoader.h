@@ -57,12 +57,34 @@ class PidStoreLoader {
    * @param directory the directory to load files from.
    * @param validate set to true if we should perform validation of the
    *   contents.
+   * @param cache_file the binary cache to use, or an empty string to always
+   *   parse the files.
    * @returns A pointer to a new RootPidStore or NULL if loading failed.
    *
    * This is an all-or-nothing load. Any error with cause us to abort the load.
+   *
+   * If the cache is up to date, the PID data is read from it. Otherwise the
+   * files are parsed and, if that succeeds, the cache is rewritten.
    */
   const RootPidStore *LoadFromDirectory(const std::string &directory,
-                                        bool validate = true);
+                                        bool validate = true,
+                                        const std::string &cache_file = "");
+
+  /**
+   * @brief Load PID information from a cache written by LoadFromDirectory.
+   * @param cache_file the cache to load.
+   * @param directory the directory the cache was built from.
+   * @param validate set to true if the data must have been validated when the
+   *   cache was written.
+   * @returns A pointer to a new RootPidStore or NULL if the cache is missing
+   *   or out of date.
+   *
+   * The cache is out of date if any of the files in the directory have
+   * changed, or it was written by a different version of OLA.
+   */
+  const RootPidStore *LoadFromCache(const std::string &cache_file,
+                                    const std::string &directory,
+                                    bool validate = true);
 
   /**
    * @brief Load Pid information from a stream
@@ -83,6 +105,20 @@ class PidStoreLoader {
   bool ReadFile(const std::string &file_path,
                 ola::rdm::pid::PidStore *proto);
 
+  void ListPidFiles(const std::string &directory,
+                    std::vector<std::string> *files,
+                    std::string *override_file);
+  std::string CacheKey(const std::vector<std::string> &files,
+                       const std::string &override_file);
+  const RootPidStore *ReadCache(const std::string &cache_file,
+                                const std::string &key,
+                                bool validate);
+  void WriteCache(const std::string &cache_file,
+                  const std::string &key,
+                  bool validated,
+                  const ola::rdm::pid::PidStore &store_pb,
+                  const ola::rdm::pid::PidStore &override_pb);
+
   const RootPidStore *BuildStore(const ola::rdm::pid::PidStore &store_pb,
                                  const ola::rdm::pid::PidStore &override_pb,
                                  bool validate);
@@ -119,6 +155,7 @@ class PidStoreLoader {
   void FreeManufacturerMap(ManufacturerMap *data);
 
   static const char OVERRIDE_FILE_NAME[];
+  static const char CACHE_MAGIC[];
   static const uint16_t ESTA_MANUFACTURER_ID;
   static const uint16_t MANUFACTURER_PID_MIN;
   static const uint16_t MANUFACTURER_PID_MAX;
@@ -19,7 +19,14 @@
  */
 
 #include <cppunit/extensions/HelperMacros.h>
+#include <stdio.h>
 #include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#ifndef _WIN32
+#include <utime.h>
+#endif  // _WIN32
+#include <fstream>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -56,6 +63,10 @@ class PidStoreTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testPidStoreLoad);
   CPPUNIT_TEST(testPidStoreFileLoad);
   CPPUNIT_TEST(testPidStoreDirectoryLoad);
+  CPPUNIT_TEST(testPidStoreCache);
+#ifndef _WIN32
+  CPPUNIT_TEST(testPidStoreCacheKey);
+#endif  // _WIN32
   CPPUNIT_TEST(testPidStoreLoadMissingFile);
   CPPUNIT_TEST(testPidStoreLoadDuplicateManufacturer);
   CPPUNIT_TEST(testPidStoreLoadDuplicateValue);
@@ -70,6 +81,8 @@ class PidStoreTest: public CppUnit::TestFixture {
   void testPidStoreLoad();
   void testPidStoreFileLoad();
   void testPidStoreDirectoryLoad();
+  void testPidStoreCache();
+  void testPidStoreCacheKey();
   void testPidStoreLoadMissingFile();
   void testPidStoreLoadDuplicateManufacturer();
   void testPidStoreLoadDuplicateValue();
@@ -443,6 +456,119 @@ void PidStoreTest::testPidStoreDirectoryLoad() {
 }
 
 
+/**
+ * Check that the binary cache is written, read back & invalidated.
+ */
+void PidStoreTest::testPidStoreCache() {
+  const string cache_file = TEST_BUILD_DIR "/common/rdm/PidStoreTest.cache";
+  const string directory = GetTestDataFile("pids");
+  remove(cache_file.c_str());
+
+  PidStoreLoader loader;
+  OLA_ASSERT_NULL(loader.LoadFromCache(cache_file, directory));
+
+  // Loading from the directory writes the cache.
+  auto_ptr<const RootPidStore> root_store(
+      loader.LoadFromDirectory(directory, true, cache_file));
+  OLA_ASSERT_NOT_NULL(root_store.get());
+
+  auto_ptr<const RootPidStore> cached_store(
+      loader.LoadFromCache(cache_file, directory));
+  OLA_ASSERT_NOT_NULL(cached_store.get());
+  OLA_ASSERT_EQ(root_store->Version(), cached_store->Version());
+  OLA_ASSERT_EQ(root_store->EstaStore()->PidCount(),
+                cached_store->EstaStore()->PidCount());
+
+  const PidStore *open_lighting_store =
+    cached_store->ManufacturerStore(ola::OPEN_LIGHTING_ESTA_CODE);
+  OLA_ASSERT_NOT_NULL(open_lighting_store);
+  OLA_ASSERT_EQ(1u, open_lighting_store->PidCount());
+  // The overrides are cached as well.
+  OLA_ASSERT_NULL(open_lighting_store->LookupPID("SERIAL_NUMBER"));
+  const PidDescriptor *foo_bar = open_lighting_store->LookupPID(32768);
+  OLA_ASSERT_NOT_NULL(foo_bar);
+  OLA_ASSERT_EQ(string("FOO_BAR"), foo_bar->Name());
+  OLA_ASSERT_NOT_NULL(foo_bar->GetResponse());
+
+  // The cache doesn't match a different set of files.
+  OLA_ASSERT_NULL(loader.LoadFromCache(cache_file,
+                                       TEST_SRC_DIR "/common/rdm/testdata"));
+
+  // An unvalidated cache isn't used if validation is required.
+  remove(cache_file.c_str());
+  cached_store.reset(loader.LoadFromDirectory(directory, false, cache_file));
+  OLA_ASSERT_NOT_NULL(cached_store.get());
+  OLA_ASSERT_NULL(loader.LoadFromCache(cache_file, directory, true));
+  cached_store.reset(loader.LoadFromCache(cache_file, directory, false));
+  OLA_ASSERT_NOT_NULL(cached_store.get());
+
+  // A corrupt cache is ignored, and then replaced.
+  {
+    std::ofstream file(cache_file.c_str());
+    file << "OLAPIDS1 not a cache";
+  }
+  OLA_ASSERT_NULL(loader.LoadFromCache(cache_file, directory));
+  root_store.reset(loader.LoadFromDirectory(directory, true, cache_file));
+  OLA_ASSERT_NOT_NULL(root_store.get());
+  cached_store.reset(loader.LoadFromCache(cache_file, directory));
+  OLA_ASSERT_NOT_NULL(cached_store.get());
+  remove(cache_file.c_str());
+}
+
+
+#ifndef _WIN32
+/**
+ * Check that the cache is invalidated when a PID file is rewritten, even if
+ * the size & modification time don't change.
+ */
+void PidStoreTest::testPidStoreCacheKey() {
+  const string cache_file = TEST_BUILD_DIR "/common/rdm/PidStoreTest.keycache";
+  const string directory = TEST_BUILD_DIR "/common/rdm/PidStoreTest.pids";
+  const string pid_file = directory + "/pids.proto";
+  mkdir(directory.c_str(), 0755);
+  remove(cache_file.c_str());
+
+  {
+    std::ofstream file(pid_file.c_str());
+    file << "pid { name: \"FOO_BAR\" value: 100 get_request {} "
+         << "get_response {} get_sub_device_range: ROOT_DEVICE } version: 1";
+  }
+  struct stat file_stat;
+  OLA_ASSERT_EQ(0, stat(pid_file.c_str(), &file_stat));
+
+  PidStoreLoader loader;
+  auto_ptr<const RootPidStore> root_store(
+      loader.LoadFromDirectory(directory, true, cache_file));
+  OLA_ASSERT_NOT_NULL(root_store.get());
+  OLA_ASSERT_NOT_NULL(root_store->EstaStore()->LookupPID("FOO_BAR"));
+  auto_ptr<const RootPidStore> cached_store(
+      loader.LoadFromCache(cache_file, directory));
+  OLA_ASSERT_NOT_NULL(cached_store.get());
+
+  // Rewrite the file with the same size, and restore the modification time.
+  {
+    std::ofstream file(pid_file.c_str());
+    file << "pid { name: \"FOO_BAZ\" value: 100 get_request {} "
+         << "get_response {} get_sub_device_range: ROOT_DEVICE } version: 1";
+  }
+  struct utimbuf times;
+  times.actime = file_stat.st_atime;
+  times.modtime = file_stat.st_mtime;
+  OLA_ASSERT_EQ(0, utime(pid_file.c_str(), &times));
+
+  OLA_ASSERT_NULL(loader.LoadFromCache(cache_file, directory));
+  root_store.reset(loader.LoadFromDirectory(directory, true, cache_file));
+  OLA_ASSERT_NOT_NULL(root_store.get());
+  OLA_ASSERT_NULL(root_store->EstaStore()->LookupPID("FOO_BAR"));
+  OLA_ASSERT_NOT_NULL(root_store->EstaStore()->LookupPID("FOO_BAZ"));
+
+  remove(cache_file.c_str());
+  remove(pid_file.c_str());
+  remove(directory.c_str());
+}
+#endif  // _WIN32
+
+
 /**
  * Check that loading a missing file fails.
  */
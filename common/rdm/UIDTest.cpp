@@ -226,6 +226,21 @@ void UIDTest::testUIDSet() {
 
   difference = set3.SetDifference(set1);
   OLA_ASSERT_EQ(0u, difference.Size());
+
+  // UIDs added out of order are kept sorted.
+  UIDSet set4;
+  set4.AddUID(UID(2, 1));
+  set4.AddUID(UID(1, 5));
+  set4.AddUID(UID(1, 3));
+  set4.AddUID(UID(1, 5));
+  OLA_ASSERT_EQ(3u, set4.Size());
+  OLA_ASSERT_EQ(string("0001:00000003,0001:00000005,0002:00000001"),
+                set4.ToString());
+  set4.RemoveUID(UID(1, 4));
+  OLA_ASSERT_EQ(3u, set4.Size());
+  set4.RemoveUID(UID(1, 3));
+  OLA_ASSERT_EQ(string("0001:00000005,0002:00000001"), set4.ToString());
+  OLA_ASSERT_FALSE(set4.Contains(UID(1, 3)));
 }
 
 
@@ -249,6 +264,13 @@ void UIDTest::testUIDSetUnion() {
   OLA_ASSERT_TRUE(union_set.Contains(uid2));
   OLA_ASSERT_TRUE(union_set.Contains(uid3));
   OLA_ASSERT_TRUE(union_set.Contains(uid4));
+
+  // Overlapping sets
+  set2.AddUID(uid);
+  union_set = set1.Union(set2);
+  OLA_ASSERT_EQ(4u, union_set.Size());
+  OLA_ASSERT_EQ(union_set, set2);
+  OLA_ASSERT_EQ(union_set, set2.Union(set1));
 }
 
 
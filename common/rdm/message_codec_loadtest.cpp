@@ -0,0 +1,217 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * message_codec_loadtest.cpp
+ * Compare the MessageCodec with the MessageSerializer & MessageDeserializer.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "common/rdm/MessageCodec.h"
+#include "ola/Clock.h"
+#include "ola/Logging.h"
+#include "ola/base/Array.h"
+#include "ola/base/Flags.h"
+#include "ola/base/Init.h"
+#include "ola/messaging/Message.h"
+#include "ola/rdm/MessageDeserializer.h"
+#include "ola/rdm/MessageSerializer.h"
+#include "ola/rdm/PidStore.h"
+#include "ola/rdm/RDMEnums.h"
+
+using ola::Clock;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::messaging::Message;
+using ola::rdm::MessageCodec;
+using ola::rdm::MessageDeserializer;
+using ola::rdm::MessageSerializer;
+using ola::rdm::PidDescriptor;
+using ola::rdm::RootPidStore;
+using std::auto_ptr;
+using std::cout;
+using std::endl;
+using std::string;
+
+DEFINE_string(pid_location, "",
+              "The directory containing the PID definitions.");
+DEFINE_s_uint32(iterations, i, 200000, "The number of times to encode & "
+                "decode each message");
+
+namespace {
+
+const uint8_t DEVICE_INFO[] = {
+  1, 0, 0, 1, 1, 1, 0, 0, 0, 1, 0, 4, 1, 3, 0, 1, 0, 0, 2};
+
+const uint8_t SUPPORTED_PARAMETERS[] = {
+  0, 0x50, 0, 0x60, 0, 0x80, 0, 0x81, 0, 0x82, 0, 0xc0, 0, 0xe0, 0, 0xe1,
+  2, 0, 2, 1, 3, 0, 4, 0, 4, 1, 4, 2, 4, 3, 4, 4, 4, 5, 0x10, 0, 0x10, 1,
+  0x10, 2, 0x10, 0x30, 0x10, 0x40, 0x10, 0x50, 0x80, 0, 0x80, 1, 0x80, 2};
+
+const uint8_t DEVICE_LABEL[] = {
+  'D', 'i', 'm', 'm', 'e', 'r', ' ', 'r', 'a', 'c', 'k', ' ', '1', '2'};
+
+const uint8_t SENSOR_VALUE[] = {0, 0, 0x1e, 0, 0x0a, 0, 0x32, 0, 0x1c};
+
+const uint8_t STATUS_MESSAGES[] = {
+  0, 0, 2, 0, 1, 0, 1, 0, 2,
+  0, 1, 2, 0, 2, 0, 3, 0, 4,
+  0, 2, 4, 0, 3, 0, 5, 0, 6,
+  0, 3, 2, 0, 4, 0, 7, 0, 8,
+  0, 4, 2, 0, 5, 0, 9, 0, 10};
+
+const struct {
+  uint16_t pid;
+  const uint8_t *data;
+  unsigned int length;
+} MESSAGES[] = {
+  {ola::rdm::PID_DEVICE_INFO, DEVICE_INFO, sizeof(DEVICE_INFO)},
+  {ola::rdm::PID_SUPPORTED_PARAMETERS, SUPPORTED_PARAMETERS,
+   sizeof(SUPPORTED_PARAMETERS)},
+  {ola::rdm::PID_DEVICE_LABEL, DEVICE_LABEL, sizeof(DEVICE_LABEL)},
+  {ola::rdm::PID_SENSOR_VALUE, SENSOR_VALUE, sizeof(SENSOR_VALUE)},
+  {ola::rdm::PID_STATUS_MESSAGES, STATUS_MESSAGES, sizeof(STATUS_MESSAGES)},
+};
+
+/*
+ * Return the time per iteration in ns.
+ */
+uint64_t NanoSeconds(const TimeStamp &start, const TimeStamp &end) {
+  TimeInterval duration = end - start;
+  return static_cast<uint64_t>(duration.AsInt()) * 1000 / FLAGS_iterations;
+}
+
+void Print(const string &name, const string &direction, uint64_t visitor_ns,
+           uint64_t codec_ns) {
+  cout << std::setw(22) << std::left << name << std::setw(7) << direction
+       << std::setw(8) << std::right << visitor_ns << " ns"
+       << std::setw(8) << codec_ns << " ns";
+  if (codec_ns) {
+    cout << std::setw(7) << std::fixed << std::setprecision(1)
+         << static_cast<double>(visitor_ns) / codec_ns << "x";
+  }
+  cout << endl;
+}
+
+/*
+ * Time decoding & encoding a message with both methods.
+ */
+bool TimeMessage(const PidDescriptor *pid, const uint8_t *data,
+                 unsigned int length) {
+  const ola::messaging::Descriptor *descriptor = pid->GetResponse();
+  if (!descriptor) {
+    OLA_WARN << pid->Name() << " doesn't have a GET response";
+    return false;
+  }
+  auto_ptr<const MessageCodec> codec(MessageCodec::Compile(descriptor));
+  if (!codec.get()) {
+    OLA_WARN << "Failed to compile the GET response for " << pid->Name();
+    return false;
+  }
+
+  Clock clock;
+  TimeStamp start, end;
+  uint64_t decode_ns, encode_ns;
+
+  MessageDeserializer deserializer;
+  clock.CurrentTime(&start);
+  for (unsigned int i = 0; i < FLAGS_iterations; i++) {
+    delete deserializer.InflateMessage(descriptor, data, length);
+  }
+  clock.CurrentTime(&end);
+  decode_ns = NanoSeconds(start, end);
+
+  auto_ptr<const Message> message(
+      deserializer.InflateMessage(descriptor, data, length));
+  if (!message.get()) {
+    OLA_WARN << "Failed to inflate " << pid->Name();
+    return false;
+  }
+
+  MessageSerializer serializer;
+  unsigned int serialized_length;
+  clock.CurrentTime(&start);
+  for (unsigned int i = 0; i < FLAGS_iterations; i++) {
+    serializer.SerializeMessage(message.get(), &serialized_length);
+  }
+  clock.CurrentTime(&end);
+  encode_ns = NanoSeconds(start, end);
+
+  MessageCodec::Values values;
+  clock.CurrentTime(&start);
+  for (unsigned int i = 0; i < FLAGS_iterations; i++) {
+    codec->Decode(data, length, &values);
+  }
+  clock.CurrentTime(&end);
+  Print(pid->Name(), "decode", decode_ns, NanoSeconds(start, end));
+
+  if (!codec->Decode(data, length, &values)) {
+    OLA_WARN << "Failed to decode " << pid->Name();
+    return false;
+  }
+
+  uint8_t buffer[256];
+  unsigned int encoded_length = 0;
+  clock.CurrentTime(&start);
+  for (unsigned int i = 0; i < FLAGS_iterations; i++) {
+    encoded_length = sizeof(buffer);
+    codec->Encode(values, buffer, &encoded_length);
+  }
+  clock.CurrentTime(&end);
+  Print("", "encode", encode_ns, NanoSeconds(start, end));
+
+  if (encoded_length != length || memcmp(buffer, data, length)) {
+    OLA_WARN << "Encoded data for " << pid->Name() << " doesn't match";
+    return false;
+  }
+  return true;
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  ola::AppInit(&argc, argv, "[options]",
+               "Compare the MessageCodec with the MessageSerializer & "
+               "MessageDeserializer.");
+
+  auto_ptr<const RootPidStore> pid_store(
+      RootPidStore::LoadFromDirectory(FLAGS_pid_location));
+  if (!pid_store.get()) {
+    OLA_FATAL << "Failed to load the PID store";
+    return 1;
+  }
+
+  cout << FLAGS_iterations << " iterations, time per message" << endl;
+  cout << std::setw(29) << " " << std::setw(11) << std::right << "Visitor"
+       << std::setw(11) << "Codec" << endl;
+
+  bool ok = true;
+  for (unsigned int i = 0; i < arraysize(MESSAGES); i++) {
+    const PidDescriptor *pid = pid_store->GetDescriptor(MESSAGES[i].pid);
+    if (!pid) {
+      OLA_WARN << "Missing PID " << MESSAGES[i].pid;
+      ok = false;
+      continue;
+    }
+    ok &= TimeMessage(pid, MESSAGES[i].data, MESSAGES[i].length);
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,164 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * pid_store_loadtest.cpp
+ * Time loading the PID store, with & without the binary cache.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ola/Clock.h"
+#include "ola/Logging.h"
+#include "ola/base/Flags.h"
+#include "ola/base/Init.h"
+#include "ola/rdm/PidStore.h"
+
+using ola::Clock;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::rdm::PidDescriptor;
+using ola::rdm::PidStore;
+using ola::rdm::RootPidStore;
+using std::auto_ptr;
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+DEFINE_string(pid_location, "",
+              "The directory containing the PID definitions.");
+DEFINE_string(cache_file, "pid_store_loadtest.cache",
+              "The cache file to use, this is removed once the test "
+              "completes.");
+DEFINE_s_uint32(iterations, i, 20, "The number of times to load the store");
+DEFINE_uint32(lookups, 1000, "The number of times to lookup each PID");
+
+namespace {
+
+void Print(const string &name, const TimeStamp &start, const TimeStamp &end,
+           unsigned int count) {
+  TimeInterval duration = end - start;
+  cout << std::setw(20) << std::left << name << std::setw(10) << std::right
+       << duration.AsInt() / count << " us" << endl;
+}
+
+/*
+ * Load the store a number of times.
+ */
+bool TimeLoad(const string &name, const string &cache_file) {
+  Clock clock;
+  TimeStamp start, end;
+  clock.CurrentTime(&start);
+  for (unsigned int i = 0; i < FLAGS_iterations; i++) {
+    auto_ptr<const RootPidStore> pid_store(
+        RootPidStore::LoadFromDirectory(FLAGS_pid_location, true, cache_file));
+    if (!pid_store.get()) {
+      OLA_WARN << "Failed to load the PID store";
+      return false;
+    }
+  }
+  clock.CurrentTime(&end);
+  Print(name, start, end, FLAGS_iterations);
+  return true;
+}
+
+/*
+ * Lookup each PLASA PID by value & by name.
+ */
+void TimeLookups(const PidStore *store) {
+  vector<const PidDescriptor*> pids;
+  store->AllPids(&pids);
+  if (pids.empty()) {
+    return;
+  }
+
+  vector<uint16_t> values;
+  vector<string> names;
+  vector<const PidDescriptor*>::const_iterator iter = pids.begin();
+  for (; iter != pids.end(); ++iter) {
+    values.push_back((*iter)->Value());
+    names.push_back((*iter)->Name());
+  }
+
+  Clock clock;
+  TimeStamp start, end;
+  unsigned int found = 0;
+  clock.CurrentTime(&start);
+  for (unsigned int i = 0; i < FLAGS_lookups; i++) {
+    for (unsigned int j = 0; j < values.size(); j++) {
+      found += store->LookupPID(values[j]) != NULL;
+    }
+  }
+  clock.CurrentTime(&end);
+  TimeInterval duration = end - start;
+  cout << std::setw(20) << std::left << "Lookup by value" << std::setw(10)
+       << std::right << duration.AsInt() * 1000 / (FLAGS_lookups * pids.size())
+       << " ns" << endl;
+
+  clock.CurrentTime(&start);
+  for (unsigned int i = 0; i < FLAGS_lookups; i++) {
+    for (unsigned int j = 0; j < names.size(); j++) {
+      found += store->LookupPID(names[j]) != NULL;
+    }
+  }
+  clock.CurrentTime(&end);
+  duration = end - start;
+  cout << std::setw(20) << std::left << "Lookup by name" << std::setw(10)
+       << std::right << duration.AsInt() * 1000 / (FLAGS_lookups * pids.size())
+       << " ns" << endl;
+
+  if (found != 2 * FLAGS_lookups * pids.size()) {
+    OLA_WARN << "Lookups failed";
+  }
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  ola::AppInit(&argc, argv, "[options]",
+               "Time loading the PID store, with & without the binary cache.");
+
+  const string cache_file = FLAGS_cache_file.str();
+  remove(cache_file.c_str());
+
+  cout << FLAGS_iterations << " iterations, time per load" << endl;
+  bool ok = TimeLoad("Parse", "");
+
+  // The first load with a cache file writes the cache.
+  Clock clock;
+  TimeStamp start, end;
+  clock.CurrentTime(&start);
+  auto_ptr<const RootPidStore> pid_store(
+      RootPidStore::LoadFromDirectory(FLAGS_pid_location, true, cache_file));
+  clock.CurrentTime(&end);
+  if (!pid_store.get()) {
+    OLA_FATAL << "Failed to load the PID store";
+    return 1;
+  }
+  Print("Parse & write cache", start, end, 1);
+
+  ok &= TimeLoad("Load from cache", cache_file);
+  remove(cache_file.c_str());
+
+  TimeLookups(pid_store->EstaStore());
+  return ok ? 0 : 1;
+}
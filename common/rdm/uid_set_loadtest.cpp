@@ -0,0 +1,201 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * uid_set_loadtest.cpp
+ * Compare the UIDSet operations with the equivalent std::set<UID> code.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "ola/Clock.h"
+#include "ola/Logging.h"
+#include "ola/base/Flags.h"
+#include "ola/base/Init.h"
+#include "ola/rdm/UID.h"
+#include "ola/rdm/UIDSet.h"
+
+using ola::Clock;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::rdm::UID;
+using ola::rdm::UIDSet;
+using std::cout;
+using std::endl;
+using std::set;
+using std::string;
+using std::vector;
+
+DEFINE_s_uint32(uids, u, 10000, "The number of UIDs in each set");
+DEFINE_s_uint32(iterations, i, 100, "The number of times to run each "
+                "operation");
+
+namespace {
+
+typedef set<UID> UIDTree;
+
+void Print(const string &name, const TimeStamp &tree_start,
+           const TimeStamp &tree_end, const TimeStamp &set_start,
+           const TimeStamp &set_end) {
+  uint64_t tree_us = (tree_end - tree_start).AsInt() / FLAGS_iterations;
+  uint64_t set_us = (set_end - set_start).AsInt() / FLAGS_iterations;
+  cout << std::setw(12) << std::left << name << std::setw(10) << std::right
+       << tree_us << " us" << std::setw(10) << set_us << " us";
+  if (set_us) {
+    cout << std::setw(7) << std::fixed << std::setprecision(1)
+         << static_cast<double>(tree_us) / set_us << "x";
+  }
+  cout << endl;
+}
+
+UIDTree TreeUnion(const UIDTree &a, const UIDTree &b) {
+  UIDTree result;
+  std::set_union(a.begin(), a.end(), b.begin(), b.end(),
+                 std::inserter(result, result.begin()));
+  return result;
+}
+
+UIDTree TreeDifference(const UIDTree &a, const UIDTree &b) {
+  UIDTree result;
+  std::set_difference(a.begin(), a.end(), b.begin(), b.end(),
+                      std::inserter(result, result.begin()));
+  return result;
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  ola::AppInit(&argc, argv, "[options]",
+               "Compare the UIDSet operations with std::set<UID>.");
+
+  // Two sets of UIDs, in a random order, which overlap by half.
+  vector<UID> uids;
+  for (unsigned int i = 0; i < FLAGS_uids * 3 / 2; i++) {
+    uids.push_back(UID(0x7a70 + i % 4, i * 37));
+  }
+  std::random_shuffle(uids.begin(), uids.end());
+  vector<UID> first(uids.begin(), uids.begin() + FLAGS_uids);
+  vector<UID> second(uids.end() - FLAGS_uids, uids.end());
+
+  Clock clock;
+  TimeStamp tree_start, tree_end, set_start, set_end;
+  UIDTree tree1, tree2;
+  UIDSet set1, set2;
+
+  cout << FLAGS_uids << " UIDs, " << FLAGS_iterations
+       << " iterations, time per operation" << endl;
+  cout << std::setw(12) << " " << std::setw(13) << std::right << "std::set"
+       << std::setw(13) << "UIDSet" << endl;
+
+  clock.CurrentTime(&tree_start);
+  for (unsigned int i = 0; i < FLAGS_iterations; i++) {
+    tree1.clear();
+    tree1.insert(first.begin(), first.end());
+  }
+  clock.CurrentTime(&tree_end);
+  clock.CurrentTime(&set_start);
+  for (unsigned int i = 0; i < FLAGS_iterations; i++) {
+    set1.Clear();
+    vector<UID>::const_iterator iter = first.begin();
+    for (; iter != first.end(); ++iter) {
+      set1.AddUID(*iter);
+    }
+  }
+  clock.CurrentTime(&set_end);
+  Print("Add", tree_start, tree_end, set_start, set_end);
+
+  // Devices are usually discovered, and listed in a TOD, in ascending order.
+  vector<UID> sorted_first(first);
+  std::sort(sorted_first.begin(), sorted_first.end());
+  clock.CurrentTime(&tree_start);
+  for (unsigned int i = 0; i < FLAGS_iterations; i++) {
+    tree1.clear();
+    tree1.insert(sorted_first.begin(), sorted_first.end());
+  }
+  clock.CurrentTime(&tree_end);
+  clock.CurrentTime(&set_start);
+  for (unsigned int i = 0; i < FLAGS_iterations; i++) {
+    set1.Clear();
+    vector<UID>::const_iterator iter = sorted_first.begin();
+    for (; iter != sorted_first.end(); ++iter) {
+      set1.AddUID(*iter);
+    }
+  }
+  clock.CurrentTime(&set_end);
+  Print("Add sorted", tree_start, tree_end, set_start, set_end);
+
+  tree2.insert(second.begin(), second.end());
+  vector<UID>::const_iterator iter = second.begin();
+  for (; iter != second.end(); ++iter) {
+    set2.AddUID(*iter);
+  }
+
+  unsigned int found = 0;
+  clock.CurrentTime(&tree_start);
+  for (unsigned int i = 0; i < FLAGS_iterations; i++) {
+    for (iter = second.begin(); iter != second.end(); ++iter) {
+      found += tree1.find(*iter) != tree1.end();
+    }
+  }
+  clock.CurrentTime(&tree_end);
+  clock.CurrentTime(&set_start);
+  for (unsigned int i = 0; i < FLAGS_iterations; i++) {
+    for (iter = second.begin(); iter != second.end(); ++iter) {
+      found -= set1.Contains(*iter);
+    }
+  }
+  clock.CurrentTime(&set_end);
+  Print("Contains", tree_start, tree_end, set_start, set_end);
+
+  unsigned int tree_size = 0, set_size = 0;
+  clock.CurrentTime(&tree_start);
+  for (unsigned int i = 0; i < FLAGS_iterations; i++) {
+    tree_size = TreeUnion(tree1, tree2).size();
+  }
+  clock.CurrentTime(&tree_end);
+  clock.CurrentTime(&set_start);
+  for (unsigned int i = 0; i < FLAGS_iterations; i++) {
+    set_size = set1.Union(set2).Size();
+  }
+  clock.CurrentTime(&set_end);
+  Print("Union", tree_start, tree_end, set_start, set_end);
+  bool ok = tree_size == set_size;
+
+  clock.CurrentTime(&tree_start);
+  for (unsigned int i = 0; i < FLAGS_iterations; i++) {
+    tree_size = TreeDifference(tree1, tree2).size();
+  }
+  clock.CurrentTime(&tree_end);
+  clock.CurrentTime(&set_start);
+  for (unsigned int i = 0; i < FLAGS_iterations; i++) {
+    set_size = set1.SetDifference(set2).Size();
+  }
+  clock.CurrentTime(&set_end);
+  Print("Difference", tree_start, tree_end, set_start, set_end);
+  ok &= tree_size == set_size;
+
+  if (!ok || found) {
+    OLA_WARN << "std::set and UIDSet results differ";
+    return 1;
+  }
+  return 0;
+}
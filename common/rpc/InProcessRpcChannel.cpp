@@ -0,0 +1,344 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * InProcessRpcChannel.cpp
+ * An RPC channel between two threads in the same process.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#include "common/rpc/InProcessRpcChannel.h"
+
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/message.h>
+#include <memory>
+#include <string>
+
+#include "common/rpc/RpcController.h"
+#include "common/rpc/RpcService.h"
+#include "ola/Logging.h"
+#include "ola/thread/Mutex.h"
+
+namespace ola {
+namespace rpc {
+
+using google::protobuf::Message;
+using google::protobuf::MethodDescriptor;
+using ola::thread::ExecutorInterface;
+using ola::thread::MutexLocker;
+using std::auto_ptr;
+using std::string;
+
+const char InProcessRpcChannel::CHANNEL_CLOSED_ERROR[] = "Channel closed";
+
+/*
+ * The state shared by the two ends of a channel. The link is reference
+ * counted, each connected end and each callback queued on an executor holds
+ * a reference.
+ */
+class InProcessRpcChannel::Link {
+ public:
+  Link()
+      : executing(0),
+        ref_count(2) {
+    ends[0] = NULL;
+    ends[1] = NULL;
+  }
+
+  void Ref() {
+    __sync_fetch_and_add(&ref_count, 1);
+  }
+
+  void DeRef() {
+    if (__sync_sub_and_fetch(&ref_count, 1) == 0) {
+      delete this;
+    }
+  }
+
+  /*
+   * Queue a callback on the executor of one of the ends. The lock isn't held
+   * while the callback is queued, otherwise the woken thread can block on
+   * the lock straight away, which doubles the context switches per call.
+   * Instead Detach() waits for any Execute() that's in progress, so the
+   * executor stays valid.
+   */
+  bool Execute(unsigned int index, ola::BaseCallback0<void> *callback) {
+    ExecutorInterface *executor = NULL;
+    {
+      MutexLocker locker(&mutex);
+      if (!ends[index]) {
+        return false;
+      }
+      executor = ends[index]->m_executor;
+      executing++;
+    }
+
+    executor->Execute(callback);
+
+    MutexLocker locker(&mutex);
+    if (--executing == 0) {
+      executed.Broadcast();
+    }
+    return true;
+  }
+
+  /*
+   * Remove an end from the link, once this returns no more callbacks will be
+   * queued on its executor.
+   */
+  void Detach(unsigned int index) {
+    MutexLocker locker(&mutex);
+    ends[index] = NULL;
+    while (executing) {
+      executed.Wait(&mutex);
+    }
+  }
+
+  InProcessRpcChannel *End(unsigned int index) {
+    MutexLocker locker(&mutex);
+    return ends[index];
+  }
+
+  ola::thread::Mutex mutex;
+  ola::thread::ConditionVariable executed;
+  InProcessRpcChannel *ends[2];  // GUARDED_BY(mutex)
+  unsigned int executing;  // GUARDED_BY(mutex)
+  unsigned int ref_count;
+};
+
+/*
+ * A call that is in flight.
+ */
+struct InProcessRpcChannel::PendingCall {
+  PendingCall(Link *link,
+              unsigned int caller,
+              const MethodDescriptor *method,
+              RpcController *controller,
+              Message *request,
+              Message *response,
+              SingleUseCallback0<void> *done)
+      : link(link),
+        caller(caller),
+        method(method),
+        controller(controller),
+        request(request),
+        response(response),
+        done(done),
+        failed(false) {
+    link->Ref();
+  }
+
+  ~PendingCall() {
+    link->DeRef();
+  }
+
+  void SetFailed(const string &reason) {
+    failed = true;
+    error = reason;
+  }
+
+  Link *link;
+  const unsigned int caller;
+  const MethodDescriptor *method;
+  RpcController *controller;  // the caller's controller
+  auto_ptr<Message> request;  // our copy of the request
+  Message *response;  // the caller's response, the callee writes to this
+  SingleUseCallback0<void> *done;
+  auto_ptr<RpcController> server_controller;
+  bool failed;
+  string error;
+};
+
+InProcessRpcChannel::InProcessRpcChannel(RpcService *service,
+                                         ExecutorInterface *executor)
+    : RpcChannel(service, NULL),
+      m_executor(executor),
+      m_link(NULL),
+      m_index(0) {
+}
+
+InProcessRpcChannel::~InProcessRpcChannel() {
+  Close();
+}
+
+bool InProcessRpcChannel::Connect(InProcessRpcChannel *end1,
+                                  InProcessRpcChannel *end2) {
+  if (end1 == end2 || end1->m_link || end2->m_link) {
+    OLA_WARN << "InProcessRpcChannel is already connected";
+    return false;
+  }
+
+  Link *link = new Link();
+  link->ends[0] = end1;
+  link->ends[1] = end2;
+  end1->m_link = link;
+  end1->m_index = 0;
+  end2->m_link = link;
+  end2->m_index = 1;
+  return true;
+}
+
+void InProcessRpcChannel::Close() {
+  if (!m_link) {
+    return;
+  }
+
+  Link *link = m_link;
+  m_link = NULL;
+  link->Detach(m_index);
+
+  link->Ref();
+  BaseCallback0<void> *callback = NewSingleCallback(
+      &InProcessRpcChannel::DeliverClose, link, 1 - m_index);
+  if (!link->Execute(1 - m_index, callback)) {
+    // The peer has already closed.
+    delete callback;
+    link->DeRef();
+  }
+  link->DeRef();
+}
+
+void InProcessRpcChannel::CallMethod(const MethodDescriptor *method,
+                                     RpcController *controller,
+                                     const Message *request,
+                                     Message *reply,
+                                     SingleUseCallback0<void> *done) {
+  const bool is_streaming =
+    method->output_type()->name() == STREAMING_NO_RESPONSE;
+  if (is_streaming && (controller || reply || done)) {
+    OLA_FATAL << "Calling streaming method " << method->name() <<
+      " but a controller, reply or closure in non-NULL";
+    return;
+  }
+
+  if (m_link) {
+    Message *request_copy = request->New();
+    request_copy->CopyFrom(*request);
+    PendingCall *call = new PendingCall(m_link, m_index, method, controller,
+                                        request_copy, reply, done);
+
+    BaseCallback0<void> *callback = NewSingleCallback(
+        &InProcessRpcChannel::DispatchCall, call);
+    if (m_link->Execute(1 - m_index, callback)) {
+      return;
+    }
+    // The peer has closed, but we haven't been notified yet.
+    delete callback;
+    delete call;
+  }
+
+  OLA_WARN << "RPC channel closed, not sending " << method->name();
+  if (!is_streaming) {
+    controller->SetFailed("Failed to send request");
+    done->Run();
+  }
+}
+
+void InProcessRpcChannel::PeerClosed() {
+  Link *link = m_link;
+  m_link = NULL;
+  link->Detach(m_index);
+  link->DeRef();
+  HandleChannelClose();
+}
+
+/*
+ * Run on the executor of the called end.
+ */
+void InProcessRpcChannel::DispatchCall(PendingCall *call) {
+  InProcessRpcChannel *end = call->link->End(1 - call->caller);
+  RpcService *service = end ? end->Service() : NULL;
+  if (!service) {
+    OLA_WARN << "no service registered for " << call->method->name();
+    call->SetFailed(end ? "No service registered" : CHANNEL_CLOSED_ERROR);
+  } else if (call->method->service() != service->GetDescriptor()) {
+    OLA_WARN << "service doesn't implement " << call->method->full_name();
+    call->SetFailed("Not Implemented");
+  }
+
+  if (call->failed) {
+    if (call->done) {
+      ServerCallComplete(call);
+    } else {
+      delete call;
+    }
+    return;
+  }
+
+  call->server_controller.reset(new RpcController(end->Session()));
+  if (!call->done) {
+    // Streaming requests don't have a response.
+    service->CallMethod(call->method, call->server_controller.get(),
+                        call->request.get(), NULL, NULL);
+    delete call;
+    return;
+  }
+
+  service->CallMethod(
+      call->method, call->server_controller.get(), call->request.get(),
+      call->response,
+      NewSingleCallback(&InProcessRpcChannel::ServerCallComplete, call));
+}
+
+/*
+ * Run on the executor of the called end once the Service has handled the
+ * call.
+ */
+void InProcessRpcChannel::ServerCallComplete(PendingCall *call) {
+  if (call->server_controller.get() && call->server_controller->Failed()) {
+    call->SetFailed(call->server_controller->ErrorText());
+  }
+
+  BaseCallback0<void> *callback = NewSingleCallback(
+      &InProcessRpcChannel::DeliverResponse, call);
+  if (call->link->Execute(call->caller, callback)) {
+    return;
+  }
+
+  // The calling end has gone away.
+  delete callback;
+  delete call->done;
+  delete call;
+}
+
+/*
+ * Run on the executor of the calling end.
+ */
+void InProcessRpcChannel::DeliverResponse(PendingCall *call) {
+  InProcessRpcChannel *caller = call->link->End(call->caller);
+  SingleUseCallback0<void> *done = call->done;
+  if (caller) {
+    if (call->failed) {
+      call->controller->SetFailed(call->error);
+    }
+    delete call;
+    done->Run();
+  } else {
+    delete call;
+    delete done;
+  }
+}
+
+/*
+ * Run on the executor of the end that is still open.
+ */
+void InProcessRpcChannel::DeliverClose(Link *link, unsigned int index) {
+  InProcessRpcChannel *end = link->End(index);
+  if (end) {
+    end->PeerClosed();
+  }
+  link->DeRef();
+}
+}  // namespace rpc
+}  // namespace ola
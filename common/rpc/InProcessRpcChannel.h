@@ -0,0 +1,119 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * InProcessRpcChannel.h
+ * An RPC channel between two threads in the same process.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#ifndef COMMON_RPC_INPROCESSRPCCHANNEL_H_
+#define COMMON_RPC_INPROCESSRPCCHANNEL_H_
+
+#include <google/protobuf/service.h>
+#include <ola/Callback.h>
+#include <ola/base/Macro.h>
+#include <ola/thread/ExecutorInterface.h>
+
+#include "common/rpc/RpcChannel.h"
+
+namespace ola {
+namespace rpc {
+
+/**
+ * @brief An RpcChannel that calls the Service on the other end directly.
+ *
+ * A pair of InProcessRpcChannels are connected with Connect(). A method
+ * called on one end is run by the Service of the other end, on that end's
+ * executor, and the done callback is run on the executor of the calling end.
+ * This means the ends can be used from different threads, each end must only
+ * be used from the thread that runs its executor.
+ *
+ * Nothing is serialized, the request is copied and the response is written
+ * directly into the reply passed to CallMethod().
+ *
+ * When one end is closed or deleted, the close handler of the other end is
+ * run. Calls that were in flight to or from a closed end are failed, or if
+ * the calling end is gone, the done callback is deleted without being run.
+ *
+ * An end must be deleted before its executor.
+ */
+class InProcessRpcChannel: public RpcChannel {
+ public:
+  /**
+   * @brief Create a new InProcessRpcChannel.
+   * @param service the Service to use to handle incoming requests, may be
+   *   NULL. Ownership is not transferred.
+   * @param executor the executor to run incoming requests and completed
+   *   calls on. Ownership is not transferred.
+   */
+  InProcessRpcChannel(RpcService *service,
+                      ola::thread::ExecutorInterface *executor);
+
+  /**
+   * @brief Destructor, this closes the channel.
+   */
+  ~InProcessRpcChannel();
+
+  /**
+   * @brief Connect two channels together.
+   * @param end1 the first end, this must not already be connected.
+   * @param end2 the second end, this must not already be connected.
+   * @returns true if the channels were connected, false otherwise.
+   */
+  static bool Connect(InProcessRpcChannel *end1, InProcessRpcChannel *end2);
+
+  /**
+   * @brief Check if this channel is connected to another end.
+   */
+  bool Connected() const { return m_link != NULL; }
+
+  /**
+   * @brief Close the channel.
+   *
+   * The close handler of the other end will be run.
+   */
+  void Close();
+
+  /**
+   * @brief Invoke an RPC method on the other end of the channel.
+   */
+  void CallMethod(const google::protobuf::MethodDescriptor *method,
+                  class RpcController *controller,
+                  const google::protobuf::Message *request,
+                  google::protobuf::Message *response,
+                  SingleUseCallback0<void> *done);
+
+ private:
+  class Link;
+  struct PendingCall;
+
+  ola::thread::ExecutorInterface *m_executor;
+  Link *m_link;
+  unsigned int m_index;  // our index in m_link
+
+  void PeerClosed();
+
+  static void DispatchCall(PendingCall *call);
+  static void ServerCallComplete(PendingCall *call);
+  static void DeliverResponse(PendingCall *call);
+  static void DeliverClose(Link *link, unsigned int index);
+
+  static const char CHANNEL_CLOSED_ERROR[];
+
+  DISALLOW_COPY_AND_ASSIGN(InProcessRpcChannel);
+};
+}  // namespace rpc
+}  // namespace ola
+#endif  // COMMON_RPC_INPROCESSRPCCHANNEL_H_
@@ -0,0 +1,201 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * InProcessRpcChannelTest.cpp
+ * Test fixture for the InProcessRpcChannel class
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <memory>
+#include <string>
+
+#include "common/rpc/InProcessRpcChannel.h"
+#include "common/rpc/RpcController.h"
+#include "common/rpc/RpcSession.h"
+#include "common/rpc/TestService.h"
+#include "common/rpc/TestService.pb.h"
+#include "common/rpc/TestServiceService.pb.h"
+#include "ola/Callback.h"
+#include "ola/io/SelectServer.h"
+#include "ola/testing/TestUtils.h"
+#include "ola/thread/CallbackThread.h"
+
+
+using ola::NewSingleCallback;
+using ola::io::SelectServer;
+using ola::rpc::EchoReply;
+using ola::rpc::EchoRequest;
+using ola::rpc::InProcessRpcChannel;
+using ola::rpc::RpcController;
+using ola::rpc::RpcSession;
+using ola::rpc::TestService_Stub;
+using ola::thread::CallbackThread;
+using std::auto_ptr;
+using std::string;
+
+class InProcessRpcChannelTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(InProcessRpcChannelTest);
+  CPPUNIT_TEST(testEcho);
+  CPPUNIT_TEST(testFailedEcho);
+  CPPUNIT_TEST(testStreamRequest);
+  CPPUNIT_TEST(testClose);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void setUp();
+  void tearDown();
+  void testEcho();
+  void testFailedEcho();
+  void testStreamRequest();
+  void testClose();
+  void EchoComplete();
+  void FailedEchoComplete();
+  void SendFailed();
+  void ChannelClosed(RpcSession *session);
+  void DeleteServerChannel();
+
+ private:
+  RpcController m_controller;
+  EchoRequest m_request;
+  EchoReply m_reply;
+  bool m_closed;
+
+  // The client end runs in this thread, the server end runs in
+  // m_server_thread.
+  SelectServer m_ss;
+  SelectServer m_server_ss;
+  auto_ptr<CallbackThread> m_server_thread;
+
+  auto_ptr<TestServiceImpl> m_service;
+  auto_ptr<InProcessRpcChannel> m_server_channel;
+  auto_ptr<InProcessRpcChannel> m_channel;
+  auto_ptr<TestService_Stub> m_stub;
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(InProcessRpcChannelTest);
+
+void InProcessRpcChannelTest::setUp() {
+  m_closed = false;
+  m_service.reset(new TestServiceImpl(&m_server_ss));
+  m_server_channel.reset(
+      new InProcessRpcChannel(m_service.get(), &m_server_ss));
+  m_channel.reset(new InProcessRpcChannel(NULL, &m_ss));
+  OLA_ASSERT_TRUE(InProcessRpcChannel::Connect(m_channel.get(),
+                                               m_server_channel.get()));
+  OLA_ASSERT_FALSE(InProcessRpcChannel::Connect(m_channel.get(),
+                                                m_server_channel.get()));
+  m_stub.reset(new TestService_Stub(m_channel.get()));
+
+  m_server_thread.reset(new CallbackThread(
+      NewSingleCallback(&m_server_ss, &SelectServer::Run)));
+  OLA_ASSERT_TRUE(m_server_thread->Start());
+}
+
+void InProcessRpcChannelTest::tearDown() {
+  // Terminate() is a no-op if the SelectServer isn't running yet, so run it
+  // from within the server thread.
+  m_server_ss.Execute(
+      NewSingleCallback(&m_server_ss, &SelectServer::Terminate));
+  m_server_thread->Join();
+  m_stub.reset();
+  m_channel.reset();
+  m_server_channel.reset();
+}
+
+void InProcessRpcChannelTest::EchoComplete() {
+  m_ss.Terminate();
+  OLA_ASSERT_FALSE(m_controller.Failed());
+  OLA_ASSERT_EQ(m_reply.data(), m_request.data());
+}
+
+void InProcessRpcChannelTest::FailedEchoComplete() {
+  m_ss.Terminate();
+  OLA_ASSERT_TRUE(m_controller.Failed());
+  OLA_ASSERT_EQ(string("Error"), m_controller.ErrorText());
+}
+
+void InProcessRpcChannelTest::SendFailed() {
+  OLA_ASSERT_TRUE(m_controller.Failed());
+  OLA_ASSERT_EQ(string("Failed to send request"), m_controller.ErrorText());
+}
+
+void InProcessRpcChannelTest::ChannelClosed(RpcSession *session) {
+  OLA_ASSERT_EQ(m_channel->Session(), session);
+  m_closed = true;
+  m_ss.Terminate();
+}
+
+void InProcessRpcChannelTest::DeleteServerChannel() {
+  m_server_channel.reset();
+}
+
+/*
+ * Check that we can call the echo method in the TestServiceImpl.
+ */
+void InProcessRpcChannelTest::testEcho() {
+  m_request.set_data("foo");
+  m_request.set_session_ptr(0);
+  m_stub->Echo(&m_controller,
+               &m_request,
+               &m_reply,
+               NewSingleCallback(this, &InProcessRpcChannelTest::EchoComplete));
+  m_ss.Run();
+}
+
+/*
+ * Check that method that fail return correctly
+ */
+void InProcessRpcChannelTest::testFailedEcho() {
+  m_request.set_data("foo");
+  m_stub->FailedEcho(
+      &m_controller,
+      &m_request,
+      &m_reply,
+      NewSingleCallback(this, &InProcessRpcChannelTest::FailedEchoComplete));
+  m_ss.Run();
+}
+
+/*
+ * Check stream requests work, the service terminates the server thread.
+ */
+void InProcessRpcChannelTest::testStreamRequest() {
+  m_request.set_data("foo");
+  m_stub->Stream(NULL, &m_request, NULL, NULL);
+  m_server_thread->Join();
+}
+
+/*
+ * Check the close handler runs when the other end goes away, and that calls
+ * fail after that.
+ */
+void InProcessRpcChannelTest::testClose() {
+  m_channel->SetChannelCloseHandler(
+      NewSingleCallback(this, &InProcessRpcChannelTest::ChannelClosed));
+
+  m_server_ss.Execute(
+      NewSingleCallback(this, &InProcessRpcChannelTest::DeleteServerChannel));
+  m_ss.Run();
+  OLA_ASSERT_TRUE(m_closed);
+  OLA_ASSERT_FALSE(m_channel->Connected());
+
+  m_request.set_data("foo");
+  m_stub->Echo(&m_controller,
+               &m_request,
+               &m_reply,
+               NewSingleCallback(this, &InProcessRpcChannelTest::SendFailed));
+  OLA_ASSERT_TRUE(m_controller.Failed());
+}
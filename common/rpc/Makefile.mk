@@ -9,6 +9,8 @@ built_sources += \
 # LIBRARIES
 ##################################################
 common_libolacommon_la_SOURCES += \
+    common/rpc/InProcessRpcChannel.cpp \
+    common/rpc/InProcessRpcChannel.h \
     common/rpc/RpcChannel.cpp \
     common/rpc/RpcChannel.h \
     common/rpc/RpcSession.h \
@@ -35,6 +37,17 @@ common/rpc/TestService.pb.cc common/rpc/TestService.pb.h: common/rpc/Makefile.mk
 common/rpc/TestServiceService.pb.cpp common/rpc/TestServiceService.pb.h: common/rpc/Makefile.mk common/rpc/TestService.proto protoc/ola_protoc_plugin$(EXEEXT)
 	$(OLA_PROTOC) --cppservice_out common/rpc --proto_path $(srcdir)/common/rpc $(srcdir)/common/rpc/TestService.proto
 
+# PROGRAMS
+##################################################
+noinst_PROGRAMS += common/rpc/rpc_loadtest
+
+common_rpc_rpc_loadtest_SOURCES = common/rpc/rpc_loadtest.cpp
+nodist_common_rpc_rpc_loadtest_SOURCES = \
+    common/rpc/TestService.pb.cc \
+    common/rpc/TestServiceService.pb.cpp
+common_rpc_rpc_loadtest_LDADD = common/libolacommon.la \
+                                $(libprotobuf_LIBS)
+
 # TESTS
 ##################################################
 test_programs += common/rpc/RpcTester common/rpc/RpcServerTester
@@ -44,6 +57,7 @@ common_rpc_TEST_SOURCES = \
     common/rpc/TestService.cpp
 
 common_rpc_RpcTester_SOURCES = \
+    common/rpc/InProcessRpcChannelTest.cpp \
     common/rpc/RpcControllerTest.cpp \
     common/rpc/RpcChannelTest.cpp \
     common/rpc/RpcHeaderTest.cpp \
@@ -207,8 +207,6 @@ void RpcChannel::CallMethod(const MethodDescriptor *method,
                             const Message *request,
                             Message *reply,
                             SingleUseCallback0<void> *done) {
-  // TODO(simonn): reduce the number of copies here
-  string output;
   RpcMessage message;
   bool is_streaming = false;
 
@@ -227,8 +225,7 @@ void RpcChannel::CallMethod(const MethodDescriptor *method,
   message.set_id(m_sequence.Next());
   message.set_name(method->name());
 
-  request->SerializeToString(&output);
-  message.set_buffer(output);
+  request->SerializeToString(message.mutable_buffer());
   bool r = SendMsg(&message);
 
   if (is_streaming)
@@ -257,7 +254,6 @@ void RpcChannel::CallMethod(const MethodDescriptor *method,
 }
 
 void RpcChannel::RequestComplete(OutstandingRequest *request) {
-  string output;
   RpcMessage message;
 
   if (request->controller->Failed()) {
@@ -267,8 +263,7 @@ void RpcChannel::RequestComplete(OutstandingRequest *request) {
 
   message.set_type(RESPONSE);
   message.set_id(request->id);
-  request->response->SerializeToString(&output);
-  message.set_buffer(output);
+  request->response->SerializeToString(message.mutable_buffer());
   SendMsg(&message);
   DeleteOutstandingRequest(request);
 }
@@ -290,19 +285,20 @@ bool RpcChannel::SendMsg(RpcMessage *msg) {
   }
 
   uint32_t header;
-  // reserve the first 4 bytes for the header
-  string output(sizeof(header), 0);
-  msg->AppendToString(&output);
-  int length = output.size();
+  // reserve the first 4 bytes for the header. The buffer is re-used so we
+  // don't allocate for each message.
+  m_output_buffer.assign(sizeof(header), 0);
+  msg->AppendToString(&m_output_buffer);
+  int length = m_output_buffer.size();
 
   RpcHeader::EncodeHeader(&header, PROTOCOL_VERSION,
                                 length - sizeof(header));
-  output.replace(
+  m_output_buffer.replace(
       0, sizeof(header),
       reinterpret_cast<const char*>(&header), sizeof(header));
 
   ssize_t ret = m_descriptor->Send(
-      reinterpret_cast<const uint8_t*>(output.data()), length);
+      reinterpret_cast<const uint8_t*>(m_output_buffer.data()), length);
 
   if (ret != length) {
     OLA_WARN << "Failed to send full RPC message, closing channel";
@@ -31,6 +31,7 @@
 #include <ola/io/Descriptor.h>
 #include <ola/util/SequenceNumber.h>
 #include <memory>
+#include <string>
 
 #include "ola/ExportMap.h"
 
@@ -74,7 +75,7 @@ class RpcChannel {
     /**
      * @brief Destructor
      */
-    ~RpcChannel();
+    virtual ~RpcChannel();
 
     /**
      * @brief Set the Service to use to handle incoming requests.
@@ -111,7 +112,7 @@ class RpcChannel {
     /**
      * @brief Invoke an RPC method on this channel.
      */
-    void CallMethod(const google::protobuf::MethodDescriptor *method,
+    virtual void CallMethod(const google::protobuf::MethodDescriptor *method,
                     class RpcController *controller,
                     const google::protobuf::Message *request,
                     google::protobuf::Message *response,
@@ -135,6 +136,19 @@ class RpcChannel {
      */
     static const unsigned int PROTOCOL_VERSION = 1;
 
+ protected:
+    /**
+     * @brief Return the Service used to handle incoming requests.
+     */
+    RpcService *Service() const { return m_service; }
+
+    /**
+     * @brief Run the close handler, if there is one.
+     */
+    void HandleChannelClose();
+
+    static const char STREAMING_NO_RESPONSE[];
+
  private:
     typedef HASH_NAMESPACE::HASH_MAP_CLASS<int, class OutstandingResponse*>
       ResponseMap;
@@ -149,6 +163,7 @@ class RpcChannel {
     unsigned int m_buffer_size;  // size of the buffer
     unsigned int m_expected_size;  // the total size of the current msg
     unsigned int m_current_size;  // the amount of data read for the current msg
+    std::string m_output_buffer;  // buffer for outgoing msgs
     HASH_NAMESPACE::HASH_MAP_CLASS<int, class OutstandingRequest*> m_requests;
     ResponseMap m_responses;
     ExportMap *m_export_map;
@@ -172,14 +187,11 @@ class RpcChannel {
     void HandleCanceledResponse(RpcMessage *msg);
     void HandleNotImplemented(RpcMessage *msg);
 
-    void HandleChannelClose();
-
     static const char K_RPC_RECEIVED_TYPE_VAR[];
     static const char K_RPC_RECEIVED_VAR[];
     static const char K_RPC_SENT_ERROR_VAR[];
     static const char K_RPC_SENT_VAR[];
     static const char *K_RPC_VARIABLES[];
-    static const char STREAMING_NO_RESPONSE[];
     static const unsigned int INITIAL_BUFFER_SIZE = 1 << 11;  // 2k
     static const unsigned int MAX_BUFFER_SIZE = 1 << 20;  // 1M
 };
@@ -25,6 +25,7 @@
 #include <ola/network/SocketAddress.h>
 #include <ola/network/TCPSocket.h>
 #include <ola/rpc/RpcSessionHandler.h>
+#include "common/rpc/InProcessRpcChannel.h"
 #include "common/rpc/RpcChannel.h"
 #include "common/rpc/RpcSession.h"
 
@@ -45,6 +46,10 @@ void CleanupChannel(RpcChannel *channel,
   delete channel;
   delete descriptor;
 }
+
+void CleanupInProcessChannel(InProcessRpcChannel *channel) {
+  delete channel;
+}
 }  // namespace
 
 const char RpcServer::K_CLIENT_VAR[] = "clients-connected";
@@ -74,7 +79,14 @@ RpcServer::~RpcServer() {
     (*iter)->TransferOnClose()->Run();
   }
 
-  if (!sockets.empty()) {
+  InProcessChannels channels = m_in_process_channels;
+  InProcessChannels::const_iterator channel_iter = channels.begin();
+  for (; channel_iter != channels.end(); ++channel_iter) {
+    (*channel_iter)->SetChannelCloseHandler(NULL);
+    InProcessChannelClosed(*channel_iter, (*channel_iter)->Session());
+  }
+
+  if (!sockets.empty() || !channels.empty()) {
     m_ss->DrainCallbacks();
   }
 
@@ -148,6 +160,29 @@ bool RpcServer::AddClient(ConnectedDescriptor *descriptor) {
   return true;
 }
 
+bool RpcServer::AddInProcessClient(InProcessRpcChannel *client_channel) {
+  auto_ptr<InProcessRpcChannel> channel(
+      new InProcessRpcChannel(m_service, m_ss));
+  if (!InProcessRpcChannel::Connect(channel.get(), client_channel)) {
+    return false;
+  }
+
+  if (m_session_handler) {
+    m_session_handler->NewClient(channel->Session());
+  }
+
+  channel->SetChannelCloseHandler(
+      NewSingleCallback(this, &RpcServer::InProcessChannelClosed,
+                        channel.get()));
+
+  if (m_options.export_map) {
+    (*m_options.export_map->GetIntegerVar(K_CLIENT_VAR))++;
+  }
+
+  m_in_process_channels.insert(channel.release());
+  return true;
+}
+
 void RpcServer::NewTCPConnection(TCPSocket *socket) {
   if (!socket)
     return;
@@ -175,5 +210,21 @@ void RpcServer::ChannelClosed(ConnectedDescriptor *descriptor,
   m_ss->Execute(
       NewSingleCallback(CleanupChannel, session->Channel(), descriptor));
 }
+
+void RpcServer::InProcessChannelClosed(InProcessRpcChannel *channel,
+                                       RpcSession *session) {
+  if (m_session_handler) {
+    m_session_handler->ClientRemoved(session);
+  }
+
+  if (m_options.export_map) {
+    (*m_options.export_map->GetIntegerVar(K_CLIENT_VAR))--;
+  }
+
+  m_in_process_channels.erase(channel);
+
+  // The channel may be in our call stack, so delete it later.
+  m_ss->Execute(NewSingleCallback(CleanupInProcessChannel, channel));
+}
 }  // namespace rpc
 }  // namespace ola
@@ -113,8 +113,20 @@ class RpcServer {
    */
   bool AddClient(ola::io::ConnectedDescriptor *descriptor);
 
+  /**
+   * @brief Attach a client running in this process.
+   * @param client_channel the client end of the channel, this must not be
+   *   connected. Ownership is not transferred, the channel may be used from
+   *   another thread.
+   *
+   * Calls from the client invoke the RPCService directly, without
+   * serializing the messages.
+   */
+  bool AddInProcessClient(class InProcessRpcChannel *client_channel);
+
  private:
   typedef std::set<ola::io::ConnectedDescriptor*> ClientDescriptors;
+  typedef std::set<class InProcessRpcChannel*> InProcessChannels;
 
   ola::io::SelectServerInterface *m_ss;
   RpcService *m_service;
@@ -124,10 +136,13 @@ class RpcServer {
   ola::network::TCPSocketFactory m_tcp_socket_factory;
   std::auto_ptr<ola::network::TCPAcceptingSocket> m_accepting_socket;
   ClientDescriptors m_connected_sockets;
+  InProcessChannels m_in_process_channels;
 
   void NewTCPConnection(ola::network::TCPSocket *socket);
   void ChannelClosed(ola::io::ConnectedDescriptor *socket,
                      class RpcSession *session);
+  void InProcessChannelClosed(class InProcessRpcChannel *channel,
+                              class RpcSession *session);
 
   static const char K_CLIENT_VAR[];
   static const char K_RPC_PORT_VAR[];
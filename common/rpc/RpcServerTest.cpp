@@ -19,7 +19,10 @@
  */
 
 #include <memory>
+#include <string>
 
+#include "common/rpc/InProcessRpcChannel.h"
+#include "common/rpc/RpcController.h"
 #include "common/rpc/RpcServer.h"
 #include "common/rpc/RpcSession.h"
 #include "common/rpc/TestService.h"
@@ -28,7 +31,12 @@
 #include "ola/rpc/RpcSessionHandler.h"
 #include "ola/testing/TestUtils.h"
 
+using ola::NewSingleCallback;
 using ola::io::SelectServer;
+using ola::rpc::EchoReply;
+using ola::rpc::EchoRequest;
+using ola::rpc::InProcessRpcChannel;
+using ola::rpc::RpcController;
 using ola::rpc::RpcSession;
 using ola::rpc::RpcServer;
 using std::auto_ptr;
@@ -39,18 +47,22 @@ class RpcServerTest: public CppUnit::TestFixture,
   CPPUNIT_TEST(testEcho);
   CPPUNIT_TEST(testFailedEcho);
   CPPUNIT_TEST(testStreamRequest);
+  CPPUNIT_TEST(testInProcessClient);
   CPPUNIT_TEST_SUITE_END();
 
  public:
   void testEcho();
   void testFailedEcho();
   void testStreamRequest();
+  void testInProcessClient();
 
   void setUp();
 
   void NewClient(RpcSession *session);
   void ClientRemoved(RpcSession *session);
 
+  void InProcessEchoComplete(RpcController *controller, EchoReply *reply);
+
  private:
   SelectServer m_ss;
   auto_ptr<TestServiceImpl> m_service;
@@ -58,11 +70,13 @@ class RpcServerTest: public CppUnit::TestFixture,
   auto_ptr<TestClient> m_client;
 
   uint8_t ptr_data;
+  unsigned int m_clients_removed;
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(RpcServerTest);
 
 void RpcServerTest::setUp() {
+  m_clients_removed = 0;
   m_service.reset(new TestServiceImpl(&m_ss));
   m_server.reset(new RpcServer(
       &m_ss, m_service.get(), this, RpcServer::Options()));
@@ -78,6 +92,14 @@ void RpcServerTest::NewClient(RpcSession *session) {
 
 void RpcServerTest::ClientRemoved(RpcSession *session) {
   OLA_ASSERT_EQ(reinterpret_cast<void*>(&ptr_data), session->GetData());
+  m_clients_removed++;
+}
+
+void RpcServerTest::InProcessEchoComplete(RpcController *controller,
+                                          EchoReply *reply) {
+  OLA_ASSERT_FALSE(controller->Failed());
+  OLA_ASSERT_EQ(std::string(TestClient::kTestData), reply->data());
+  m_ss.Terminate();
 }
 
 void RpcServerTest::testEcho() {
@@ -91,3 +113,25 @@ void RpcServerTest::testFailedEcho() {
 void RpcServerTest::testStreamRequest() {
   m_client->StreamMessage();
 }
+
+void RpcServerTest::testInProcessClient() {
+  auto_ptr<InProcessRpcChannel> channel(new InProcessRpcChannel(NULL, &m_ss));
+  OLA_ASSERT_TRUE(m_server->AddInProcessClient(channel.get()));
+  OLA_ASSERT_FALSE(m_server->AddInProcessClient(channel.get()));
+
+  ola::rpc::TestService_Stub stub(channel.get());
+  EchoRequest request;
+  EchoReply reply;
+  RpcController controller;
+  request.set_data(TestClient::kTestData);
+  request.set_session_ptr(reinterpret_cast<uintptr_t>(&ptr_data));
+  stub.Echo(&controller, &request, &reply,
+            NewSingleCallback(this, &RpcServerTest::InProcessEchoComplete,
+                              &controller, &reply));
+  m_ss.Run();
+
+  // Deleting the client end removes the client from the server.
+  channel.reset();
+  m_ss.RunOnce(ola::TimeInterval(0, 0));
+  OLA_ASSERT_EQ(1u, m_clients_removed);
+}
@@ -0,0 +1,206 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * rpc_loadtest.cpp
+ * Compare the latency of an RpcChannel over a pipe with an
+ * InProcessRpcChannel, for a range of message sizes.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#include <sys/resource.h>
+#include <stdint.h>
+
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "common/rpc/InProcessRpcChannel.h"
+#include "common/rpc/RpcChannel.h"
+#include "common/rpc/RpcController.h"
+#include "common/rpc/TestService.pb.h"
+#include "common/rpc/TestServiceService.pb.h"
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/base/Array.h"
+#include "ola/base/Flags.h"
+#include "ola/base/Init.h"
+#include "ola/io/Descriptor.h"
+#include "ola/io/SelectServer.h"
+#include "ola/thread/CallbackThread.h"
+
+using ola::Clock;
+using ola::NewSingleCallback;
+using ola::TimeStamp;
+using ola::io::PipeDescriptor;
+using ola::io::SelectServer;
+using ola::rpc::EchoReply;
+using ola::rpc::EchoRequest;
+using ola::rpc::InProcessRpcChannel;
+using ola::rpc::RpcChannel;
+using ola::rpc::RpcController;
+using ola::rpc::STREAMING_NO_RESPONSE;
+using ola::rpc::TestService;
+using ola::rpc::TestService_Stub;
+using ola::thread::CallbackThread;
+using std::auto_ptr;
+using std::cout;
+using std::endl;
+using std::string;
+
+DEFINE_s_uint32(calls, c, 20000, "The number of calls to make for each size");
+
+namespace {
+
+/**
+ * Echos the request data back in the reply.
+ */
+class EchoService : public TestService {
+ public:
+  void Echo(RpcController*, const EchoRequest *request, EchoReply *reply,
+            CompletionCallback *done) {
+    reply->set_data(request->data());
+    done->Run();
+  }
+
+  void FailedEcho(RpcController *controller, const EchoRequest*, EchoReply*,
+                  CompletionCallback *done) {
+    controller->SetFailed("Error");
+    done->Run();
+  }
+
+  void Stream(RpcController*, const EchoRequest*, STREAMING_NO_RESPONSE*,
+              CompletionCallback*) {
+  }
+};
+
+/**
+ * Makes one call at a time, the next call is made once the previous one
+ * completes.
+ */
+class CallLoop {
+ public:
+  CallLoop(SelectServer *ss, RpcChannel *channel, unsigned int size,
+           unsigned int calls)
+      : m_ss(ss),
+        m_stub(channel),
+        m_remaining(calls) {
+    m_request.set_data(string(size, 'x'));
+  }
+
+  void Next() {
+    if (!m_remaining--) {
+      m_ss->Terminate();
+      return;
+    }
+    m_controller.Reset();
+    m_stub.Echo(&m_controller, &m_request, &m_reply,
+                NewSingleCallback(this, &CallLoop::Next));
+  }
+
+ private:
+  SelectServer *m_ss;
+  TestService_Stub m_stub;
+  unsigned int m_remaining;
+  RpcController m_controller;
+  EchoRequest m_request;
+  EchoReply m_reply;
+};
+
+int64_t CPUTime() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return (static_cast<int64_t>(usage.ru_utime.tv_sec) +
+          usage.ru_stime.tv_sec) * ola::USEC_IN_SECONDS +
+         usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+/*
+ * Make the calls from the client SelectServer, with the server SelectServer
+ * running in another thread.
+ */
+void Run(SelectServer *client_ss, SelectServer *server_ss,
+         RpcChannel *channel, unsigned int size) {
+  CallbackThread thread(NewSingleCallback(server_ss, &SelectServer::Run));
+  thread.Start();
+
+  CallLoop loop(client_ss, channel, size, FLAGS_calls);
+  Clock clock;
+  TimeStamp start, end;
+  clock.CurrentTime(&start);
+  const int64_t start_cpu = CPUTime();
+
+  client_ss->Execute(NewSingleCallback(&loop, &CallLoop::Next));
+  client_ss->Run();
+
+  clock.CurrentTime(&end);
+  const int64_t cpu = CPUTime() - start_cpu;
+  server_ss->Terminate();
+  thread.Join();
+
+  cout << std::setw(10) << std::fixed << std::setprecision(1)
+       << static_cast<double>((end - start).AsInt()) / FLAGS_calls << " us"
+       << std::setw(10) << static_cast<double>(cpu) / FLAGS_calls << " us";
+}
+
+void RunPipe(EchoService *service, unsigned int size) {
+  SelectServer client_ss, server_ss;
+  PipeDescriptor pipe;
+  pipe.Init();
+  auto_ptr<PipeDescriptor> other_end(pipe.OppositeEnd());
+
+  RpcChannel server_channel(service, &pipe);
+  RpcChannel client_channel(NULL, other_end.get());
+  server_ss.AddReadDescriptor(&pipe);
+  client_ss.AddReadDescriptor(other_end.get());
+
+  Run(&client_ss, &server_ss, &client_channel, size);
+
+  client_ss.RemoveReadDescriptor(other_end.get());
+  server_ss.RemoveReadDescriptor(&pipe);
+}
+
+void RunInProcess(EchoService *service, unsigned int size) {
+  SelectServer client_ss, server_ss;
+  InProcessRpcChannel server_channel(service, &server_ss);
+  InProcessRpcChannel client_channel(NULL, &client_ss);
+  InProcessRpcChannel::Connect(&server_channel, &client_channel);
+
+  Run(&client_ss, &server_ss, &client_channel, size);
+
+  client_channel.Close();
+  server_ss.DrainCallbacks();
+  client_ss.DrainCallbacks();
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  ola::AppInit(&argc, argv, "[options]",
+               "Compare the RpcChannel & InProcessRpcChannel latency.");
+
+  const unsigned int SIZES[] = {16, 200, 600, 5000, 50000};
+  EchoService service;
+
+  cout << std::setw(8) << "Size" << std::setw(26) << "Pipe (wall / CPU)"
+       << std::setw(26) << "In-process (wall / CPU)" << endl;
+  for (unsigned int i = 0; i < arraysize(SIZES); i++) {
+    cout << std::setw(8) << SIZES[i] << std::setw(2) << "";
+    RunPipe(&service, SIZES[i]);
+    cout << std::setw(6) << "";
+    RunInProcess(&service, SIZES[i]);
+    cout << endl;
+  }
+  return 0;
+}
@@ -0,0 +1,336 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * DmxFrameTimer.cpp
+ * Generate the break, mark after break & frame timing for DMX output threads.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <errno.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <set>
+#include <string>
+
+#include "ola/ExportMap.h"
+#include "ola/Logging.h"
+#include "ola/base/Flags.h"
+#include "ola/thread/DmxFrameTimer.h"
+
+DEFINE_uint16(output_thread_spin_us, 0,
+              "Busy wait for the last N microseconds of each sleep in the "
+              "DMX output threads. This improves the timing accuracy at the "
+              "cost of CPU time.");
+
+namespace {
+
+// The timers that currently exist, used to export the stats.
+ola::thread::Mutex timers_mutex;
+std::set<ola::thread::DmxFrameTimer*> timers;
+std::set<std::string> exported_timers;
+
+const char K_DMX_FRAMES_VAR[] = "dmx-frames";
+const char K_DMX_BREAK_VAR[] = "dmx-break-us";
+const char K_DMX_MIN_BREAK_VAR[] = "dmx-min-break-us";
+const char K_DMX_MAB_VAR[] = "dmx-mab-us";
+const char K_DMX_MIN_MAB_VAR[] = "dmx-min-mab-us";
+const char K_DMX_FRAME_TIME_VAR[] = "dmx-frame-time-us";
+const char K_DMX_MAX_FRAME_TIME_VAR[] = "dmx-max-frame-time-us";
+const char K_DMX_VAR_LABEL[] = "device";
+}  // namespace
+
+namespace ola {
+namespace thread {
+
+using std::string;
+
+const int64_t DmxFrameTimer::BAD_GRANULARITY_LIMIT = 3000;
+
+DmxFrameTimer::Options::Options()
+    : spin_time(static_cast<int64_t>(FLAGS_output_thread_spin_us)) {
+}
+
+DmxFrameTimer::DmxFrameTimer(const string &name,
+                             const Options &options,
+                             SchedulingStats *scheduling_stats)
+    : m_name(name),
+      m_spin_time(options.spin_time),
+      m_scheduling_stats(scheduling_stats),
+      m_granularity(UNKNOWN),
+      m_frames(0) {
+  MutexLocker locker(&timers_mutex);
+  timers.insert(this);
+}
+
+DmxFrameTimer::~DmxFrameTimer() {
+  MutexLocker locker(&timers_mutex);
+  timers.erase(this);
+}
+
+void DmxFrameTimer::CheckGranularity() {
+  TimeStamp start, end;
+  CurrentTime(&start);
+  usleep(1000);
+  CurrentTime(&end);
+
+  m_granularity = ((end - start).AsInt() > BAD_GRANULARITY_LIMIT) ?
+      BAD : GOOD;
+  OLA_INFO << "Granularity for " << m_name << " is "
+           << (m_granularity == GOOD ? "GOOD" : "BAD");
+}
+
+void DmxFrameTimer::StartFrame() {
+  TimeStamp now;
+  CurrentTime(&now);
+
+  {
+    MutexLocker locker(&m_mutex);
+    if (m_frames) {
+      m_frame_stats.Record(now - m_last_frame_start);
+    }
+    m_frames++;
+  }
+  m_last_frame_start = now;
+
+  // If the last frame finished on time, this frame is scheduled from the end
+  // of the last one, so the wake up latency doesn't accumulate.
+  if (m_next_frame_start.IsSet()) {
+    m_frame_start = m_next_frame_start;
+    m_next_frame_start = TimeStamp();
+  } else {
+    m_frame_start = now;
+  }
+}
+
+void DmxFrameTimer::Break(unsigned int duration) {
+  CurrentTime(&m_break_start);
+  if (!CoarseTimers()) {
+    TimeStamp woken;
+    SleepUntil(m_break_start + TimeInterval(static_cast<int64_t>(duration)),
+               &woken);
+  }
+}
+
+void DmxFrameTimer::MarkAfterBreak(unsigned int duration) {
+  // The break lasts until the caller clears it, which happens just before
+  // this is called.
+  TimeStamp start, end;
+  CurrentTime(&start);
+  if (CoarseTimers()) {
+    end = start;
+  } else {
+    SleepUntil(start + TimeInterval(static_cast<int64_t>(duration)), &end);
+  }
+
+  MutexLocker locker(&m_mutex);
+  m_break_stats.Record(start - m_break_start);
+  m_mab_stats.Record(end - start);
+}
+
+void DmxFrameTimer::WaitForFrameEnd(const TimeInterval &frame_time) {
+  const TimeStamp deadline = m_frame_start + frame_time;
+  TimeStamp now;
+  CurrentTime(&now);
+  if (now < deadline) {
+    m_next_frame_start = deadline;
+  }
+
+  if (!CoarseTimers()) {
+    SleepUntil(deadline, &now);
+    return;
+  }
+
+  // See if we can drop out of bad mode.
+  const TimeStamp start = now;
+  usleep(1000);
+  CurrentTime(&now);
+  if ((now - start).AsInt() < BAD_GRANULARITY_LIMIT) {
+    m_granularity = GOOD;
+    OLA_INFO << "Switching from BAD to GOOD granularity for " << m_name;
+  }
+
+  while (now < deadline) {
+    CurrentTime(&now);
+  }
+}
+
+void DmxFrameTimer::Sleep(unsigned int duration) {
+  TimeStamp now;
+  CurrentTime(&now);
+  SleepUntil(now + TimeInterval(static_cast<int64_t>(duration)), &now);
+}
+
+void DmxFrameTimer::SleepUntil(const TimeStamp &deadline, TimeStamp *woken) {
+  const TimeStamp wake_up = deadline - m_spin_time;
+  CurrentTime(woken);
+
+  if (*woken < wake_up) {
+#ifdef HAVE_CLOCK_NANOSLEEP
+    struct timespec ts;
+    ts.tv_sec = wake_up.Seconds();
+    ts.tv_nsec = wake_up.MicroSeconds() * 1000;
+    // clock_nanosleep returns the error rather than setting errno.
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) ==
+           EINTR) {
+    }
+#else
+    usleep((wake_up - *woken).AsInt());
+#endif
+    CurrentTime(woken);
+  }
+
+  if (m_scheduling_stats) {
+    m_scheduling_stats->RecordWakeUp(wake_up, *woken);
+  }
+
+  while (*woken < deadline) {
+    CurrentTime(woken);
+  }
+}
+
+void DmxFrameTimer::CurrentTime(TimeStamp *now) {
+  struct timeval tv;
+#ifdef HAVE_CLOCK_NANOSLEEP
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  tv.tv_sec = ts.tv_sec;
+  tv.tv_usec = ts.tv_nsec / 1000;
+#else
+  gettimeofday(&tv, NULL);
+#endif
+  *now = tv;
+}
+
+uint64_t DmxFrameTimer::Frames() const {
+  MutexLocker locker(&m_mutex);
+  return m_frames;
+}
+
+TimeInterval DmxFrameTimer::MeanBreak() const {
+  MutexLocker locker(&m_mutex);
+  return m_break_stats.Mean();
+}
+
+TimeInterval DmxFrameTimer::MinBreak() const {
+  MutexLocker locker(&m_mutex);
+  return TimeInterval(m_break_stats.min);
+}
+
+TimeInterval DmxFrameTimer::MeanMarkAfterBreak() const {
+  MutexLocker locker(&m_mutex);
+  return m_mab_stats.Mean();
+}
+
+TimeInterval DmxFrameTimer::MinMarkAfterBreak() const {
+  MutexLocker locker(&m_mutex);
+  return TimeInterval(m_mab_stats.min);
+}
+
+TimeInterval DmxFrameTimer::MeanFrameTime() const {
+  MutexLocker locker(&m_mutex);
+  return m_frame_stats.Mean();
+}
+
+TimeInterval DmxFrameTimer::MaxFrameTime() const {
+  MutexLocker locker(&m_mutex);
+  return TimeInterval(m_frame_stats.max);
+}
+
+void DmxFrameTimer::ExportStats(ExportMap *export_map) {
+  UIntMap *frames = export_map->GetUIntMapVar(K_DMX_FRAMES_VAR,
+                                              K_DMX_VAR_LABEL);
+  UIntMap *mean_break = export_map->GetUIntMapVar(K_DMX_BREAK_VAR,
+                                                  K_DMX_VAR_LABEL);
+  UIntMap *min_break = export_map->GetUIntMapVar(K_DMX_MIN_BREAK_VAR,
+                                                 K_DMX_VAR_LABEL);
+  UIntMap *mean_mab = export_map->GetUIntMapVar(K_DMX_MAB_VAR,
+                                                K_DMX_VAR_LABEL);
+  UIntMap *min_mab = export_map->GetUIntMapVar(K_DMX_MIN_MAB_VAR,
+                                               K_DMX_VAR_LABEL);
+  UIntMap *frame_time = export_map->GetUIntMapVar(K_DMX_FRAME_TIME_VAR,
+                                                  K_DMX_VAR_LABEL);
+  UIntMap *max_frame_time = export_map->GetUIntMapVar(
+      K_DMX_MAX_FRAME_TIME_VAR, K_DMX_VAR_LABEL);
+
+  MutexLocker locker(&timers_mutex);
+  std::set<string> exported;
+  std::set<DmxFrameTimer*>::const_iterator iter = timers.begin();
+  for (; iter != timers.end(); ++iter) {
+    const DmxFrameTimer *timer = *iter;
+    if (!timer->Frames()) {
+      continue;
+    }
+
+    const string &key = timer->Name();
+    exported.insert(key);
+    frames->Set(key, static_cast<unsigned int>(timer->Frames()));
+    mean_break->Set(key, static_cast<unsigned int>(
+        timer->MeanBreak().AsInt()));
+    min_break->Set(key, static_cast<unsigned int>(
+        timer->MinBreak().AsInt()));
+    mean_mab->Set(key, static_cast<unsigned int>(
+        timer->MeanMarkAfterBreak().AsInt()));
+    min_mab->Set(key, static_cast<unsigned int>(
+        timer->MinMarkAfterBreak().AsInt()));
+    frame_time->Set(key, static_cast<unsigned int>(
+        timer->MeanFrameTime().AsInt()));
+    max_frame_time->Set(key, static_cast<unsigned int>(
+        timer->MaxFrameTime().AsInt()));
+  }
+
+  // Remove the timers that have been deleted.
+  std::set<string>::const_iterator key_iter = exported_timers.begin();
+  for (; key_iter != exported_timers.end(); ++key_iter) {
+    if (exported.find(*key_iter) == exported.end()) {
+      frames->Remove(*key_iter);
+      mean_break->Remove(*key_iter);
+      min_break->Remove(*key_iter);
+      mean_mab->Remove(*key_iter);
+      min_mab->Remove(*key_iter);
+      frame_time->Remove(*key_iter);
+      max_frame_time->Remove(*key_iter);
+    }
+  }
+  exported_timers.swap(exported);
+}
+
+void DmxFrameTimer::IntervalStats::Record(const TimeInterval &interval) {
+  const int64_t value = interval.AsInt();
+  if (count) {
+    min = std::min(min, value);
+    max = std::max(max, value);
+  } else {
+    min = value;
+    max = value;
+  }
+  count++;
+  total += value;
+}
+
+TimeInterval DmxFrameTimer::IntervalStats::Mean() const {
+  if (!count) {
+    return TimeInterval();
+  }
+  return TimeInterval(total / static_cast<int64_t>(count));
+}
+}  // namespace thread
+}  // namespace ola
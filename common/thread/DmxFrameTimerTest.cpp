@@ -0,0 +1,149 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * DmxFrameTimerTest.cpp
+ * Test fixture for the DmxFrameTimer class
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <memory>
+#include <string>
+
+#include "ola/Clock.h"
+#include "ola/ExportMap.h"
+#include "ola/Logging.h"
+#include "ola/testing/TestUtils.h"
+#include "ola/thread/DmxFrameTimer.h"
+#include "ola/thread/SchedulingStats.h"
+
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::thread::DmxFrameTimer;
+using ola::thread::SchedulingStats;
+using std::string;
+
+class DmxFrameTimerTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(DmxFrameTimerTest);
+  CPPUNIT_TEST(testSleepUntil);
+  CPPUNIT_TEST(testFrameTiming);
+  CPPUNIT_TEST(testExportStats);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void testSleepUntil();
+  void testFrameTiming();
+  void testExportStats();
+
+ private:
+  void SendFrames(DmxFrameTimer *timer, unsigned int count,
+                  const TimeInterval &frame_time);
+
+  static const unsigned int BREAK = 110;
+  static const unsigned int MAB = 16;
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(DmxFrameTimerTest);
+
+
+/*
+ * Check we never wake up early, with and without the busy wait.
+ */
+void DmxFrameTimerTest::testSleepUntil() {
+  SchedulingStats stats;
+  DmxFrameTimer::Options options;
+  options.spin_time = TimeInterval(0, 0);
+  DmxFrameTimer timer("test", options, &stats);
+
+  TimeStamp now, woken;
+  DmxFrameTimer::CurrentTime(&now);
+  TimeStamp deadline = now + TimeInterval(0, 2000);
+  timer.SleepUntil(deadline, &woken);
+  OLA_ASSERT_TRUE(woken >= deadline);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1), stats.WakeUps());
+
+  options.spin_time = TimeInterval(0, 500);
+  DmxFrameTimer spinning_timer("test-spin", options, &stats);
+  DmxFrameTimer::CurrentTime(&now);
+  deadline = now + TimeInterval(0, 2000);
+  spinning_timer.SleepUntil(deadline, &woken);
+  OLA_ASSERT_TRUE(woken >= deadline);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(2), stats.WakeUps());
+
+  // A deadline in the past returns immediately.
+  spinning_timer.SleepUntil(now, &woken);
+  OLA_ASSERT_TRUE(woken >= deadline);
+}
+
+
+/*
+ * Check the break, mark after break & frame times meet the requested times.
+ */
+void DmxFrameTimerTest::testFrameTiming() {
+  const unsigned int FRAME_COUNT = 20;
+  const TimeInterval FRAME_TIME(0, 5000);
+  DmxFrameTimer timer("test");
+
+  SendFrames(&timer, FRAME_COUNT, FRAME_TIME);
+
+  OLA_ASSERT_EQ(static_cast<uint64_t>(FRAME_COUNT), timer.Frames());
+  OLA_ASSERT_TRUE(timer.MinBreak().AsInt() >= BREAK);
+  OLA_ASSERT_TRUE(timer.MinMarkAfterBreak().AsInt() >= MAB);
+  OLA_ASSERT_TRUE(timer.MaxFrameTime() >= FRAME_TIME);
+  // The frames are scheduled from the previous deadline, so the mean can't
+  // drift by more than the latency of the first wake up.
+  OLA_ASSERT_TRUE(timer.MeanFrameTime() >= TimeInterval(0, 4900));
+
+  OLA_INFO << "Break: mean " << timer.MeanBreak() << ", min "
+           << timer.MinBreak() << "; MAB: mean " << timer.MeanMarkAfterBreak()
+           << ", min " << timer.MinMarkAfterBreak() << "; Frame time: mean "
+           << timer.MeanFrameTime() << ", max " << timer.MaxFrameTime();
+}
+
+
+/*
+ * Check the stats are exported & removed once the timer is deleted.
+ */
+void DmxFrameTimerTest::testExportStats() {
+  ola::ExportMap export_map;
+  std::auto_ptr<DmxFrameTimer> timer(new DmxFrameTimer("device-1"));
+  DmxFrameTimer idle_timer("device-2");
+
+  SendFrames(timer.get(), 2, TimeInterval(0, 1000));
+  DmxFrameTimer::ExportStats(&export_map);
+
+  ola::UIntMap *frames = export_map.GetUIntMapVar("dmx-frames");
+  ola::UIntMap *min_break = export_map.GetUIntMapVar("dmx-min-break-us");
+  OLA_ASSERT_EQ(2u, (*frames)["device-1"]);
+  OLA_ASSERT_TRUE((*min_break)["device-1"] >= BREAK);
+  // Timers which haven't sent a frame aren't exported.
+  OLA_ASSERT_EQ(string("map:device device-1:2"), frames->Value());
+
+  timer.reset();
+  DmxFrameTimer::ExportStats(&export_map);
+  OLA_ASSERT_EQ(string("map:device"), frames->Value());
+}
+
+
+void DmxFrameTimerTest::SendFrames(DmxFrameTimer *timer, unsigned int count,
+                                   const TimeInterval &frame_time) {
+  for (unsigned int i = 0; i < count; i++) {
+    timer->StartFrame();
+    timer->Break(BREAK);
+    timer->MarkAfterBreak(MAB);
+    timer->WaitForFrameEnd(frame_time);
+  }
+}
@@ -2,14 +2,24 @@
 ##################################################
 common_libolacommon_la_SOURCES += \
     common/thread/ConsumerThread.cpp \
+    common/thread/DmxFrameTimer.cpp \
     common/thread/ExecutorThread.cpp \
     common/thread/Mutex.cpp \
     common/thread/PeriodicThread.cpp \
+    common/thread/SchedulingStats.cpp \
     common/thread/SignalThread.cpp \
     common/thread/Thread.cpp \
     common/thread/ThreadPool.cpp \
     common/thread/Utils.cpp
 
+# PROGRAMS
+##################################################
+noinst_PROGRAMS += common/thread/threadpool_loadtest
+
+common_thread_threadpool_loadtest_SOURCES = \
+    common/thread/threadpool_loadtest.cpp
+common_thread_threadpool_loadtest_LDADD = common/libolacommon.la
+
 # TESTS
 ##################################################
 test_programs += common/thread/ExecutorThreadTester \
@@ -17,6 +27,7 @@ test_programs += common/thread/ExecutorThreadTester \
                  common/thread/FutureTester
 
 common_thread_ThreadTester_SOURCES = \
+    common/thread/DmxFrameTimerTest.cpp \
     common/thread/ThreadPoolTest.cpp \
     common/thread/ThreadTest.cpp
 common_thread_ThreadTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
@@ -0,0 +1,78 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * SchedulingStats.cpp
+ * Track how late a thread wakes up.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#include "ola/thread/SchedulingStats.h"
+
+namespace ola {
+namespace thread {
+
+SchedulingStats::SchedulingStats()
+    : m_wake_ups(0),
+      m_total_latency(0),
+      m_max_latency(0) {
+}
+
+template <typename T>
+T SchedulingStats::Load(const T *value) {
+  return __sync_fetch_and_add(const_cast<T*>(value), 0);
+}
+
+void SchedulingStats::RecordWakeUp(const TimeStamp &expected,
+                                   const TimeStamp &actual) {
+  // Waking early isn't a scheduling problem, so it's counted as 0.
+  int64_t latency = actual > expected ? (actual - expected).AsInt() : 0;
+
+  __sync_fetch_and_add(&m_wake_ups, 1);
+  __sync_fetch_and_add(&m_total_latency, latency);
+  int64_t max_latency = Load(&m_max_latency);
+  while (latency > max_latency) {
+    const int64_t previous = __sync_val_compare_and_swap(
+        &m_max_latency, max_latency, latency);
+    if (previous == max_latency) {
+      break;
+    }
+    max_latency = previous;
+  }
+}
+
+uint64_t SchedulingStats::WakeUps() const {
+  return Load(&m_wake_ups);
+}
+
+TimeInterval SchedulingStats::MaxLatency() const {
+  return TimeInterval(Load(&m_max_latency));
+}
+
+TimeInterval SchedulingStats::MeanLatency() const {
+  const uint64_t wake_ups = Load(&m_wake_ups);
+  if (!wake_ups) {
+    return TimeInterval();
+  }
+  return TimeInterval(Load(&m_total_latency) /
+                      static_cast<int64_t>(wake_ups));
+}
+
+void SchedulingStats::Reset() {
+  __sync_lock_test_and_set(&m_wake_ups, 0);
+  __sync_lock_test_and_set(&m_total_latency, 0);
+  __sync_lock_test_and_set(&m_max_latency, 0);
+}
+}  // namespace thread
+}  // namespace ola
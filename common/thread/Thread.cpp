@@ -24,16 +24,23 @@
 
 #include <errno.h>
 #include <pthread.h>
+#include <sched.h>
 #include <string.h>
 
 #ifdef HAVE_PTHREAD_NP_H
 #include <pthread_np.h>
 #endif
 
+#ifdef HAVE_MLOCKALL
+#include <sys/mman.h>
+#endif
 
+#include <set>
 #include <string>
 
+#include "ola/ExportMap.h"
 #include "ola/Logging.h"
+#include "ola/strings/Format.h"
 #include "ola/thread/Thread.h"
 #include "ola/thread/Utils.h"
 
@@ -46,6 +53,18 @@ void *StartThread(void *d) {
   ola::thread::Thread *thread = static_cast<ola::thread::Thread*>(d);
   return thread->_InternalRun();
 }
+
+// The threads that are currently running, used to export the scheduling
+// stats.
+ola::thread::Mutex running_threads_mutex;
+std::set<ola::thread::Thread*> running_threads;
+// The keys we exported last time.
+std::set<std::string> exported_threads;
+
+const char K_THREAD_WAKE_UPS_VAR[] = "thread-wake-ups";
+const char K_THREAD_MAX_LATENCY_VAR[] = "thread-max-latency-us";
+const char K_THREAD_MEAN_LATENCY_VAR[] = "thread-mean-latency-us";
+const char K_THREAD_VAR_LABEL[] = "thread";
 }  // namespace
 
 namespace ola {
@@ -55,7 +74,9 @@ using std::string;
 
 Thread::Options::Options(const std::string &name)
   : name(name),
-    inheritsched(PTHREAD_EXPLICIT_SCHED) {
+    inheritsched(PTHREAD_EXPLICIT_SCHED),
+    lock_memory(false),
+    fallback_to_default_scheduling(false) {
   // Default the scheduling options to the system-default values.
   pthread_attr_t attrs;
   pthread_attr_init(&attrs);
@@ -81,6 +102,11 @@ Thread::Thread(const Options &options)
   }
 }
 
+Thread::~Thread() {
+  MutexLocker locker(&running_threads_mutex);
+  running_threads.erase(this);
+}
+
 bool Thread::Start() {
   MutexLocker locker(&m_mutex);
   if (m_running) {
@@ -96,34 +122,53 @@ bool Thread::Start() {
 }
 
 bool Thread::FastStart() {
-  pthread_attr_t attrs;
-  pthread_attr_init(&attrs);
-
   if (m_options.inheritsched != PTHREAD_EXPLICIT_SCHED) {
     OLA_FATAL << "PTHREAD_EXPLICIT_SCHED not set, programming bug for "
               << Name() << "!";
     return false;
   }
 
+  if (CreateThread(m_options.policy, m_options.priority)) {
+    return true;
+  }
+
+  const Options defaults;
+  if (!m_options.fallback_to_default_scheduling ||
+      (m_options.policy == defaults.policy &&
+       m_options.priority == defaults.priority)) {
+    return false;
+  }
+
+  OLA_WARN << "Unable to start " << Name() << " with policy "
+           << PolicyToString(m_options.policy) << ", priority "
+           << m_options.priority << ", falling back to "
+           << PolicyToString(defaults.policy);
+  return CreateThread(defaults.policy, defaults.priority);
+}
+
+bool Thread::CreateThread(int policy, int priority) {
+  pthread_attr_t attrs;
+  pthread_attr_init(&attrs);
+
   // glibc 2.8 and onwards has a bug where PTHREAD_EXPLICIT_SCHED won't be
   // honored unless the policy and priority are explicitly set. See
   // man pthread_attr_setinheritsched.
   // By fetching the default values in Thread::Options(), we avoid this bug.
-  int ret = pthread_attr_setschedpolicy(&attrs, m_options.policy);
+  int ret = pthread_attr_setschedpolicy(&attrs, policy);
   if (ret) {
     OLA_WARN << "pthread_attr_setschedpolicy failed for " << Name()
-             << ", policy " << m_options.policy << ": " << strerror(errno);
+             << ", policy " << policy << ": " << strerror(ret);
     pthread_attr_destroy(&attrs);
     return false;
   }
 
   struct sched_param param;
-  param.sched_priority = m_options.priority;
+  param.sched_priority = priority;
   ret = pthread_attr_setschedparam(&attrs, &param);
   if (ret) {
     OLA_WARN << "pthread_attr_setschedparam failed for " << Name()
              << ", priority " << param.sched_priority << ": "
-             << strerror(errno);
+             << strerror(ret);
     pthread_attr_destroy(&attrs);
     return false;
   }
@@ -131,7 +176,7 @@ bool Thread::FastStart() {
   ret = pthread_attr_setinheritsched(&attrs, PTHREAD_EXPLICIT_SCHED);
   if (ret) {
     OLA_WARN << "pthread_attr_setinheritsched to PTHREAD_EXPLICIT_SCHED "
-             << "failed for " << Name() << ": " << strerror(errno);
+             << "failed for " << Name() << ": " << strerror(ret);
     pthread_attr_destroy(&attrs);
     return false;
   }
@@ -192,12 +237,102 @@ void *Thread::_InternalRun() {
 
   OLA_INFO << "Thread " << Name() << ", policy " << PolicyToString(policy)
            << ", priority " << param.sched_priority;
+  ApplyRealTimeOptions();
+
+  {
+    MutexLocker locker(&running_threads_mutex);
+    running_threads.insert(this);
+  }
   {
     MutexLocker locker(&m_mutex);
     m_running = true;
   }
   m_condition.Signal();
-  return Run();
+  void *result = Run();
+
+  MutexLocker locker(&running_threads_mutex);
+  running_threads.erase(this);
+  return result;
+}
+
+void Thread::ExportSchedulingStats(ExportMap *export_map) {
+  UIntMap *wake_ups = export_map->GetUIntMapVar(K_THREAD_WAKE_UPS_VAR,
+                                                K_THREAD_VAR_LABEL);
+  UIntMap *max_latency = export_map->GetUIntMapVar(K_THREAD_MAX_LATENCY_VAR,
+                                                   K_THREAD_VAR_LABEL);
+  UIntMap *mean_latency = export_map->GetUIntMapVar(K_THREAD_MEAN_LATENCY_VAR,
+                                                    K_THREAD_VAR_LABEL);
+
+  MutexLocker locker(&running_threads_mutex);
+  std::set<string> exported;
+  std::set<Thread*>::const_iterator iter = running_threads.begin();
+  for (; iter != running_threads.end(); ++iter) {
+    const SchedulingStats &stats = (*iter)->SchedulingStatistics();
+    if (!stats.WakeUps()) {
+      continue;
+    }
+
+    // Thread names aren't unique, so add a suffix if required.
+    string key = (*iter)->Name();
+    for (unsigned int i = 2; exported.find(key) != exported.end(); i++) {
+      key = (*iter)->Name() + "-" + ola::strings::IntToString(i);
+    }
+    exported.insert(key);
+
+    wake_ups->Set(key, static_cast<unsigned int>(stats.WakeUps()));
+    max_latency->Set(key, static_cast<unsigned int>(
+        stats.MaxLatency().AsInt()));
+    mean_latency->Set(key, static_cast<unsigned int>(
+        stats.MeanLatency().AsInt()));
+  }
+
+  // Remove the threads that have exited.
+  std::set<string>::const_iterator key_iter = exported_threads.begin();
+  for (; key_iter != exported_threads.end(); ++key_iter) {
+    if (exported.find(*key_iter) == exported.end()) {
+      wake_ups->Remove(*key_iter);
+      max_latency->Remove(*key_iter);
+      mean_latency->Remove(*key_iter);
+    }
+  }
+  exported_threads.swap(exported);
+}
+
+/*
+ * Apply the CPU affinity and memory locking options. These are best effort,
+ * the thread continues to run if they fail.
+ */
+void Thread::ApplyRealTimeOptions() {
+  if (!m_options.cpu_affinity.empty()) {
+#ifdef HAVE_SCHED_SETAFFINITY
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    std::vector<unsigned int>::const_iterator iter =
+        m_options.cpu_affinity.begin();
+    for (; iter != m_options.cpu_affinity.end(); ++iter) {
+      if (*iter < CPU_SETSIZE) {
+        CPU_SET(*iter, &cpus);
+      }
+    }
+    if (sched_setaffinity(0, sizeof(cpus), &cpus)) {
+      OLA_WARN << "Failed to set the CPU affinity for " << Name() << ": "
+               << strerror(errno);
+    }
+#else
+    OLA_WARN << "CPU affinity isn't supported, ignoring for " << Name();
+#endif
+  }
+
+  if (m_options.lock_memory) {
+#ifdef HAVE_MLOCKALL
+    if (mlockall(MCL_CURRENT | MCL_FUTURE)) {
+      OLA_WARN << "mlockall() failed for " << Name() << ": "
+               << strerror(errno);
+    }
+#else
+    OLA_WARN << "Memory locking isn't supported, ignoring for " << Name();
+#endif
+  }
 }
 }  // namespace thread
 }  // namespace ola
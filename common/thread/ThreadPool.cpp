@@ -18,20 +18,84 @@
  * Copyright (C) 2011 Simon Newton
  */
 
+#include <pthread.h>
+#include <stdint.h>
+#include <deque>
+#include <vector>
+
 #include "ola/Logging.h"
+#include "ola/strings/Format.h"
 #include "ola/thread/Thread.h"
 #include "ola/thread/ThreadPool.h"
-#include "ola/thread/ConsumerThread.h"
 
 namespace ola {
 namespace thread {
 
+/**
+ * A thread in the pool. This runs actions from its own queue, stealing from
+ * the other queues when its own is empty.
+ */
+class ThreadPool::WorkerThread: public Thread {
+ public:
+  WorkerThread(ThreadPool *pool, unsigned int queue_index)
+      : Thread(Thread::Options(
+            "ola-pool-" + ola::strings::IntToString(queue_index))),
+        m_pool(pool),
+        m_queue_index(queue_index) {
+  }
+
+  void *Run() {
+    pthread_setspecific(
+        m_pool->m_queue_key,
+        reinterpret_cast<void*>(static_cast<uintptr_t>(m_queue_index + 1)));
+
+    while (true) {
+      Action action = m_pool->NextAction(m_queue_index);
+      if (action) {
+        action->Run();
+      } else if (!m_pool->WaitForWork()) {
+        break;
+      }
+    }
+    return NULL;
+  }
+
+ private:
+  ThreadPool *m_pool;
+  const unsigned int m_queue_index;
+
+  DISALLOW_COPY_AND_ASSIGN(WorkerThread);
+};
+
+
+ThreadPool::ThreadPool(unsigned int thread_count)
+    : m_thread_count(thread_count),
+      m_shutdown(false),
+      m_pending(0),
+      m_idle_threads(0),
+      m_next_queue(0) {
+  pthread_key_create(&m_queue_key, NULL);
+  for (unsigned int i = 0; i < m_thread_count; i++) {
+    m_queues.push_back(new WorkQueue());
+  }
+}
+
 
 /**
  * Clean up
  */
 ThreadPool::~ThreadPool() {
   JoinAllThreads();
+
+  std::vector<WorkQueue*>::iterator iter = m_queues.begin();
+  for (; iter != m_queues.end(); ++iter) {
+    if (!(*iter)->actions.empty()) {
+      OLA_WARN << "ThreadPool destroyed with " << (*iter)->actions.size()
+               << " actions pending, these will leak";
+    }
+    delete *iter;
+  }
+  pthread_key_delete(m_queue_key);
 }
 
 
@@ -44,15 +108,12 @@ bool ThreadPool::Init() {
     return false;
   }
 
-  for (unsigned int i = 1 ; i <= m_thread_count; i++) {
-    ConsumerThread *thread = new ConsumerThread(
-        &m_callback_queue,
-        &m_shutdown,
-        &m_mutex,
-        &m_condition_var);
+  for (unsigned int i = 0; i < m_thread_count; i++) {
+    WorkerThread *thread = new WorkerThread(this, i);
     if (!thread->Start()) {
-      OLA_WARN << "Failed to start thread " << i
+      OLA_WARN << "Failed to start thread " << i + 1
                << ", aborting ThreadPool::Init()";
+      delete thread;
       JoinAllThreads();
       return false;
     }
@@ -76,35 +137,127 @@ void ThreadPool::JoinAll() {
  * probably leak memory.
  */
 void ThreadPool::Execute(ola::BaseCallback0<void> *closure) {
-  MutexLocker locker(&m_mutex);
-  if (m_shutdown) {
-    OLA_WARN << "Adding actions to a ThreadPool while it's shutting down, "
-                "this will leak!";
+  if (m_queues.empty()) {
+    OLA_WARN << "Adding actions to a ThreadPool with no threads, this will "
+                "leak!";
+    return;
+  }
+
+  // Pool threads add to their own queue, everyone else round-robins.
+  uintptr_t queue_index = reinterpret_cast<uintptr_t>(
+      pthread_getspecific(m_queue_key));
+  if (queue_index) {
+    queue_index--;
+  } else {
+    if (m_shutdown) {
+      OLA_WARN << "Adding actions to a ThreadPool while it's shutting down, "
+                  "this will leak!";
+    }
+    queue_index = __sync_fetch_and_add(&m_next_queue, 1) % m_queues.size();
   }
-  m_callback_queue.push(closure);
-  m_condition_var.Signal();
+
+  WorkQueue *queue = m_queues[queue_index];
+  {
+    MutexLocker locker(&queue->mutex);
+    queue->actions.push_back(closure);
+  }
+
+  // The increment of m_pending must be ordered before the read of
+  // m_idle_threads; WaitForWork() does the opposite. The __sync builtins are
+  // full barriers so either we see the idle thread, or it sees the action.
+  __sync_fetch_and_add(&m_pending, 1);
+  if (__sync_fetch_and_add(&m_idle_threads, 0)) {
+    MutexLocker locker(&m_idle_mutex);
+    m_idle_condition.Signal();
+  }
+}
+
+
+Future<void> ThreadPool::Submit(BaseCallback0<void> *callback) {
+  Future<void> future;
+  Execute(NewSingleCallback(&ThreadPool::RunAndSetVoid, callback, future));
+  return future;
 }
 
 
 /**
- * Join all threads.
+ * Get the next action to run. We take the newest action from our own queue,
+ * since it's most likely to be warm in the cache, and the oldest action from
+ * any queue we steal from.
+ */
+ThreadPool::Action ThreadPool::NextAction(unsigned int queue_index) {
+  const unsigned int queue_count = m_queues.size();
+  for (unsigned int i = 0; i < queue_count; i++) {
+    WorkQueue *queue = m_queues[(queue_index + i) % queue_count];
+    Action action = NULL;
+    {
+      MutexLocker locker(&queue->mutex);
+      if (queue->actions.empty()) {
+        continue;
+      }
+      if (i == 0) {
+        action = queue->actions.back();
+        queue->actions.pop_back();
+      } else {
+        action = queue->actions.front();
+        queue->actions.pop_front();
+      }
+    }
+    __sync_fetch_and_sub(&m_pending, 1);
+    return action;
+  }
+  return NULL;
+}
+
+
+/**
+ * Block until there are actions to run.
+ * @returns false if the pool is shutting down and there is no more work.
+ */
+bool ThreadPool::WaitForWork() {
+  MutexLocker locker(&m_idle_mutex);
+  __sync_fetch_and_add(&m_idle_threads, 1);
+  bool has_work = true;
+  // m_pending may briefly go negative if an action is taken before Execute()
+  // increments the count.
+  while (__sync_fetch_and_add(&m_pending, 0) <= 0) {
+    if (m_shutdown) {
+      has_work = false;
+      break;
+    }
+    m_idle_condition.Wait(&m_idle_mutex);
+  }
+  __sync_fetch_and_sub(&m_idle_threads, 1);
+  return has_work;
+}
+
+
+/**
+ * Join all threads. Any actions still in the queues are run first.
  */
 void ThreadPool::JoinAllThreads() {
   if (m_threads.empty())
     return;
 
   {
-    MutexLocker locker(&m_mutex);
+    MutexLocker locker(&m_idle_mutex);
     m_shutdown = true;
-    m_condition_var.Broadcast();
+    m_idle_condition.Broadcast();
   }
 
   while (!m_threads.empty()) {
-    ConsumerThread *thread = m_threads.back();
+    WorkerThread *thread = m_threads.back();
     m_threads.pop_back();
     thread->Join();
     delete thread;
   }
 }
+
+
+void ThreadPool::RunAndSetVoid(BaseCallback0<void> *callback,
+                               Future<void> future) {
+  callback->Run();
+  future.Set();
+}
 }  // namespace thread
 }  // namespace ola
@@ -26,12 +26,14 @@
 
 #include "ola/Callback.h"
 #include "ola/Logging.h"
+#include "ola/thread/Future.h"
 #include "ola/thread/Thread.h"
 #include "ola/thread/ThreadPool.h"
 #include "ola/testing/TestUtils.h"
 
 
 
+using ola::thread::Future;
 using ola::thread::Mutex;
 using ola::thread::MutexLocker;
 using ola::thread::ThreadPool;
@@ -42,6 +44,8 @@ class ThreadPoolTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(test1By10);
   CPPUNIT_TEST(test2By10);
   CPPUNIT_TEST(test10By100);
+  CPPUNIT_TEST(testSubmit);
+  CPPUNIT_TEST(testNestedExecute);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -54,6 +58,8 @@ class ThreadPoolTest: public CppUnit::TestFixture {
     void test10By100() {
       RunThreads(10, 100);
     }
+    void testSubmit();
+    void testNestedExecute();
 
     void setUp() {
       m_counter = 0;
@@ -69,6 +75,22 @@ class ThreadPoolTest: public CppUnit::TestFixture {
     }
 
     void RunThreads(unsigned int threads, unsigned int actions);
+
+    unsigned int Square(unsigned int i) {
+      return i * i;
+    }
+
+    void Spawn(ThreadPool *pool, unsigned int depth) {
+      IncrementCounter();
+      if (depth) {
+        pool->Execute(
+            ola::NewSingleCallback(this, &ThreadPoolTest::Spawn, pool,
+                                   depth - 1));
+        pool->Execute(
+            ola::NewSingleCallback(this, &ThreadPoolTest::Spawn, pool,
+                                   depth - 1));
+      }
+    }
 };
 
 
@@ -89,3 +111,45 @@ void ThreadPoolTest::RunThreads(unsigned int threads, unsigned int actions) {
   pool.JoinAll();
   OLA_ASSERT_EQ(static_cast<unsigned int>(actions), m_counter);
 }
+
+
+/**
+ * Check that Submit() completes the futures.
+ */
+void ThreadPoolTest::testSubmit() {
+  ThreadPool pool(4);
+  OLA_ASSERT_TRUE(pool.Init());
+
+  std::vector<Future<unsigned int> > futures;
+  for (unsigned int i = 0; i < 100; i++) {
+    futures.push_back(pool.Submit(
+        ola::NewSingleCallback(this, &ThreadPoolTest::Square, i)));
+  }
+
+  Future<void> done = pool.Submit(
+      ola::NewSingleCallback(this, &ThreadPoolTest::IncrementCounter));
+
+  for (unsigned int i = 0; i < futures.size(); i++) {
+    OLA_ASSERT_EQ(i * i, futures[i].Get());
+  }
+  done.Get();
+  OLA_ASSERT_TRUE(done.IsComplete());
+  OLA_ASSERT_EQ(1u, m_counter);
+  pool.JoinAll();
+}
+
+
+/**
+ * Check that actions added from within the pool are run, including those
+ * added while the pool is shutting down.
+ */
+void ThreadPoolTest::testNestedExecute() {
+  ThreadPool pool(3);
+  OLA_ASSERT_TRUE(pool.Init());
+
+  // A depth of 9 is 2^10 - 1 actions.
+  pool.Execute(ola::NewSingleCallback(this, &ThreadPoolTest::Spawn, &pool,
+                                      9u));
+  pool.JoinAll();
+  OLA_ASSERT_EQ(1023u, m_counter);
+}
@@ -24,13 +24,18 @@
 
 #include <cppunit/extensions/HelperMacros.h>
 #include <errno.h>
+#include <sched.h>
 #include <string.h>
 #ifndef _WIN32
 #include <sys/resource.h>
 #endif
 #include <algorithm>
+#include <string>
 
+#include "ola/Clock.h"
+#include "ola/ExportMap.h"
 #include "ola/Logging.h"
+#include "ola/base/Flags.h"
 #include "ola/system/Limits.h"
 #include "ola/testing/TestUtils.h"
 #include "ola/thread/Thread.h"
@@ -41,6 +46,9 @@ using ola::thread::ConditionVariable;
 using ola::thread::Mutex;
 using ola::thread::MutexLocker;
 using ola::thread::Thread;
+using std::string;
+
+DECLARE_string(output_thread_policy);
 
 // A struct containing the scheduling parameters.
 struct SchedulingParams {
@@ -109,13 +117,19 @@ class ThreadTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(ThreadTest);
   CPPUNIT_TEST(testThread);
   CPPUNIT_TEST(testSchedulingOptions);
+  CPPUNIT_TEST(testSchedulingFallback);
   CPPUNIT_TEST(testConditionVariable);
+  CPPUNIT_TEST(testCPUAffinity);
+  CPPUNIT_TEST(testSchedulingStats);
   CPPUNIT_TEST_SUITE_END();
 
  public:
   void testThread();
   void testConditionVariable();
   void testSchedulingOptions();
+  void testSchedulingFallback();
+  void testCPUAffinity();
+  void testSchedulingStats();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(ThreadTest);
@@ -226,6 +240,47 @@ void ThreadTest::testSchedulingOptions() {
 #endif  // #ifndef _WIN32
 }
 
+/*
+ * Check that output threads start with the default policy if the real time
+ * one can't be used.
+ */
+void ThreadTest::testSchedulingFallback() {
+#ifndef _WIN32
+  SchedulingParams default_params = GetCurrentParams();
+
+  {
+    // 0 isn't a valid SCHED_FIFO priority, so this fails.
+    Thread::Options options("InvalidPriority");
+    options.policy = SCHED_FIFO;
+    options.priority = 0;
+    MockThread thread(options);
+    OLA_ASSERT_FALSE(thread.Start());
+  }
+
+  {
+    Thread::Options options("InvalidPriorityWithFallback");
+    options.policy = SCHED_FIFO;
+    options.priority = 0;
+    options.fallback_to_default_scheduling = true;
+    MockThread thread(options);
+    OLA_ASSERT_TRUE(RunThread(&thread));
+    OLA_ASSERT_EQ(default_params.policy, thread.GetSchedulingParams().policy);
+  }
+
+  // The default output thread priority is clamped to the range of the policy.
+  FLAGS_output_thread_policy = "fifo";
+  Thread::Options options = ola::thread::OutputThreadOptions("Output");
+  FLAGS_output_thread_policy = "";
+  OLA_ASSERT_EQ(static_cast<int>(SCHED_FIFO), options.policy);
+  OLA_ASSERT_EQ(sched_get_priority_min(SCHED_FIFO), options.priority);
+  OLA_ASSERT_TRUE(options.fallback_to_default_scheduling);
+  {
+    MockThread thread(options);
+    OLA_ASSERT_TRUE(RunThread(&thread));
+  }
+#endif  // #ifndef _WIN32
+}
+
 class MockConditionThread: public Thread {
  public:
     MockConditionThread(
@@ -269,3 +324,130 @@ void ThreadTest::testConditionVariable() {
 
   thread.Join();
 }
+
+
+#ifdef HAVE_SCHED_SETAFFINITY
+// A thread that captures the CPUs it's allowed to run on.
+class AffinityThread: public Thread {
+ public:
+  explicit AffinityThread(const Options &options)
+      : Thread(options) {
+    CPU_ZERO(&m_cpus);
+  }
+
+  void *Run() {
+    sched_getaffinity(0, sizeof(m_cpus), &m_cpus);
+    return NULL;
+  }
+
+  cpu_set_t m_cpus;
+};
+#endif
+
+/*
+ * Check the CPU affinity option.
+ */
+void ThreadTest::testCPUAffinity() {
+#ifdef HAVE_SCHED_SETAFFINITY
+  cpu_set_t our_cpus;
+  OLA_ASSERT_EQ(0, sched_getaffinity(0, sizeof(our_cpus), &our_cpus));
+
+  // Pick the last CPU we're allowed to run on.
+  int cpu = -1;
+  for (int i = 0; i < CPU_SETSIZE; i++) {
+    if (CPU_ISSET(i, &our_cpus)) {
+      cpu = i;
+    }
+  }
+  OLA_ASSERT_NE(-1, cpu);
+
+  Thread::Options options("AffinityThread");
+  options.cpu_affinity.push_back(cpu);
+  AffinityThread thread(options);
+  OLA_ASSERT_TRUE(thread.Start());
+  OLA_ASSERT_TRUE(thread.Join());
+  OLA_ASSERT_EQ(1, CPU_COUNT(&thread.m_cpus));
+  OLA_ASSERT_TRUE(CPU_ISSET(cpu, &thread.m_cpus));
+#else
+  OLA_INFO << "Skipping testCPUAffinity since sched_setaffinity is missing";
+#endif
+}
+
+// A thread that records a wake up, then waits until it's told to exit.
+class RecordingThread: public Thread {
+ public:
+  RecordingThread()
+      : Thread(Options("RecordingThread")),
+        m_recorded(false),
+        m_exit(false) {
+  }
+
+  void *Run() {
+    ola::TimeStamp expected, actual;
+    ola::Clock clock;
+    clock.CurrentTime(&actual);
+    expected = actual - ola::TimeInterval(0, 500);
+    RecordWakeUp(expected, actual);
+
+    MutexLocker locker(&m_mutex);
+    m_recorded = true;
+    m_condition.Signal();
+    while (!m_exit) {
+      m_condition.Wait(&m_mutex);
+    }
+    return NULL;
+  }
+
+  void WaitForRecord() {
+    MutexLocker locker(&m_mutex);
+    while (!m_recorded) {
+      m_condition.Wait(&m_mutex);
+    }
+  }
+
+  void Stop() {
+    {
+      MutexLocker locker(&m_mutex);
+      m_exit = true;
+    }
+    m_condition.Signal();
+    Join();
+  }
+
+ private:
+  Mutex m_mutex;
+  ConditionVariable m_condition;
+  bool m_recorded;
+  bool m_exit;
+};
+
+/*
+ * Check that the scheduling stats are exported.
+ */
+void ThreadTest::testSchedulingStats() {
+  ola::ExportMap export_map;
+  RecordingThread thread1, thread2;
+  OLA_ASSERT_TRUE(thread1.Start());
+  OLA_ASSERT_TRUE(thread2.Start());
+  thread1.WaitForRecord();
+  thread2.WaitForRecord();
+
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1),
+                thread1.SchedulingStatistics().WakeUps());
+  OLA_ASSERT_EQ(static_cast<int64_t>(500),
+                thread1.SchedulingStatistics().MaxLatency().AsInt());
+
+  Thread::ExportSchedulingStats(&export_map);
+  ola::UIntMap *wake_ups = export_map.GetUIntMapVar("thread-wake-ups");
+  ola::UIntMap *max_latency = export_map.GetUIntMapVar(
+      "thread-max-latency-us");
+  OLA_ASSERT_EQ(1u, (*wake_ups)["RecordingThread"]);
+  OLA_ASSERT_EQ(1u, (*wake_ups)["RecordingThread-2"]);
+  OLA_ASSERT_EQ(500u, (*max_latency)["RecordingThread"]);
+
+  // Once the threads exit, they're removed.
+  thread1.Stop();
+  thread2.Stop();
+  Thread::ExportSchedulingStats(&export_map);
+  OLA_ASSERT_EQ(string("map:thread"), wake_ups->Value());
+}
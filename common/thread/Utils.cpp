@@ -21,14 +21,33 @@
 #include "ola/thread/Utils.h"
 
 #include <pthread.h>
+#include <sched.h>
 #include <string.h>
+#include <algorithm>
 #include <string>
+#include <vector>
 #include "ola/Logging.h"
+#include "ola/StringUtils.h"
+#include "ola/base/Flags.h"
 #include "ola/thread/Thread.h"
 
+DEFINE_string(output_thread_policy, "",
+              "The scheduling policy for output threads, one of {fifo, rr}.");
+DEFINE_uint16(output_thread_priority, 0,
+              "The priority of output threads, only used if "
+              "--output-thread-policy is set. Values outside the range of "
+              "the policy are clamped, so 0 means the lowest priority.");
+DEFINE_string(output_thread_cpus, "",
+              "A comma separated list of CPUs to run output threads on.");
+DEFINE_default_bool(output_thread_lock_memory, false,
+                    "Lock all memory in RAM when output threads start.");
+
 namespace ola {
 namespace thread {
 
+using std::string;
+using std::vector;
+
 std::string PolicyToString(int policy) {
   switch (policy) {
     case SCHED_FIFO:
@@ -56,5 +75,47 @@ bool SetSchedParam(pthread_t thread, int policy,
   }
   return true;
 }
+
+Thread::Options OutputThreadOptions(const string &name) {
+  Thread::Options options(name);
+
+  string policy = FLAGS_output_thread_policy.str();
+  ToLower(&policy);
+  if (policy == "fifo" || policy == "rr") {
+    options.policy = (policy == "fifo") ? SCHED_FIFO : SCHED_RR;
+    const int min_priority = sched_get_priority_min(options.policy);
+    const int max_priority = sched_get_priority_max(options.policy);
+    options.priority = FLAGS_output_thread_priority;
+    if (options.priority < min_priority || options.priority > max_priority) {
+      options.priority = std::min(std::max(options.priority, min_priority),
+                                  max_priority);
+      OLA_WARN << "Output thread priority " << FLAGS_output_thread_priority
+               << " is out of range for " << PolicyToString(options.policy)
+               << ", using " << options.priority << " for " << name;
+    }
+    // Without the privileges for a real time policy, output at the normal
+    // priority rather than not at all.
+    options.fallback_to_default_scheduling = true;
+  } else if (!policy.empty()) {
+    OLA_WARN << "Unknown scheduling policy " << policy << " for " << name;
+  }
+
+  vector<string> cpus;
+  StringSplit(FLAGS_output_thread_cpus.str(), &cpus, ",");
+  vector<string>::const_iterator iter = cpus.begin();
+  for (; iter != cpus.end(); ++iter) {
+    unsigned int cpu;
+    if (iter->empty()) {
+      continue;
+    } else if (StringToInt(*iter, &cpu)) {
+      options.cpu_affinity.push_back(cpu);
+    } else {
+      OLA_WARN << "Invalid CPU " << *iter << " for " << name;
+    }
+  }
+
+  options.lock_memory = FLAGS_output_thread_lock_memory;
+  return options;
+}
 }  // namespace thread
 }  // namespace ola
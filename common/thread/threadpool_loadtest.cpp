@@ -0,0 +1,127 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * threadpool_loadtest.cpp
+ * Measure how the ThreadPool scales from 1 to N threads.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#include <stdint.h>
+#include <unistd.h>
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/Logging.h"
+#include "ola/base/Flags.h"
+#include "ola/base/Init.h"
+#include "ola/thread/Future.h"
+#include "ola/thread/ThreadPool.h"
+
+using ola::Clock;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::thread::Future;
+using ola::thread::ThreadPool;
+using std::cout;
+using std::endl;
+using std::vector;
+
+DEFINE_s_uint32(threads, t, 0,
+                "The maximum number of threads, 0 uses the number of CPUs");
+DEFINE_s_uint32(tasks, n, 10000, "The number of tasks to run");
+DEFINE_s_uint32(work, w, 10000, "The number of iterations per task");
+
+/**
+ * A CPU bound task.
+ */
+uint32_t Work(uint32_t seed, uint32_t iterations) {
+  uint32_t value = seed;
+  for (uint32_t i = 0; i < iterations; i++) {
+    // xorshift32
+    value ^= value << 13;
+    value ^= value >> 17;
+    value ^= value << 5;
+  }
+  return value;
+}
+
+/**
+ * Run all the tasks on a pool with the given number of threads.
+ * @returns the time taken.
+ */
+TimeInterval RunTasks(unsigned int thread_count) {
+  ThreadPool pool(thread_count);
+  if (!pool.Init()) {
+    OLA_FATAL << "Failed to start the ThreadPool";
+    return TimeInterval();
+  }
+
+  vector<Future<uint32_t> > results;
+  results.reserve(FLAGS_tasks);
+
+  Clock clock;
+  TimeStamp start, end;
+  clock.CurrentTime(&start);
+  for (uint32_t i = 0; i < FLAGS_tasks; i++) {
+    results.push_back(pool.Submit(
+        ola::NewSingleCallback(&Work, i + 1,
+                               static_cast<uint32_t>(FLAGS_work))));
+  }
+
+  uint32_t checksum = 0;
+  for (unsigned int i = 0; i < results.size(); i++) {
+    checksum ^= results[i].Get();
+  }
+  clock.CurrentTime(&end);
+  pool.JoinAll();
+
+  OLA_DEBUG << "Checksum " << checksum;
+  return end - start;
+}
+
+int main(int argc, char* argv[]) {
+  ola::AppInit(&argc, argv, "[options]",
+               "Measure the scalability of the ThreadPool.");
+
+  unsigned int max_threads = FLAGS_threads;
+  if (max_threads == 0) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);  // NOLINT(runtime/int)
+    max_threads = cpus > 0 ? static_cast<unsigned int>(cpus) : 1;
+  }
+
+  cout << "Running " << FLAGS_tasks << " tasks of " << FLAGS_work
+       << " iterations" << endl;
+
+  int64_t baseline = 0;
+  for (unsigned int threads = 1; threads <= max_threads; threads++) {
+    TimeInterval duration = RunTasks(threads);
+    if (threads == 1) {
+      baseline = duration.AsInt();
+    }
+    cout << std::setw(3) << threads << " thread(s): " << duration;
+    if (duration.AsInt()) {
+      int64_t rate = static_cast<int64_t>(FLAGS_tasks) * 1000000 /
+                     duration.AsInt();
+      cout << ", " << rate << " tasks/s, speedup " << std::fixed << std::setprecision(2)
+           << (static_cast<double>(baseline) / duration.AsInt());
+    }
+    cout << endl;
+  }
+  return 0;
+}
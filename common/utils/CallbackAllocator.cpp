@@ -0,0 +1,126 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * CallbackAllocator.cpp
+ * Pooled memory allocation for SingleUseCallbacks.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#include <pthread.h>
+#include <string.h>
+#include <new>
+
+#include "ola/CallbackAllocator.h"
+
+namespace ola {
+
+namespace {
+
+// Blocks are allocated in multiples of BLOCK_ALIGNMENT bytes, which covers
+// all the callbacks in Callback.h on a 64 bit system. Anything larger goes
+// straight to the heap.
+const size_t BLOCK_ALIGNMENT = 16;
+const unsigned int SIZE_CLASSES = 8;
+
+// The maximum number of free blocks a thread keeps for each size class.
+const unsigned int MAX_FREE_BLOCKS = 64;
+
+struct FreeBlock {
+  FreeBlock *next;
+};
+
+struct ThreadCache {
+  FreeBlock *free_blocks[SIZE_CLASSES];
+  unsigned int free_count[SIZE_CLASSES];
+};
+
+pthread_once_t cache_key_once = PTHREAD_ONCE_INIT;
+pthread_key_t cache_key;
+
+/*
+ * Called when a thread exits, returns the cached blocks to the heap.
+ */
+void DeleteThreadCache(void *data) {
+  ThreadCache *cache = static_cast<ThreadCache*>(data);
+  for (unsigned int i = 0; i < SIZE_CLASSES; i++) {
+    FreeBlock *block = cache->free_blocks[i];
+    while (block) {
+      FreeBlock *next = block->next;
+      ::operator delete(block);
+      block = next;
+    }
+  }
+  delete cache;
+}
+
+void CreateCacheKey() {
+  pthread_key_create(&cache_key, DeleteThreadCache);
+}
+
+ThreadCache *GetThreadCache() {
+  pthread_once(&cache_key_once, CreateCacheKey);
+  ThreadCache *cache = static_cast<ThreadCache*>(
+      pthread_getspecific(cache_key));
+  if (!cache) {
+    cache = new ThreadCache;
+    memset(cache, 0, sizeof(*cache));
+    pthread_setspecific(cache_key, cache);
+  }
+  return cache;
+}
+
+inline unsigned int SizeClass(size_t size) {
+  return size ? (size - 1) / BLOCK_ALIGNMENT : 0;
+}
+}  // namespace
+
+void *AllocateCallback(size_t size) {
+  unsigned int size_class = SizeClass(size);
+  if (size_class >= SIZE_CLASSES) {
+    return ::operator new(size);
+  }
+
+  ThreadCache *cache = GetThreadCache();
+  FreeBlock *block = cache->free_blocks[size_class];
+  if (block) {
+    cache->free_blocks[size_class] = block->next;
+    cache->free_count[size_class]--;
+    return block;
+  }
+  return ::operator new((size_class + 1) * BLOCK_ALIGNMENT);
+}
+
+void FreeCallback(void *ptr, size_t size) {
+  if (!ptr) {
+    return;
+  }
+
+  unsigned int size_class = SizeClass(size);
+  if (size_class >= SIZE_CLASSES) {
+    ::operator delete(ptr);
+    return;
+  }
+
+  ThreadCache *cache = GetThreadCache();
+  if (cache->free_count[size_class] >= MAX_FREE_BLOCKS) {
+    ::operator delete(ptr);
+    return;
+  }
+  FreeBlock *block = static_cast<FreeBlock*>(ptr);
+  block->next = cache->free_blocks[size_class];
+  cache->free_blocks[size_class] = block;
+  cache->free_count[size_class]++;
+}
+}  // namespace ola
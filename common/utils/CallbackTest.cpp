@@ -19,6 +19,7 @@
  */
 
 #include <cppunit/extensions/HelperMacros.h>
+#include <string.h>
 #include <string>
 
 #include "ola/Callback.h"
@@ -34,6 +35,7 @@ class CallbackTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testFunctionCallbacks1);
   CPPUNIT_TEST(testMethodCallbacks1);
   CPPUNIT_TEST(testMethodCallbacks2);
+  CPPUNIT_TEST(testSingleUseAllocation);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -43,6 +45,7 @@ class CallbackTest: public CppUnit::TestFixture {
     void testMethodCallbacks1();
     void testMethodCallbacks2();
     void testMethodCallbacks4();
+    void testSingleUseAllocation();
 
     void Method0() {}
     bool BoolMethod0() { return true; }
@@ -121,6 +124,15 @@ using ola::SingleUseCallback0;
 
 // Functions used for testing
 void Function0() {}
+
+// Too large for the callback pool
+struct LargeArg {
+  char data[512];
+};
+
+unsigned int LargeFunction(LargeArg arg) {
+  return arg.data[sizeof(arg.data) - 1];
+}
 bool BoolFunction0() { return true; }
 
 void Function1(unsigned int i) {
@@ -551,3 +563,33 @@ void CallbackTest::testMethodCallbacks4() {
                          TEST_STRING_VALUE));
   delete c4;
 }
+
+
+/*
+ * Check that SingleUse callbacks re-use memory once they've run.
+ */
+void CallbackTest::testSingleUseAllocation() {
+  SingleUseCallback0<void> *c1 = NewSingleCallback(
+      this, &CallbackTest::Method1, TEST_INT_VALUE);
+  const void *first_address = c1;
+  c1->Run();
+
+  SingleUseCallback0<void> *c2 = NewSingleCallback(
+      this, &CallbackTest::Method1, TEST_INT_VALUE);
+  OLA_ASSERT_EQ(first_address, static_cast<const void*>(c2));
+
+  // Deleting a callback without running it also returns it to the pool.
+  delete c2;
+  SingleUseCallback0<bool> *c3 = NewSingleCallback(
+      this, &CallbackTest::BoolMethod1, TEST_INT_VALUE);
+  OLA_ASSERT_EQ(first_address, static_cast<const void*>(c3));
+  OLA_ASSERT_TRUE(c3->Run());
+
+  // Large callbacks are allocated from the heap.
+  LargeArg arg;
+  memset(arg.data, 0, sizeof(arg.data));
+  arg.data[sizeof(arg.data) - 1] = TEST_INT_VALUE;
+  SingleUseCallback0<unsigned int> *c4 = NewSingleCallback(&LargeFunction,
+                                                           arg);
+  OLA_ASSERT_EQ(TEST_INT_VALUE, c4->Run());
+}
@@ -2,6 +2,7 @@
 ################################################
 common_libolacommon_la_SOURCES += \
     common/utils/ActionQueue.cpp \
+    common/utils/CallbackAllocator.cpp \
     common/utils/Clock.cpp \
     common/utils/DmxBuffer.cpp \
     common/utils/StringUtils.cpp \
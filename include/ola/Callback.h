@@ -31,7 +31,9 @@
  * time.
  *
  * The SingleUse varient of a Callback automatically delete itself after it
- * has been executed.
+ * has been executed. Since they are created and destroyed at a high rate,
+ * SingleUse callbacks are allocated from a per-thread pool rather than the
+ * heap, see CallbackAllocator.h.
  *
  * Callbacks are used throughout OLA to reduce the coupling between classes
  * and make for more modular code.
@@ -105,6 +107,9 @@
 #ifndef INCLUDE_OLA_CALLBACK_H_
 #define INCLUDE_OLA_CALLBACK_H_
 
+#include <ola/CallbackAllocator.h>
+#include <stddef.h>
+
 namespace ola {
 
 /**
@@ -141,6 +146,12 @@ template <typename ReturnType>
 class SingleUseCallback0: public BaseCallback0<ReturnType> {
  public:
   virtual ~SingleUseCallback0() {}
+  static void *operator new(size_t size) {
+    return AllocateCallback(size);
+  }
+  static void operator delete(void *ptr, size_t size) {
+    FreeCallback(ptr, size);
+  }
   ReturnType Run() {
     ReturnType ret = this->DoRun();
     delete this;
@@ -157,6 +168,12 @@ template <>
 class SingleUseCallback0<void>: public BaseCallback0<void> {
  public:
   virtual ~SingleUseCallback0() {}
+  static void *operator new(size_t size) {
+    return AllocateCallback(size);
+  }
+  static void operator delete(void *ptr, size_t size) {
+    FreeCallback(ptr, size);
+  }
   void Run() {
     this->DoRun();
     delete this;
@@ -1004,6 +1021,12 @@ template <typename ReturnType, typename Arg0>
 class SingleUseCallback1: public BaseCallback1<ReturnType, Arg0> {
  public:
   virtual ~SingleUseCallback1() {}
+  static void *operator new(size_t size) {
+    return AllocateCallback(size);
+  }
+  static void operator delete(void *ptr, size_t size) {
+    FreeCallback(ptr, size);
+  }
   ReturnType Run(Arg0 arg0) {
     ReturnType ret = this->DoRun(arg0);
     delete this;
@@ -1020,6 +1043,12 @@ template <typename Arg0>
 class SingleUseCallback1<void, Arg0>: public BaseCallback1<void, Arg0> {
  public:
   virtual ~SingleUseCallback1() {}
+  static void *operator new(size_t size) {
+    return AllocateCallback(size);
+  }
+  static void operator delete(void *ptr, size_t size) {
+    FreeCallback(ptr, size);
+  }
   void Run(Arg0 arg0) {
     this->DoRun(arg0);
     delete this;
@@ -1907,6 +1936,12 @@ template <typename ReturnType, typename Arg0, typename Arg1>
 class SingleUseCallback2: public BaseCallback2<ReturnType, Arg0, Arg1> {
  public:
   virtual ~SingleUseCallback2() {}
+  static void *operator new(size_t size) {
+    return AllocateCallback(size);
+  }
+  static void operator delete(void *ptr, size_t size) {
+    FreeCallback(ptr, size);
+  }
   ReturnType Run(Arg0 arg0, Arg1 arg1) {
     ReturnType ret = this->DoRun(arg0, arg1);
     delete this;
@@ -1923,6 +1958,12 @@ template <typename Arg0, typename Arg1>
 class SingleUseCallback2<void, Arg0, Arg1>: public BaseCallback2<void, Arg0, Arg1> {  // NOLINT(whitespace/line_length)
  public:
   virtual ~SingleUseCallback2() {}
+  static void *operator new(size_t size) {
+    return AllocateCallback(size);
+  }
+  static void operator delete(void *ptr, size_t size) {
+    FreeCallback(ptr, size);
+  }
   void Run(Arg0 arg0, Arg1 arg1) {
     this->DoRun(arg0, arg1);
     delete this;
@@ -2850,6 +2891,12 @@ template <typename ReturnType, typename Arg0, typename Arg1, typename Arg2>
 class SingleUseCallback3: public BaseCallback3<ReturnType, Arg0, Arg1, Arg2> {
  public:
   virtual ~SingleUseCallback3() {}
+  static void *operator new(size_t size) {
+    return AllocateCallback(size);
+  }
+  static void operator delete(void *ptr, size_t size) {
+    FreeCallback(ptr, size);
+  }
   ReturnType Run(Arg0 arg0, Arg1 arg1, Arg2 arg2) {
     ReturnType ret = this->DoRun(arg0, arg1, arg2);
     delete this;
@@ -2866,6 +2913,12 @@ template <typename Arg0, typename Arg1, typename Arg2>
 class SingleUseCallback3<void, Arg0, Arg1, Arg2>: public BaseCallback3<void, Arg0, Arg1, Arg2> {  // NOLINT(whitespace/line_length)
  public:
   virtual ~SingleUseCallback3() {}
+  static void *operator new(size_t size) {
+    return AllocateCallback(size);
+  }
+  static void operator delete(void *ptr, size_t size) {
+    FreeCallback(ptr, size);
+  }
   void Run(Arg0 arg0, Arg1 arg1, Arg2 arg2) {
     this->DoRun(arg0, arg1, arg2);
     delete this;
@@ -3833,6 +3886,12 @@ template <typename ReturnType, typename Arg0, typename Arg1, typename Arg2, type
 class SingleUseCallback4: public BaseCallback4<ReturnType, Arg0, Arg1, Arg2, Arg3> {  // NOLINT(whitespace/line_length)
  public:
   virtual ~SingleUseCallback4() {}
+  static void *operator new(size_t size) {
+    return AllocateCallback(size);
+  }
+  static void operator delete(void *ptr, size_t size) {
+    FreeCallback(ptr, size);
+  }
   ReturnType Run(Arg0 arg0, Arg1 arg1, Arg2 arg2, Arg3 arg3) {
     ReturnType ret = this->DoRun(arg0, arg1, arg2, arg3);
     delete this;
@@ -3849,6 +3908,12 @@ template <typename Arg0, typename Arg1, typename Arg2, typename Arg3>
 class SingleUseCallback4<void, Arg0, Arg1, Arg2, Arg3>: public BaseCallback4<void, Arg0, Arg1, Arg2, Arg3> {  // NOLINT(whitespace/line_length)
  public:
   virtual ~SingleUseCallback4() {}
+  static void *operator new(size_t size) {
+    return AllocateCallback(size);
+  }
+  static void operator delete(void *ptr, size_t size) {
+    FreeCallback(ptr, size);
+  }
   void Run(Arg0 arg0, Arg1 arg1, Arg2 arg2, Arg3 arg3) {
     this->DoRun(arg0, arg1, arg2, arg3);
     delete this;
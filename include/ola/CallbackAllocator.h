@@ -0,0 +1,74 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * CallbackAllocator.h
+ * Pooled memory allocation for SingleUseCallbacks.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+/**
+ * @addtogroup callbacks
+ * @{
+ * @file CallbackAllocator.h
+ * @brief Pooled memory allocation for SingleUseCallbacks.
+ *
+ * SingleUseCallbacks are created on the hot paths, for example once per
+ * frame for each client that receives DMX data, and are deleted as soon as
+ * they run. Rather than going to the heap each time, freed callbacks are kept
+ * on a small per-thread free list, bucketed by size, and re-used by the next
+ * allocation of a similar size. Callbacks may be freed on a different thread
+ * to the one that allocated them.
+ *
+ * This is used instead of small buffer (inline) storage. Callbacks are passed
+ * around as pointers, and ownership moves to the code that runs them, so
+ * there's no enclosing object for the storage to live in. Pooling avoids the
+ * heap without changing any of the APIs that take a callback.
+ *
+ * You shouldn't need to call these functions directly, the operator new and
+ * operator delete of the SingleUseCallback classes do this.
+ * @}
+ */
+
+#ifndef INCLUDE_OLA_CALLBACKALLOCATOR_H_
+#define INCLUDE_OLA_CALLBACKALLOCATOR_H_
+
+#include <stddef.h>
+
+namespace ola {
+
+/**
+ * @addtogroup callbacks
+ * @{
+ */
+
+/**
+ * @brief Allocate memory for a callback.
+ * @param size the size of the callback object.
+ * @returns a pointer to at least size bytes of memory.
+ */
+void *AllocateCallback(size_t size);
+
+/**
+ * @brief Free memory allocated with AllocateCallback().
+ * @param ptr the memory to free.
+ * @param size the size that was passed to AllocateCallback().
+ */
+void FreeCallback(void *ptr, size_t size);
+
+/**
+ * @}
+ */
+}  // namespace ola
+#endif  // INCLUDE_OLA_CALLBACKALLOCATOR_H_
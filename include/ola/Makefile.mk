@@ -29,6 +29,7 @@ pkginclude_HEADERS += \
     include/ola/ActionQueue.h \
     include/ola/BaseTypes.h \
     include/ola/Callback.h \
+    include/ola/CallbackAllocator.h \
     include/ola/CallbackRunner.h \
     include/ola/Clock.h \
     include/ola/Constants.h \
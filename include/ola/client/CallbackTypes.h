@@ -153,6 +153,34 @@ typedef SingleUseCallback3<void, const Result&,
                            const RDMMetadata&,
                            const ola::rdm::RDMResponse*> RDMCallback;
 
+/**
+ * @brief Called when a OlaClient::RDMBulkGet() request completes.
+ * @param result the Result of the API call.
+ * @param results a RDMBulkGetResult for each UID and PID that was requested.
+ */
+typedef SingleUseCallback2<void, const Result&,
+                           const std::vector<RDMBulkGetResult>&>
+    RDMBulkGetCallback;
+
+/**
+ * @brief Called when a OlaClient::RDMBroadcast() request completes.
+ * @param result the Result of the API call.
+ * @param results a RDMBroadcastResult for each universe and command.
+ * @param duration the time taken for all the commands to complete.
+ */
+typedef SingleUseCallback3<void, const Result&,
+                           const std::vector<RDMBroadcastResult>&,
+                           const TimeInterval&>
+    RDMBroadcastCallback;
+
+/**
+ * @brief Called when a polled RDM parameter changes.
+ * @param update the RDMParameterUpdate.
+ * @sa OlaClient::RegisterForRDMUpdates()
+ */
+typedef Callback1<void, const RDMParameterUpdate&>
+    RepeatableRDMUpdateCallback;
+
 
 }  // namespace client
 }  // namespace ola
@@ -21,9 +21,12 @@
 #ifndef INCLUDE_OLA_CLIENT_CLIENTTYPES_H_
 #define INCLUDE_OLA_CLIENT_CLIENTTYPES_H_
 
+#include <ola/Clock.h>
 #include <ola/dmx/SourcePriorities.h>
+#include <ola/rdm/RDMCommand.h>
 #include <ola/rdm/RDMFrame.h>
 #include <ola/rdm/RDMResponseCodes.h>
+#include <ola/rdm/UID.h>
 
 #include <olad/PortConstants.h>
 
@@ -350,6 +353,140 @@ struct RDMMetadata {
       : response_code(_response_code) {
   }
 };
+
+/**
+ * @brief The result of one of the requests made by OlaClient::RDMBulkGet().
+ */
+struct RDMBulkGetResult {
+  /**
+   * @brief The UID the request was sent to.
+   */
+  ola::rdm::UID uid;
+
+  /**
+   * @brief The PID that was requested.
+   */
+  uint16_t pid;
+
+  /**
+   * @brief The metadata for the response.
+   */
+  RDMMetadata metadata;
+
+  /**
+   * @brief The RDM Response, or NULL if no response was received.
+   *
+   * This is only valid for the duration of the callback.
+   */
+  const ola::rdm::RDMResponse *response;
+
+  RDMBulkGetResult(const ola::rdm::UID &_uid, uint16_t _pid)
+      : uid(_uid),
+        pid(_pid),
+        response(NULL) {
+  }
+};
+
+/**
+ * @brief A command to send with OlaClient::RDMBroadcast().
+ *
+ * Responders don't reply to broadcasts, so the command is always sent as a
+ * SET.
+ */
+struct RDMBroadcastCommand {
+  /**
+   * @brief The sub device.
+   */
+  uint16_t sub_device;
+
+  /**
+   * @brief The PID, e.g. DMX_START_ADDRESS.
+   */
+  uint16_t pid;
+
+  /**
+   * @brief The param data.
+   */
+  std::string data;
+
+  RDMBroadcastCommand(uint16_t _sub_device, uint16_t _pid,
+                      const std::string &_data)
+      : sub_device(_sub_device),
+        pid(_pid),
+        data(_data) {
+  }
+};
+
+/**
+ * @brief The result of sending one of the commands from
+ * OlaClient::RDMBroadcast() to a universe.
+ */
+struct RDMBroadcastResult {
+  /**
+   * @brief The universe the command was sent to.
+   */
+  unsigned int universe;
+
+  /**
+   * @brief The index of the command.
+   */
+  unsigned int command;
+
+  /**
+   * @brief The response code, RDM_WAS_BROADCAST if the command was sent
+   * to every port in the universe.
+   */
+  ola::rdm::RDMStatusCode response_code;
+
+  /**
+   * @brief The time the command took to complete.
+   */
+  TimeInterval duration;
+
+  RDMBroadcastResult(unsigned int _universe, unsigned int _command)
+      : universe(_universe),
+        command(_command),
+        response_code(ola::rdm::RDM_WAS_BROADCAST) {
+  }
+};
+
+/**
+ * @brief A change to a RDM parameter that the server polls.
+ * @sa OlaClient::RegisterForRDMUpdates()
+ */
+struct RDMParameterUpdate {
+  /**
+   * @brief The universe the responder is on.
+   */
+  unsigned int universe;
+
+  /**
+   * @brief The UID of the responder.
+   */
+  ola::rdm::UID uid;
+
+  /**
+   * @brief The sub device.
+   */
+  uint16_t sub_device;
+
+  /**
+   * @brief The PID of the parameter, e.g. SENSOR_VALUE.
+   */
+  uint16_t pid;
+
+  /**
+   * @brief The new param data.
+   */
+  std::string data;
+
+  RDMParameterUpdate(unsigned int _universe, const ola::rdm::UID &_uid)
+      : universe(_universe),
+        uid(_uid),
+        sub_device(0),
+        pid(0) {
+  }
+};
 }  // namespace client
 }  // namespace ola
 #endif  // INCLUDE_OLA_CLIENT_CLIENTTYPES_H_
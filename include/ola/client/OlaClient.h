@@ -34,8 +34,12 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace ola {
+
+namespace rpc { class RpcChannel; }
+
 namespace client {
 
 /**
@@ -45,6 +49,16 @@ namespace client {
 class OlaClient {
  public:
   explicit OlaClient(ola::io::ConnectedDescriptor *descriptor);
+
+  /**
+   * @brief Create a client that uses an existing RPC channel.
+   * @param channel the channel to olad. Ownership is not transferred.
+   *
+   * This is used by clients running inside olad, with an
+   * ola::rpc::InProcessRpcChannel connected to the RPC server.
+   */
+  explicit OlaClient(ola::rpc::RpcChannel *channel);
+
   ~OlaClient();
 
   /*
@@ -73,6 +87,15 @@ class OlaClient {
    */
   void SetDMXCallback(RepeatableDMXCallback *callback);
 
+  /**
+   * @brief Set the callback to be run when a polled RDM parameter changes.
+   *
+   * The callback will be run for universes that have been registered with
+   * RegisterForRDMUpdates().
+   * @param callback the callback to run, ownership is transferred.
+   */
+  void SetRDMUpdateCallback(RepeatableRDMUpdateCallback *callback);
+
   /**
    * @brief Trigger a plugin reload.
    * @param callback the SetCallback to invoke upon completion.
@@ -308,6 +331,56 @@ class OlaClient {
               unsigned int data_length,
               const SendRDMArgs& args);
 
+  /**
+   * @brief Fetch a set of PIDs from a set of UIDs.
+   *
+   * A GET request is sent to every UID for each PID. The requests are sent
+   * with a lower priority than RDMGet() and RDMSet() requests.
+   * @param universe the universe to send the commands on
+   * @param uids the UIDs to send the commands to
+   * @param sub_device the sub device index
+   * @param pids the PIDs to fetch
+   * @param callback the RDMBulkGetCallback to run once all the requests have
+   *   completed.
+   */
+  void RDMBulkGet(unsigned int universe,
+                  const std::vector<ola::rdm::UID> &uids,
+                  uint16_t sub_device,
+                  const std::vector<uint16_t> &pids,
+                  RDMBulkGetCallback *callback);
+
+  /**
+   * @brief Send broadcast or vendorcast commands to a set of universes.
+   *
+   * Every command is sent to every universe at once. This is much faster
+   * than sending the commands one at a time when, for example, changing the
+   * DMX start address of the devices on many universes.
+   * @param universes the universes to send the commands on
+   * @param uid the broadcast or vendorcast UID to send the commands to
+   * @param commands the commands to send
+   * @param callback the RDMBroadcastCallback to run once all the commands have
+   *   completed.
+   */
+  void RDMBroadcast(const std::vector<unsigned int> &universes,
+                    const ola::rdm::UID &uid,
+                    const std::vector<RDMBroadcastCommand> &commands,
+                    RDMBroadcastCallback *callback);
+
+  /**
+   * @brief Register for changes to the RDM sensors & status of a universe.
+   *
+   * While registered, the server polls each responder on the universe for
+   * SENSOR_VALUE, LAMP_HOURS, STATUS_MESSAGES and QUEUED_MESSAGE when the RDM
+   * line is idle. The callback set by SetRDMUpdateCallback() is run with the
+   * current values, and then each time one of them changes.
+   * @param universe the id of the universe.
+   * @param register_action the action (register or unregister)
+   * @param callback the SetCallback to invoke upon completion.
+   */
+  void RegisterForRDMUpdates(unsigned int universe,
+                             RegisterAction register_action,
+                             SetCallback *callback);
+
   /**
    * @brief Send TimeCode data.
    * @param timecode The timecode data.
@@ -63,7 +63,9 @@ USA
    * time.
    *
    * The SingleUse varient of a Callback automatically delete itself after it
-   * has been executed.
+   * has been executed. Since they are created and destroyed at a high rate,
+   * SingleUse callbacks are allocated from a per-thread pool rather than the
+   * heap, see CallbackAllocator.h.
    *
    * Callbacks are used throughout OLA to reduce the coupling between classes
    * and make for more modular code.
@@ -137,6 +139,9 @@ USA
   #ifndef INCLUDE_OLA_CALLBACK_H_
   #define INCLUDE_OLA_CALLBACK_H_
 
+  #include <ola/CallbackAllocator.h>
+  #include <stddef.h>
+
   namespace ola {
 
   /**
@@ -155,6 +160,16 @@ def Footer():
   #endif  // INCLUDE_OLA_CALLBACK_H_""")
 
 
+def PrintAllocator():
+  """Single use callbacks are short lived so they use the callback pool."""
+  print '  static void *operator new(size_t size) {'
+  print '    return AllocateCallback(size);'
+  print '  }'
+  print '  static void operator delete(void *ptr, size_t size) {'
+  print '    FreeCallback(ptr, size);'
+  print '  }'
+
+
 def GenerateBase(number_of_args):
   """Generate the base Callback classes."""
   optional_comma = ''
@@ -212,6 +227,7 @@ def GenerateBase(number_of_args):
                 (number_of_args, number_of_args, optional_comma, arg_types))
   print ' public:'
   print '  virtual ~SingleUseCallback%d() {}' % number_of_args
+  PrintAllocator()
   print '  ReturnType Run(%s) {' % arg_list
   print '    ReturnType ret = this->DoRun(%s);' % args
   print '    delete this;'
@@ -234,6 +250,7 @@ def GenerateBase(number_of_args):
                  optional_comma, arg_types))
   print ' public:'
   print '  virtual ~SingleUseCallback%d() {}' % number_of_args
+  PrintAllocator()
   print '  void Run(%s) {' % arg_list
   print '    this->DoRun(%s);' % args
   print '    delete this;'
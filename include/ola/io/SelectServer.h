@@ -200,13 +200,11 @@ class SelectServer: public SelectServerInterface {
   TimeInterval m_poll_interval;
   std::auto_ptr<class TimeoutManager> m_timeout_manager;
   std::auto_ptr<class PollerInterface> m_poller;
+  std::auto_ptr<class ExecuteQueue> m_incoming_queue;
 
   Clock *m_clock;
   bool m_free_clock;
   LoopClosureSet m_loop_callbacks;
-  Callbacks m_incoming_callbacks;
-  ola::thread::Mutex m_incoming_mutex;
-  LoopbackDescriptor m_incoming_descriptor;
 
   void Init(const Options &options);
   bool CheckForEvents(const TimeInterval &poll_interval);
@@ -36,6 +36,7 @@
 #include <queue>
 #include <stack>
 #include <utility>
+#include <vector>
 
 namespace ola {
 namespace rdm {
@@ -48,7 +49,8 @@ namespace rdm {
  *
  * For each of the MuteDevice, UnMuteAll and Branch methods, the implementation
  * should send the appropriate RDM command and then run the provided callback
- * when the command has been sent.
+ * when the command has been sent. The callbacks are owned by the
+ * DiscoveryAgent, the implementation must not delete them.
  */
 class DiscoveryTargetInterface {
  public:
@@ -102,6 +104,15 @@ class DiscoveryTargetInterface {
   virtual void Branch(const UID &lower,
                       const UID &upper,
                       BranchCallback *callback) = 0;
+
+  /**
+   * @brief The number of MuteDevice() calls that can be outstanding at once.
+   *
+   * Targets that can queue commands, and so avoid a round trip between each
+   * one, can return more than 1. The previously discovered devices are then
+   * muted in parallel during incremental discovery.
+   */
+  virtual unsigned int MaxMutesInFlight() const { return 1; }
 };
 
 
@@ -118,10 +129,12 @@ class DiscoveryTargetInterface {
  *
  * The discovery process goes something like this:
  *   - if incremental, copy all previously discovered UIDs to the mute list
- *   - push (0, 0xffffffffffff) onto the resolution stack
+ *   - push (0, 0xffffffffffff) onto the resolution stack. For full discovery,
+ *     if devices were found last time, the range is instead split at the
+ *     mid points between them, so each branch holds one known device.
  *   - unmute all
  *   - mute all previously discovered UIDs, for any that fail to mute remove
- *     them from the UIDSet.
+ *     them from the UIDSet. Up to MaxMutesInFlight() mutes are sent at once.
  *   - Send a discovery unique branch message
  *     - If we get a valid response, mute, and send the same branch again
  *     - If we get a collision, split the UID range, and try each branch
@@ -148,6 +161,17 @@ class DiscoveryAgent {
   typedef ola::SingleUseCallback2<void, bool, const UIDSet&>
     DiscoveryCompleteCallback;
 
+  /**
+   * @brief The number of commands sent during a discovery run.
+   */
+  struct DiscoveryStats {
+    unsigned int branches;  /**< @brief The number of DUB commands */
+    unsigned int collisions;  /**< @brief The number of DUB collisions */
+    unsigned int mutes;  /**< @brief The number of mute commands */
+
+    DiscoveryStats() : branches(0), collisions(0), mutes(0) {}
+  };
+
   /**
    * @brief Cancel any in-progress discovery operation.
    * If a discovery operation is running, this will result in the callback
@@ -167,6 +191,11 @@ class DiscoveryAgent {
    */
   void StartIncrementalDiscovery(DiscoveryCompleteCallback *on_complete);
 
+  /**
+   * @brief Return the stats for the current, or last, discovery run.
+   */
+  const DiscoveryStats& Stats() const { return m_stats; }
+
  private:
   /**
    * @brief Represents a range of UIDs (a branch of the UID tree)
@@ -192,6 +221,27 @@ class DiscoveryAgent {
 
   typedef std::stack<UIDRange*> UIDRanges;
 
+  /**
+   * @brief An incremental mute sent to the target.
+   *
+   * The callback is owned by the agent and reused once the mute completes. A
+   * mute may still be outstanding after Abort(), so completions from an
+   * earlier discovery run are identified by the generation, and ignored.
+   */
+  struct IncrementalMute {
+    IncrementalMute()
+        : uid(0, 0),
+          generation(0),
+          in_flight(false) {
+    }
+    UID uid;
+    unsigned int generation;
+    bool in_flight;
+    std::auto_ptr<DiscoveryTargetInterface::MuteDeviceCallback> callback;
+  };
+
+  typedef std::vector<IncrementalMute*> IncrementalMutes;
+
   DiscoveryTargetInterface *m_target;
   UIDSet m_uids;
   // uids that are misbehaved in some way
@@ -202,8 +252,6 @@ class DiscoveryAgent {
   // Callbacks used by the DiscoveryTarget
   std::auto_ptr<DiscoveryTargetInterface::UnMuteDeviceCallback>
       m_unmute_callback;
-  std::auto_ptr<DiscoveryTargetInterface::MuteDeviceCallback>
-      m_incremental_mute_callback;
   std::auto_ptr<DiscoveryTargetInterface::MuteDeviceCallback>
       m_branch_mute_callback;
   std::auto_ptr<DiscoveryTargetInterface::BranchCallback> m_branch_callback;
@@ -213,20 +261,28 @@ class DiscoveryAgent {
   UID m_muting_uid;  // the uid we're currently trying to mute
   unsigned int m_unmute_count;
   unsigned int m_mute_attempts;
+  IncrementalMutes m_incremental_mutes;
+  // incremental mutes from this discovery run that are outstanding
+  unsigned int m_mutes_in_flight;
+  unsigned int m_generation;  // incremented for each discovery run
+  bool m_sending_mutes;
   bool m_tree_corrupt;  // true if there was a problem with discovery
+  DiscoveryStats m_stats;
 
   void InitDiscovery(DiscoveryCompleteCallback *on_complete,
                      bool incremental);
 
   void UnMuteComplete();
   void MaybeMuteNextDevice();
-  void IncrementalMuteComplete(bool status);
+  IncrementalMute *FreeIncrementalMute();
+  void IncrementalMuteComplete(IncrementalMute *mute, bool status);
   void SendDiscovery();
 
   void BranchComplete(const uint8_t *data, unsigned int length);
   void BranchMuteComplete(bool status);
   void HandleCollision();
   void FreeCurrentRange();
+  void PushKnownDeviceRanges(const UIDSet &uids);
 
   static const unsigned int PREAMBLE_SIZE = 8;
   static const unsigned int EUID_SIZE = 12;
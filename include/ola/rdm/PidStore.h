@@ -158,9 +158,18 @@ class RootPidStore {
    * empty, the installed location will be used.
    * @param validate whether to perform validation on the data. Validation can
    * be turned off for faster load times.
+   * @param cache_file the path of a binary cache of the PID data, or empty to
+   * always parse the text files.
+   *
+   * Parsing the text files dominates the load time. If cache_file is up to
+   * date with the files in directory, and the version of OLA, the data is
+   * read from the cache instead. Otherwise the files are parsed and
+   * the cache is rewritten.
    */
-  static const RootPidStore *LoadFromDirectory(const std::string &directory,
-                                               bool validate = true);
+  static const RootPidStore *LoadFromDirectory(
+      const std::string &directory,
+      bool validate = true,
+      const std::string &cache_file = "");
 
   /**
    * @brief Returns the location of the installed PID data.
@@ -219,6 +228,8 @@ class PidStore {
    * @brief Lookup a PidDescriptor by PID.
    * @param pid_value the PID to lookup.
    * @return a PidDescriptor or NULL if the parameter wasn't found.
+   *
+   * This is a binary search, it doesn't allocate memory.
    */
   const PidDescriptor *LookupPID(uint16_t pid_value) const;
 
@@ -230,10 +241,12 @@ class PidStore {
   const PidDescriptor *LookupPID(const std::string &pid_name) const;
 
  private:
-  typedef std::map<uint16_t, const PidDescriptor*> PidMap;
-  typedef std::map<std::string, const PidDescriptor*> PidNameMap;
-  PidMap m_pid_by_value;
-  PidNameMap m_pid_by_name;
+  typedef std::vector<const PidDescriptor*> PidList;
+
+  // The same descriptors, sorted by value and by name. These are built once
+  // and never modified, so sorted vectors are smaller & faster than maps.
+  PidList m_pid_by_value;
+  PidList m_pid_by_name;
 
   DISALLOW_COPY_AND_ASSIGN(PidStore);
 };
@@ -0,0 +1,238 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * DmxFrameTimer.h
+ * Generate the break, mark after break & frame timing for DMX output threads.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#ifndef INCLUDE_OLA_THREAD_DMXFRAMETIMER_H_
+#define INCLUDE_OLA_THREAD_DMXFRAMETIMER_H_
+
+#include <stdint.h>
+#include <ola/Clock.h>
+#include <ola/base/Macro.h>
+#include <ola/thread/Mutex.h>
+#include <ola/thread/SchedulingStats.h>
+#include <string>
+
+namespace ola {
+
+class ExportMap;
+
+namespace thread {
+
+/**
+ * @brief Times the DMX frames generated by an output thread.
+ *
+ * Output threads which generate the break and mark after break in software,
+ * like the FTDI and UART plugins, use this to time each part of the frame.
+ * Sleeps are to absolute deadlines on the monotonic clock, so errors don't
+ * accumulate from one frame to the next. Optionally the end of each sleep
+ * can be a busy wait, which trades CPU time for accuracy.
+ *
+ * If the system timers are too coarse to sleep for the length of a break,
+ * the break & mark after break are as short as the hardware makes them and
+ * the frame time is busy waited.
+ *
+ * The measured break, mark after break and frame times are recorded and
+ * exported by ExportStats(), keyed by the name of the timer. Apart from the
+ * statistics accessors and ExportStats(), all methods must be called from
+ * the output thread.
+ * @examplepara
+ *   @code
+ *   timer.StartFrame();
+ *   widget->SetBreak(true);
+ *   timer.Break(DMX_BREAK);
+ *   widget->SetBreak(false);
+ *   timer.MarkAfterBreak(DMX_MAB);
+ *   widget->Write(buffer);
+ *   timer.WaitForFrameEnd(frame_time);
+ *   @endcode
+ */
+class DmxFrameTimer {
+ public:
+  struct Options {
+    /**
+     * @brief The length of the busy wait at the end of each sleep.
+     *
+     * Defaults to the value of --output-thread-spin-us.
+     */
+    TimeInterval spin_time;
+
+    Options();
+  };
+
+  /**
+   * @brief Create a new DmxFrameTimer.
+   * @param name the name of the device, used to export the statistics.
+   * @param options the Options for the timer.
+   * @param scheduling_stats if not NULL, the wake up latency of each sleep
+   *   is recorded here, usually these are the SchedulingStats of the output
+   *   thread.
+   */
+  DmxFrameTimer(const std::string &name,
+                const Options &options = Options(),
+                SchedulingStats *scheduling_stats = NULL);
+  ~DmxFrameTimer();
+
+  /**
+   * @brief Return the name of this timer.
+   */
+  const std::string &Name() const { return m_name; }
+
+  /**
+   * @brief Check if the system timers are accurate enough to time a break.
+   *
+   * This should be called from the output thread, after any real time
+   * scheduling has been applied.
+   */
+  void CheckGranularity();
+
+  /**
+   * @brief Mark the start of a frame.
+   */
+  void StartFrame();
+
+  /**
+   * @brief Hold the break.
+   * @param duration the length of the break in microseconds, starting from
+   *   when this method is called.
+   */
+  void Break(unsigned int duration);
+
+  /**
+   * @brief Hold the mark after break.
+   * @param duration the length of the mark after break in microseconds.
+   */
+  void MarkAfterBreak(unsigned int duration);
+
+  /**
+   * @brief Sleep until the frame is complete.
+   * @param frame_time the time between the start of each frame.
+   *
+   * If the frame overran, this returns immediately and the next frame is
+   * scheduled from when it starts.
+   */
+  void WaitForFrameEnd(const TimeInterval &frame_time);
+
+  /**
+   * @brief Sleep for a period.
+   * @param duration the time to sleep in microseconds.
+   */
+  void Sleep(unsigned int duration);
+
+  /**
+   * @brief Sleep until an absolute time on the monotonic clock.
+   * @param deadline the time to wake up.
+   * @param[out] woken the time the sleep ended.
+   */
+  void SleepUntil(const TimeStamp &deadline, TimeStamp *woken);
+
+  /**
+   * @brief Get the current time from the monotonic clock.
+   * @param[out] now the current time.
+   */
+  static void CurrentTime(TimeStamp *now);
+
+  // Statistics, these can be called from any thread.
+
+  /**
+   * @brief The number of frames started.
+   */
+  uint64_t Frames() const;
+
+  /**
+   * @brief The mean length of the break.
+   */
+  TimeInterval MeanBreak() const;
+
+  /**
+   * @brief The shortest break.
+   */
+  TimeInterval MinBreak() const;
+
+  /**
+   * @brief The mean length of the mark after break.
+   */
+  TimeInterval MeanMarkAfterBreak() const;
+
+  /**
+   * @brief The shortest mark after break.
+   */
+  TimeInterval MinMarkAfterBreak() const;
+
+  /**
+   * @brief The mean time between the start of each frame.
+   */
+  TimeInterval MeanFrameTime() const;
+
+  /**
+   * @brief The longest time between the start of two frames.
+   */
+  TimeInterval MaxFrameTime() const;
+
+  /**
+   * @brief Export the statistics of all timers.
+   * @param export_map the ExportMap to update.
+   *
+   * This must be called from the thread that owns the ExportMap, usually
+   * periodically.
+   */
+  static void ExportStats(ExportMap *export_map);
+
+ private:
+  class IntervalStats {
+   public:
+    IntervalStats() : count(0), total(0), min(0), max(0) {}
+
+    void Record(const TimeInterval &interval);
+    TimeInterval Mean() const;
+
+    uint64_t count;
+    int64_t total;
+    int64_t min;
+    int64_t max;
+  };
+
+  enum TimerGranularity { UNKNOWN, GOOD, BAD };
+
+  const std::string m_name;
+  const TimeInterval m_spin_time;
+  SchedulingStats *m_scheduling_stats;
+  TimerGranularity m_granularity;
+
+  // Only used by the output thread.
+  TimeStamp m_frame_start;  // when the current frame was scheduled to start
+  TimeStamp m_last_frame_start;  // when the current frame actually started
+  TimeStamp m_next_frame_start;
+  TimeStamp m_break_start;
+
+  mutable Mutex m_mutex;
+  IntervalStats m_break_stats;  // GUARDED_BY(m_mutex)
+  IntervalStats m_mab_stats;  // GUARDED_BY(m_mutex)
+  IntervalStats m_frame_stats;  // GUARDED_BY(m_mutex)
+  uint64_t m_frames;  // GUARDED_BY(m_mutex)
+
+  bool CoarseTimers() const { return m_granularity == BAD; }
+
+  // If sleeping for 1ms takes longer than this, the timers are too coarse.
+  static const int64_t BAD_GRANULARITY_LIMIT;
+
+  DISALLOW_COPY_AND_ASSIGN(DmxFrameTimer);
+};
+}  // namespace thread
+}  // namespace ola
+#endif  // INCLUDE_OLA_THREAD_DMXFRAMETIMER_H_
@@ -62,10 +62,10 @@ class FutureImpl {
 
   const T& Get() const {
     MutexLocker l(&m_mutex);
-    if (m_is_set) {
-      return m_value;
+    // Loop to guard against spurious wake ups.
+    while (!m_is_set) {
+      m_condition.Wait(&m_mutex);
     }
-    m_condition.Wait(&m_mutex);
     return m_value;
   }
 
@@ -128,10 +128,9 @@ class FutureImpl<void> {
 
   void Get() const {
     MutexLocker l(&m_mutex);
-    if (m_is_set) {
-      return;
+    while (!m_is_set) {
+      m_condition.Wait(&m_mutex);
     }
-    m_condition.Wait(&m_mutex);
   }
 
   void Set() {
@@ -2,6 +2,7 @@ olathreadincludedir = $(pkgincludedir)/thread/
 olathreadinclude_HEADERS = \
     include/ola/thread/CallbackThread.h \
     include/ola/thread/ConsumerThread.h \
+    include/ola/thread/DmxFrameTimer.h \
     include/ola/thread/ExecutorInterface.h \
     include/ola/thread/ExecutorThread.h \
     include/ola/thread/Future.h \
@@ -10,6 +11,7 @@ olathreadinclude_HEADERS = \
     include/ola/thread/PeriodicThread.h \
     include/ola/thread/SchedulerInterface.h \
     include/ola/thread/SchedulingExecutorInterface.h \
+    include/ola/thread/SchedulingStats.h \
     include/ola/thread/SignalThread.h \
     include/ola/thread/Thread.h \
     include/ola/thread/ThreadPool.h \
@@ -0,0 +1,82 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * SchedulingStats.h
+ * Track how late a thread wakes up.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#ifndef INCLUDE_OLA_THREAD_SCHEDULINGSTATS_H_
+#define INCLUDE_OLA_THREAD_SCHEDULINGSTATS_H_
+
+#include <stdint.h>
+#include <ola/Clock.h>
+#include <ola/base/Macro.h>
+
+namespace ola {
+namespace thread {
+
+/**
+ * @brief Records the scheduling latency of a thread.
+ *
+ * Time critical threads call RecordWakeUp() each time they return from a
+ * sleep, with the time they expected to wake up. The difference is the
+ * scheduling latency. All methods are thread safe. The counters are updated
+ * with atomic operations, so a real time thread never blocks on a reader.
+ */
+class SchedulingStats {
+ public:
+  SchedulingStats();
+
+  /**
+   * @brief Record a wake up.
+   * @param expected the time the thread asked to be woken up.
+   * @param actual the time the thread actually woke up.
+   */
+  void RecordWakeUp(const TimeStamp &expected, const TimeStamp &actual);
+
+  /**
+   * @brief The number of wake ups recorded.
+   */
+  uint64_t WakeUps() const;
+
+  /**
+   * @brief The largest latency seen.
+   */
+  TimeInterval MaxLatency() const;
+
+  /**
+   * @brief The mean latency.
+   */
+  TimeInterval MeanLatency() const;
+
+  /**
+   * @brief Reset the statistics.
+   */
+  void Reset();
+
+ private:
+  uint64_t m_wake_ups;
+  int64_t m_total_latency;
+  int64_t m_max_latency;
+
+  template <typename T>
+  static T Load(const T *value);
+
+  DISALLOW_COPY_AND_ASSIGN(SchedulingStats);
+};
+}  // namespace thread
+}  // namespace ola
+#endif  // INCLUDE_OLA_THREAD_SCHEDULINGSTATS_H_
@@ -30,8 +30,10 @@
 #include <pthread.h>
 #include <ola/base/Macro.h>
 #include <ola/thread/Mutex.h>
+#include <ola/thread/SchedulingStats.h>
 
 #include <string>
+#include <vector>
 
 #if defined(_WIN32) && defined(__GNUC__)
 inline std::ostream& operator<<(std::ostream &stream,
@@ -42,6 +44,9 @@ inline std::ostream& operator<<(std::ostream &stream,
 #endif
 
 namespace ola {
+
+class ExportMap;
+
 namespace thread {
 
 typedef pthread_t ThreadId;
@@ -87,6 +92,32 @@ class Thread {
      */
     int inheritsched;
 
+    /**
+     * @brief The CPUs the thread is allowed to run on.
+     *
+     * If empty, the thread may run on any CPU. This is only supported on
+     * Linux, elsewhere it's ignored.
+     */
+    std::vector<unsigned int> cpu_affinity;
+
+    /**
+     * @brief Lock the process's memory once the thread starts.
+     *
+     * This calls mlockall(), so it affects the whole process, including any
+     * memory allocated in the future. It prevents page faults from delaying
+     * time critical threads. Defaults to false.
+     */
+    bool lock_memory;
+
+    /**
+     * @brief Start with the default policy & priority if the thread can't be
+     *   created with the requested ones.
+     *
+     * Real time policies usually need extra privileges. Defaults to false, in
+     * which case Start() fails.
+     */
+    bool fallback_to_default_scheduling;
+
     /**
      * @brief Create new thread Options.
      * @param name the name of the thread.
@@ -103,7 +134,7 @@ class Thread {
   /**
    * @brief Destructor
    */
-  virtual ~Thread() {}
+  virtual ~Thread();
 
   /**
    * @brief Start the thread and wait for the thread to be running.
@@ -154,6 +185,14 @@ class Thread {
    */
   std::string Name() const { return m_options.name; }
 
+  /**
+   * @brief Return the scheduling statistics for this thread.
+   * @returns the SchedulingStats, which may be read from any thread.
+   */
+  const SchedulingStats &SchedulingStatistics() const {
+    return m_scheduling_stats;
+  }
+
   /**
    * @private
    * Called by pthread_create. Internally this calls Run().
@@ -166,6 +205,16 @@ class Thread {
    */
   static inline ThreadId Self() { return pthread_self(); }
 
+  /**
+   * @brief Export the scheduling statistics of all running threads.
+   * @param export_map the ExportMap to update.
+   *
+   * Only threads that have recorded at least one wake up are exported. This
+   * must be called from the thread that owns the ExportMap, usually
+   * periodically.
+   */
+  static void ExportSchedulingStats(ExportMap *export_map);
+
  protected:
   /**
    * @brief The entry point for the new thread.
@@ -175,12 +224,36 @@ class Thread {
    */
   virtual void *Run() = 0;
 
+  /**
+   * @brief Record a wake up from within Run().
+   * @param expected the time the thread expected to wake up.
+   * @param actual the time the thread actually woke up.
+   *
+   * Sub classes that sleep between time critical operations should call this
+   * so the scheduling latency is visible in the ExportMap.
+   */
+  void RecordWakeUp(const TimeStamp &expected, const TimeStamp &actual) {
+    m_scheduling_stats.RecordWakeUp(expected, actual);
+  }
+
+  /**
+   * @brief Return the scheduling statistics, so that helpers like the
+   * DmxFrameTimer can record wake ups on behalf of this thread.
+   */
+  SchedulingStats *MutableSchedulingStatistics() {
+    return &m_scheduling_stats;
+  }
+
  private:
   pthread_t m_thread_id;
   bool m_running;
   Options m_options;
   Mutex m_mutex;  // protects m_running
   ConditionVariable m_condition;  // use to wait for the thread to start
+  SchedulingStats m_scheduling_stats;
+
+  bool CreateThread(int policy, int priority);
+  void ApplyRealTimeOptions();
 
   DISALLOW_COPY_AND_ASSIGN(Thread);
 };
@@ -21,39 +21,111 @@
 #ifndef INCLUDE_OLA_THREAD_THREADPOOL_H_
 #define INCLUDE_OLA_THREAD_THREADPOOL_H_
 
+#include <pthread.h>
 #include <ola/Callback.h>
 #include <ola/base/Macro.h>
-#include <ola/thread/ConsumerThread.h>
-#include <ola/thread/Thread.h>
-#include <queue>
+#include <ola/thread/Future.h>
+#include <ola/thread/Mutex.h>
+#include <deque>
 #include <vector>
 
 namespace ola {
 namespace thread {
 
+/**
+ * @brief A work-stealing pool of threads.
+ *
+ * Each thread in the pool has its own queue of actions. Actions passed to
+ * Execute() from outside the pool are spread across the queues, actions
+ * passed to Execute() from within a pool thread are added to that thread's
+ * queue. When a thread runs out of work it steals from the other queues
+ * before going to sleep, so there is no single lock that all threads contend
+ * on.
+ *
+ * Actions that need to return a result can be passed to Submit(), which
+ * returns a Future that completes once the action has run.
+ *
+ * @note Actions shouldn't block on a Future that will be completed by another
+ * action in the same pool, since all the threads may end up waiting.
+ */
 class ThreadPool {
  public :
   typedef ola::BaseCallback0<void>* Action;
 
-  explicit ThreadPool(unsigned int thread_count)
-      : m_thread_count(thread_count),
-        m_shutdown(false) {
-  }
+  explicit ThreadPool(unsigned int thread_count);
   ~ThreadPool();
   bool Init();
+
+  /**
+   * @brief Run all outstanding actions and then stop the threads.
+   */
   void JoinAll();
+
+  /**
+   * @brief Queue an action.
+   * @param action the action to run, ownership is transferred.
+   */
   void Execute(Action action);
 
+  /**
+   * @brief Queue an action which returns a value.
+   * @param callback the callback to run, ownership is transferred.
+   * @returns A Future which is set to the return value of the callback.
+   */
+  template <typename T>
+  Future<T> Submit(BaseCallback0<T> *callback) {
+    Future<T> future;
+    Execute(NewSingleCallback(&ThreadPool::RunAndSet<T>, callback, future));
+    return future;
+  }
+
+  /**
+   * @brief Queue an action, and get a Future that completes once it's run.
+   * @param callback the callback to run, ownership is transferred.
+   * @returns A Future which is set once the callback has run.
+   */
+  Future<void> Submit(BaseCallback0<void> *callback);
+
+  /**
+   * @brief The number of threads in the pool.
+   */
+  unsigned int ThreadCount() const { return m_thread_count; }
+
  private:
-  std::queue<Action> m_callback_queue;
-  unsigned int m_thread_count;
+  class WorkerThread;
+
+  struct WorkQueue {
+    Mutex mutex;
+    std::deque<Action> actions;
+  };
+
+  const unsigned int m_thread_count;
   bool m_shutdown;
-  Mutex m_mutex;
-  ConditionVariable m_condition_var;
-  std::vector<ConsumerThread*> m_threads;
+  // The number of queued actions across all queues, and the number of
+  // threads waiting on m_idle_condition. These are accessed with atomic
+  // builtins.
+  volatile int m_pending;
+  volatile int m_idle_threads;
+  volatile unsigned int m_next_queue;
+  Mutex m_idle_mutex;
+  ConditionVariable m_idle_condition;
+  std::vector<WorkQueue*> m_queues;
+  std::vector<WorkerThread*> m_threads;
+  // Maps a pool thread to its queue index + 1.
+  pthread_key_t m_queue_key;
 
+  Action NextAction(unsigned int queue_index);
+  bool WaitForWork();
   void JoinAllThreads();
 
+  template <typename T>
+  static void RunAndSet(BaseCallback0<T> *callback, Future<T> future) {
+    future.Set(callback->Run());
+  }
+
+  static void RunAndSetVoid(BaseCallback0<void> *callback,
+                            Future<void> future);
+
   DISALLOW_COPY_AND_ASSIGN(ThreadPool);
 };
 }  // namespace thread
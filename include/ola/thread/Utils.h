@@ -22,6 +22,7 @@
 #define INCLUDE_OLA_THREAD_UTILS_H_
 
 #include <pthread.h>
+#include <ola/thread/Thread.h>
 #include <string>
 
 namespace ola {
@@ -44,6 +45,18 @@ std::string PolicyToString(int policy);
 bool SetSchedParam(pthread_t thread, int policy,
                    const struct sched_param &param);
 
+/**
+ * @brief Get the Thread::Options for a time critical output thread.
+ * @param name the name of the thread.
+ * @returns the Thread::Options, configured from the --output-thread-* flags.
+ *
+ * Threads that generate DMX timing, such as the break, should use this so
+ * the scheduling policy, CPU affinity and memory locking can be configured
+ * at run time. If the thread can't be started with the real time policy, it
+ * falls back to the default policy.
+ */
+Thread::Options OutputThreadOptions(const std::string &name);
+
 }  // namespace thread
 }  // namespace ola
 #endif  // INCLUDE_OLA_THREAD_UTILS_H_
@@ -31,6 +31,7 @@
 #include <ola/rdm/UIDSet.h>
 #include <olad/DmxSource.h>
 
+#include <memory>
 #include <set>
 #include <map>
 #include <vector>
@@ -41,6 +42,8 @@ namespace ola {
 class Client;
 class InputPort;
 class OutputPort;
+class RDMResponseCache;
+class RDMScheduler;
 
 class Universe: public ola::rdm::RDMControllerInterface {
  public:
@@ -49,6 +52,16 @@ class Universe: public ola::rdm::RDMControllerInterface {
       MERGE_LTP
     };
 
+    /**
+     * @brief The priority of a RDM request.
+     *
+     * Interactive requests are sent before any queued background requests.
+     */
+    enum RDMPriority {
+      RDM_PRIORITY_INTERACTIVE,
+      RDM_PRIORITY_BACKGROUND
+    };
+
     Universe(unsigned int uid, class UniverseStore *store,
              ExportMap *export_map,
              Clock *clock);
@@ -127,11 +140,16 @@ class Universe: public ola::rdm::RDMControllerInterface {
     // RDM methods
     void SendRDMRequest(ola::rdm::RDMRequest *request,
                         ola::rdm::RDMCallback *callback);
+    void SendRDMRequest(ola::rdm::RDMRequest *request,
+                        ola::rdm::RDMCallback *callback,
+                        RDMPriority priority,
+                        bool use_cache = false);
     void RunRDMDiscovery(ola::rdm::RDMDiscoveryCallback *on_complete,
                          bool full = true);
     void NewUIDList(OutputPort *port, const ola::rdm::UIDSet &uids);
     void GetUIDs(ola::rdm::UIDSet *uids) const;
     unsigned int UIDCount() const;
+    unsigned int QueuedRDMRequests() const;
 
     bool operator==(const Universe &other) {
       return m_universe_id == other.UniverseId();
@@ -144,6 +162,8 @@ class Universe: public ola::rdm::RDMControllerInterface {
     static const char K_UNIVERSE_MODE_VAR[];
     static const char K_UNIVERSE_NAME_VAR[];
     static const char K_UNIVERSE_OUTPUT_PORT_VAR[];
+    static const char K_UNIVERSE_RDM_CACHE_HITS_VAR[];
+    static const char K_UNIVERSE_RDM_CACHE_MISSES_VAR[];
     static const char K_UNIVERSE_RDM_REQUESTS[];
     static const char K_UNIVERSE_SINK_CLIENTS_VAR[];
     static const char K_UNIVERSE_SOURCE_CLIENTS_VAR[];
@@ -180,6 +200,8 @@ class Universe: public ola::rdm::RDMControllerInterface {
     Clock *m_clock;
     TimeInterval m_rdm_discovery_interval;
     TimeStamp m_last_discovery_time;
+    std::auto_ptr<RDMScheduler> m_rdm_scheduler;
+    std::auto_ptr<RDMResponseCache> m_rdm_cache;
 
     void HandleBroadcastAck(broadcast_request_tracker *tracker,
                             ola::rdm::RDMReply *reply);
@@ -197,6 +219,7 @@ class Universe: public ola::rdm::RDMControllerInterface {
 
     void SafeIncrement(const std::string &name);
     void SafeDecrement(const std::string &name);
+    void UpdateRDMCacheStats();
 
     template<class PortClass>
     bool GenericAddPort(PortClass *port,
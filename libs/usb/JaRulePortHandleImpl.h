@@ -68,6 +68,8 @@ class JaRulePortHandleImpl
   void Branch(const ola::rdm::UID &lower,
               const ola::rdm::UID &upper,
               BranchCallback *branch_complete);
+  // The widget accepts two commands at once, so keep the USB pipe full.
+  unsigned int MaxMutesInFlight() const { return 2; }
 
   /**
    * @brief Send DMX data from this widget
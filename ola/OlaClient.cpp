@@ -43,6 +43,10 @@ OlaClient::OlaClient(ConnectedDescriptor *descriptor)
     : m_core(new OlaClientCore(descriptor)) {
 }
 
+OlaClient::OlaClient(ola::rpc::RpcChannel *channel)
+    : m_core(new OlaClientCore(channel)) {
+}
+
 OlaClient::~OlaClient() {
 }
 
@@ -62,6 +66,10 @@ void OlaClient::SetDMXCallback(RepeatableDMXCallback *callback) {
   m_core->SetDMXCallback(callback);
 }
 
+void OlaClient::SetRDMUpdateCallback(RepeatableRDMUpdateCallback *callback) {
+  m_core->SetRDMUpdateCallback(callback);
+}
+
 void OlaClient::ReloadPlugins(SetCallback *callback) {
   m_core->ReloadPlugins(callback);
 }
@@ -203,5 +211,26 @@ void OlaClient::RDMSet(unsigned int universe,
                        const SendRDMArgs& args) {
   m_core->RDMSet(universe, uid, sub_device, pid, data, data_length, args);
 }
+
+void OlaClient::RDMBulkGet(unsigned int universe,
+                           const std::vector<ola::rdm::UID> &uids,
+                           uint16_t sub_device,
+                           const std::vector<uint16_t> &pids,
+                           RDMBulkGetCallback *callback) {
+  m_core->RDMBulkGet(universe, uids, sub_device, pids, callback);
+}
+
+void OlaClient::RDMBroadcast(const std::vector<unsigned int> &universes,
+                             const ola::rdm::UID &uid,
+                             const std::vector<RDMBroadcastCommand> &commands,
+                             RDMBroadcastCallback *callback) {
+  m_core->RDMBroadcast(universes, uid, commands, callback);
+}
+
+void OlaClient::RegisterForRDMUpdates(unsigned int universe,
+                                      RegisterAction register_action,
+                                      SetCallback *callback) {
+  m_core->RegisterForRDMUpdates(universe, register_action, callback);
+}
 }  // namespace client
 }  // namespace ola
@@ -57,6 +57,13 @@ const char OlaClientCore::NOT_CONNECTED_ERROR[] = "Not connected";
 
 OlaClientCore::OlaClientCore(ConnectedDescriptor *descriptor)
     : m_descriptor(descriptor),
+      m_external_channel(NULL),
+      m_connected(false) {
+}
+
+OlaClientCore::OlaClientCore(RpcChannel *channel)
+    : m_descriptor(NULL),
+      m_external_channel(channel),
       m_connected(false) {
 }
 
@@ -75,12 +82,16 @@ bool OlaClientCore::Setup() {
   if (m_connected)
     return false;
 
-  m_channel.reset(new RpcChannel(this, m_descriptor));
+  if (m_external_channel) {
+    m_external_channel->SetService(this);
+  } else {
+    m_channel.reset(new RpcChannel(this, m_descriptor));
+  }
 
-  if (!m_channel.get()) {
+  if (!Channel()) {
     return false;
   }
-  m_stub.reset(new OlaServerService_Stub(m_channel.get()));
+  m_stub.reset(new OlaServerService_Stub(Channel()));
 
   if (!m_stub.get()) {
     m_channel.reset();
@@ -97,8 +108,13 @@ bool OlaClientCore::Setup() {
  */
 bool OlaClientCore::Stop() {
   if (m_connected) {
-    m_descriptor->Close();
-    m_channel.reset();
+    if (m_external_channel) {
+      m_external_channel->SetChannelCloseHandler(NULL);
+      m_external_channel->SetService(NULL);
+    } else {
+      m_descriptor->Close();
+      m_channel.reset();
+    }
     m_stub.reset();
   }
   m_connected = false;
@@ -110,10 +126,10 @@ bool OlaClientCore::Stop() {
  */
 void OlaClientCore::SetCloseHandler(ClosedCallback *callback) {
   if (callback) {
-    m_channel->SetChannelCloseHandler(
+    Channel()->SetChannelCloseHandler(
         NewSingleCallback(this, &OlaClientCore::ChannelClosed, callback));
   } else {
-    m_channel->SetChannelCloseHandler(NULL);
+    Channel()->SetChannelCloseHandler(NULL);
   }
 }
 
@@ -121,6 +137,11 @@ void OlaClientCore::SetDMXCallback(RepeatableDMXCallback *callback) {
   m_dmx_callback.reset(callback);
 }
 
+void OlaClientCore::SetRDMUpdateCallback(
+    RepeatableRDMUpdateCallback *callback) {
+  m_rdm_update_callback.reset(callback);
+}
+
 void OlaClientCore::ReloadPlugins(SetCallback *callback) {
   ola::proto::PluginReloadRequest request;
   RpcController *controller = new RpcController();
@@ -586,6 +607,111 @@ void OlaClientCore::RDMSet(unsigned int universe,
                  args);
 }
 
+void OlaClientCore::RDMBulkGet(unsigned int universe,
+                               const vector<UID> &uids,
+                               uint16_t sub_device,
+                               const vector<uint16_t> &pids,
+                               RDMBulkGetCallback *callback) {
+  if (!callback) {
+    OLA_WARN << "RDM callback was null, bulk get won't be sent";
+    return;
+  }
+
+  RpcController *controller = new RpcController();
+  ola::proto::RDMBulkGetReply *reply = new ola::proto::RDMBulkGetReply();
+
+  if (!m_connected) {
+    controller->SetFailed(NOT_CONNECTED_ERROR);
+    HandleRDMBulkGet(controller, reply, callback);
+    return;
+  }
+
+  ola::proto::RDMBulkGetRequest request;
+  request.set_universe(universe);
+  request.set_sub_device(sub_device);
+  vector<UID>::const_iterator uid_iter = uids.begin();
+  for (; uid_iter != uids.end(); ++uid_iter) {
+    ola::proto::UID *pb_uid = request.add_uid();
+    pb_uid->set_esta_id(uid_iter->ManufacturerId());
+    pb_uid->set_device_id(uid_iter->DeviceId());
+  }
+  vector<uint16_t>::const_iterator pid_iter = pids.begin();
+  for (; pid_iter != pids.end(); ++pid_iter) {
+    request.add_param_id(*pid_iter);
+  }
+
+  CompletionCallback *cb = NewSingleCallback(
+      this,
+      &OlaClientCore::HandleRDMBulkGet,
+      controller, reply, callback);
+
+  m_stub->RDMBulkGet(controller, &request, reply, cb);
+}
+
+void OlaClientCore::RDMBroadcast(const vector<unsigned int> &universes,
+                                 const UID &uid,
+                                 const vector<RDMBroadcastCommand> &commands,
+                                 RDMBroadcastCallback *callback) {
+  if (!callback) {
+    OLA_WARN << "RDM callback was null, broadcast won't be sent";
+    return;
+  }
+
+  RpcController *controller = new RpcController();
+  ola::proto::RDMBroadcastReply *reply = new ola::proto::RDMBroadcastReply();
+
+  if (!m_connected) {
+    controller->SetFailed(NOT_CONNECTED_ERROR);
+    HandleRDMBroadcast(controller, reply, callback);
+    return;
+  }
+
+  ola::proto::RDMBroadcastRequest request;
+  vector<unsigned int>::const_iterator universe_iter = universes.begin();
+  for (; universe_iter != universes.end(); ++universe_iter) {
+    request.add_universe(*universe_iter);
+  }
+  request.mutable_uid()->set_esta_id(uid.ManufacturerId());
+  request.mutable_uid()->set_device_id(uid.DeviceId());
+  vector<RDMBroadcastCommand>::const_iterator command_iter = commands.begin();
+  for (; command_iter != commands.end(); ++command_iter) {
+    ola::proto::RDMBroadcastCommand *pb_command = request.add_command();
+    pb_command->set_sub_device(command_iter->sub_device);
+    pb_command->set_param_id(command_iter->pid);
+    pb_command->set_data(command_iter->data);
+  }
+
+  CompletionCallback *cb = NewSingleCallback(
+      this,
+      &OlaClientCore::HandleRDMBroadcast,
+      controller, reply, callback);
+
+  m_stub->RDMBroadcast(controller, &request, reply, cb);
+}
+
+void OlaClientCore::RegisterForRDMUpdates(unsigned int universe,
+                                          RegisterAction register_action,
+                                          SetCallback *callback) {
+  ola::proto::RegisterRDMUpdatesRequest request;
+  RpcController *controller = new RpcController();
+  ola::proto::Ack *reply = new ola::proto::Ack();
+
+  request.set_universe(universe);
+  request.set_action(register_action == REGISTER ? ola::proto::REGISTER :
+                     ola::proto::UNREGISTER);
+
+  if (m_connected) {
+    CompletionCallback *cb = ola::NewSingleCallback(
+        this,
+        &OlaClientCore::HandleAck,
+        controller, reply, callback);
+    m_stub->RegisterForRDMUpdates(controller, &request, reply, cb);
+  } else {
+    controller->SetFailed(NOT_CONNECTED_ERROR);
+    HandleAck(controller, reply, callback);
+  }
+}
+
 void OlaClientCore::SendTimeCode(const ola::timecode::TimeCode &timecode,
                                  SetCallback *callback) {
   if (!timecode.IsValid()) {
@@ -637,6 +763,23 @@ void OlaClientCore::UpdateDmxData(ola::rpc::RpcController*,
   done->Run();
 }
 
+void OlaClientCore::UpdateRDMParameter(
+    ola::rpc::RpcController*,
+    const ola::proto::RDMParameterUpdate *request,
+    ola::proto::Ack*,
+    CompletionCallback *done) {
+  if (m_rdm_update_callback.get()) {
+    RDMParameterUpdate update(
+        request->universe(),
+        UID(request->uid().esta_id(), request->uid().device_id()));
+    update.sub_device = request->sub_device();
+    update.pid = request->param_id();
+    update.data = request->data();
+    m_rdm_update_callback->Run(update);
+  }
+  done->Run();
+}
+
 void OlaClientCore::ChannelClosed(ClosedCallback *callback,
                                   OLA_UNUSED ola::rpc::RpcSession *session) {
   callback->Run();
@@ -940,6 +1083,65 @@ void OlaClientCore::HandleRDM(RpcController *controller_ptr,
   callback->Run(result, metadata, response);
 }
 
+void OlaClientCore::HandleRDMBulkGet(RpcController *controller_ptr,
+                                     ola::proto::RDMBulkGetReply *reply_ptr,
+                                     RDMBulkGetCallback *callback) {
+  auto_ptr<RpcController> controller(controller_ptr);
+  auto_ptr<ola::proto::RDMBulkGetReply> reply(reply_ptr);
+
+  Result result(controller->Failed() ? controller->ErrorText() : "");
+  vector<RDMBulkGetResult> results;
+
+  if (!controller->Failed()) {
+    results.reserve(reply->result_size());
+    for (int i = 0; i < reply->result_size(); i++) {
+      const ola::proto::RDMBulkGetResult &pb_result = reply->result(i);
+      RDMBulkGetResult bulk_result(
+          UID(pb_result.uid().esta_id(), pb_result.uid().device_id()),
+          pb_result.param_id());
+      bulk_result.response = BuildRDMResponse(
+          reply->mutable_result(i)->mutable_response(),
+          &bulk_result.metadata.response_code);
+      results.push_back(bulk_result);
+    }
+  }
+
+  callback->Run(result, results);
+
+  vector<RDMBulkGetResult>::iterator iter = results.begin();
+  for (; iter != results.end(); ++iter) {
+    delete iter->response;
+  }
+}
+
+void OlaClientCore::HandleRDMBroadcast(
+    RpcController *controller_ptr,
+    ola::proto::RDMBroadcastReply *reply_ptr,
+    RDMBroadcastCallback *callback) {
+  auto_ptr<RpcController> controller(controller_ptr);
+  auto_ptr<ola::proto::RDMBroadcastReply> reply(reply_ptr);
+
+  Result result(controller->Failed() ? controller->ErrorText() : "");
+  vector<RDMBroadcastResult> results;
+  TimeInterval duration;
+
+  if (!controller->Failed()) {
+    results.reserve(reply->result_size());
+    for (int i = 0; i < reply->result_size(); i++) {
+      const ola::proto::RDMBroadcastResult &pb_result = reply->result(i);
+      RDMBroadcastResult broadcast_result(pb_result.universe(),
+                                          pb_result.command());
+      broadcast_result.response_code = static_cast<ola::rdm::RDMStatusCode>(
+          pb_result.response_code());
+      broadcast_result.duration = TimeInterval(pb_result.duration());
+      results.push_back(broadcast_result);
+    }
+    duration = TimeInterval(reply->duration());
+  }
+
+  callback->Run(result, results, duration);
+}
+
 void OlaClientCore::GenericFetchCandidatePorts(
     unsigned int universe_id,
     bool include_universe,
@@ -23,6 +23,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "common/protocol/Ola.pb.h"
 #include "common/protocol/OlaService.pb.h"
@@ -58,6 +59,13 @@ class OlaClientCore: public ola::proto::OlaClientService {
   typedef ola::SingleUseCallback0<void> ClosedCallback;
 
   explicit OlaClientCore(ola::io::ConnectedDescriptor *descriptor);
+
+  /**
+   * @brief Create a client that uses an existing RpcChannel.
+   * @param channel the channel to use, ownership is not transferred.
+   */
+  explicit OlaClientCore(ola::rpc::RpcChannel *channel);
+
   ~OlaClientCore();
 
   bool Setup();
@@ -74,6 +82,13 @@ class OlaClientCore: public ola::proto::OlaClientService {
    */
   void SetDMXCallback(RepeatableDMXCallback *callback);
 
+  /**
+   * @brief Set the callback to be run when a polled RDM parameter changes.
+   * Ownership of the callback is transferred to the OlaClientCore.
+   * @param callback the callback to run.
+   */
+  void SetRDMUpdateCallback(RepeatableRDMUpdateCallback *callback);
+
   /**
    * @brief Trigger a plugin reload.
    * @param callback the SetCallback to invoke upon completion.
@@ -306,6 +321,53 @@ class OlaClientCore: public ola::proto::OlaClientService {
               unsigned int data_length,
               const SendRDMArgs& args);
 
+  /**
+   * @brief Fetch a set of PIDs from a set of UIDs.
+   *
+   * A GET request is sent to every UID for each PID. The requests are sent
+   * with a lower priority than RDMGet() and RDMSet() requests.
+   * @param universe the universe to send the commands on
+   * @param uids the UIDs to send the commands to
+   * @param sub_device the sub device index
+   * @param pids the PIDs to fetch
+   * @param callback the RDMBulkGetCallback to run once all the requests have
+   *   completed.
+   */
+  void RDMBulkGet(unsigned int universe,
+                  const std::vector<ola::rdm::UID> &uids,
+                  uint16_t sub_device,
+                  const std::vector<uint16_t> &pids,
+                  RDMBulkGetCallback *callback);
+
+  /**
+   * @brief Send broadcast or vendorcast commands to a set of universes.
+   *
+   * Every command is sent to every universe at once. This is much faster
+   * than sending the commands one at a time when, for example, changing the
+   * DMX start address of the devices on many universes.
+   * @param universes the universes to send the commands on
+   * @param uid the broadcast or vendorcast UID to send the commands to
+   * @param commands the commands to send
+   * @param callback the RDMBroadcastCallback to run once all the commands have
+   *   completed.
+   */
+  void RDMBroadcast(const std::vector<unsigned int> &universes,
+                    const ola::rdm::UID &uid,
+                    const std::vector<RDMBroadcastCommand> &commands,
+                    RDMBroadcastCallback *callback);
+
+  /**
+   * @brief Register for changes to the RDM sensors & status of a universe.
+   * The callback set by SetRDMUpdateCallback() will be called when a polled
+   * parameter changes.
+   * @param universe the id of the universe.
+   * @param register_action the action (register or unregister)
+   * @param callback the SetCallback to invoke upon completion.
+   */
+  void RegisterForRDMUpdates(unsigned int universe,
+                             RegisterAction register_action,
+                             SetCallback *callback);
+
   /**
    * @brief Send TimeCode data.
    * @param timecode The timecode data.
@@ -322,15 +384,33 @@ class OlaClientCore: public ola::proto::OlaClientService {
                      ola::proto::Ack* response,
                      CompletionCallback* done);
 
+  /**
+   * @brief This is called by the channel when a polled RDM parameter changes.
+   */
+  void UpdateRDMParameter(ola::rpc::RpcController* controller,
+                          const ola::proto::RDMParameterUpdate* request,
+                          ola::proto::Ack* response,
+                          CompletionCallback* done);
+
  private:
   ola::io::ConnectedDescriptor *m_descriptor;
+  ola::rpc::RpcChannel *m_external_channel;
   std::auto_ptr<RepeatableDMXCallback> m_dmx_callback;
+  std::auto_ptr<RepeatableRDMUpdateCallback> m_rdm_update_callback;
   std::auto_ptr<ola::rpc::RpcChannel> m_channel;
   std::auto_ptr<ola::proto::OlaServerService_Stub> m_stub;
   int m_connected;
 
   void ChannelClosed(ClosedCallback *callback, ola::rpc::RpcSession *session);
 
+  /**
+   * @brief Return the channel in use, either the one passed in or the one
+   * we created.
+   */
+  ola::rpc::RpcChannel *Channel() {
+    return m_external_channel ? m_external_channel : m_channel.get();
+  }
+
   /**
    * @brief Called when GetPlugins() completes.
    */
@@ -415,6 +495,20 @@ class OlaClientCore: public ola::proto::OlaClientService {
                  ola::proto::RDMResponse *reply,
                  RDMCallback *callback);
 
+  /**
+   * @brief Called when a RDMBulkGet request completes.
+   */
+  void HandleRDMBulkGet(ola::rpc::RpcController *controller,
+                        ola::proto::RDMBulkGetReply *reply,
+                        RDMBulkGetCallback *callback);
+
+  /**
+   * @brief Called when a RDMBroadcast request completes.
+   */
+  void HandleRDMBroadcast(ola::rpc::RpcController *controller,
+                          ola::proto::RDMBroadcastReply *reply,
+                          RDMBroadcastCallback *callback);
+
   /**
    * @brief Fetch a list of candidate ports, with or without a universe
    */
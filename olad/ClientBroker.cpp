@@ -42,7 +42,9 @@ void ClientBroker::RemoveClient(const Client *client) {
 void ClientBroker::SendRDMRequest(const Client *client,
                                   Universe *universe,
                                   ola::rdm::RDMRequest *request,
-                                  ola::rdm::RDMCallback *callback) {
+                                  ola::rdm::RDMCallback *callback,
+                                  Universe::RDMPriority priority,
+                                  bool use_cache) {
   if (!STLContains(m_clients, client)) {
     OLA_WARN << "Making an RDM call but the client doesn't exist in the "
              << "broker!";
@@ -51,7 +53,9 @@ void ClientBroker::SendRDMRequest(const Client *client,
   universe->SendRDMRequest(
       request,
       NewSingleCallback(this, &ClientBroker::RequestComplete, client,
-                        callback));
+                        callback),
+      priority,
+      use_cache);
 }
 
 void ClientBroker::RunRDMDiscovery(const Client *client,
@@ -73,11 +73,18 @@ class ClientBroker {
    * @param request the RDM request.
    * @param callback the callback to run when the request completes. Ownership
    *   is transferred.
+   * @param priority the priority of the request.
+   * @param use_cache true if the request can be answered from the universe's
+   *   RDM response cache. Only background requests should set this, since
+   *   the cached response may be stale.
    */
-  void SendRDMRequest(const Client *client,
-                      Universe *universe,
-                      ola::rdm::RDMRequest *request,
-                      ola::rdm::RDMCallback *callback);
+  void SendRDMRequest(
+      const Client *client,
+      Universe *universe,
+      ola::rdm::RDMRequest *request,
+      ola::rdm::RDMCallback *callback,
+      Universe::RDMPriority priority = Universe::RDM_PRIORITY_INTERACTIVE,
+      bool use_cache = false);
 
   /**
    * @brief Make an RDM call.
@@ -22,7 +22,9 @@ ola_server_sources = \
     olad/PluginLoader.h \
     olad/PluginManager.cpp \
     olad/PluginManager.h \
-    olad/RDMHTTPModule.h
+    olad/RDMHTTPModule.h \
+    olad/RDMPoller.cpp \
+    olad/RDMPoller.h
 ola_server_additional_libs =
 
 if HAVE_DNSSD
@@ -76,6 +78,14 @@ if USE_FTDI
 olad_olad_LDADD += -lftdi -lusb
 endif
 
+noinst_PROGRAMS += olad/get_dmx_loadtest
+olad_get_dmx_loadtest_SOURCES = olad/get_dmx_loadtest.cpp
+olad_get_dmx_loadtest_LDADD = $(libprotobuf_LIBS) \
+                              olad/plugin_api/libolaserverplugininterface.la \
+                              olad/libolaserver.la \
+                              common/libolacommon.la \
+                              ola/libola.la
+
 # TESTS
 ##################################################
 test_programs += \
@@ -88,7 +98,8 @@ COMMON_OLAD_TEST_LDADD = $(COMMON_TESTING_LIBS) $(libprotobuf_LIBS) \
 
 olad_OlaTester_SOURCES = \
     olad/PluginManagerTest.cpp \
-    olad/OlaServerServiceImplTest.cpp
+    olad/OlaServerServiceImplTest.cpp \
+    olad/RDMPollerTest.cpp
 olad_OlaTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 olad_OlaTester_LDADD = $(COMMON_OLAD_TEST_LDADD)
 
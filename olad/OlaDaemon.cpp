@@ -50,6 +50,8 @@
 DEFINE_s_string(config_dir, c, "",
                 "The path to the config directory, Defaults to ~/.ola/ " \
                 "on *nix and %LOCALAPPDATA%\\.ola\\ on Windows.");
+DEFINE_default_bool(pid_cache, true,
+                    "Disable the binary cache of the PID definitions.");
 
 namespace ola {
 
@@ -63,6 +65,7 @@ using std::string;
 
 const char OlaDaemon::OLA_CONFIG_DIR[] = ".ola";
 const char OlaDaemon::CONFIG_DIR_KEY[] = "config-dir";
+const char OlaDaemon::PID_CACHE_FILE[] = "pids.cache";
 const char OlaDaemon::UID_KEY[] = "uid";
 const char OlaDaemon::GID_KEY[] = "gid";
 const char OlaDaemon::USER_NAME_KEY[] = "user";
@@ -125,12 +128,19 @@ bool OlaDaemon::Init() {
   auto_ptr<PreferencesFactory> preferences_factory(
       new FileBackedPreferencesFactory(config_dir));
 
+  OlaServer::Options options = m_options;
+  if (!FLAGS_pid_cache) {
+    options.pid_cache_file.clear();
+  } else if (options.pid_cache_file.empty()) {
+    options.pid_cache_file = ola::file::JoinPaths(config_dir, PID_CACHE_FILE);
+  }
+
   // Order is important here as we won't load the same plugin twice.
   m_plugin_loaders.push_back(new DynamicPluginLoader());
 
   auto_ptr<OlaServer> server(
       new OlaServer(m_plugin_loaders,
-                    preferences_factory.get(), &m_ss, m_options,
+                    preferences_factory.get(), &m_ss, options,
                     NULL, m_export_map));
 
   bool ok = server->Init();
@@ -101,6 +101,7 @@ class OlaDaemon {
 
   static const char OLA_CONFIG_DIR[];
   static const char CONFIG_DIR_KEY[];
+  static const char PID_CACHE_FILE[];
   static const char UID_KEY[];
   static const char USER_NAME_KEY[];
   static const char GID_KEY[];
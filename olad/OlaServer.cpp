@@ -43,6 +43,8 @@
 #include "ola/rdm/PidStore.h"
 #include "ola/rdm/UID.h"
 #include "ola/stl/STLUtils.h"
+#include "ola/thread/DmxFrameTimer.h"
+#include "ola/thread/Thread.h"
 #include "olad/ClientBroker.h"
 #include "olad/DiscoveryAgent.h"
 #include "olad/OlaServer.h"
@@ -53,6 +55,7 @@
 #include "olad/Port.h"
 #include "olad/PortBroker.h"
 #include "olad/Preferences.h"
+#include "olad/RDMPoller.h"
 #include "olad/Universe.h"
 #include "olad/plugin_api/Client.h"
 #include "olad/plugin_api/DeviceManager.h"
@@ -103,7 +106,8 @@ OlaServer::OlaServer(const vector<PluginLoader*> &plugin_loaders,
       m_default_uid(OPEN_LIGHTING_ESTA_CODE, 0),
       m_server_preferences(NULL),
       m_universe_preferences(NULL),
-      m_housekeeping_timeout(ola::thread::INVALID_TIMEOUT) {
+      m_housekeeping_timeout(ola::thread::INVALID_TIMEOUT),
+      m_rdm_poll_timeout(ola::thread::INVALID_TIMEOUT) {
   if (!m_export_map) {
     m_our_export_map.reset(new ExportMap());
     m_export_map = m_our_export_map.get();
@@ -128,8 +132,13 @@ OlaServer::~OlaServer() {
     m_ss->RemoveTimeout(m_housekeeping_timeout);
   }
 
+  if (m_rdm_poll_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_ss->RemoveTimeout(m_rdm_poll_timeout);
+  }
+
   StopPlugins();
 
+  m_rdm_poller.reset();
   m_broker.reset();
   m_port_broker.reset();
 
@@ -168,7 +177,8 @@ bool OlaServer::Init() {
   }
 
   auto_ptr<const RootPidStore> pid_store(
-      RootPidStore::LoadFromDirectory(m_options.pid_data_dir));
+      RootPidStore::LoadFromDirectory(m_options.pid_data_dir, true,
+                                      m_options.pid_cache_file));
   if (!pid_store.get()) {
     OLA_WARN << "No PID definitions loaded";
   }
@@ -219,6 +229,9 @@ bool OlaServer::Init() {
 
   auto_ptr<ClientBroker> broker(new ClientBroker());
 
+  auto_ptr<RDMPoller> rdm_poller(
+      new RDMPoller(universe_store.get(), &m_clock, m_default_uid));
+
   auto_ptr<DeviceManager> device_manager(
       new DeviceManager(m_preferences_factory, port_manager.get()));
 
@@ -236,6 +249,7 @@ bool OlaServer::Init() {
       plugin_manager.get(),
       port_manager.get(),
       broker.get(),
+      rdm_poller.get(),
       m_ss->WakeUpTime(),
       NewCallback(this, &OlaServer::ReloadPluginsInternal)));
 
@@ -269,8 +283,9 @@ bool OlaServer::Init() {
   bool web_server_started = false;
 
   // Initializing the web server causes a call to NewClient. We need to have
-  // the broker in place for the call, otherwise we'll segfault.
+  // the broker & poller in place for the call, otherwise we'll segfault.
   m_broker.reset(broker.release());
+  m_rdm_poller.reset(rdm_poller.release());
 
 #ifdef HAVE_LIBMICROHTTPD
   if (m_options.http_enable) {
@@ -316,6 +331,14 @@ bool OlaServer::Init() {
       K_HOUSEKEEPING_TIMEOUT_MS,
       ola::NewCallback(this, &OlaServer::RunHousekeeping));
 
+  if (m_rdm_poll_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_ss->RemoveTimeout(m_rdm_poll_timeout);
+  }
+
+  m_rdm_poll_timeout = m_ss->RegisterRepeatingTimeout(
+      RDMPoller::POLL_TICK_MS,
+      ola::NewCallback(this, &OlaServer::RunRDMPoll));
+
   // The plugin load procedure can take a while so we run it in the main loop.
   m_ss->Execute(
       ola::NewSingleCallback(m_plugin_manager.get(), &PluginManager::LoadAll));
@@ -331,7 +354,7 @@ void OlaServer::ReloadPidStore() {
   // We load the PIDs in this thread, and then hand the RootPidStore over to
   // the main thread. This avoids doing disk I/O in the network thread.
   const RootPidStore* pid_store = RootPidStore::LoadFromDirectory(
-      m_options.pid_data_dir);
+      m_options.pid_data_dir, true, m_options.pid_cache_file);
   if (!pid_store) {
     return;
   }
@@ -366,6 +389,7 @@ void OlaServer::ClientRemoved(RpcSession *session) {
   session->SetData(NULL);
 
   m_broker->RemoveClient(client.get());
+  m_rdm_poller->RemoveClient(client.get());
 
   vector<Universe*> universe_list;
   m_universe_store->GetList(&universe_list);
@@ -384,6 +408,8 @@ void OlaServer::ClientRemoved(RpcSession *session) {
 bool OlaServer::RunHousekeeping() {
   OLA_DEBUG << "Garbage collecting";
   m_universe_store->GarbageCollectUniverses();
+  ola::thread::Thread::ExportSchedulingStats(m_export_map);
+  ola::thread::DmxFrameTimer::ExportStats(m_export_map);
 
   // Give the universes an opportunity to run discovery
   vector<Universe*> universes;
@@ -403,6 +429,14 @@ bool OlaServer::RunHousekeeping() {
   return true;
 }
 
+/*
+ * Send any RDM poll requests that are due.
+ */
+bool OlaServer::RunRDMPoll() {
+  m_rdm_poller->Poll();
+  return true;
+}
+
 #ifdef HAVE_LIBMICROHTTPD
 bool OlaServer::StartHttpServer(ola::rpc::RpcServer *server,
                                 const ola::network::Interface &iface) {
@@ -410,36 +444,23 @@ bool OlaServer::StartHttpServer(ola::rpc::RpcServer *server,
     return true;
   }
 
-  // create a pipe for the HTTP server to communicate with the main
-  // server on.
-  auto_ptr<ola::io::PipeDescriptor> pipe_descriptor(
-      new ola::io::PipeDescriptor());
-  if (!pipe_descriptor->Init()) {
-    return false;
-  }
-
-  // ownership of the pipe_descriptor is transferred here.
   OladHTTPServer::OladHTTPServerOptions options;
   options.port = m_options.http_port ? m_options.http_port : DEFAULT_HTTP_PORT;
   options.data_dir = (m_options.http_data_dir.empty() ? HTTP_DATA_DIR :
                       m_options.http_data_dir);
   options.enable_quit = m_options.http_enable_quit;
 
+  // The HTTP server's OlaClient is attached to the RPC server with an
+  // in-process channel, rather than a pipe.
   auto_ptr<OladHTTPServer> httpd(
-      new OladHTTPServer(m_export_map, options,
-                         pipe_descriptor->OppositeEnd(),
-                         this, iface));
-
-  if (httpd->Init()) {
-    httpd->Start();
-    // register the pipe descriptor as a client
-    InternalNewConnection(server, pipe_descriptor.release());
-    m_httpd.reset(httpd.release());
-    return true;
-  } else {
-    pipe_descriptor->Close();
+      new OladHTTPServer(m_export_map, options, server, this, iface));
+
+  if (!httpd->Init()) {
     return false;
   }
+  httpd->Start();
+  m_httpd.reset(httpd.release());
+  return true;
 }
 #endif
 
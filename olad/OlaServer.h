@@ -72,6 +72,13 @@ class OlaServer : public ola::rpc::RpcSessionHandlerInterface {
     std::string http_data_dir;
     std::string network_interface;
     std::string pid_data_dir;  /** @brief Directory with the PID definitions */
+    /**
+     * @brief The binary cache of the PID definitions, empty to disable.
+     *
+     * OlaDaemon defaults this to pids.cache in the config directory, unless
+     * --no-pid-cache is passed.
+     */
+    std::string pid_cache_file;
   };
 
   /**
@@ -180,6 +187,7 @@ class OlaServer : public ola::rpc::RpcSessionHandlerInterface {
 
   std::auto_ptr<class ExportMap> m_our_export_map;
   ola::rdm::UID m_default_uid;
+  Clock m_clock;
 
   // These are all populated in Init.
   std::auto_ptr<class DeviceManager> m_device_manager;
@@ -189,6 +197,7 @@ class OlaServer : public ola::rpc::RpcSessionHandlerInterface {
   std::auto_ptr<class PortManager> m_port_manager;
   std::auto_ptr<class OlaServerServiceImpl> m_service_impl;
   std::auto_ptr<class ClientBroker> m_broker;
+  std::auto_ptr<class RDMPoller> m_rdm_poller;
   std::auto_ptr<class PortBroker> m_port_broker;
   std::auto_ptr<const ola::rdm::RootPidStore> m_pid_store;
   std::auto_ptr<class DiscoveryAgentInterface> m_discovery_agent;
@@ -198,9 +207,11 @@ class OlaServer : public ola::rpc::RpcSessionHandlerInterface {
   std::string m_instance_name;
 
   ola::thread::timeout_id m_housekeeping_timeout;
+  ola::thread::timeout_id m_rdm_poll_timeout;
   std::auto_ptr<OladHTTPServer_t> m_httpd;
 
   bool RunHousekeeping();
+  bool RunRDMPoll();
 
 #ifdef HAVE_LIBMICROHTTPD
   bool StartHttpServer(ola::rpc::RpcServer *server,
@@ -40,10 +40,12 @@
 #include "olad/Plugin.h"
 #include "olad/PluginManager.h"
 #include "olad/Port.h"
+#include "olad/RDMPoller.h"
 #include "olad/Universe.h"
 #include "olad/plugin_api/Client.h"
 #include "olad/plugin_api/DeviceManager.h"
 #include "olad/plugin_api/PortManager.h"
+#include "olad/plugin_api/RDMScheduler.h"
 #include "olad/plugin_api/UniverseStore.h"
 
 namespace ola {
@@ -66,6 +68,7 @@ using ola::proto::PluginListReply;
 using ola::proto::PluginListRequest;
 using ola::proto::PortInfo;
 using ola::proto::RegisterDmxRequest;
+using ola::proto::RegisterRDMUpdatesRequest;
 using ola::proto::UniverseInfo;
 using ola::proto::UniverseInfoReply;
 using ola::proto::UniverseNameRequest;
@@ -116,6 +119,7 @@ OlaServerServiceImpl::OlaServerServiceImpl(
     PluginManager *plugin_manager,
     PortManager *port_manager,
     ClientBroker *broker,
+    RDMPoller *rdm_poller,
     const TimeStamp *wake_up_time,
     ReloadPluginsCallback *reload_plugins_callback)
     : m_universe_store(universe_store),
@@ -123,6 +127,7 @@ OlaServerServiceImpl::OlaServerServiceImpl(
       m_plugin_manager(plugin_manager),
       m_port_manager(port_manager),
       m_broker(broker),
+      m_rdm_poller(rdm_poller),
       m_wake_up_time(wake_up_time),
       m_reload_plugins_callback(reload_plugins_callback) {
 }
@@ -761,6 +766,8 @@ void OlaServerServiceImpl::RDMCommand(
         done,
         request->include_raw_response());
 
+  // Interactive requests always go to the responder, so they never return a
+  // stale cached response.
   m_broker->SendRDMRequest(client, universe, rdm_request, callback);
 }
 
@@ -806,6 +813,186 @@ void OlaServerServiceImpl::RDMDiscoveryCommand(
   m_broker->SendRDMRequest(client, universe, rdm_request, callback);
 }
 
+void OlaServerServiceImpl::RDMBulkGet(
+    RpcController* controller,
+    const ola::proto::RDMBulkGetRequest* request,
+    ola::proto::RDMBulkGetReply* response,
+    ola::rpc::RpcService::CompletionCallback* done) {
+  Universe *universe = m_universe_store->GetUniverse(request->universe());
+  if (!universe) {
+    MissingUniverseError(controller);
+    done->Run();
+    return;
+  }
+
+  // Check the sizes separately, so the product can't overflow.
+  const unsigned int uid_count = request->uid_size();
+  const unsigned int param_id_count = request->param_id_size();
+  if (uid_count > MAX_BULK_GET_REQUESTS ||
+      param_id_count > MAX_BULK_GET_REQUESTS ||
+      uid_count * param_id_count > MAX_BULK_GET_REQUESTS) {
+    controller->SetFailed("Too many requests");
+    done->Run();
+    return;
+  }
+  const unsigned int request_count = uid_count * param_id_count;
+
+  // If the RDMScheduler's queue overflows the extra requests fail with
+  // RDM_FAILED_TO_SEND, which the caller can't tell apart from a send error.
+  // Reject the whole call instead, so it can be retried later.
+  if (universe->QueuedRDMRequests() + request_count >
+      RDMScheduler::MAX_QUEUE_SIZE) {
+    controller->SetFailed("RDM queue full");
+    done->Run();
+    return;
+  }
+
+  Client *client = GetClient(controller);
+  UID source_uid = client->GetUID();
+
+  // The extra count is released once all the requests have been sent, since
+  // the requests may complete synchronously.
+  BulkGetTracker *tracker = new BulkGetTracker;
+  tracker->done = done;
+  tracker->outstanding = request_count + 1;
+
+  for (int i = 0; i < request->uid_size(); i++) {
+    UID destination(request->uid(i).esta_id(),
+                    request->uid(i).device_id());
+
+    for (int j = 0; j < request->param_id_size(); j++) {
+      ola::proto::RDMBulkGetResult *result = response->add_result();
+      result->mutable_uid()->CopyFrom(request->uid(i));
+      result->set_param_id(request->param_id(j));
+
+      ola::rdm::RDMRequest *rdm_request = new ola::rdm::RDMGetRequest(
+          source_uid,
+          destination,
+          0,  // transaction #
+          1,  // port id
+          request->sub_device(),
+          request->param_id(j),
+          NULL,
+          0);
+
+      ola::rdm::RDMCallback *callback = NewSingleCallback(
+          this,
+          &OlaServerServiceImpl::HandleBulkGetResponse,
+          tracker,
+          result->mutable_response(),
+          request->include_raw_response());
+
+      m_broker->SendRDMRequest(client, universe, rdm_request, callback,
+                               Universe::RDM_PRIORITY_BACKGROUND,
+                               !request->include_raw_response());
+    }
+  }
+  BulkGetRequestComplete(tracker);
+}
+
+void OlaServerServiceImpl::RDMBroadcast(
+    RpcController* controller,
+    const ola::proto::RDMBroadcastRequest* request,
+    ola::proto::RDMBroadcastReply* response,
+    ola::rpc::RpcService::CompletionCallback* done) {
+  UID destination = UID::AllDevices();
+  if (request->has_uid()) {
+    destination = UID(request->uid().esta_id(), request->uid().device_id());
+  }
+  if (!destination.IsBroadcast()) {
+    controller->SetFailed("Not a broadcast UID");
+    done->Run();
+    return;
+  }
+
+  // Check the sizes separately, so the product can't overflow.
+  const unsigned int universe_count = request->universe_size();
+  const unsigned int command_count = request->command_size();
+  if (universe_count > MAX_BROADCAST_REQUESTS ||
+      command_count > MAX_BROADCAST_REQUESTS ||
+      universe_count * command_count > MAX_BROADCAST_REQUESTS) {
+    controller->SetFailed("Too many requests");
+    done->Run();
+    return;
+  }
+  const unsigned int request_count = universe_count * command_count;
+
+  vector<Universe*> universes;
+  universes.reserve(request->universe_size());
+  for (int i = 0; i < request->universe_size(); i++) {
+    Universe *universe = m_universe_store->GetUniverse(request->universe(i));
+    if (!universe) {
+      MissingUniverseError(controller);
+      done->Run();
+      return;
+    }
+    universes.push_back(universe);
+  }
+
+  Client *client = GetClient(controller);
+  UID source_uid = client->GetUID();
+
+  // The extra count is released once all the commands have been sent, since
+  // broadcasts often complete synchronously.
+  BroadcastTracker *tracker = new BroadcastTracker;
+  tracker->done = done;
+  tracker->response = response;
+  tracker->start = *m_wake_up_time;
+  tracker->outstanding = request_count + 1;
+
+  for (unsigned int i = 0; i < universes.size(); i++) {
+    for (int j = 0; j < request->command_size(); j++) {
+      const ola::proto::RDMBroadcastCommand &command = request->command(j);
+      ola::proto::RDMBroadcastResult *result = response->add_result();
+      result->set_universe(request->universe(i));
+      result->set_command(j);
+      result->set_response_code(ola::proto::RDM_WAS_BROADCAST);
+      result->set_duration(0);
+
+      ola::rdm::RDMRequest *rdm_request = new ola::rdm::RDMSetRequest(
+          source_uid,
+          destination,
+          0,  // transaction #
+          1,  // port id
+          command.sub_device(),
+          command.param_id(),
+          reinterpret_cast<const uint8_t*>(command.data().data()),
+          command.data().size());
+
+      ola::rdm::RDMCallback *callback = NewSingleCallback(
+          this,
+          &OlaServerServiceImpl::HandleBroadcastResponse,
+          tracker,
+          result);
+
+      m_broker->SendRDMRequest(client, universes[i], rdm_request, callback);
+    }
+  }
+  BroadcastRequestComplete(tracker);
+}
+
+void OlaServerServiceImpl::RegisterForRDMUpdates(
+    RpcController* controller,
+    const RegisterRDMUpdatesRequest* request,
+    Ack*,
+    ola::rpc::RpcService::CompletionCallback* done) {
+  ClosureRunner runner(done);
+  if (!m_rdm_poller) {
+    controller->SetFailed("RDM polling isn't available");
+    return;
+  }
+
+  Client *client = GetClient(controller);
+  if (request->action() == ola::proto::REGISTER) {
+    if (!m_universe_store->GetUniverse(request->universe())) {
+      return MissingUniverseError(controller);
+    }
+    m_rdm_poller->Subscribe(client, request->universe());
+  } else {
+    m_rdm_poller->Unsubscribe(client, request->universe());
+  }
+}
+
 void OlaServerServiceImpl::SetSourceUID(
     RpcController *controller,
     const ola::proto::UID* request,
@@ -850,6 +1037,67 @@ void OlaServerServiceImpl::HandleRDMResponse(
     bool include_raw_packets,
     ola::rdm::RDMReply *reply) {
   ClosureRunner runner(done);
+  PopulateRDMResponse(response, include_raw_packets, reply);
+}
+
+/*
+ * Handle the response to one of the requests from a RDMBulkGet call.
+ */
+void OlaServerServiceImpl::HandleBulkGetResponse(
+    BulkGetTracker *tracker,
+    ola::proto::RDMResponse* response,
+    bool include_raw_packets,
+    ola::rdm::RDMReply *reply) {
+  PopulateRDMResponse(response, include_raw_packets, reply);
+  BulkGetRequestComplete(tracker);
+}
+
+void OlaServerServiceImpl::BulkGetRequestComplete(BulkGetTracker *tracker) {
+  if (--tracker->outstanding == 0) {
+    tracker->done->Run();
+    delete tracker;
+  }
+}
+
+/*
+ * Handle the completion of one of the commands from a RDMBroadcast call.
+ */
+void OlaServerServiceImpl::HandleBroadcastResponse(
+    BroadcastTracker *tracker,
+    ola::proto::RDMBroadcastResult *result,
+    ola::rdm::RDMReply *reply) {
+  result->set_response_code(
+      static_cast<ola::proto::RDMResponseCode>(reply->StatusCode()));
+  result->set_duration(MicroSecondsSince(tracker->start));
+  BroadcastRequestComplete(tracker);
+}
+
+void OlaServerServiceImpl::BroadcastRequestComplete(
+    BroadcastTracker *tracker) {
+  if (--tracker->outstanding == 0) {
+    tracker->response->set_duration(MicroSecondsSince(tracker->start));
+    tracker->done->Run();
+    delete tracker;
+  }
+}
+
+/*
+ * The wake up time is when the SelectServer last returned, which is when the
+ * event that completed the request was received.
+ */
+uint32_t OlaServerServiceImpl::MicroSecondsSince(
+    const TimeStamp &start) const {
+  const int64_t duration = (*m_wake_up_time - start).AsInt();
+  return duration > 0 ? static_cast<uint32_t>(duration) : 0;
+}
+
+/*
+ * Copy a RDMReply into the RDMResponse protobuf.
+ */
+void OlaServerServiceImpl::PopulateRDMResponse(
+    ola::proto::RDMResponse* response,
+    bool include_raw_packets,
+    ola::rdm::RDMReply *reply) {
   response->set_response_code(
       static_cast<ola::proto::RDMResponseCode>(reply->StatusCode()));
 
@@ -24,6 +24,7 @@
 #include "common/protocol/Ola.pb.h"
 #include "common/protocol/OlaService.pb.h"
 #include "ola/Callback.h"
+#include "ola/Clock.h"
 #include "ola/rdm/RDMCommand.h"
 #include "ola/rdm/RDMControllerInterface.h"
 #include "ola/rdm/UID.h"
@@ -62,6 +63,7 @@ class OlaServerServiceImpl : public ola::proto::OlaServerService {
                        class PluginManager *plugin_manager,
                        class PortManager *port_manager,
                        class ClientBroker *broker,
+                       class RDMPoller *rdm_poller,
                        const class TimeStamp *wake_up_time,
                        ReloadPluginsCallback *reload_plugins_callback);
 
@@ -243,6 +245,40 @@ class OlaServerServiceImpl : public ola::proto::OlaServerService {
                            ola::proto::RDMResponse* response,
                            ola::rpc::RpcService::CompletionCallback* done);
 
+  /**
+   * @brief Fetch a set of PIDs from a set of UIDs.
+   *
+   * The requests are sent with background priority, so they don't delay
+   * RDMCommand requests. The response is sent once all the requests have
+   * completed.
+   */
+  void RDMBulkGet(ola::rpc::RpcController* controller,
+                  const ::ola::proto::RDMBulkGetRequest* request,
+                  ola::proto::RDMBulkGetReply* response,
+                  ola::rpc::RpcService::CompletionCallback* done);
+
+  /**
+   * @brief Send broadcast or vendorcast commands to a set of universes.
+   *
+   * Every command is sent to every universe at once, the universes fan each
+   * command out to all of their ports. The response is sent once all the
+   * commands have completed, and includes the time each one took. Only SET
+   * commands are accepted.
+   */
+  void RDMBroadcast(ola::rpc::RpcController* controller,
+                    const ::ola::proto::RDMBroadcastRequest* request,
+                    ola::proto::RDMBroadcastReply* response,
+                    ola::rpc::RpcService::CompletionCallback* done);
+
+  /**
+   * @brief Register a client to receive changes to polled RDM parameters.
+   */
+  void RegisterForRDMUpdates(
+      ola::rpc::RpcController* controller,
+      const ::ola::proto::RegisterRDMUpdatesRequest* request,
+      ola::proto::Ack* response,
+      ola::rpc::RpcService::CompletionCallback* done);
+
   /**
    * @brief Set this client's source UID.
    */
@@ -260,10 +296,41 @@ class OlaServerServiceImpl : public ola::proto::OlaServerService {
                     ola::rpc::RpcService::CompletionCallback* done);
 
  private:
+  /**
+   * @brief Tracks the outstanding requests for a RDMBulkGet call.
+   */
+  struct BulkGetTracker {
+    ola::rpc::RpcService::CompletionCallback *done;
+    unsigned int outstanding;
+  };
+
+  /**
+   * @brief Tracks the outstanding commands for a RDMBroadcast call.
+   */
+  struct BroadcastTracker {
+    ola::rpc::RpcService::CompletionCallback *done;
+    ola::proto::RDMBroadcastReply *response;
+    TimeStamp start;
+    unsigned int outstanding;
+  };
+
   void HandleRDMResponse(ola::proto::RDMResponse* response,
                          ola::rpc::RpcService::CompletionCallback* done,
                          bool include_raw_packets,
                          ola::rdm::RDMReply *reply);
+  void HandleBulkGetResponse(BulkGetTracker *tracker,
+                             ola::proto::RDMResponse* response,
+                             bool include_raw_packets,
+                             ola::rdm::RDMReply *reply);
+  void BulkGetRequestComplete(BulkGetTracker *tracker);
+  void HandleBroadcastResponse(BroadcastTracker *tracker,
+                               ola::proto::RDMBroadcastResult *result,
+                               ola::rdm::RDMReply *reply);
+  void BroadcastRequestComplete(BroadcastTracker *tracker);
+  uint32_t MicroSecondsSince(const TimeStamp &start) const;
+  void PopulateRDMResponse(ola::proto::RDMResponse* response,
+                           bool include_raw_packets,
+                           ola::rdm::RDMReply *reply);
   void RDMDiscoveryComplete(unsigned int universe,
                             ola::rpc::RpcService::CompletionCallback* done,
                             ola::proto::UIDListReply *response,
@@ -295,8 +362,17 @@ class OlaServerServiceImpl : public ola::proto::OlaServerService {
   class PluginManager *m_plugin_manager;
   class PortManager *m_port_manager;
   class ClientBroker *m_broker;
+  class RDMPoller *m_rdm_poller;
   const class TimeStamp *m_wake_up_time;
   std::auto_ptr<ReloadPluginsCallback> m_reload_plugins_callback;
+
+  // The maximum number of UID x PID requests in a single RDMBulkGet call.
+  // This is well below RDMScheduler::MAX_QUEUE_SIZE so that several bulk gets
+  // can be queued for a port at once.
+  static const unsigned int MAX_BULK_GET_REQUESTS = 250;
+  // The maximum number of universe x command requests in a single
+  // RDMBroadcast call.
+  static const unsigned int MAX_BROADCAST_REQUESTS = 1000;
 };
 }  // namespace ola
 #endif  // OLAD_OLASERVERSERVICEIMPL_H_
@@ -24,6 +24,8 @@
 
 #include <cppunit/extensions/HelperMacros.h>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/rpc/RpcController.h"
 #include "common/rpc/RpcSession.h"
@@ -33,13 +35,18 @@
 #include "ola/DmxBuffer.h"
 #include "ola/ExportMap.h"
 #include "ola/Logging.h"
+#include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/RDMReply.h"
 #include "ola/rdm/UID.h"
+#include "ola/rdm/UIDSet.h"
 #include "ola/testing/TestUtils.h"
+#include "olad/ClientBroker.h"
 #include "olad/OlaServerServiceImpl.h"
 #include "olad/PluginLoader.h"
 #include "olad/Universe.h"
 #include "olad/plugin_api/Client.h"
 #include "olad/plugin_api/DeviceManager.h"
+#include "olad/plugin_api/TestCommon.h"
 #include "olad/plugin_api/UniverseStore.h"
 
 using ola::Client;
@@ -49,9 +56,13 @@ using ola::DmxBuffer;
 using ola::OlaServerServiceImpl;
 using ola::Universe;
 using ola::UniverseStore;
+using ola::rdm::RDMCallback;
+using ola::rdm::RDMRequest;
+using ola::rdm::UID;
 using ola::rpc::RpcController;
 using ola::rpc::RpcSession;
 using std::string;
+using std::vector;
 
 class OlaServerServiceImplTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(OlaServerServiceImplTest);
@@ -60,6 +71,8 @@ class OlaServerServiceImplTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testUpdateDmxData);
   CPPUNIT_TEST(testSetUniverseName);
   CPPUNIT_TEST(testSetMergeMode);
+  CPPUNIT_TEST(testRDMBulkGet);
+  CPPUNIT_TEST(testRDMBroadcast);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -76,10 +89,23 @@ class OlaServerServiceImplTest: public CppUnit::TestFixture {
     void testUpdateDmxData();
     void testSetUniverseName();
     void testSetMergeMode();
+    void testRDMBulkGet();
+    void testRDMBroadcast();
 
  private:
     ola::rdm::UID m_uid;
     ola::Clock m_clock;
+    vector<std::pair<const RDMRequest*, RDMCallback*> > m_deferred_requests;
+
+    void DeferRDMRequest(const RDMRequest *request, RDMCallback *callback) {
+      m_deferred_requests.push_back(std::make_pair(request, callback));
+    }
+
+    void CompleteDeferredRequest(unsigned int i,
+                                 ola::rdm::RDMStatusCode status_code) {
+      delete m_deferred_requests[i].first;
+      ola::rdm::RunRDMCallback(m_deferred_requests[i].second, status_code);
+    }
 
     void CallGetDmx(OlaServerServiceImpl *service,
                     int universe_id,
@@ -187,6 +213,73 @@ class SetMergeModeCheck {
 };
 
 
+/*
+ * Make a RDMBulkGet call and hold the reply, since the call may complete
+ * asynchronously.
+ */
+class RDMBulkGetCall {
+ public:
+  explicit RDMBulkGetCall(Client *client)
+      : m_session(NULL),
+        m_controller(&m_session),
+        m_done(false) {
+    m_session.SetData(client);
+  }
+
+  void Send(OlaServerServiceImpl *service,
+            const ola::proto::RDMBulkGetRequest &request) {
+    service->RDMBulkGet(
+        &m_controller, &request, &m_reply,
+        NewSingleCallback(this, &RDMBulkGetCall::Done));
+  }
+
+  bool IsDone() const { return m_done; }
+  RpcController *Controller() { return &m_controller; }
+
+ private:
+  RpcSession m_session;
+  RpcController m_controller;
+  ola::proto::RDMBulkGetReply m_reply;
+  bool m_done;
+
+  void Done() { m_done = true; }
+};
+
+
+/*
+ * Make a RDMBroadcast call and hold the reply, since the call may complete
+ * asynchronously.
+ */
+class RDMBroadcastCall {
+ public:
+  explicit RDMBroadcastCall(Client *client)
+      : m_session(NULL),
+        m_controller(&m_session),
+        m_done(false) {
+    m_session.SetData(client);
+  }
+
+  void Send(OlaServerServiceImpl *service,
+            const ola::proto::RDMBroadcastRequest &request) {
+    service->RDMBroadcast(
+        &m_controller, &request, &m_reply,
+        NewSingleCallback(this, &RDMBroadcastCall::Done));
+  }
+
+  bool IsDone() const { return m_done; }
+  RpcController *Controller() { return &m_controller; }
+  const ola::proto::RDMBroadcastReply &Reply() const { return m_reply; }
+
+ private:
+  RpcSession m_session;
+  RpcController m_controller;
+  ola::proto::RDMBroadcastReply m_reply;
+  bool m_done;
+
+  void Done() { m_done = true; }
+};
+
+
 /*
  * Assert that we got a missing universe error
  */
@@ -217,7 +310,8 @@ class GenericAckCheck: public parent {
  */
 void OlaServerServiceImplTest::testGetDmx() {
   UniverseStore store(NULL, NULL);
-  OlaServerServiceImpl service(&store, NULL, NULL, NULL, NULL, NULL, NULL);
+  OlaServerServiceImpl service(&store, NULL, NULL, NULL, NULL, NULL, NULL,
+                               NULL);
 
   GenericMissingUniverseCheck<GetDmxCheck, ola::proto::DmxData>
     missing_universe_check;
@@ -274,7 +368,8 @@ void OlaServerServiceImplTest::CallGetDmx(OlaServerServiceImpl *service,
  */
 void OlaServerServiceImplTest::testRegisterForDmx() {
   UniverseStore store(NULL, NULL);
-  OlaServerServiceImpl service(&store, NULL, NULL, NULL, NULL, NULL, NULL);
+  OlaServerServiceImpl service(&store, NULL, NULL, NULL, NULL, NULL, NULL,
+                               NULL);
 
   // Register for a universe that doesn't exist
   unsigned int universe_id = 0;
@@ -355,7 +450,7 @@ void OlaServerServiceImplTest::testUpdateDmxData() {
   ola::TimeStamp time1;
   ola::Client client1(NULL, m_uid);
   ola::Client client2(NULL, m_uid);
-  OlaServerServiceImpl service(&store, NULL, NULL, NULL, NULL,
+  OlaServerServiceImpl service(&store, NULL, NULL, NULL, NULL, NULL,
                                &time1, NULL);
 
   GenericMissingUniverseCheck<UpdateDmxDataCheck, ola::proto::Ack>
@@ -427,7 +522,8 @@ void OlaServerServiceImplTest::CallUpdateDmxData(
  */
 void OlaServerServiceImplTest::testSetUniverseName() {
   UniverseStore store(NULL, NULL);
-  OlaServerServiceImpl service(&store, NULL, NULL, NULL, NULL, NULL, NULL);
+  OlaServerServiceImpl service(&store, NULL, NULL, NULL, NULL, NULL, NULL,
+                               NULL);
 
   unsigned int universe_id = 0;
   string universe_name = "test 1";
@@ -485,7 +581,8 @@ void OlaServerServiceImplTest::CallSetUniverseName(
  */
 void OlaServerServiceImplTest::testSetMergeMode() {
   UniverseStore store(NULL, NULL);
-  OlaServerServiceImpl service(&store, NULL, NULL, NULL, NULL, NULL, NULL);
+  OlaServerServiceImpl service(&store, NULL, NULL, NULL, NULL, NULL, NULL,
+                               NULL);
 
   unsigned int universe_id = 0;
 
@@ -535,3 +632,215 @@ void OlaServerServiceImplTest::CallSetMergeMode(
   request.set_merge_mode(merge_mode);
   service->SetMergeMode(&controller, &request, &response, closure);
 }
+
+/*
+ * Check the RDMBulkGet method limits the number of requests.
+ */
+void OlaServerServiceImplTest::testRDMBulkGet() {
+  UniverseStore store(NULL, NULL);
+  ola::ClientBroker broker;
+  OlaServerServiceImpl service(&store, NULL, NULL, NULL, &broker, NULL,
+                               NULL, NULL);
+  Client client(NULL, m_uid);
+  broker.AddClient(&client);
+
+  UID uid(ola::OPEN_LIGHTING_ESTA_CODE, 1);
+  ola::rdm::UIDSet uids;
+  uids.AddUID(uid);
+
+  Universe *universe = store.GetUniverseOrCreate(1);
+  TestMockRDMOutputPort port(
+      NULL, 1, &uids, false,
+      ola::NewCallback(this, &OlaServerServiceImplTest::DeferRDMRequest));
+  universe->AddPort(&port);
+  port.SetUniverse(universe);
+  universe->NewUIDList(&port, uids);
+
+  ola::proto::RDMBulkGetRequest request;
+  request.set_universe(1);
+  request.set_include_raw_response(true);
+  ola::proto::UID *request_uid = request.add_uid();
+  request_uid->set_esta_id(uid.ManufacturerId());
+  request_uid->set_device_id(uid.DeviceId());
+
+  // Too many requests
+  {
+    ola::proto::RDMBulkGetRequest large_request(request);
+    for (unsigned int i = 0; i < 251; i++) {
+      large_request.add_param_id(ola::rdm::PID_IDENTIFY_DEVICE);
+    }
+    RDMBulkGetCall call(&client);
+    call.Send(&service, large_request);
+    OLA_ASSERT_TRUE(call.IsDone());
+    OLA_ASSERT_TRUE(call.Controller()->Failed());
+    OLA_ASSERT_EQ(string("Too many requests"), call.Controller()->ErrorText());
+  }
+
+  // 2^16 x 2^16 requests, the product overflows an unsigned int.
+  {
+    ola::proto::RDMBulkGetRequest large_request(request);
+    for (unsigned int i = 0; i < 0xffff; i++) {
+      large_request.add_uid()->CopyFrom(*request_uid);
+      large_request.add_param_id(ola::rdm::PID_IDENTIFY_DEVICE);
+    }
+    large_request.add_param_id(ola::rdm::PID_IDENTIFY_DEVICE);
+    RDMBulkGetCall call(&client);
+    call.Send(&service, large_request);
+    OLA_ASSERT_TRUE(call.IsDone());
+    OLA_ASSERT_TRUE(call.Controller()->Failed());
+    OLA_ASSERT_EQ(string("Too many requests"), call.Controller()->ErrorText());
+  }
+
+  // Fill the port's queue, one request is in flight and the rest are queued.
+  const unsigned int call_count = 4;
+  ola::proto::RDMBulkGetRequest full_request(request);
+  for (unsigned int i = 0; i < 250; i++) {
+    full_request.add_param_id(ola::rdm::PID_IDENTIFY_DEVICE);
+  }
+  vector<RDMBulkGetCall*> calls;
+  for (unsigned int i = 0; i < call_count; i++) {
+    calls.push_back(new RDMBulkGetCall(&client));
+    calls.back()->Send(&service, full_request);
+    OLA_ASSERT_FALSE(calls.back()->IsDone());
+  }
+  OLA_ASSERT_EQ(static_cast<size_t>(1), m_deferred_requests.size());
+  OLA_ASSERT_EQ(999u, universe->QueuedRDMRequests());
+
+  // There isn't room for another two requests.
+  {
+    request.add_param_id(ola::rdm::PID_IDENTIFY_DEVICE);
+    request.add_param_id(ola::rdm::PID_IDENTIFY_DEVICE);
+    RDMBulkGetCall call(&client);
+    call.Send(&service, request);
+    OLA_ASSERT_TRUE(call.IsDone());
+    OLA_ASSERT_TRUE(call.Controller()->Failed());
+    OLA_ASSERT_EQ(string("RDM queue full"), call.Controller()->ErrorText());
+  }
+
+  // Removing the port fails the queued requests.
+  universe->RemovePort(&port);
+  CompleteDeferredRequest(0, ola::rdm::RDM_TIMEOUT);
+  for (unsigned int i = 0; i < call_count; i++) {
+    OLA_ASSERT_TRUE(calls[i]->IsDone());
+    OLA_ASSERT_FALSE(calls[i]->Controller()->Failed());
+    delete calls[i];
+  }
+  m_deferred_requests.clear();
+  broker.RemoveClient(&client);
+}
+
+/*
+ * Check the RDMBroadcast method works
+ */
+void OlaServerServiceImplTest::testRDMBroadcast() {
+  UniverseStore store(NULL, NULL);
+  ola::ClientBroker broker;
+  ola::TimeStamp wake_up_time;
+  m_clock.CurrentTime(&wake_up_time);
+  OlaServerServiceImpl service(&store, NULL, NULL, NULL, &broker, NULL,
+                               &wake_up_time, NULL);
+  Client client(NULL, m_uid);
+  broker.AddClient(&client);
+
+  ola::proto::RDMBroadcastRequest request;
+  request.add_universe(1);
+  request.add_universe(2);
+  ola::proto::RDMBroadcastCommand *command = request.add_command();
+  command->set_sub_device(0);
+  command->set_param_id(ola::rdm::PID_IDENTIFY_DEVICE);
+  command->set_data(string(1, 1));
+  request.add_command()->CopyFrom(*command);
+
+  // A UID that isn't a broadcast
+  {
+    ola::proto::RDMBroadcastRequest unicast_request(request);
+    unicast_request.mutable_uid()->set_esta_id(0x7a70);
+    unicast_request.mutable_uid()->set_device_id(1);
+    RDMBroadcastCall call(&client);
+    call.Send(&service, unicast_request);
+    OLA_ASSERT_TRUE(call.IsDone());
+    OLA_ASSERT_TRUE(call.Controller()->Failed());
+    OLA_ASSERT_EQ(string("Not a broadcast UID"),
+                  call.Controller()->ErrorText());
+  }
+
+  // Too many requests
+  {
+    ola::proto::RDMBroadcastRequest large_request;
+    for (unsigned int i = 0; i < 2; i++) {
+      large_request.add_universe(i + 1);
+    }
+    for (unsigned int i = 0; i < 501; i++) {
+      large_request.add_command()->CopyFrom(*command);
+    }
+    RDMBroadcastCall call(&client);
+    call.Send(&service, large_request);
+    OLA_ASSERT_TRUE(call.IsDone());
+    OLA_ASSERT_TRUE(call.Controller()->Failed());
+    OLA_ASSERT_EQ(string("Too many requests"), call.Controller()->ErrorText());
+  }
+
+  // The universes don't exist
+  {
+    RDMBroadcastCall call(&client);
+    call.Send(&service, request);
+    OLA_ASSERT_TRUE(call.IsDone());
+    OLA_ASSERT_TRUE(call.Controller()->Failed());
+    OLA_ASSERT_EQ(string("Universe doesn't exist"),
+                  call.Controller()->ErrorText());
+  }
+
+  // Universe 1 has a port which completes the commands later, universe 2 has
+  // no ports so the commands complete immediately.
+  Universe *universe1 = store.GetUniverseOrCreate(1);
+  store.GetUniverseOrCreate(2);
+  ola::rdm::UIDSet uids;
+  TestMockRDMOutputPort port(
+      NULL, 1, &uids, false,
+      ola::NewCallback(this, &OlaServerServiceImplTest::DeferRDMRequest));
+  universe1->AddPort(&port);
+  port.SetUniverse(universe1);
+
+  {
+    RDMBroadcastCall call(&client);
+    call.Send(&service, request);
+    OLA_ASSERT_FALSE(call.IsDone());
+    OLA_ASSERT_EQ(static_cast<size_t>(2), m_deferred_requests.size());
+    OLA_ASSERT_TRUE(m_deferred_requests[0].first->DestinationUID().
+                    IsBroadcast());
+
+    wake_up_time += ola::TimeInterval(0, 1000);
+    CompleteDeferredRequest(0, ola::rdm::RDM_WAS_BROADCAST);
+    OLA_ASSERT_FALSE(call.IsDone());
+    wake_up_time += ola::TimeInterval(0, 1000);
+    CompleteDeferredRequest(1, ola::rdm::RDM_FAILED_TO_SEND);
+    OLA_ASSERT_TRUE(call.IsDone());
+    OLA_ASSERT_FALSE(call.Controller()->Failed());
+
+    const ola::proto::RDMBroadcastReply &reply = call.Reply();
+    OLA_ASSERT_EQ(4, reply.result_size());
+    OLA_ASSERT_EQ(2000u, reply.duration());
+
+    OLA_ASSERT_EQ(1, reply.result(0).universe());
+    OLA_ASSERT_EQ(0, reply.result(0).command());
+    OLA_ASSERT_EQ(ola::proto::RDM_WAS_BROADCAST,
+                  reply.result(0).response_code());
+    OLA_ASSERT_EQ(1000u, reply.result(0).duration());
+
+    OLA_ASSERT_EQ(1, reply.result(1).universe());
+    OLA_ASSERT_EQ(1, reply.result(1).command());
+    OLA_ASSERT_EQ(ola::proto::RDM_FAILED_TO_SEND,
+                  reply.result(1).response_code());
+    OLA_ASSERT_EQ(2000u, reply.result(1).duration());
+
+    for (unsigned int i = 2; i < 4; i++) {
+      OLA_ASSERT_EQ(2, reply.result(i).universe());
+      OLA_ASSERT_EQ(static_cast<int>(i - 2), reply.result(i).command());
+      OLA_ASSERT_EQ(ola::proto::RDM_WAS_BROADCAST,
+                    reply.result(i).response_code());
+      OLA_ASSERT_EQ(0u, reply.result(i).duration());
+    }
+  }
+  universe1->RemovePort(&port);
+  broker.RemoveClient(&client);
+}
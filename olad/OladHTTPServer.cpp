@@ -49,7 +49,6 @@ using ola::client::OlaUniverse;
 using ola::http::HTTPRequest;
 using ola::http::HTTPResponse;
 using ola::http::HTTPServer;
-using ola::io::ConnectedDescriptor;
 using ola::web::JsonArray;
 using ola::web::JsonObject;
 using std::cout;
@@ -69,19 +68,22 @@ const char OladHTTPServer::K_PRIORITY_MODE_SUFFIX[] = "_priority_mode";
  * @brief Create a new OLA HTTP server
  * @param export_map the ExportMap to display when /debug is called
  * @param options the OladHTTPServerOptions for the OLA HTTP server
- * @param client_socket A ConnectedDescriptor which is used to communicate with
- *   the server.
+ * @param rpc_server the RpcServer to connect our OlaClient to. Calls from
+ *   the client are handled directly, without being serialized.
  * @param ola_server the OlaServer to use
  * @param iface the network interface to bind to
  */
 OladHTTPServer::OladHTTPServer(ExportMap *export_map,
                                const OladHTTPServerOptions &options,
-                               ConnectedDescriptor *client_socket,
+                               ola::rpc::RpcServer *rpc_server,
                                OlaServer *ola_server,
                                const ola::network::Interface &iface)
     : OlaHTTPServer(options, export_map),
-      m_client_socket(client_socket),
-      m_client(client_socket),
+      m_rpc_server(rpc_server),
+      // The client runs in the HTTP server's thread.
+      m_client_channel(
+          new ola::rpc::InProcessRpcChannel(NULL, m_server.SelectServer())),
+      m_client(m_client_channel.get()),
       m_ola_server(ola_server),
       m_enable_quit(options.enable_quit),
       m_interface(iface),
@@ -377,13 +379,8 @@ OladHTTPServer::OladHTTPServer(ExportMap *export_map,
  * @brief Teardown
  */
 OladHTTPServer::~OladHTTPServer() {
-  if (m_client_socket) {
-    m_server.SelectServer()->RemoveReadDescriptor(m_client_socket);
-  }
   m_client.Stop();
-  if (m_client_socket) {
-    delete m_client_socket;
-  }
+  m_client_channel->Close();
 }
 
 
@@ -399,13 +396,7 @@ bool OladHTTPServer::Init() {
   if (!m_client.Setup()) {
     return false;
   }
-  /*
-  Setup disconnect notifications.
-  m_socket->SetOnClose(
-    ola::NewSingleCallback(this, &SimpleClient::SocketClosed));
-  */
-  m_server.SelectServer()->AddReadDescriptor(m_client_socket);
-  return true;
+  return m_rpc_server->AddInProcessClient(m_client_channel.get());
 }
 
 
@@ -22,8 +22,11 @@
 #define OLAD_OLADHTTPSERVER_H_
 
 #include <time.h>
+#include <memory>
 #include <string>
 #include <vector>
+#include "common/rpc/InProcessRpcChannel.h"
+#include "common/rpc/RpcServer.h"
 #include "ola/ExportMap.h"
 #include "ola/client/OlaClient.h"
 #include "ola/base/Macro.h"
@@ -54,7 +57,7 @@ class OladHTTPServer: public ola::http::OlaHTTPServer {
 
   OladHTTPServer(ExportMap *export_map,
                  const OladHTTPServerOptions &options,
-                 ola::io::ConnectedDescriptor *client_socket,
+                 ola::rpc::RpcServer *rpc_server,
                  class OlaServer *ola_server,
                  const ola::network::Interface &iface);
   virtual ~OladHTTPServer();
@@ -151,7 +154,8 @@ class OladHTTPServer: public ola::http::OlaHTTPServer {
   static const char HELP_PARAMETER[];
 
  private:
-  class ola::io::ConnectedDescriptor *m_client_socket;
+  ola::rpc::RpcServer *m_rpc_server;
+  std::auto_ptr<ola::rpc::InProcessRpcChannel> m_client_channel;
   ola::client::OlaClient m_client;
   class OlaServer *m_ola_server;
   bool m_enable_quit;
@@ -0,0 +1,411 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * RDMPoller.cpp
+ * Polls RDM responders for sensor values & status messages.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#include "olad/RDMPoller.h"
+
+#include <string>
+
+#include "ola/Callback.h"
+#include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/RDMEnums.h"
+#include "ola/rdm/RDMReply.h"
+#include "ola/rdm/UIDSet.h"
+#include "ola/stl/STLUtils.h"
+#include "olad/Universe.h"
+#include "olad/plugin_api/Client.h"
+#include "olad/plugin_api/UniverseStore.h"
+
+namespace ola {
+
+using ola::rdm::RDMReply;
+using ola::rdm::RDMResponse;
+using ola::rdm::UID;
+using ola::rdm::UIDSet;
+using std::string;
+
+namespace {
+// The offset of the sensor count in a DEVICE_INFO response.
+const unsigned int SENSOR_COUNT_OFFSET = 18;
+}  // namespace
+
+const unsigned int RDMPoller::DEFAULT_POLL_INTERVAL_MS;
+const unsigned int RDMPoller::POLL_TICK_MS;
+
+RDMPoller::ResponderState::ResponderState()
+    : next_item(0),
+      queued_messages(false) {
+  // The sensor count is needed before the rest of the items can be polled.
+  items.push_back(PollItem(ola::rdm::PID_DEVICE_INFO, ""));
+}
+
+RDMPoller::RDMPoller(UniverseStore *universe_store,
+                     Clock *clock,
+                     const UID &source_uid,
+                     unsigned int poll_interval_ms)
+    : m_universe_store(universe_store),
+      m_clock(clock),
+      m_source_uid(source_uid),
+      m_poll_interval(poll_interval_ms / 1000,
+                      (poll_interval_ms % 1000) * 1000),
+      m_next_state_id(0),
+      m_transaction_number(0) {
+}
+
+RDMPoller::~RDMPoller() {
+  std::set<PollRequest*>::iterator iter = m_pending.begin();
+  for (; iter != m_pending.end(); ++iter) {
+    (*iter)->poller = NULL;
+  }
+
+  while (!m_universes.empty()) {
+    DeleteUniverseState(m_universes.begin());
+  }
+}
+
+void RDMPoller::Subscribe(Client *client, unsigned int universe_id) {
+  UniverseMap::iterator iter = STLLookupOrInsertNull(&m_universes,
+                                                     universe_id);
+  if (!iter->second) {
+    iter->second = new UniverseState(m_next_state_id++);
+    // Wait for any request sent before the universe was unsubscribed, so
+    // there's still only one in flight.
+    iter->second->in_flight = RequestPending(universe_id);
+  }
+
+  UniverseState *state = iter->second;
+  if (state->clients.insert(client).second) {
+    SendValues(client, universe_id, *state);
+  }
+  SendRequests(universe_id, state);
+}
+
+void RDMPoller::Unsubscribe(Client *client, unsigned int universe_id) {
+  UniverseMap::iterator iter = m_universes.find(universe_id);
+  if (iter == m_universes.end()) {
+    return;
+  }
+
+  iter->second->clients.erase(client);
+  if (iter->second->clients.empty()) {
+    DeleteUniverseState(iter);
+  }
+}
+
+void RDMPoller::RemoveClient(Client *client) {
+  UniverseMap::iterator iter = m_universes.begin();
+  while (iter != m_universes.end()) {
+    iter->second->clients.erase(client);
+    if (iter->second->clients.empty()) {
+      DeleteUniverseState(iter++);
+    } else {
+      ++iter;
+    }
+  }
+}
+
+void RDMPoller::Poll() {
+  UniverseMap::iterator iter = m_universes.begin();
+  for (; iter != m_universes.end(); ++iter) {
+    SendRequests(iter->first, iter->second);
+  }
+}
+
+unsigned int RDMPoller::ValueCount(unsigned int universe_id) const {
+  const UniverseState *state = STLFindOrNull(m_universes, universe_id);
+  if (!state) {
+    return 0;
+  }
+
+  unsigned int count = 0;
+  ResponderMap::const_iterator iter = state->responders.begin();
+  for (; iter != state->responders.end(); ++iter) {
+    count += iter->second->values.size();
+  }
+  return count;
+}
+
+/*
+ * Delete the state for a universe. Any request in flight for the universe is
+ * ignored when it completes.
+ */
+void RDMPoller::DeleteUniverseState(UniverseMap::iterator iter) {
+  STLDeleteValues(&iter->second->responders);
+  delete iter->second;
+  m_universes.erase(iter);
+}
+
+bool RDMPoller::RequestPending(unsigned int universe_id) const {
+  std::set<PollRequest*>::const_iterator iter = m_pending.begin();
+  for (; iter != m_pending.end(); ++iter) {
+    if ((*iter)->universe_id == universe_id) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+ * Send requests for the universe until one is in flight. If the universe
+ * completes requests synchronously, this loops rather than recursing.
+ */
+void RDMPoller::SendRequests(unsigned int universe_id, UniverseState *state) {
+  if (state->sending || state->in_flight) {
+    return;
+  }
+
+  Universe *universe = m_universe_store->GetUniverse(universe_id);
+  if (!universe) {
+    return;
+  }
+  UpdateResponders(*universe, state);
+
+  state->sending = true;
+  // Requests from clients go first, we only use the time the line is idle.
+  while (!state->in_flight && !universe->QueuedRDMRequests()) {
+    ResponderMap::iterator iter = NextResponder(state);
+    if (iter == state->responders.end()) {
+      break;
+    }
+
+    ResponderState *responder = iter->second;
+    uint16_t pid;
+    string param_data;
+    if (responder->queued_messages) {
+      responder->queued_messages = false;
+      pid = ola::rdm::PID_QUEUED_MESSAGE;
+      param_data.push_back(ola::rdm::STATUS_ADVISORY);
+    } else {
+      const PollItem &item = responder->items[responder->next_item];
+      pid = item.pid;
+      param_data = item.param_data;
+    }
+
+    PollRequest *request = new PollRequest(this, universe_id, state->id,
+                                           iter->first, pid);
+    m_pending.insert(request);
+    state->in_flight = true;
+    universe->SendRDMRequest(
+        new ola::rdm::RDMGetRequest(
+            m_source_uid, iter->first, m_transaction_number++, 1,
+            ola::rdm::ROOT_RDM_DEVICE, pid,
+            reinterpret_cast<const uint8_t*>(param_data.data()),
+            param_data.size()),
+        NewSingleCallback(&RDMPoller::RequestComplete, request),
+        Universe::RDM_PRIORITY_BACKGROUND,
+        true);
+  }
+  state->sending = false;
+}
+
+/*
+ * Add state for the responders that have been discovered, and remove the
+ * state for responders that have gone.
+ */
+void RDMPoller::UpdateResponders(const Universe &universe,
+                                 UniverseState *state) {
+  UIDSet uids;
+  universe.GetUIDs(&uids);
+
+  ResponderMap::iterator iter = state->responders.begin();
+  while (iter != state->responders.end()) {
+    if (uids.Contains(iter->first)) {
+      ++iter;
+    } else {
+      delete iter->second;
+      state->responders.erase(iter++);
+    }
+  }
+
+  UIDSet::Iterator uid_iter = uids.Begin();
+  for (; uid_iter != uids.End(); ++uid_iter) {
+    ResponderMap::iterator responder_iter = STLLookupOrInsertNull(
+        &state->responders, *uid_iter);
+    if (!responder_iter->second) {
+      responder_iter->second = new ResponderState();
+    }
+  }
+}
+
+/*
+ * Return the responder to poll next. Responders with queued messages go
+ * first, then the responder that has been waiting the longest.
+ */
+RDMPoller::ResponderMap::iterator RDMPoller::NextResponder(
+    UniverseState *state) {
+  TimeStamp now;
+  m_clock->CurrentTime(&now);
+
+  ResponderMap::iterator next = state->responders.end();
+  ResponderMap::iterator iter = state->responders.begin();
+  for (; iter != state->responders.end(); ++iter) {
+    const ResponderState *responder = iter->second;
+    if (responder->queued_messages) {
+      return iter;
+    }
+    if (responder->items.empty() || now < responder->next_poll) {
+      continue;
+    }
+    if (next == state->responders.end() ||
+        responder->next_poll < next->second->next_poll) {
+      next = iter;
+    }
+  }
+  return next;
+}
+
+void RDMPoller::RequestComplete(PollRequest *request, RDMReply *reply) {
+  if (request->poller) {
+    request->poller->m_pending.erase(request);
+    request->poller->HandleReply(*request, *reply);
+  }
+  delete request;
+}
+
+void RDMPoller::HandleReply(const PollRequest &request,
+                            const RDMReply &reply) {
+  UniverseState *state = STLFindOrNull(m_universes, request.universe_id);
+  if (!state) {
+    return;
+  }
+  state->in_flight = false;
+
+  if (state->id != request.state_id) {
+    // The request was sent before the universe was unsubscribed, the reply
+    // belongs to the old state.
+    SendRequests(request.universe_id, state);
+    return;
+  }
+
+  ResponderState *responder = STLFindOrNull(state->responders, request.uid);
+  if (responder) {
+    const RDMResponse *response = reply.Response();
+    bool advance = request.pid != ola::rdm::PID_QUEUED_MESSAGE;
+    if (reply.StatusCode() == ola::rdm::RDM_COMPLETED_OK && response) {
+      if (response->MessageCount()) {
+        responder->queued_messages = true;
+      }
+
+      if (response->ResponseType() == ola::rdm::RDM_ACK) {
+        HandleAck(request.universe_id, state, request, responder, *response);
+        if (request.pid == ola::rdm::PID_DEVICE_INFO) {
+          // The items were replaced, start from the beginning.
+          advance = false;
+        }
+      } else if (response->ResponseType() == ola::rdm::RDM_NACK_REASON &&
+                 advance &&
+                 responder->next_item < responder->items.size() &&
+                 responder->items[responder->next_item].pid == request.pid) {
+        // The responder doesn't support this parameter, stop polling it.
+        responder->items.erase(responder->items.begin() +
+                               responder->next_item);
+        advance = false;
+      }
+    }
+
+    if (advance) {
+      responder->next_item++;
+    }
+    if (responder->next_item >= responder->items.size()) {
+      responder->next_item = 0;
+      m_clock->CurrentTime(&responder->next_poll);
+      responder->next_poll += m_poll_interval;
+    }
+  }
+
+  SendRequests(request.universe_id, state);
+}
+
+void RDMPoller::HandleAck(unsigned int universe_id,
+                          UniverseState *state,
+                          const PollRequest &request,
+                          ResponderState *responder,
+                          const RDMResponse &response) {
+  const string data(reinterpret_cast<const char*>(response.ParamData()),
+                    response.ParamDataSize());
+
+  if (request.pid == ola::rdm::PID_DEVICE_INFO) {
+    uint8_t sensor_count = 0;
+    if (data.size() > SENSOR_COUNT_OFFSET) {
+      sensor_count = data[SENSOR_COUNT_OFFSET];
+    }
+
+    responder->items.clear();
+    for (unsigned int i = 0; i < sensor_count; i++) {
+      responder->items.push_back(
+          PollItem(ola::rdm::PID_SENSOR_VALUE, string(1, i)));
+    }
+    responder->items.push_back(PollItem(ola::rdm::PID_LAMP_HOURS, ""));
+    responder->items.push_back(
+        PollItem(ola::rdm::PID_STATUS_MESSAGES,
+                 string(1, ola::rdm::STATUS_ADVISORY)));
+    responder->next_item = 0;
+    return;
+  }
+
+  // A QUEUED_MESSAGE response may be for any PID. An empty STATUS_MESSAGES
+  // response means there was nothing queued.
+  const uint16_t pid = response.ParamId();
+  if (request.pid == ola::rdm::PID_QUEUED_MESSAGE &&
+      pid == ola::rdm::PID_STATUS_MESSAGES && data.empty()) {
+    return;
+  }
+
+  const ValueKey key = MakeValueKey(pid, data);
+  ValueMap::iterator iter = responder->values.find(key);
+  if (iter != responder->values.end()) {
+    if (iter->second == data) {
+      return;
+    }
+    iter->second = data;
+  } else {
+    responder->values.insert(ValueMap::value_type(key, data));
+  }
+
+  std::set<Client*>::iterator client_iter = state->clients.begin();
+  for (; client_iter != state->clients.end(); ++client_iter) {
+    (*client_iter)->SendRDMUpdate(universe_id, request.uid,
+                                  ola::rdm::ROOT_RDM_DEVICE, pid, data);
+  }
+}
+
+/*
+ * Send all the stored values to a client.
+ */
+void RDMPoller::SendValues(Client *client, unsigned int universe_id,
+                           const UniverseState &state) {
+  ResponderMap::const_iterator iter = state.responders.begin();
+  for (; iter != state.responders.end(); ++iter) {
+    ValueMap::const_iterator value_iter = iter->second->values.begin();
+    for (; value_iter != iter->second->values.end(); ++value_iter) {
+      client->SendRDMUpdate(universe_id, iter->first,
+                            ola::rdm::ROOT_RDM_DEVICE,
+                            value_iter->first.first, value_iter->second);
+    }
+  }
+}
+
+RDMPoller::ValueKey RDMPoller::MakeValueKey(uint16_t pid, const string &data) {
+  // Each sensor has its own value, the first byte is the sensor number.
+  if (pid == ola::rdm::PID_SENSOR_VALUE && !data.empty()) {
+    return ValueKey(pid, data.substr(0, 1));
+  }
+  return ValueKey(pid, "");
+}
+}  // namespace ola
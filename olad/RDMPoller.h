@@ -0,0 +1,218 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * RDMPoller.h
+ * Polls RDM responders for sensor values & status messages.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#ifndef OLAD_RDMPOLLER_H_
+#define OLAD_RDMPOLLER_H_
+
+#include <stdint.h>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ola/Clock.h"
+#include "ola/base/Macro.h"
+#include "ola/rdm/RDMControllerInterface.h"
+#include "ola/rdm/UID.h"
+
+namespace ola {
+
+class Client;
+class Universe;
+class UniverseStore;
+
+/**
+ * @brief Polls RDM responders in the background and pushes changes to
+ * clients.
+ *
+ * Clients subscribe to a universe. While a universe has subscribers, each
+ * responder on it is polled for SENSOR_VALUE (one request per sensor),
+ * LAMP_HOURS and STATUS_MESSAGES once per poll interval. If a responder
+ * reports queued messages they are fetched with QUEUED_MESSAGE before
+ * anything else. The latest value of each parameter is stored, and clients
+ * are sent an update when it changes.
+ *
+ * Polling only uses idle RDM line time: there is at most one poll request
+ * in flight per universe, it's sent at background priority, and it's only
+ * sent when no other requests are waiting for the universe's ports.
+ */
+class RDMPoller {
+ public:
+  /**
+   * @brief Create a new RDMPoller.
+   * @param universe_store the UniverseStore to find universes in.
+   * @param clock the Clock to use.
+   * @param source_uid the UID to send the poll requests from.
+   * @param poll_interval_ms how often to poll each responder.
+   */
+  RDMPoller(UniverseStore *universe_store,
+            Clock *clock,
+            const ola::rdm::UID &source_uid,
+            unsigned int poll_interval_ms = DEFAULT_POLL_INTERVAL_MS);
+
+  /**
+   * @brief Destructor.
+   *
+   * Requests that are in flight complete as normal, their responses are
+   * discarded.
+   */
+  ~RDMPoller();
+
+  /**
+   * @brief Subscribe a client to the changes on a universe.
+   * @param client the Client, ownership is not transferred.
+   * @param universe_id the universe to subscribe to.
+   *
+   * The client is sent the current value of every stored parameter.
+   */
+  void Subscribe(Client *client, unsigned int universe_id);
+
+  /**
+   * @brief Unsubscribe a client from a universe.
+   * @param client the Client.
+   * @param universe_id the universe to unsubscribe from.
+   *
+   * Polling stops once a universe has no subscribers.
+   */
+  void Unsubscribe(Client *client, unsigned int universe_id);
+
+  /**
+   * @brief Unsubscribe a client from all universes.
+   * @param client the Client, which is about to be deleted.
+   */
+  void RemoveClient(Client *client);
+
+  /**
+   * @brief Send the poll requests that are due.
+   *
+   * This should be called periodically, every POLL_TICK_MS.
+   */
+  void Poll();
+
+  /**
+   * @brief The number of parameter values stored for a universe.
+   */
+  unsigned int ValueCount(unsigned int universe_id) const;
+
+  /**
+   * @brief The default interval between polls of a responder.
+   */
+  static const unsigned int DEFAULT_POLL_INTERVAL_MS = 1000;
+
+  /**
+   * @brief How often Poll() should be called.
+   */
+  static const unsigned int POLL_TICK_MS = 100;
+
+ private:
+  // The PID & the sensor number, the latter is only used for SENSOR_VALUE.
+  typedef std::pair<uint16_t, std::string> ValueKey;
+  typedef std::map<ValueKey, std::string> ValueMap;
+
+  struct PollItem {
+    uint16_t pid;
+    std::string param_data;
+
+    PollItem(uint16_t pid, const std::string &param_data)
+        : pid(pid),
+          param_data(param_data) {
+    }
+  };
+
+  struct ResponderState {
+    std::vector<PollItem> items;
+    unsigned int next_item;
+    TimeStamp next_poll;
+    bool queued_messages;
+    ValueMap values;
+
+    ResponderState();
+  };
+
+  typedef std::map<ola::rdm::UID, ResponderState*> ResponderMap;
+
+  struct UniverseState {
+    // Identifies the state, since a universe may be unsubscribed and then
+    // subscribed again while a request is in flight.
+    const unsigned int id;
+    std::set<Client*> clients;
+    ResponderMap responders;
+    bool in_flight;
+    bool sending;
+
+    explicit UniverseState(unsigned int id)
+        : id(id),
+          in_flight(false),
+          sending(false) {
+    }
+  };
+
+  typedef std::map<unsigned int, UniverseState*> UniverseMap;
+
+  /*
+   * A poll request that is in flight.
+   */
+  struct PollRequest {
+    RDMPoller *poller;
+    unsigned int universe_id;
+    unsigned int state_id;
+    ola::rdm::UID uid;
+    uint16_t pid;
+
+    PollRequest(RDMPoller *poller, unsigned int universe_id,
+                unsigned int state_id, const ola::rdm::UID &uid, uint16_t pid)
+        : poller(poller),
+          universe_id(universe_id),
+          state_id(state_id),
+          uid(uid),
+          pid(pid) {
+    }
+  };
+
+  UniverseStore *m_universe_store;
+  Clock *m_clock;
+  const ola::rdm::UID m_source_uid;
+  const TimeInterval m_poll_interval;
+  UniverseMap m_universes;
+  std::set<PollRequest*> m_pending;
+  unsigned int m_next_state_id;
+  uint8_t m_transaction_number;
+
+  void DeleteUniverseState(UniverseMap::iterator iter);
+  bool RequestPending(unsigned int universe_id) const;
+  void SendRequests(unsigned int universe_id, UniverseState *state);
+  void UpdateResponders(const Universe &universe, UniverseState *state);
+  ResponderMap::iterator NextResponder(UniverseState *state);
+  static void RequestComplete(PollRequest *request,
+                              ola::rdm::RDMReply *reply);
+  void HandleReply(const PollRequest &request, const ola::rdm::RDMReply &reply);
+  void HandleAck(unsigned int universe_id, UniverseState *state,
+                 const PollRequest &request, ResponderState *responder,
+                 const ola::rdm::RDMResponse &response);
+  void SendValues(Client *client, unsigned int universe_id,
+                  const UniverseState &state);
+
+  static ValueKey MakeValueKey(uint16_t pid, const std::string &data);
+
+  DISALLOW_COPY_AND_ASSIGN(RDMPoller);
+};
+}  // namespace ola
+#endif  // OLAD_RDMPOLLER_H_
@@ -0,0 +1,417 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * RDMPollerTest.cpp
+ * Test fixture for the RDMPoller class
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/Logging.h"
+#include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/RDMEnums.h"
+#include "ola/rdm/RDMReply.h"
+#include "ola/rdm/UID.h"
+#include "ola/rdm/UIDSet.h"
+#include "ola/testing/TestUtils.h"
+#include "olad/Preferences.h"
+#include "olad/RDMPoller.h"
+#include "olad/Universe.h"
+#include "olad/plugin_api/Client.h"
+#include "olad/plugin_api/TestCommon.h"
+#include "olad/plugin_api/UniverseStore.h"
+
+using ola::MockClock;
+using ola::NewCallback;
+using ola::NewSingleCallback;
+using ola::RDMPoller;
+using ola::Universe;
+using ola::rdm::RDMCallback;
+using ola::rdm::RDMReply;
+using ola::rdm::RDMRequest;
+using ola::rdm::UID;
+using ola::rdm::UIDSet;
+using std::string;
+using std::vector;
+
+namespace {
+const unsigned int TEST_UNIVERSE = 1;
+}  // namespace
+
+/*
+ * Records the updates it's sent.
+ */
+class RDMUpdateClient: public ola::Client {
+ public:
+  struct Update {
+    UID uid;
+    uint16_t pid;
+    string data;
+
+    Update(const UID &uid, uint16_t pid, const string &data)
+        : uid(uid), pid(pid), data(data) {}
+  };
+
+  RDMUpdateClient() : ola::Client(NULL, UID(0x7a70, 100)) {}
+
+  bool SendRDMUpdate(unsigned int universe_id, const UID &uid,
+                     uint16_t sub_device, uint16_t pid, const string &data) {
+    OLA_ASSERT_EQ(TEST_UNIVERSE, universe_id);
+    OLA_ASSERT_EQ(static_cast<uint16_t>(ola::rdm::ROOT_RDM_DEVICE),
+                  sub_device);
+    updates.push_back(Update(uid, pid, data));
+    return true;
+  }
+
+  vector<Update> updates;
+};
+
+
+class RDMPollerTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(RDMPollerTest);
+  CPPUNIT_TEST(testPolling);
+  CPPUNIT_TEST(testQueuedMessages);
+  CPPUNIT_TEST(testIdleTimeOnly);
+  CPPUNIT_TEST(testSubscriptions);
+  CPPUNIT_TEST(testResubscribeInFlight);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  RDMPollerTest()
+      : m_uid(0x7a70, 1),
+        m_preferences("foo") {
+  }
+
+  void setUp();
+  void tearDown();
+
+  void testPolling();
+  void testQueuedMessages();
+  void testIdleTimeOnly();
+  void testSubscriptions();
+  void testResubscribeInFlight();
+
+ private:
+  typedef std::pair<const RDMRequest*, RDMCallback*> DeferredRequest;
+
+  UID m_uid;
+  MockClock m_clock;
+  ola::MemoryPreferences m_preferences;
+  ola::UniverseStore *m_store;
+  Universe *m_universe;
+  UIDSet m_port_uids;
+  TestMockRDMOutputPort *m_port;
+  std::deque<DeferredRequest> m_deferred_requests;
+
+  void DeferRDMRequest(const RDMRequest *request, RDMCallback *callback) {
+    m_deferred_requests.push_back(DeferredRequest(request, callback));
+  }
+
+  uint16_t Ack(const string &data, uint8_t message_count = 0);
+  uint16_t Nack();
+  uint16_t CompleteRequest(ola::rdm::RDMResponse *response);
+  void AckDeviceInfo(uint8_t sensor_count);
+  void AdvanceToNextPoll() { m_clock.AdvanceTime(1, 0); }
+  void Ignore(RDMReply*) {}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(RDMPollerTest);
+
+void RDMPollerTest::setUp() {
+  ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
+  m_deferred_requests.clear();
+  m_store = new ola::UniverseStore(&m_preferences, NULL);
+  m_universe = m_store->GetUniverseOrCreate(TEST_UNIVERSE);
+
+  m_port_uids.Clear();
+  m_port_uids.AddUID(m_uid);
+  m_port = new TestMockRDMOutputPort(NULL, 1, &m_port_uids, true);
+  m_port->SetRDMHandler(NewCallback(this, &RDMPollerTest::DeferRDMRequest));
+  m_universe->AddPort(m_port);
+  m_port->SetUniverse(m_universe);
+}
+
+void RDMPollerTest::tearDown() {
+  while (!m_deferred_requests.empty()) {
+    Nack();
+  }
+  m_universe->RemovePort(m_port);
+  delete m_port;
+  m_store->DeleteAll();
+  delete m_store;
+}
+
+/*
+ * Complete the oldest request with an ACK, and return the PID it was for.
+ */
+uint16_t RDMPollerTest::Ack(const string &data, uint8_t message_count) {
+  OLA_ASSERT_FALSE(m_deferred_requests.empty());
+  return CompleteRequest(ola::rdm::GetResponseFromData(
+      m_deferred_requests.front().first,
+      reinterpret_cast<const uint8_t*>(data.data()), data.size(),
+      ola::rdm::RDM_ACK, message_count));
+}
+
+uint16_t RDMPollerTest::Nack() {
+  OLA_ASSERT_FALSE(m_deferred_requests.empty());
+  return CompleteRequest(ola::rdm::NackWithReason(
+      m_deferred_requests.front().first, ola::rdm::NR_UNKNOWN_PID));
+}
+
+uint16_t RDMPollerTest::CompleteRequest(ola::rdm::RDMResponse *response) {
+  DeferredRequest deferred = m_deferred_requests.front();
+  m_deferred_requests.pop_front();
+  const uint16_t pid = deferred.first->ParamId();
+  delete deferred.first;
+
+  RDMReply reply(ola::rdm::RDM_COMPLETED_OK, response);
+  deferred.second->Run(&reply);
+  return pid;
+}
+
+void RDMPollerTest::AckDeviceInfo(uint8_t sensor_count) {
+  string device_info(19, 0);
+  device_info[18] = sensor_count;
+  OLA_ASSERT_EQ(static_cast<uint16_t>(ola::rdm::PID_DEVICE_INFO),
+                Ack(device_info));
+}
+
+/*
+ * Check the responder is polled, and clients are sent the values that
+ * change.
+ */
+void RDMPollerTest::testPolling() {
+  RDMPoller poller(m_store, &m_clock, UID(0x7a70, 200));
+  RDMUpdateClient client;
+
+  // Nothing is polled without subscribers.
+  poller.Poll();
+  OLA_ASSERT_TRUE(m_deferred_requests.empty());
+
+  poller.Subscribe(&client, TEST_UNIVERSE);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), m_deferred_requests.size());
+  OLA_ASSERT_EQ(UID(0x7a70, 200), m_deferred_requests[0].first->SourceUID());
+  AckDeviceInfo(2);
+
+  // One request is in flight at a time.
+  OLA_ASSERT_EQ(static_cast<size_t>(1), m_deferred_requests.size());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(0),
+                m_deferred_requests[0].first->ParamData()[0]);
+  OLA_ASSERT_EQ(static_cast<uint16_t>(ola::rdm::PID_SENSOR_VALUE),
+                Ack(string("\x00\x01", 2)));
+  OLA_ASSERT_EQ(static_cast<uint8_t>(1),
+                m_deferred_requests[0].first->ParamData()[0]);
+  OLA_ASSERT_EQ(static_cast<uint16_t>(ola::rdm::PID_SENSOR_VALUE),
+                Ack(string("\x01\x02", 2)));
+  OLA_ASSERT_EQ(static_cast<uint16_t>(ola::rdm::PID_LAMP_HOURS), Nack());
+  OLA_ASSERT_EQ(static_cast<uint16_t>(ola::rdm::PID_STATUS_MESSAGES),
+                Ack(""));
+  OLA_ASSERT_TRUE(m_deferred_requests.empty());
+
+  OLA_ASSERT_EQ(static_cast<size_t>(3), client.updates.size());
+  OLA_ASSERT_EQ(m_uid, client.updates[0].uid);
+  OLA_ASSERT_EQ(static_cast<uint16_t>(ola::rdm::PID_SENSOR_VALUE),
+                client.updates[0].pid);
+  OLA_ASSERT_EQ(string("\x00\x01", 2), client.updates[0].data);
+  OLA_ASSERT_EQ(string("\x01\x02", 2), client.updates[1].data);
+  OLA_ASSERT_EQ(static_cast<uint16_t>(ola::rdm::PID_STATUS_MESSAGES),
+                client.updates[2].pid);
+  OLA_ASSERT_EQ(3u, poller.ValueCount(TEST_UNIVERSE));
+
+  // Nothing more is sent until the poll interval has passed.
+  poller.Poll();
+  OLA_ASSERT_TRUE(m_deferred_requests.empty());
+
+  // The unsupported PID isn't polled again, and only changes are sent.
+  AdvanceToNextPoll();
+  poller.Poll();
+  OLA_ASSERT_EQ(static_cast<uint16_t>(ola::rdm::PID_SENSOR_VALUE),
+                Ack(string("\x00\x01", 2)));
+  OLA_ASSERT_EQ(static_cast<uint16_t>(ola::rdm::PID_SENSOR_VALUE),
+                Ack(string("\x01\x03", 2)));
+  OLA_ASSERT_EQ(static_cast<uint16_t>(ola::rdm::PID_STATUS_MESSAGES),
+                Ack(""));
+  OLA_ASSERT_TRUE(m_deferred_requests.empty());
+  OLA_ASSERT_EQ(static_cast<size_t>(4), client.updates.size());
+  OLA_ASSERT_EQ(string("\x01\x03", 2), client.updates[3].data);
+  OLA_ASSERT_EQ(3u, poller.ValueCount(TEST_UNIVERSE));
+
+  poller.Unsubscribe(&client, TEST_UNIVERSE);
+}
+
+/*
+ * Check queued messages are fetched.
+ */
+void RDMPollerTest::testQueuedMessages() {
+  RDMPoller poller(m_store, &m_clock, UID(0x7a70, 200));
+  RDMUpdateClient client;
+  poller.Subscribe(&client, TEST_UNIVERSE);
+  AckDeviceInfo(0);
+
+  // The responder has a queued message, that's fetched next.
+  OLA_ASSERT_EQ(static_cast<uint16_t>(ola::rdm::PID_LAMP_HOURS),
+                Ack(string("\x00\x00\x00\x10", 4), 1));
+  OLA_ASSERT_EQ(static_cast<uint16_t>(ola::rdm::PID_QUEUED_MESSAGE),
+                m_deferred_requests[0].first->ParamId());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(ola::rdm::STATUS_ADVISORY),
+                m_deferred_requests[0].first->ParamData()[0]);
+  CompleteRequest(ola::rdm::GetResponseWithPid(
+      m_deferred_requests.front().first, ola::rdm::PID_DMX_START_ADDRESS,
+      reinterpret_cast<const uint8_t*>("\x00\x05"), 2));
+
+  // Then the regular polling continues.
+  OLA_ASSERT_EQ(static_cast<uint16_t>(ola::rdm::PID_STATUS_MESSAGES),
+                Ack(""));
+  OLA_ASSERT_TRUE(m_deferred_requests.empty());
+
+  OLA_ASSERT_EQ(static_cast<size_t>(3), client.updates.size());
+  OLA_ASSERT_EQ(static_cast<uint16_t>(ola::rdm::PID_LAMP_HOURS),
+                client.updates[0].pid);
+  OLA_ASSERT_EQ(static_cast<uint16_t>(ola::rdm::PID_DMX_START_ADDRESS),
+                client.updates[1].pid);
+  OLA_ASSERT_EQ(string("\x00\x05", 2), client.updates[1].data);
+  OLA_ASSERT_EQ(static_cast<uint16_t>(ola::rdm::PID_STATUS_MESSAGES),
+                client.updates[2].pid);
+
+  // An empty STATUS_MESSAGES response to QUEUED_MESSAGE means there was
+  // nothing queued.
+  AdvanceToNextPoll();
+  poller.Poll();
+  OLA_ASSERT_EQ(static_cast<uint16_t>(ola::rdm::PID_LAMP_HOURS),
+                Ack(string("\x00\x00\x00\x10", 4), 1));
+  CompleteRequest(ola::rdm::GetResponseWithPid(
+      m_deferred_requests.front().first, ola::rdm::PID_STATUS_MESSAGES,
+      NULL, 0));
+  OLA_ASSERT_EQ(static_cast<uint16_t>(ola::rdm::PID_STATUS_MESSAGES),
+                Ack(""));
+  OLA_ASSERT_EQ(static_cast<size_t>(3), client.updates.size());
+  poller.RemoveClient(&client);
+}
+
+/*
+ * Check that polling waits for the other requests on the universe.
+ */
+void RDMPollerTest::testIdleTimeOnly() {
+  RDMPoller poller(m_store, &m_clock, UID(0x7a70, 200));
+  RDMUpdateClient client;
+  poller.Subscribe(&client, TEST_UNIVERSE);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), m_deferred_requests.size());
+
+  // A client request is queued behind the poll request.
+  m_universe->SendRDMRequest(
+      new ola::rdm::RDMGetRequest(UID(0x7a70, 300), m_uid, 0, 1, 0,
+                                  ola::rdm::PID_IDENTIFY_DEVICE, NULL, 0),
+      NewSingleCallback(this, &RDMPollerTest::Ignore));
+  OLA_ASSERT_EQ(1u, m_universe->QueuedRDMRequests());
+
+  // Once the poll request completes, the client request goes next, and
+  // nothing is polled until the line is idle again.
+  AckDeviceInfo(0);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), m_deferred_requests.size());
+  OLA_ASSERT_EQ(0u, m_universe->QueuedRDMRequests());
+  OLA_ASSERT_EQ(static_cast<uint16_t>(ola::rdm::PID_IDENTIFY_DEVICE),
+                Ack(string(1, 0)));
+  OLA_ASSERT_TRUE(m_deferred_requests.empty());
+
+  poller.Poll();
+  OLA_ASSERT_EQ(static_cast<size_t>(1), m_deferred_requests.size());
+  OLA_ASSERT_EQ(static_cast<uint16_t>(ola::rdm::PID_LAMP_HOURS),
+                m_deferred_requests[0].first->ParamId());
+  poller.RemoveClient(&client);
+}
+
+/*
+ * Check subscribing & unsubscribing.
+ */
+void RDMPollerTest::testSubscriptions() {
+  RDMUpdateClient client1, client2;
+  {
+    RDMPoller poller(m_store, &m_clock, UID(0x7a70, 200));
+    poller.Subscribe(&client1, TEST_UNIVERSE);
+    AckDeviceInfo(0);
+    Nack();
+    Ack("status");
+    OLA_ASSERT_EQ(static_cast<size_t>(1), client1.updates.size());
+
+    // New subscribers are sent the current values.
+    poller.Subscribe(&client2, TEST_UNIVERSE);
+    OLA_ASSERT_EQ(static_cast<size_t>(1), client2.updates.size());
+    OLA_ASSERT_EQ(string("status"), client2.updates[0].data);
+
+    poller.Unsubscribe(&client1, TEST_UNIVERSE);
+    AdvanceToNextPoll();
+    poller.Poll();
+    Ack("status2");
+    OLA_ASSERT_EQ(static_cast<size_t>(1), client1.updates.size());
+    OLA_ASSERT_EQ(static_cast<size_t>(2), client2.updates.size());
+
+    // Once there are no subscribers, polling stops and the values are
+    // dropped.
+    poller.RemoveClient(&client2);
+    OLA_ASSERT_EQ(0u, poller.ValueCount(TEST_UNIVERSE));
+    AdvanceToNextPoll();
+    poller.Poll();
+    OLA_ASSERT_TRUE(m_deferred_requests.empty());
+
+    // The poller is deleted with a request in flight. DEVICE_INFO is
+    // answered from the universe's cache this time.
+    poller.Subscribe(&client1, TEST_UNIVERSE);
+    OLA_ASSERT_EQ(static_cast<size_t>(1), m_deferred_requests.size());
+  }
+  OLA_ASSERT_EQ(static_cast<uint16_t>(ola::rdm::PID_LAMP_HOURS), Nack());
+  OLA_ASSERT_TRUE(m_deferred_requests.empty());
+}
+
+/*
+ * Check a reply sent before a universe was unsubscribed and subscribed again
+ * isn't applied to the new state.
+ */
+void RDMPollerTest::testResubscribeInFlight() {
+  RDMPoller poller(m_store, &m_clock, UID(0x7a70, 200));
+  RDMUpdateClient client;
+  poller.Subscribe(&client, TEST_UNIVERSE);
+  AckDeviceInfo(0);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), m_deferred_requests.size());
+  OLA_ASSERT_EQ(static_cast<uint16_t>(ola::rdm::PID_LAMP_HOURS),
+                m_deferred_requests[0].first->ParamId());
+
+  // Nothing new is sent until the old request completes.
+  poller.Unsubscribe(&client, TEST_UNIVERSE);
+  poller.Subscribe(&client, TEST_UNIVERSE);
+  poller.Poll();
+  OLA_ASSERT_EQ(static_cast<size_t>(1), m_deferred_requests.size());
+
+  // The old reply is dropped, and the new state starts polling. DEVICE_INFO
+  // is answered from the universe's cache.
+  OLA_ASSERT_EQ(static_cast<uint16_t>(ola::rdm::PID_LAMP_HOURS),
+                Ack(string("\x00\x00\x00\x10", 4)));
+  OLA_ASSERT_TRUE(client.updates.empty());
+  OLA_ASSERT_EQ(0u, poller.ValueCount(TEST_UNIVERSE));
+  OLA_ASSERT_EQ(static_cast<size_t>(1), m_deferred_requests.size());
+
+  OLA_ASSERT_EQ(static_cast<uint16_t>(ola::rdm::PID_LAMP_HOURS),
+                Ack(string("\x00\x00\x00\x10", 4)));
+  OLA_ASSERT_EQ(static_cast<size_t>(1), client.updates.size());
+  OLA_ASSERT_EQ(1u, poller.ValueCount(TEST_UNIVERSE));
+  OLA_ASSERT_EQ(static_cast<size_t>(1), m_deferred_requests.size());
+  poller.RemoveClient(&client);
+}
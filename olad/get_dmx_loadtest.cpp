@@ -0,0 +1,193 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * get_dmx_loadtest.cpp
+ * Measure the latency of the GetDmx RPC, which backs the web server's
+ * /get_dmx handler, over a pipe and over an InProcessRpcChannel.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#include <sys/resource.h>
+#include <stdint.h>
+
+#include <iostream>
+#include <memory>
+
+#include "common/rpc/InProcessRpcChannel.h"
+#include "common/rpc/RpcChannel.h"
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/Logging.h"
+#include "ola/OlaClientCore.h"
+#include "ola/base/Flags.h"
+#include "ola/base/Init.h"
+#include "ola/io/Descriptor.h"
+#include "ola/io/SelectServer.h"
+#include "ola/thread/CallbackThread.h"
+#include "olad/OlaServerServiceImpl.h"
+#include "olad/Universe.h"
+#include "olad/plugin_api/UniverseStore.h"
+
+using ola::Clock;
+using ola::DmxBuffer;
+using ola::NewSingleCallback;
+using ola::OlaServerServiceImpl;
+using ola::TimeStamp;
+using ola::UniverseStore;
+using ola::client::DMXMetadata;
+using ola::client::OlaClientCore;
+using ola::client::Result;
+using ola::io::PipeDescriptor;
+using ola::io::SelectServer;
+using ola::rpc::InProcessRpcChannel;
+using ola::rpc::RpcChannel;
+using ola::thread::CallbackThread;
+using std::auto_ptr;
+using std::cout;
+using std::endl;
+
+DEFINE_uint32(calls, 20000, "The number of GetDmx calls to make");
+
+namespace {
+
+/**
+ * Makes one call at a time, the next call is made once the previous one
+ * completes.
+ */
+class CallLoop {
+ public:
+  CallLoop(SelectServer *ss, OlaClientCore *client, unsigned int calls)
+      : m_ss(ss),
+        m_client(client),
+        m_remaining(calls),
+        m_failures(0) {
+  }
+
+  void Next() {
+    if (!m_remaining--) {
+      m_ss->Terminate();
+      return;
+    }
+    m_client->FetchDMX(1, NewSingleCallback(this, &CallLoop::Complete));
+  }
+
+  unsigned int Failures() const { return m_failures; }
+
+ private:
+  SelectServer *m_ss;
+  OlaClientCore *m_client;
+  unsigned int m_remaining;
+  unsigned int m_failures;
+
+  void Complete(const Result &result, const DMXMetadata&,
+                const DmxBuffer &buffer) {
+    if (!result.Success() || buffer.Size() != ola::DMX_UNIVERSE_SIZE) {
+      m_failures++;
+    }
+    Next();
+  }
+};
+
+int64_t CPUTime() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return (static_cast<int64_t>(usage.ru_utime.tv_sec) +
+          usage.ru_stime.tv_sec) * ola::USEC_IN_SECONDS +
+         usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+/*
+ * Run the calls from the client SelectServer, with olad's SelectServer in
+ * another thread, the same as the web server.
+ */
+void Run(const char *name, SelectServer *client_ss, SelectServer *server_ss,
+         OlaClientCore *client) {
+  CallbackThread thread(NewSingleCallback(server_ss, &SelectServer::Run));
+  thread.Start();
+
+  CallLoop loop(client_ss, client, FLAGS_calls);
+  Clock clock;
+  TimeStamp start, end;
+  clock.CurrentTime(&start);
+  const int64_t start_cpu = CPUTime();
+
+  client_ss->Execute(NewSingleCallback(&loop, &CallLoop::Next));
+  client_ss->Run();
+
+  clock.CurrentTime(&end);
+  const int64_t cpu = CPUTime() - start_cpu;
+  server_ss->Terminate();
+  thread.Join();
+
+  cout << name << ": " << static_cast<double>((end - start).AsInt()) /
+          FLAGS_calls << " us/call, CPU "
+       << static_cast<double>(cpu) / FLAGS_calls << " us/call";
+  if (loop.Failures()) {
+    cout << ", " << loop.Failures() << " failures";
+  }
+  cout << endl;
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  ola::AppInit(&argc, argv, "[options]",
+               "Measure the GetDmx RPC over a pipe and in-process.");
+
+  UniverseStore universe_store(NULL, NULL);
+  DmxBuffer buffer;
+  buffer.SetRangeToValue(0, 128, ola::DMX_UNIVERSE_SIZE);
+  universe_store.GetUniverseOrCreate(1)->SetDMX(buffer);
+
+  OlaServerServiceImpl service(&universe_store, NULL, NULL, NULL, NULL, NULL,
+                               NULL, NULL);
+
+  {
+    SelectServer client_ss, server_ss;
+    PipeDescriptor pipe;
+    pipe.Init();
+    auto_ptr<PipeDescriptor> other_end(pipe.OppositeEnd());
+
+    RpcChannel server_channel(&service, &pipe);
+    server_ss.AddReadDescriptor(&pipe);
+    OlaClientCore client(other_end.get());
+    client.Setup();
+    client_ss.AddReadDescriptor(other_end.get());
+
+    Run("pipe", &client_ss, &server_ss, &client);
+
+    client_ss.RemoveReadDescriptor(other_end.get());
+    server_ss.RemoveReadDescriptor(&pipe);
+    client.Stop();
+  }
+
+  {
+    SelectServer client_ss, server_ss;
+    InProcessRpcChannel server_channel(&service, &server_ss);
+    InProcessRpcChannel client_channel(NULL, &client_ss);
+    InProcessRpcChannel::Connect(&server_channel, &client_channel);
+    OlaClientCore client(&client_channel);
+    client.Setup();
+
+    Run("in-process", &client_ss, &server_ss, &client);
+
+    client.Stop();
+    client_channel.Close();
+    server_ss.DrainCallbacks();
+    client_ss.DrainCallbacks();
+  }
+  return 0;
+}
@@ -19,6 +19,7 @@
  */
 
 #include <map>
+#include <string>
 #include <utility>
 #include "common/protocol/Ola.pb.h"
 #include "common/protocol/OlaService.pb.h"
@@ -33,15 +34,39 @@ namespace ola {
 using ola::rdm::UID;
 using ola::rpc::RpcController;
 using std::map;
+using std::string;
+
+/*
+ * The state for an in-flight UpdateDmxData call.
+ */
+class Client::DmxUpdate {
+ public:
+  RpcController controller;
+  ola::proto::Ack ack;
+};
+
+/*
+ * The state for an in-flight UpdateRDMParameter call.
+ */
+class Client::RDMUpdate {
+ public:
+  RpcController controller;
+  ola::proto::RDMParameterUpdate request;
+  ola::proto::Ack ack;
+};
+
+const unsigned int Client::MAX_FREE_UPDATES = 4;
 
 Client::Client(ola::proto::OlaClientService_Stub *client_stub,
                const ola::rdm::UID &uid)
     : m_client_stub(client_stub),
-      m_uid(uid) {
+      m_uid(uid),
+      m_dmx_data(new ola::proto::DmxData()) {
 }
 
 Client::~Client() {
   m_data_map.clear();
+  STLDeleteElements(&m_free_updates);
 }
 
 bool Client::SendDMX(unsigned int universe, uint8_t priority,
@@ -51,20 +76,49 @@ bool Client::SendDMX(unsigned int universe, uint8_t priority,
     return false;
   }
 
-  RpcController *controller = new RpcController();
-  ola::proto::DmxData dmx_data;
-  ola::proto::Ack *ack = new ola::proto::Ack();
+  DmxUpdate *update;
+  if (m_free_updates.empty()) {
+    update = new DmxUpdate();
+  } else {
+    update = m_free_updates.back();
+    m_free_updates.pop_back();
+  }
 
-  dmx_data.set_priority(priority);
-  dmx_data.set_universe(universe);
-  dmx_data.set_data(buffer.Get());
+  m_dmx_data->set_priority(priority);
+  m_dmx_data->set_universe(universe);
+  m_dmx_data->set_data(buffer.GetRaw(), buffer.Size());
 
   m_client_stub->UpdateDmxData(
-      controller,
-      &dmx_data,
-      ack,
-      ola::NewSingleCallback(this, &ola::Client::SendDMXCallback,
-                             controller, ack));
+      &update->controller,
+      m_dmx_data.get(),
+      &update->ack,
+      ola::NewSingleCallback(this, &ola::Client::SendDMXCallback, update));
+  return true;
+}
+
+bool Client::SendRDMUpdate(unsigned int universe, const UID &uid,
+                           uint16_t sub_device, uint16_t pid,
+                           const string &data) {
+  if (!m_client_stub.get()) {
+    OLA_FATAL << "client_stub is null";
+    return false;
+  }
+
+  // Parameter changes are rare, so there's no free list here.
+  RDMUpdate *update = new RDMUpdate();
+  update->request.set_universe(universe);
+  update->request.mutable_uid()->set_esta_id(uid.ManufacturerId());
+  update->request.mutable_uid()->set_device_id(uid.DeviceId());
+  update->request.set_sub_device(sub_device);
+  update->request.set_param_id(pid);
+  update->request.set_data(data);
+
+  m_client_stub->UpdateRDMParameter(
+      &update->controller,
+      &update->request,
+      &update->ack,
+      ola::NewSingleCallback(this, &ola::Client::SendRDMUpdateCallback,
+                             update));
   return true;
 }
 
@@ -95,10 +149,21 @@ void Client::SetUID(const ola::rdm::UID &uid) {
 /*
  * Called when UpdateDmxData completes.
  */
-void Client::SendDMXCallback(RpcController *controller,
-                             ola::proto::Ack *reply) {
-  delete controller;
-  delete reply;
+void Client::SendDMXCallback(DmxUpdate *update) {
+  if (m_free_updates.size() < MAX_FREE_UPDATES) {
+    update->controller.Reset();
+    update->ack.Clear();
+    m_free_updates.push_back(update);
+  } else {
+    delete update;
+  }
+}
+
+/*
+ * Called when UpdateRDMParameter completes.
+ */
+void Client::SendRDMUpdateCallback(RDMUpdate *update) {
+  delete update;
 }
 
 
@@ -21,8 +21,11 @@
 #ifndef OLAD_PLUGIN_API_CLIENT_H_
 #define OLAD_PLUGIN_API_CLIENT_H_
 
+#include <stdint.h>
 #include <map>
 #include <memory>
+#include <string>
+#include <vector>
 #include "common/rpc/RpcController.h"
 #include "ola/base/Macro.h"
 #include "ola/rdm/UID.h"
@@ -32,6 +35,7 @@ namespace ola {
 namespace proto {
 class OlaClientService_Stub;
 class Ack;
+class DmxData;
 }
 }
 
@@ -67,6 +71,21 @@ class Client {
   virtual bool SendDMX(unsigned int universe_id, uint8_t priority,
                        const DmxBuffer &buffer);
 
+  /**
+   * @brief Push a change to a polled RDM parameter to this client.
+   * @param universe_id the universe the responder is on.
+   * @param uid the UID of the responder.
+   * @param sub_device the sub device.
+   * @param pid the PID of the parameter.
+   * @param data the new param data.
+   * @return true if the update was sent, false otherwise
+   */
+  virtual bool SendRDMUpdate(unsigned int universe_id,
+                             const ola::rdm::UID &uid,
+                             uint16_t sub_device,
+                             uint16_t pid,
+                             const std::string &data);
+
   /**
    * @brief Called when this client sends us new data
    * @param universe the id of the universe for the new data
@@ -96,12 +115,22 @@ class Client {
   void SetUID(const ola::rdm::UID &uid);
 
  private:
-  void SendDMXCallback(ola::rpc::RpcController *controller,
-                       ola::proto::Ack *ack);
+  class DmxUpdate;
+  class RDMUpdate;
+  typedef std::vector<DmxUpdate*> DmxUpdateList;
 
   std::auto_ptr<class ola::proto::OlaClientService_Stub> m_client_stub;
   std::map<unsigned int, DmxSource> m_data_map;
   ola::rdm::UID m_uid;
+  // SendDMX() is called for every frame, so we re-use the request and the
+  // controller / reply pairs rather than allocating new ones each time.
+  std::auto_ptr<ola::proto::DmxData> m_dmx_data;
+  DmxUpdateList m_free_updates;
+
+  void SendDMXCallback(DmxUpdate *update);
+  void SendRDMUpdateCallback(RDMUpdate *update);
+
+  static const unsigned int MAX_FREE_UPDATES;
 
   DISALLOW_COPY_AND_ASSIGN(Client);
 };
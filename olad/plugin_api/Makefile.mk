@@ -25,6 +25,10 @@ olad_plugin_api_libolaserverplugininterface_la_SOURCES = \
     olad/plugin_api/PortManager.cpp \
     olad/plugin_api/PortManager.h \
     olad/plugin_api/Preferences.cpp \
+    olad/plugin_api/RDMResponseCache.cpp \
+    olad/plugin_api/RDMResponseCache.h \
+    olad/plugin_api/RDMScheduler.cpp \
+    olad/plugin_api/RDMScheduler.h \
     olad/plugin_api/Universe.cpp \
     olad/plugin_api/UniverseStore.cpp \
     olad/plugin_api/UniverseStore.h
@@ -34,6 +38,24 @@ olad_plugin_api_libolaserverplugininterface_la_LIBADD = \
     common/web/libolaweb.la \
     ola/libola.la
 
+# PROGRAMS
+##################################################
+noinst_PROGRAMS += \
+    olad/plugin_api/client_loadtest \
+    olad/plugin_api/rdm_scheduler_loadtest
+
+olad_plugin_api_client_loadtest_SOURCES = olad/plugin_api/client_loadtest.cpp
+olad_plugin_api_client_loadtest_LDADD = \
+    $(libprotobuf_LIBS) \
+    olad/plugin_api/libolaserverplugininterface.la \
+    common/libolacommon.la
+
+olad_plugin_api_rdm_scheduler_loadtest_SOURCES = \
+    olad/plugin_api/rdm_scheduler_loadtest.cpp
+olad_plugin_api_rdm_scheduler_loadtest_LDADD = \
+    olad/plugin_api/libolaserverplugininterface.la \
+    common/libolacommon.la
+
 # TESTS
 ##################################################
 test_programs += \
@@ -72,6 +94,8 @@ olad_plugin_api_PreferencesTester_SOURCES = olad/plugin_api/PreferencesTest.cpp
 olad_plugin_api_PreferencesTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 olad_plugin_api_PreferencesTester_LDADD = $(COMMON_OLAD_PLUGIN_API_TEST_LDADD)
 
-olad_plugin_api_UniverseTester_SOURCES = olad/plugin_api/UniverseTest.cpp
+olad_plugin_api_UniverseTester_SOURCES = \
+    olad/plugin_api/RDMResponseCacheTest.cpp \
+    olad/plugin_api/UniverseTest.cpp
 olad_plugin_api_UniverseTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 olad_plugin_api_UniverseTester_LDADD = $(COMMON_OLAD_PLUGIN_API_TEST_LDADD)
@@ -0,0 +1,236 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * RDMResponseCache.cpp
+ * Caches the responses to GET requests for static RDM parameters.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#include "olad/plugin_api/RDMResponseCache.h"
+
+#include <string>
+
+#include "ola/Callback.h"
+#include "ola/base/Array.h"
+#include "ola/rdm/RDMEnums.h"
+#include "ola/rdm/RDMReply.h"
+
+namespace ola {
+
+using ola::rdm::RDMCallback;
+using ola::rdm::RDMCommand;
+using ola::rdm::RDMReply;
+using ola::rdm::RDMRequest;
+using ola::rdm::RDMResponse;
+using ola::rdm::UID;
+using ola::rdm::UIDSet;
+using std::string;
+
+namespace {
+
+/*
+ * The PIDs that are cached, and how long for. The PID data files don't
+ * describe how often a parameter changes, so this lists the PLASA PIDs that
+ * only change when a SET is sent, or when the device reports a queued
+ * message.
+ */
+const struct {
+  uint16_t pid;
+  unsigned int ttl;  // in seconds
+} CACHEABLE_PIDS[] = {
+  {ola::rdm::PID_SUPPORTED_PARAMETERS, 3600},
+  {ola::rdm::PID_PARAMETER_DESCRIPTION, 3600},
+  {ola::rdm::PID_DEVICE_INFO, 60},
+  {ola::rdm::PID_PRODUCT_DETAIL_ID_LIST, 3600},
+  {ola::rdm::PID_DEVICE_MODEL_DESCRIPTION, 3600},
+  {ola::rdm::PID_MANUFACTURER_LABEL, 3600},
+  {ola::rdm::PID_DEVICE_LABEL, 300},
+  {ola::rdm::PID_LANGUAGE_CAPABILITIES, 3600},
+  {ola::rdm::PID_SOFTWARE_VERSION_LABEL, 3600},
+  {ola::rdm::PID_BOOT_SOFTWARE_VERSION_ID, 3600},
+  {ola::rdm::PID_BOOT_SOFTWARE_VERSION_LABEL, 3600},
+  {ola::rdm::PID_DMX_PERSONALITY, 60},
+  {ola::rdm::PID_DMX_PERSONALITY_DESCRIPTION, 3600},
+  {ola::rdm::PID_DMX_START_ADDRESS, 60},
+  {ola::rdm::PID_SLOT_INFO, 300},
+  {ola::rdm::PID_SLOT_DESCRIPTION, 3600},
+  {ola::rdm::PID_DEFAULT_SLOT_VALUE, 3600},
+  {ola::rdm::PID_SENSOR_DEFINITION, 3600},
+  {ola::rdm::PID_SELF_TEST_DESCRIPTION, 3600},
+  {ola::rdm::PID_CURVE_DESCRIPTION, 3600},
+  {ola::rdm::PID_OUTPUT_RESPONSE_TIME_DESCRIPTION, 3600},
+  {ola::rdm::PID_MODULATION_FREQUENCY_DESCRIPTION, 3600},
+  {ola::rdm::PID_LOCK_STATE_DESCRIPTION, 3600},
+  {ola::rdm::PID_DIMMER_INFO, 3600},
+};
+}  // namespace
+
+bool RDMResponseCache::RequestKey::operator<(const RequestKey &other) const {
+  if (pid != other.pid) {
+    return pid < other.pid;
+  }
+  if (sub_device != other.sub_device) {
+    return sub_device < other.sub_device;
+  }
+  return param_data < other.param_data;
+}
+
+RDMResponseCache::RDMResponseCache(Clock *clock)
+    : m_clock(clock),
+      m_hits(0),
+      m_misses(0) {
+}
+
+RDMResponseCache::~RDMResponseCache() {
+  std::set<PendingRequest*>::iterator iter = m_pending.begin();
+  for (; iter != m_pending.end(); ++iter) {
+    (*iter)->cache = NULL;
+  }
+}
+
+RDMResponse *RDMResponseCache::Lookup(const RDMRequest &request) {
+  if (!IsCacheable(request)) {
+    return NULL;
+  }
+
+  EntryMap::iterator uid_iter = m_entries.find(request.DestinationUID());
+  if (uid_iter != m_entries.end()) {
+    RequestKey key;
+    MakeKey(request, &key);
+    UIDEntries::iterator iter = uid_iter->second.find(key);
+    if (iter != uid_iter->second.end()) {
+      TimeStamp now;
+      m_clock->CurrentTime(&now);
+      if (now < iter->second.expiry) {
+        m_hits++;
+        return ola::rdm::GetResponseFromData(
+            &request,
+            reinterpret_cast<const uint8_t*>(iter->second.param_data.data()),
+            iter->second.param_data.size());
+      }
+      uid_iter->second.erase(iter);
+    }
+  }
+  m_misses++;
+  return NULL;
+}
+
+RDMCallback *RDMResponseCache::Watch(const RDMRequest &request,
+                                     RDMCallback *callback) {
+  if (request.CommandClass() == RDMCommand::SET_COMMAND) {
+    if (request.DestinationUID().IsBroadcast()) {
+      InvalidateAll();
+    } else {
+      Invalidate(request.DestinationUID());
+    }
+  }
+
+  PendingRequest *pending = new PendingRequest(this, request.DestinationUID(),
+                                               callback);
+  pending->cacheable = IsCacheable(request);
+  if (pending->cacheable) {
+    MakeKey(request, &pending->key);
+  }
+  m_pending.insert(pending);
+  return NewSingleCallback(&RDMResponseCache::RequestComplete, pending);
+}
+
+void RDMResponseCache::Invalidate(const UID &uid) {
+  m_entries.erase(uid);
+}
+
+void RDMResponseCache::Invalidate(const UIDSet &uids) {
+  UIDSet::Iterator iter = uids.Begin();
+  for (; iter != uids.End(); ++iter) {
+    m_entries.erase(*iter);
+  }
+}
+
+void RDMResponseCache::InvalidateAll() {
+  m_entries.clear();
+}
+
+unsigned int RDMResponseCache::Size() const {
+  unsigned int size = 0;
+  EntryMap::const_iterator iter = m_entries.begin();
+  for (; iter != m_entries.end(); ++iter) {
+    size += iter->second.size();
+  }
+  return size;
+}
+
+unsigned int RDMResponseCache::CacheTTL(uint16_t pid) {
+  for (unsigned int i = 0; i < arraysize(CACHEABLE_PIDS); i++) {
+    if (CACHEABLE_PIDS[i].pid == pid) {
+      return CACHEABLE_PIDS[i].ttl;
+    }
+  }
+  return 0;
+}
+
+bool RDMResponseCache::IsCacheable(const RDMRequest &request) {
+  return (request.CommandClass() == RDMCommand::GET_COMMAND &&
+          !request.DestinationUID().IsBroadcast() &&
+          CacheTTL(request.ParamId()) > 0);
+}
+
+void RDMResponseCache::MakeKey(const RDMRequest &request, RequestKey *key) {
+  key->sub_device = request.SubDevice();
+  key->pid = request.ParamId();
+  key->param_data.assign(reinterpret_cast<const char*>(request.ParamData()),
+                         request.ParamDataSize());
+}
+
+void RDMResponseCache::RequestComplete(PendingRequest *pending,
+                                       RDMReply *reply) {
+  if (pending->cache) {
+    pending->cache->m_pending.erase(pending);
+    pending->cache->HandleReply(*pending, *reply);
+  }
+  RDMCallback *callback = pending->callback;
+  delete pending;
+  callback->Run(reply);
+}
+
+void RDMResponseCache::HandleReply(const PendingRequest &pending,
+                                   const RDMReply &reply) {
+  const RDMResponse *response = reply.Response();
+  if (reply.StatusCode() != ola::rdm::RDM_COMPLETED_OK || !response) {
+    return;
+  }
+
+  if (response->MessageCount() ||
+      response->CommandClass() == RDMCommand::SET_COMMAND_RESPONSE) {
+    // The device has queued messages, something may have changed. SETs are
+    // invalidated again in case a GET was sent while the SET was in flight.
+    Invalidate(pending.uid);
+    return;
+  }
+
+  if (!pending.cacheable ||
+      response->ResponseType() != ola::rdm::RDM_ACK ||
+      response->CommandClass() != RDMCommand::GET_COMMAND_RESPONSE ||
+      response->ParamId() != pending.key.pid) {
+    return;
+  }
+
+  CacheEntry &entry = m_entries[pending.uid][pending.key];
+  m_clock->CurrentTime(&entry.expiry);
+  entry.expiry += TimeInterval(CacheTTL(pending.key.pid), 0);
+  entry.param_data.assign(
+      reinterpret_cast<const char*>(response->ParamData()),
+      response->ParamDataSize());
+}
+}  // namespace ola
@@ -0,0 +1,174 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * RDMResponseCache.h
+ * Caches the responses to GET requests for static RDM parameters.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#ifndef OLAD_PLUGIN_API_RDMRESPONSECACHE_H_
+#define OLAD_PLUGIN_API_RDMRESPONSECACHE_H_
+
+#include <stdint.h>
+#include <map>
+#include <set>
+#include <string>
+
+#include "ola/Clock.h"
+#include "ola/base/Macro.h"
+#include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/RDMControllerInterface.h"
+#include "ola/rdm/UID.h"
+#include "ola/rdm/UIDSet.h"
+
+namespace ola {
+
+/**
+ * @brief Caches the responses to GET requests for static RDM parameters.
+ *
+ * Entries are keyed on the UID, sub device, PID and param data of the
+ * request. Only PIDs with a non-zero CacheTTL() are cached, and only ACK
+ * responses are stored.
+ *
+ * The entries for a UID are dropped when a SET is sent to it, when it reports
+ * queued messages and when it's removed from the universe.
+ */
+class RDMResponseCache {
+ public:
+  /**
+   * @brief Create a new RDMResponseCache.
+   * @param clock the Clock used to expire entries.
+   */
+  explicit RDMResponseCache(Clock *clock);
+
+  /**
+   * @brief Destructor.
+   *
+   * Requests that are still in flight complete as normal, but aren't added
+   * to the cache.
+   */
+  ~RDMResponseCache();
+
+  /**
+   * @brief Attempt to answer a request from the cache.
+   * @param request the RDMRequest.
+   * @returns A new RDMResponse for the request, or NULL if the request
+   *   couldn't be answered from the cache.
+   */
+  ola::rdm::RDMResponse *Lookup(const ola::rdm::RDMRequest &request);
+
+  /**
+   * @brief Watch a request that is about to be sent to a responder.
+   * @param request the RDMRequest that is being sent.
+   * @param callback the callback to run once the request completes.
+   * @returns A callback to pass to the port. When run, it updates the cache
+   *   and then runs callback.
+   *
+   * SET requests invalidate the entries for the destination UID.
+   */
+  ola::rdm::RDMCallback *Watch(const ola::rdm::RDMRequest &request,
+                               ola::rdm::RDMCallback *callback);
+
+  /**
+   * @brief Drop the entries for a UID.
+   */
+  void Invalidate(const ola::rdm::UID &uid);
+
+  /**
+   * @brief Drop the entries for a set of UIDs.
+   */
+  void Invalidate(const ola::rdm::UIDSet &uids);
+
+  /**
+   * @brief Drop all entries.
+   */
+  void InvalidateAll();
+
+  /**
+   * @brief The number of requests answered from the cache.
+   */
+  unsigned int Hits() const { return m_hits; }
+
+  /**
+   * @brief The number of cacheable requests that weren't in the cache.
+   */
+  unsigned int Misses() const { return m_misses; }
+
+  /**
+   * @brief The number of cached responses.
+   */
+  unsigned int Size() const;
+
+  /**
+   * @brief Return the time to cache the responses for a PID.
+   * @param pid the PID.
+   * @returns the number of seconds to cache the response, or 0 if the PID
+   *   shouldn't be cached.
+   */
+  static unsigned int CacheTTL(uint16_t pid);
+
+ private:
+  struct RequestKey {
+    uint16_t sub_device;
+    uint16_t pid;
+    std::string param_data;
+
+    bool operator<(const RequestKey &other) const;
+  };
+
+  struct CacheEntry {
+    TimeStamp expiry;
+    std::string param_data;
+  };
+
+  typedef std::map<RequestKey, CacheEntry> UIDEntries;
+  typedef std::map<ola::rdm::UID, UIDEntries> EntryMap;
+
+  /*
+   * A request that is in flight.
+   */
+  struct PendingRequest {
+    RDMResponseCache *cache;
+    ola::rdm::UID uid;
+    RequestKey key;
+    bool cacheable;
+    ola::rdm::RDMCallback *callback;
+
+    PendingRequest(RDMResponseCache *cache, const ola::rdm::UID &uid,
+                   ola::rdm::RDMCallback *callback)
+        : cache(cache),
+          uid(uid),
+          cacheable(false),
+          callback(callback) {
+    }
+  };
+
+  Clock *m_clock;
+  EntryMap m_entries;
+  std::set<PendingRequest*> m_pending;
+  unsigned int m_hits;
+  unsigned int m_misses;
+
+  static bool IsCacheable(const ola::rdm::RDMRequest &request);
+  static void MakeKey(const ola::rdm::RDMRequest &request, RequestKey *key);
+  static void RequestComplete(PendingRequest *pending,
+                              ola::rdm::RDMReply *reply);
+  void HandleReply(const PendingRequest &pending,
+                   const ola::rdm::RDMReply &reply);
+
+  DISALLOW_COPY_AND_ASSIGN(RDMResponseCache);
+};
+}  // namespace ola
+#endif  // OLAD_PLUGIN_API_RDMRESPONSECACHE_H_
@@ -0,0 +1,274 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * RDMResponseCacheTest.cpp
+ * Test fixture for the RDMResponseCache class
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <memory>
+#include <string>
+
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/RDMEnums.h"
+#include "ola/rdm/RDMReply.h"
+#include "ola/rdm/UID.h"
+#include "ola/rdm/UIDSet.h"
+#include "ola/testing/TestUtils.h"
+#include "olad/plugin_api/RDMResponseCache.h"
+
+using ola::MockClock;
+using ola::NewSingleCallback;
+using ola::RDMResponseCache;
+using ola::rdm::RDMCallback;
+using ola::rdm::RDMGetRequest;
+using ola::rdm::RDMReply;
+using ola::rdm::RDMRequest;
+using ola::rdm::RDMResponse;
+using ola::rdm::RDMSetRequest;
+using ola::rdm::UID;
+using ola::rdm::UIDSet;
+using std::auto_ptr;
+using std::string;
+
+class RDMResponseCacheTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(RDMResponseCacheTest);
+  CPPUNIT_TEST(testLookup);
+  CPPUNIT_TEST(testUncacheable);
+  CPPUNIT_TEST(testExpiry);
+  CPPUNIT_TEST(testInvalidation);
+  CPPUNIT_TEST(testDeletedWithRequestInFlight);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  RDMResponseCacheTest()
+      : m_source(0x7a70, 100),
+        m_uid1(0x7a70, 1),
+        m_uid2(0x7a70, 2),
+        m_callback_count(0) {
+  }
+
+  void setUp() {
+    m_callback_count = 0;
+  }
+
+  void testLookup();
+  void testUncacheable();
+  void testExpiry();
+  void testInvalidation();
+  void testDeletedWithRequestInFlight();
+
+ private:
+  MockClock m_clock;
+  UID m_source;
+  UID m_uid1;
+  UID m_uid2;
+  unsigned int m_callback_count;
+
+  RDMRequest *NewGet(const UID &uid, uint16_t pid) {
+    return new RDMGetRequest(m_source, uid, 1, 1, 0, pid, NULL, 0);
+  }
+
+  void SendAndAck(RDMResponseCache *cache, const RDMRequest &request,
+                  const string &data, uint8_t message_count = 0);
+  void CallbackRan(RDMReply *) { m_callback_count++; }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(RDMResponseCacheTest);
+
+/*
+ * Pass a request through the cache and complete it with an ACK.
+ */
+void RDMResponseCacheTest::SendAndAck(RDMResponseCache *cache,
+                                      const RDMRequest &request,
+                                      const string &data,
+                                      uint8_t message_count) {
+  RDMCallback *callback = cache->Watch(
+      request, NewSingleCallback(this, &RDMResponseCacheTest::CallbackRan));
+  RDMReply reply(
+      ola::rdm::RDM_COMPLETED_OK,
+      ola::rdm::GetResponseFromData(
+          &request, reinterpret_cast<const uint8_t*>(data.data()),
+          data.size(), ola::rdm::RDM_ACK, message_count));
+  callback->Run(&reply);
+}
+
+/*
+ * Check that ACKs are cached and returned.
+ */
+void RDMResponseCacheTest::testLookup() {
+  RDMResponseCache cache(&m_clock);
+  auto_ptr<RDMRequest> request(NewGet(m_uid1, ola::rdm::PID_DEVICE_LABEL));
+  OLA_ASSERT_NULL(cache.Lookup(*request));
+  OLA_ASSERT_EQ(0u, cache.Hits());
+  OLA_ASSERT_EQ(1u, cache.Misses());
+
+  SendAndAck(&cache, *request, "foo");
+  OLA_ASSERT_EQ(1u, m_callback_count);
+  OLA_ASSERT_EQ(1u, cache.Size());
+
+  // A different source and transaction number gets a matching response.
+  RDMGetRequest other_request(UID(0x7a70, 200), m_uid1, 42, 1, 0,
+                              ola::rdm::PID_DEVICE_LABEL, NULL, 0);
+  auto_ptr<RDMResponse> response(cache.Lookup(other_request));
+  OLA_ASSERT_NOT_NULL(response.get());
+  OLA_ASSERT_EQ(m_uid1, response->SourceUID());
+  OLA_ASSERT_EQ(UID(0x7a70, 200), response->DestinationUID());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(42), response->TransactionNumber());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(ola::rdm::RDM_ACK),
+                response->ResponseType());
+  OLA_ASSERT_EQ(string("foo"),
+                string(reinterpret_cast<const char*>(response->ParamData()),
+                       response->ParamDataSize()));
+  OLA_ASSERT_EQ(1u, cache.Hits());
+
+  // Other UIDs and sub devices are separate entries.
+  auto_ptr<RDMRequest> uid2_request(NewGet(m_uid2,
+                                           ola::rdm::PID_DEVICE_LABEL));
+  OLA_ASSERT_NULL(cache.Lookup(*uid2_request));
+  RDMGetRequest sub_device_request(m_source, m_uid1, 1, 1, 1,
+                                   ola::rdm::PID_DEVICE_LABEL, NULL, 0);
+  OLA_ASSERT_NULL(cache.Lookup(sub_device_request));
+
+  // As is the param data.
+  uint8_t personality = 1;
+  RDMGetRequest description1(m_source, m_uid1, 1, 1, 0,
+                             ola::rdm::PID_DMX_PERSONALITY_DESCRIPTION,
+                             &personality, sizeof(personality));
+  SendAndAck(&cache, description1, "one");
+  personality = 2;
+  RDMGetRequest description2(m_source, m_uid1, 1, 1, 0,
+                             ola::rdm::PID_DMX_PERSONALITY_DESCRIPTION,
+                             &personality, sizeof(personality));
+  OLA_ASSERT_NULL(cache.Lookup(description2));
+  response.reset(cache.Lookup(description1));
+  OLA_ASSERT_NOT_NULL(response.get());
+}
+
+/*
+ * Check that dynamic PIDs, NACKs and SETs aren't cached.
+ */
+void RDMResponseCacheTest::testUncacheable() {
+  RDMResponseCache cache(&m_clock);
+  auto_ptr<RDMRequest> request(NewGet(m_uid1, ola::rdm::PID_SENSOR_VALUE));
+  SendAndAck(&cache, *request, "foo");
+  OLA_ASSERT_NULL(cache.Lookup(*request));
+  OLA_ASSERT_EQ(0u, cache.Misses());
+  OLA_ASSERT_EQ(0u, cache.Size());
+
+  request.reset(NewGet(m_uid1, ola::rdm::PID_DEVICE_LABEL));
+  RDMCallback *callback = cache.Watch(
+      *request, NewSingleCallback(this, &RDMResponseCacheTest::CallbackRan));
+  RDMReply nack(ola::rdm::RDM_COMPLETED_OK,
+                ola::rdm::NackWithReason(request.get(),
+                                         ola::rdm::NR_UNKNOWN_PID));
+  callback->Run(&nack);
+  OLA_ASSERT_EQ(0u, cache.Size());
+
+  callback = cache.Watch(
+      *request, NewSingleCallback(this, &RDMResponseCacheTest::CallbackRan));
+  RDMReply timeout(ola::rdm::RDM_TIMEOUT);
+  callback->Run(&timeout);
+  OLA_ASSERT_EQ(0u, cache.Size());
+  OLA_ASSERT_EQ(3u, m_callback_count);
+}
+
+/*
+ * Check entries expire.
+ */
+void RDMResponseCacheTest::testExpiry() {
+  RDMResponseCache cache(&m_clock);
+  auto_ptr<RDMRequest> request(NewGet(m_uid1, ola::rdm::PID_DEVICE_LABEL));
+  SendAndAck(&cache, *request, "foo");
+
+  const unsigned int ttl = RDMResponseCache::CacheTTL(
+      ola::rdm::PID_DEVICE_LABEL);
+  OLA_ASSERT_TRUE(ttl > 0);
+  m_clock.AdvanceTime(ttl - 1, 0);
+  auto_ptr<RDMResponse> response(cache.Lookup(*request));
+  OLA_ASSERT_NOT_NULL(response.get());
+
+  m_clock.AdvanceTime(1, 0);
+  OLA_ASSERT_NULL(cache.Lookup(*request));
+  OLA_ASSERT_EQ(0u, cache.Size());
+}
+
+/*
+ * Check SETs, queued messages and Invalidate() drop entries.
+ */
+void RDMResponseCacheTest::testInvalidation() {
+  RDMResponseCache cache(&m_clock);
+  auto_ptr<RDMRequest> label1(NewGet(m_uid1, ola::rdm::PID_DEVICE_LABEL));
+  auto_ptr<RDMRequest> info1(NewGet(m_uid1, ola::rdm::PID_DEVICE_INFO));
+  auto_ptr<RDMRequest> label2(NewGet(m_uid2, ola::rdm::PID_DEVICE_LABEL));
+  SendAndAck(&cache, *label1, "foo");
+  SendAndAck(&cache, *info1, "info");
+  SendAndAck(&cache, *label2, "bar");
+  OLA_ASSERT_EQ(3u, cache.Size());
+
+  // A SET drops all the entries for the UID, since a SET may change other
+  // parameters.
+  RDMSetRequest set_request(m_source, m_uid1, 1, 1, 0,
+                            ola::rdm::PID_DMX_START_ADDRESS, NULL, 0);
+  RDMCallback *callback = cache.Watch(
+      set_request,
+      NewSingleCallback(this, &RDMResponseCacheTest::CallbackRan));
+  OLA_ASSERT_EQ(1u, cache.Size());
+
+  // A GET sent while the SET is in flight is invalidated when the SET
+  // completes.
+  SendAndAck(&cache, *label1, "foo");
+  OLA_ASSERT_EQ(2u, cache.Size());
+  RDMReply set_reply(ola::rdm::RDM_COMPLETED_OK,
+                     ola::rdm::GetResponseFromData(&set_request));
+  callback->Run(&set_reply);
+  OLA_ASSERT_EQ(1u, cache.Size());
+
+  // A response with queued messages drops the entries for the UID.
+  SendAndAck(&cache, *label1, "foo");
+  OLA_ASSERT_EQ(2u, cache.Size());
+  SendAndAck(&cache, *info1, "info", 1);
+  OLA_ASSERT_EQ(1u, cache.Size());
+  OLA_ASSERT_NULL(cache.Lookup(*label1));
+
+  UIDSet uids;
+  uids.AddUID(m_uid2);
+  cache.Invalidate(uids);
+  OLA_ASSERT_EQ(0u, cache.Size());
+
+  SendAndAck(&cache, *label1, "foo");
+  SendAndAck(&cache, *label2, "bar");
+  cache.InvalidateAll();
+  OLA_ASSERT_EQ(0u, cache.Size());
+}
+
+/*
+ * Check requests in flight complete after the cache is deleted.
+ */
+void RDMResponseCacheTest::testDeletedWithRequestInFlight() {
+  auto_ptr<RDMResponseCache> cache(new RDMResponseCache(&m_clock));
+  auto_ptr<RDMRequest> request(NewGet(m_uid1, ola::rdm::PID_DEVICE_LABEL));
+  RDMCallback *callback = cache->Watch(
+      *request, NewSingleCallback(this, &RDMResponseCacheTest::CallbackRan));
+  cache.reset();
+
+  RDMReply reply(ola::rdm::RDM_COMPLETED_OK,
+                 ola::rdm::GetResponseFromData(request.get()));
+  callback->Run(&reply);
+  OLA_ASSERT_EQ(1u, m_callback_count);
+}
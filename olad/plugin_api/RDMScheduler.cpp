@@ -0,0 +1,176 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * RDMScheduler.cpp
+ * Schedules RDM requests across the output ports of a universe.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#include "olad/plugin_api/RDMScheduler.h"
+
+#include "ola/Logging.h"
+#include "ola/stl/STLUtils.h"
+#include "olad/Port.h"
+
+namespace ola {
+
+using ola::rdm::RDMCallback;
+using ola::rdm::RDMReply;
+using ola::rdm::RDMRequest;
+using ola::rdm::RunRDMCallback;
+
+const unsigned int RDMScheduler::MAX_QUEUE_SIZE;
+
+RDMScheduler::~RDMScheduler() {
+  PortQueues queues;
+  queues.swap(m_queues);
+  PortQueues::iterator iter = queues.begin();
+  for (; iter != queues.end(); ++iter) {
+    Detach(iter->second);
+  }
+}
+
+void RDMScheduler::SendRDMRequest(OutputPort *port,
+                                  RDMRequest *request,
+                                  RDMCallback *callback,
+                                  Universe::RDMPriority priority) {
+  PortQueue *queue = STLFindOrNull(m_queues, port);
+  if (!queue) {
+    queue = new PortQueue(this, port);
+    m_queues[port] = queue;
+  }
+
+  RequestQueue *requests = (priority == Universe::RDM_PRIORITY_BACKGROUND ?
+                            &queue->background : &queue->interactive);
+  if (requests->size() >= MAX_QUEUE_SIZE) {
+    OLA_WARN << "RDM queue for port " << port->UniqueId() << " is full";
+    delete request;
+    RunRDMCallback(callback, ola::rdm::RDM_FAILED_TO_SEND);
+    return;
+  }
+
+  PendingRequest pending = {request, callback};
+  requests->push_back(pending);
+  MaybeDispatch(queue);
+}
+
+void RDMScheduler::PortRemoved(OutputPort *port) {
+  PortQueues::iterator iter = m_queues.find(port);
+  if (iter == m_queues.end()) {
+    return;
+  }
+
+  PortQueue *queue = iter->second;
+  m_queues.erase(iter);
+  Detach(queue);
+}
+
+unsigned int RDMScheduler::QueuedRequests() const {
+  unsigned int count = 0;
+  PortQueues::const_iterator iter = m_queues.begin();
+  for (; iter != m_queues.end(); ++iter) {
+    count += iter->second->interactive.size() +
+             iter->second->background.size();
+  }
+  return count;
+}
+
+unsigned int RDMScheduler::InFlightRequests() const {
+  unsigned int count = 0;
+  PortQueues::const_iterator iter = m_queues.begin();
+  for (; iter != m_queues.end(); ++iter) {
+    if (iter->second->in_flight) {
+      count++;
+    }
+  }
+  return count;
+}
+
+/*
+ * Remove the queue from the scheduler and fail any queued requests.
+ */
+void RDMScheduler::Detach(PortQueue *queue) {
+  queue->scheduler = NULL;
+
+  // The callbacks may call back into the scheduler, so take the requests
+  // first.
+  RequestQueue interactive, background;
+  interactive.swap(queue->interactive);
+  background.swap(queue->background);
+  MaybeDelete(queue);
+
+  FailRequests(&interactive);
+  FailRequests(&background);
+}
+
+/*
+ * Send requests until there is one in flight. If the port completes requests
+ * synchronously, this loops rather than recursing.
+ */
+void RDMScheduler::MaybeDispatch(PortQueue *queue) {
+  if (queue->dispatching) {
+    return;
+  }
+
+  queue->dispatching = true;
+  while (queue->scheduler && !queue->in_flight && !queue->Empty()) {
+    RequestQueue *requests = (queue->interactive.empty() ?
+                              &queue->background : &queue->interactive);
+    PendingRequest pending = requests->front();
+    requests->pop_front();
+
+    queue->in_flight = true;
+    queue->port->SendRDMRequest(
+        pending.request,
+        NewSingleCallback(&RDMScheduler::RequestComplete, queue,
+                          pending.callback));
+  }
+  queue->dispatching = false;
+  MaybeDelete(queue);
+}
+
+void RDMScheduler::MaybeDelete(PortQueue *queue) {
+  if (!queue->scheduler && !queue->in_flight && !queue->dispatching) {
+    delete queue;
+  }
+}
+
+/*
+ * Called when the port completes a request. The request is still marked as
+ * in flight while the callback runs, which keeps the queue alive if the
+ * callback removes the port.
+ */
+void RDMScheduler::RequestComplete(PortQueue *queue,
+                                   RDMCallback *callback,
+                                   RDMReply *reply) {
+  callback->Run(reply);
+  queue->in_flight = false;
+
+  if (queue->scheduler) {
+    MaybeDispatch(queue);
+  } else {
+    MaybeDelete(queue);
+  }
+}
+
+void RDMScheduler::FailRequests(RequestQueue *queue) {
+  while (!queue->empty()) {
+    PendingRequest pending = queue->front();
+    queue->pop_front();
+    delete pending.request;
+    RunRDMCallback(pending.callback, ola::rdm::RDM_FAILED_TO_SEND);
+  }
+}
+}  // namespace ola
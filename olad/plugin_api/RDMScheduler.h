@@ -0,0 +1,140 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * RDMScheduler.h
+ * Schedules RDM requests across the output ports of a universe.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#ifndef OLAD_PLUGIN_API_RDMSCHEDULER_H_
+#define OLAD_PLUGIN_API_RDMSCHEDULER_H_
+
+#include <deque>
+#include <map>
+
+#include "ola/base/Macro.h"
+#include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/RDMControllerInterface.h"
+#include "olad/Universe.h"
+
+namespace ola {
+
+class OutputPort;
+
+/**
+ * @brief Schedules RDM requests to the output ports of a universe.
+ *
+ * Each port has one request in flight at a time, requests to different ports
+ * run in parallel. Interactive requests are sent before any queued
+ * background requests for the same port.
+ *
+ * Ports can complete requests synchronously, so the completion may run from
+ * within SendRDMRequest().
+ */
+class RDMScheduler {
+ public:
+  RDMScheduler() {}
+
+  /**
+   * @brief Destructor.
+   *
+   * Any queued requests are failed with RDM_FAILED_TO_SEND. The callbacks for
+   * requests that are in flight are still run when the port completes them.
+   */
+  ~RDMScheduler();
+
+  /**
+   * @brief Queue a request for a port.
+   * @param port the OutputPort to send the request on.
+   * @param request the RDMRequest, ownership is transferred.
+   * @param callback the callback to run when the request completes.
+   * @param priority the priority of the request.
+   */
+  void SendRDMRequest(OutputPort *port,
+                      ola::rdm::RDMRequest *request,
+                      ola::rdm::RDMCallback *callback,
+                      Universe::RDMPriority priority);
+
+  /**
+   * @brief Called when a port is removed from the universe.
+   * @param port the OutputPort that was removed.
+   *
+   * Any queued requests for the port are failed with RDM_FAILED_TO_SEND.
+   */
+  void PortRemoved(OutputPort *port);
+
+  /**
+   * @brief The number of requests that are waiting to be sent.
+   */
+  unsigned int QueuedRequests() const;
+
+  /**
+   * @brief The number of requests in flight.
+   */
+  unsigned int InFlightRequests() const;
+
+  /**
+   * @brief The maximum number of queued requests for each priority, per
+   *   port.
+   */
+  static const unsigned int MAX_QUEUE_SIZE = 1000;
+
+ private:
+  struct PendingRequest {
+    ola::rdm::RDMRequest *request;
+    ola::rdm::RDMCallback *callback;
+  };
+
+  typedef std::deque<PendingRequest> RequestQueue;
+
+  /*
+   * The queue for a port. The completion callback of the in flight request
+   * refers to the queue, so once the port is removed the queue is detached
+   * (scheduler is set to NULL) and lives until that request completes.
+   */
+  struct PortQueue {
+    RDMScheduler *scheduler;
+    OutputPort *port;
+    RequestQueue interactive;
+    RequestQueue background;
+    bool in_flight;
+    bool dispatching;
+
+    PortQueue(RDMScheduler *scheduler, OutputPort *port)
+        : scheduler(scheduler),
+          port(port),
+          in_flight(false),
+          dispatching(false) {
+    }
+
+    bool Empty() const { return interactive.empty() && background.empty(); }
+  };
+
+  typedef std::map<OutputPort*, PortQueue*> PortQueues;
+
+  PortQueues m_queues;
+
+  static void Detach(PortQueue *queue);
+  static void MaybeDispatch(PortQueue *queue);
+  static void MaybeDelete(PortQueue *queue);
+  static void RequestComplete(PortQueue *queue,
+                              ola::rdm::RDMCallback *callback,
+                              ola::rdm::RDMReply *reply);
+  static void FailRequests(RequestQueue *queue);
+
+  DISALLOW_COPY_AND_ASSIGN(RDMScheduler);
+};
+}  // namespace ola
+#endif  // OLAD_PLUGIN_API_RDMSCHEDULER_H_
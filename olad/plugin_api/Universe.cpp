@@ -49,6 +49,8 @@
 #include "olad/Port.h"
 #include "olad/Universe.h"
 #include "olad/plugin_api/Client.h"
+#include "olad/plugin_api/RDMResponseCache.h"
+#include "olad/plugin_api/RDMScheduler.h"
 #include "olad/plugin_api/UniverseStore.h"
 
 namespace ola {
@@ -56,8 +58,10 @@ namespace ola {
 using ola::rdm::RDMDiscoveryCallback;
 using ola::rdm::RDMReply;
 using ola::rdm::RDMRequest;
+using ola::rdm::RDMResponse;
 using ola::rdm::RunRDMCallback;
 using ola::rdm::UID;
+using ola::rdm::UIDSet;
 using ola::strings::ToHex;
 using std::auto_ptr;
 using std::map;
@@ -74,6 +78,10 @@ const char Universe::K_UNIVERSE_INPUT_PORT_VAR[] = "universe-input-ports";
 const char Universe::K_UNIVERSE_MODE_VAR[] = "universe-mode";
 const char Universe::K_UNIVERSE_NAME_VAR[] = "universe-name";
 const char Universe::K_UNIVERSE_OUTPUT_PORT_VAR[] = "universe-output-ports";
+const char Universe::K_UNIVERSE_RDM_CACHE_HITS_VAR[] =
+    "universe-rdm-cache-hits";
+const char Universe::K_UNIVERSE_RDM_CACHE_MISSES_VAR[] =
+    "universe-rdm-cache-misses";
 const char Universe::K_UNIVERSE_RDM_REQUESTS[] = "universe-rdm-requests";
 const char Universe::K_UNIVERSE_SINK_CLIENTS_VAR[] = "universe-sink-clients";
 const char Universe::K_UNIVERSE_SOURCE_CLIENTS_VAR[] =
@@ -96,7 +104,9 @@ Universe::Universe(unsigned int universe_id, UniverseStore *store,
       m_export_map(export_map),
       m_clock(clock),
       m_rdm_discovery_interval(),
-      m_last_discovery_time() {
+      m_last_discovery_time(),
+      m_rdm_scheduler(new RDMScheduler()),
+      m_rdm_cache(new RDMResponseCache(clock)) {
   ostringstream universe_id_str, universe_name_str;
   universe_id_str << universe_id;
   m_universe_id_str = universe_id_str.str();
@@ -110,6 +120,8 @@ Universe::Universe(unsigned int universe_id, UniverseStore *store,
     K_FPS_VAR,
     K_UNIVERSE_INPUT_PORT_VAR,
     K_UNIVERSE_OUTPUT_PORT_VAR,
+    K_UNIVERSE_RDM_CACHE_HITS_VAR,
+    K_UNIVERSE_RDM_CACHE_MISSES_VAR,
     K_UNIVERSE_RDM_REQUESTS,
     K_UNIVERSE_SINK_CLIENTS_VAR,
     K_UNIVERSE_SOURCE_CLIENTS_VAR,
@@ -141,6 +153,8 @@ Universe::~Universe() {
     K_FPS_VAR,
     K_UNIVERSE_INPUT_PORT_VAR,
     K_UNIVERSE_OUTPUT_PORT_VAR,
+    K_UNIVERSE_RDM_CACHE_HITS_VAR,
+    K_UNIVERSE_RDM_CACHE_MISSES_VAR,
     K_UNIVERSE_RDM_REQUESTS,
     K_UNIVERSE_SINK_CLIENTS_VAR,
     K_UNIVERSE_SOURCE_CLIENTS_VAR,
@@ -218,7 +232,17 @@ bool Universe::RemovePort(InputPort *port) {
  * @return true if the port was removed, false if it didn't exist
  */
 bool Universe::RemovePort(OutputPort *port) {
+  UIDSet port_uids;
+  map<UID, OutputPort*>::const_iterator uid_iter = m_output_uids.begin();
+  for (; uid_iter != m_output_uids.end(); ++uid_iter) {
+    if (uid_iter->second == port) {
+      port_uids.AddUID(uid_iter->first);
+    }
+  }
+  m_rdm_cache->Invalidate(port_uids);
+
   bool ret = GenericRemovePort(port, &m_output_ports, &m_output_uids);
+  m_rdm_scheduler->PortRemoved(port);
 
   if (m_export_map) {
     (*m_export_map->GetUIntMapVar(K_UNIVERSE_UID_COUNT_VAR))[m_universe_id_str]
@@ -452,8 +476,25 @@ void Universe::CleanStaleSourceClients() {
  * Handle a RDM request for this universe, ownership of the request object is
  * transferred to this method.
  */
-void Universe::SendRDMRequest(RDMRequest *request_ptr,
+void Universe::SendRDMRequest(RDMRequest *request,
                               ola::rdm::RDMCallback *callback) {
+  SendRDMRequest(request, callback, RDM_PRIORITY_INTERACTIVE);
+}
+
+
+/*
+ * Handle a RDM request for this universe with the given priority. Requests to
+ * a single UID are queued per port, so each port has one request in flight.
+ * Broadcast requests are sent to every port immediately.
+ *
+ * If use_cache is true, GETs for static parameters may be answered from the
+ * RDMResponseCache. The cached response may be stale, so only background
+ * requests should set this.
+ */
+void Universe::SendRDMRequest(RDMRequest *request_ptr,
+                              ola::rdm::RDMCallback *callback,
+                              RDMPriority priority,
+                              bool use_cache) {
   auto_ptr<RDMRequest> request(request_ptr);
 
   OLA_INFO << "Universe " << UniverseId() << ", RDM request to "
@@ -466,6 +507,10 @@ void Universe::SendRDMRequest(RDMRequest *request_ptr,
   SafeIncrement(K_UNIVERSE_RDM_REQUESTS);
 
   if (request->DestinationUID().IsBroadcast()) {
+    if (request->CommandClass() == ola::rdm::RDMCommand::SET_COMMAND) {
+      m_rdm_cache->InvalidateAll();
+    }
+
     if (m_output_ports.empty()) {
       RunRDMCallback(
           callback,
@@ -508,7 +553,19 @@ void Universe::SendRDMRequest(RDMRequest *request_ptr,
                << " in the output universe map, dropping request";
       RunRDMCallback(callback, ola::rdm::RDM_UNKNOWN_UID);
     } else {
-      iter->second->SendRDMRequest(request.release(), callback);
+      if (use_cache) {
+        RDMResponse *response = m_rdm_cache->Lookup(*request);
+        UpdateRDMCacheStats();
+        if (response) {
+          RDMReply reply(ola::rdm::RDM_COMPLETED_OK, response);
+          callback->Run(&reply);
+          return;
+        }
+      }
+
+      callback = m_rdm_cache->Watch(*request, callback);
+      m_rdm_scheduler->SendRDMRequest(iter->second, request.release(),
+                                      callback, priority);
     }
   }
 }
@@ -566,6 +623,7 @@ void Universe::NewUIDList(OutputPort *port, const ola::rdm::UIDSet &uids) {
   map<UID, OutputPort*>::iterator iter = m_output_uids.begin();
   while (iter != m_output_uids.end()) {
     if (iter->second == port && !uids.Contains(iter->first)) {
+      m_rdm_cache->Invalidate(iter->first);
       m_output_uids.erase(iter++);
     } else {
       ++iter;
@@ -576,6 +634,8 @@ void Universe::NewUIDList(OutputPort *port, const ola::rdm::UIDSet &uids) {
   for (; set_iter != uids.End(); ++set_iter) {
     iter = m_output_uids.find(*set_iter);
     if (iter == m_output_uids.end()) {
+      // The device may have been replaced since it was last seen.
+      m_rdm_cache->Invalidate(*set_iter);
       m_output_uids[*set_iter] = port;
     } else if (iter->second != port) {
       OLA_WARN << "UID " << *set_iter << " seen on more than one port";
@@ -608,6 +668,14 @@ unsigned int Universe::UIDCount() const {
 }
 
 
+/**
+ * Return the number of RDM requests waiting for a port to become free.
+ */
+unsigned int Universe::QueuedRDMRequests() const {
+  return m_rdm_scheduler->QueuedRequests();
+}
+
+
 /*
  * Return true if this universe is in use (has at least one port or client).
  */
@@ -901,6 +969,19 @@ void Universe::SafeDecrement(const string &name) {
 }
 
 
+/*
+ * Copy the RDM response cache hit & miss counts to the Export Map
+ */
+void Universe::UpdateRDMCacheStats() {
+  if (m_export_map) {
+    (*m_export_map->GetUIntMapVar(K_UNIVERSE_RDM_CACHE_HITS_VAR))[
+        m_universe_id_str] = m_rdm_cache->Hits();
+    (*m_export_map->GetUIntMapVar(K_UNIVERSE_RDM_CACHE_MISSES_VAR))[
+        m_universe_id_str] = m_rdm_cache->Misses();
+  }
+}
+
+
 /*
  * Add an Input or Output port to this universe.
  * @param port, the port to add
@@ -21,12 +21,14 @@
 #include <cppunit/extensions/HelperMacros.h>
 #include <iostream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "ola/Callback.h"
 #include "ola/Constants.h"
 #include "ola/Clock.h"
 #include "ola/DmxBuffer.h"
+#include "ola/base/Array.h"
 #include "ola/rdm/RDMCommand.h"
 #include "ola/rdm/RDMReply.h"
 #include "ola/rdm/RDMResponseCodes.h"
@@ -78,6 +80,7 @@ class UniverseTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testHtpMerging);
   CPPUNIT_TEST(testRDMDiscovery);
   CPPUNIT_TEST(testRDMSend);
+  CPPUNIT_TEST(testRDMScheduling);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -93,12 +96,15 @@ class UniverseTest: public CppUnit::TestFixture {
   void testHtpMerging();
   void testRDMDiscovery();
   void testRDMSend();
+  void testRDMScheduling();
 
  private:
   ola::MemoryPreferences *m_preferences;
   ola::UniverseStore *m_store;
   DmxBuffer m_buffer;
   ola::Clock m_clock;
+  vector<std::pair<const RDMRequest*, RDMCallback*> > m_deferred_requests;
+  vector<uint16_t> m_completed_pids;
 
   void ConfirmUIDs(UIDSet *expected, const UIDSet &uids);
 
@@ -113,6 +119,25 @@ class UniverseTest: public CppUnit::TestFixture {
     delete request;
     RunRDMCallback(callback, status_code);
   }
+
+  void DeferRDMRequest(const RDMRequest *request, RDMCallback *callback) {
+    m_deferred_requests.push_back(std::make_pair(request, callback));
+  }
+
+  void SendGetRequest(Universe *universe,
+                      const UID &uid,
+                      uint16_t pid,
+                      Universe::RDMPriority priority,
+                      RDMStatusCode expected_status_code);
+  uint16_t CompleteDeferredRequest(const UID &uid,
+                                   RDMStatusCode status_code);
+
+  void RecordRDM(uint16_t pid,
+                 RDMStatusCode expected_status_code,
+                 RDMReply *reply) {
+    OLA_ASSERT_EQ(expected_status_code, reply->StatusCode());
+    m_completed_pids.push_back(pid);
+  }
 };
 
 
@@ -143,6 +168,8 @@ void UniverseTest::setUp() {
   m_preferences = new ola::MemoryPreferences("foo");
   m_store = new ola::UniverseStore(m_preferences, NULL);
   m_buffer.Set(TEST_DATA);
+  m_deferred_requests.clear();
+  m_completed_pids.clear();
 }
 
 void UniverseTest::tearDown() {
@@ -800,6 +827,82 @@ void UniverseTest::testRDMSend() {
 }
 
 
+/**
+ * Check that each port has one request in flight, and that interactive
+ * requests are sent before background ones.
+ */
+void UniverseTest::testRDMScheduling() {
+  Universe *universe = m_store->GetUniverseOrCreate(TEST_UNIVERSE);
+  OLA_ASSERT(universe);
+
+  UID uid1(0x7a70, 1);
+  UID uid2(0x7a70, 2);
+  UIDSet port1_uids, port2_uids;
+  port1_uids.AddUID(uid1);
+  port2_uids.AddUID(uid2);
+  TestMockRDMOutputPort port1(NULL, 1, &port1_uids, true);
+  TestMockRDMOutputPort port2(NULL, 2, &port2_uids, true);
+  port1.SetRDMHandler(NewCallback(this, &UniverseTest::DeferRDMRequest));
+  port2.SetRDMHandler(NewCallback(this, &UniverseTest::DeferRDMRequest));
+  universe->AddPort(&port1);
+  port1.SetUniverse(universe);
+  universe->AddPort(&port2);
+  port2.SetUniverse(universe);
+
+  SendGetRequest(universe, uid1, 1, Universe::RDM_PRIORITY_BACKGROUND,
+                 ola::rdm::RDM_TIMEOUT);
+  SendGetRequest(universe, uid1, 2, Universe::RDM_PRIORITY_BACKGROUND,
+                 ola::rdm::RDM_TIMEOUT);
+  SendGetRequest(universe, uid1, 3, Universe::RDM_PRIORITY_INTERACTIVE,
+                 ola::rdm::RDM_TIMEOUT);
+  SendGetRequest(universe, uid2, 4, Universe::RDM_PRIORITY_BACKGROUND,
+                 ola::rdm::RDM_TIMEOUT);
+
+  // One request per port is in flight.
+  OLA_ASSERT_EQ(static_cast<size_t>(2), m_deferred_requests.size());
+
+  // Once the first request to uid1 completes, the interactive request is sent
+  // ahead of the queued background request.
+  OLA_ASSERT_EQ(static_cast<uint16_t>(1),
+                CompleteDeferredRequest(uid1, ola::rdm::RDM_TIMEOUT));
+  OLA_ASSERT_EQ(static_cast<uint16_t>(3),
+                CompleteDeferredRequest(uid1, ola::rdm::RDM_TIMEOUT));
+  OLA_ASSERT_EQ(static_cast<uint16_t>(4),
+                CompleteDeferredRequest(uid2, ola::rdm::RDM_TIMEOUT));
+  OLA_ASSERT_EQ(static_cast<uint16_t>(2),
+                CompleteDeferredRequest(uid1, ola::rdm::RDM_TIMEOUT));
+  OLA_ASSERT_TRUE(m_deferred_requests.empty());
+
+  const uint16_t expected_pids[] = {1, 3, 4, 2};
+  OLA_ASSERT_EQ(arraysize(expected_pids), m_completed_pids.size());
+  for (unsigned int i = 0; i < arraysize(expected_pids); i++) {
+    OLA_ASSERT_EQ(expected_pids[i], m_completed_pids[i]);
+  }
+
+  // Requests that are queued when the port is removed fail, the request in
+  // flight completes as normal.
+  m_completed_pids.clear();
+  SendGetRequest(universe, uid2, 5, Universe::RDM_PRIORITY_INTERACTIVE,
+                 ola::rdm::RDM_TIMEOUT);
+  SendGetRequest(universe, uid2, 6, Universe::RDM_PRIORITY_INTERACTIVE,
+                 ola::rdm::RDM_FAILED_TO_SEND);
+  SendGetRequest(universe, uid2, 7, Universe::RDM_PRIORITY_BACKGROUND,
+                 ola::rdm::RDM_FAILED_TO_SEND);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), m_deferred_requests.size());
+  universe->RemovePort(&port2);
+
+  const uint16_t removed_pids[] = {6, 7};
+  OLA_ASSERT_EQ(arraysize(removed_pids), m_completed_pids.size());
+  for (unsigned int i = 0; i < arraysize(removed_pids); i++) {
+    OLA_ASSERT_EQ(removed_pids[i], m_completed_pids[i]);
+  }
+  OLA_ASSERT_EQ(static_cast<uint16_t>(5),
+                CompleteDeferredRequest(uid2, ola::rdm::RDM_TIMEOUT));
+
+  universe->RemovePort(&port1);
+}
+
+
 /**
  * Check we got the uids we expect
  */
@@ -808,6 +911,47 @@ void UniverseTest::ConfirmUIDs(UIDSet *expected, const UIDSet &uids) {
 }
 
 
+/**
+ * Send a GET request and record the PID when it completes.
+ */
+void UniverseTest::SendGetRequest(Universe *universe,
+                                  const UID &uid,
+                                  uint16_t pid,
+                                  Universe::RDMPriority priority,
+                                  RDMStatusCode expected_status_code) {
+  UID source_uid(0x7a70, 100);
+  universe->SendRDMRequest(
+      new ola::rdm::RDMGetRequest(source_uid, uid, 0, 1, 0, pid, NULL, 0),
+      NewSingleCallback(this, &UniverseTest::RecordRDM, pid,
+                        expected_status_code),
+      priority);
+}
+
+
+/**
+ * Complete the deferred request for a UID.
+ * @returns the PID of the request.
+ */
+uint16_t UniverseTest::CompleteDeferredRequest(const UID &uid,
+                                               RDMStatusCode status_code) {
+  vector<std::pair<const RDMRequest*, RDMCallback*> >::iterator iter =
+      m_deferred_requests.begin();
+  for (; iter != m_deferred_requests.end(); ++iter) {
+    if (iter->first->DestinationUID() == uid) {
+      break;
+    }
+  }
+  OLA_ASSERT_TRUE(iter != m_deferred_requests.end());
+
+  uint16_t pid = iter->first->ParamId();
+  delete iter->first;
+  RDMCallback *callback = iter->second;
+  m_deferred_requests.erase(iter);
+  RunRDMCallback(callback, status_code);
+  return pid;
+}
+
+
 /**
  * Confirm an RDM response
  */
@@ -0,0 +1,177 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * client_loadtest.cpp
+ * Count the heap allocations made by each Client::SendDMX() round trip.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <iostream>
+#include <new>
+
+#include "common/protocol/Ola.pb.h"
+#include "common/protocol/OlaService.pb.h"
+#include "common/rpc/RpcChannel.h"
+#include "common/rpc/RpcController.h"
+#include "ola/Clock.h"
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/Logging.h"
+#include "ola/base/Flags.h"
+#include "ola/base/Init.h"
+#include "ola/dmx/SourcePriorities.h"
+#include "ola/io/SelectServer.h"
+#include "ola/network/Socket.h"
+#include "ola/rdm/UID.h"
+#include "olad/plugin_api/Client.h"
+
+using ola::Client;
+using ola::Clock;
+using ola::DmxBuffer;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::io::LoopbackDescriptor;
+using ola::io::SelectServer;
+using ola::rpc::RpcChannel;
+using ola::rpc::RpcController;
+using ola::rpc::RpcService;
+using std::cout;
+using std::endl;
+
+DEFINE_s_uint32(count, c, 100000, "The number of frames to send");
+DEFINE_s_uint32(warmup, w, 100, "The number of frames to send before "
+                "counting allocations");
+
+// Count every call to the global operator new. The exception specifications
+// changed in C++11.
+#if __cplusplus >= 201103L
+#define THROWS_BAD_ALLOC
+#define THROWS_NOTHING noexcept
+#else
+#define THROWS_BAD_ALLOC throw(std::bad_alloc)
+#define THROWS_NOTHING throw()
+#endif
+
+static uint64_t allocations = 0;
+
+void *operator new(size_t size) THROWS_BAD_ALLOC {
+  allocations++;
+  void *ptr = malloc(size ? size : 1);
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+// If this is inlined, gcc warns about free() being used on memory from
+// operator new.
+__attribute__((noinline)) void operator delete(void *ptr) THROWS_NOTHING {
+  free(ptr);
+}
+
+#if __cplusplus >= 201402L
+void operator delete(void *ptr, size_t) THROWS_NOTHING {
+  ::operator delete(ptr);
+}
+#endif
+
+/**
+ * The client end of the connection, this just acks each frame.
+ */
+class DmxReceiver : public ola::proto::OlaClientService {
+ public:
+  DmxReceiver() : m_frames(0) {}
+
+  void UpdateDmxData(RpcController*,
+                     const ola::proto::DmxData*,
+                     ola::proto::Ack*,
+                     RpcService::CompletionCallback *done) {
+    m_frames++;
+    done->Run();
+  }
+
+  uint64_t Frames() const { return m_frames; }
+
+ private:
+  uint64_t m_frames;
+};
+
+/**
+ * Send frames one at a time, waiting for each to arrive before sending the
+ * next. The ack for each frame is processed along with the next frame.
+ */
+void SendFrames(SelectServer *ss, DmxReceiver *receiver, Client *client,
+                const DmxBuffer &buffer, unsigned int count) {
+  for (unsigned int i = 0; i < count; i++) {
+    uint64_t expected = receiver->Frames() + 1;
+    client->SendDMX(1, ola::dmx::SOURCE_PRIORITY_DEFAULT, buffer);
+    while (receiver->Frames() < expected) {
+      ss->RunOnce(TimeInterval(1, 0));
+    }
+  }
+}
+
+int main(int argc, char* argv[]) {
+  ola::AppInit(&argc, argv, "[options]",
+               "Count the allocations made by Client::SendDMX().");
+
+  SelectServer ss;
+  LoopbackDescriptor descriptor;
+  descriptor.Init();
+
+  DmxReceiver receiver;
+  RpcChannel channel(&receiver, &descriptor);
+  ss.AddReadDescriptor(&descriptor);
+
+  Client client(new ola::proto::OlaClientService_Stub(&channel),
+                ola::rdm::UID(ola::OPEN_LIGHTING_ESTA_CODE, 0));
+
+  DmxBuffer buffer;
+  buffer.Blackout();
+
+  SendFrames(&ss, &receiver, &client, buffer, FLAGS_warmup);
+
+  Clock clock;
+  TimeStamp start, end;
+  uint64_t start_allocations = allocations;
+  clock.CurrentTime(&start);
+  SendFrames(&ss, &receiver, &client, buffer, FLAGS_count);
+  clock.CurrentTime(&end);
+  uint64_t total_allocations = allocations - start_allocations;
+
+  // Process the ack for the last frame.
+  ss.RunOnce(TimeInterval(0, 0));
+  ss.RemoveReadDescriptor(&descriptor);
+
+  TimeInterval duration = end - start;
+  cout << "Sent " << FLAGS_count << " frames in " << duration << endl;
+  if (FLAGS_count) {
+    cout << "Allocations per frame: " << std::fixed
+         << (static_cast<double>(total_allocations) / FLAGS_count) << endl;
+  }
+  if (duration.AsInt()) {
+    cout << "Frames per second: "
+         << (static_cast<int64_t>(FLAGS_count) * 1000000 / duration.AsInt())
+         << endl;
+  }
+  if (receiver.Frames() != FLAGS_warmup + FLAGS_count) {
+    OLA_WARN << "Only " << receiver.Frames() << " frames were received";
+    return 1;
+  }
+  return 0;
+}
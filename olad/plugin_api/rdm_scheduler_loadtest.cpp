@@ -0,0 +1,306 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * rdm_scheduler_loadtest.cpp
+ * Time fetching a set of PIDs from simulated responders on many ports.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/Logging.h"
+#include "ola/base/Array.h"
+#include "ola/base/Flags.h"
+#include "ola/base/Init.h"
+#include "ola/io/SelectServer.h"
+#include "ola/rdm/AdvancedDimmerResponder.h"
+#include "ola/rdm/DummyResponder.h"
+#include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/RDMEnums.h"
+#include "ola/rdm/RDMReply.h"
+#include "ola/rdm/UID.h"
+#include "ola/rdm/UIDSet.h"
+#include "ola/stl/STLUtils.h"
+#include "olad/Port.h"
+#include "olad/Preferences.h"
+#include "olad/Universe.h"
+#include "olad/plugin_api/UniverseStore.h"
+
+using ola::NewSingleCallback;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::Universe;
+using ola::io::SelectServer;
+using ola::rdm::RDMCallback;
+using ola::rdm::RDMDiscoveryCallback;
+using ola::rdm::RDMReply;
+using ola::rdm::RDMRequest;
+using ola::rdm::UID;
+using ola::rdm::UIDSet;
+using std::cout;
+using std::endl;
+using std::map;
+using std::vector;
+
+DEFINE_s_uint32(ports, p, 8, "The number of ports");
+DEFINE_s_uint32(responders, r, 4, "The number of responders on each port");
+DEFINE_s_uint32(delay, d, 2000, "The time each port takes to complete a "
+                "request, in microseconds");
+
+/**
+ * A port with simulated responders attached. Each request is answered by the
+ * responder once the delay has passed, like a request on a real line.
+ */
+class SimulatedRDMPort: public ola::BasicOutputPort {
+ public:
+  SimulatedRDMPort(SelectServer *ss, unsigned int port_id,
+                   const TimeInterval &delay)
+      : ola::BasicOutputPort(NULL, port_id, true, true),
+        m_ss(ss),
+        m_delay(delay),
+        m_in_flight(0),
+        m_max_in_flight(0) {
+  }
+
+  ~SimulatedRDMPort() {
+    ola::STLDeleteValues(&m_responders);
+  }
+
+  void AddResponder(const UID &uid,
+                    ola::rdm::RDMControllerInterface *responder) {
+    m_responders[uid] = responder;
+    m_uids.AddUID(uid);
+  }
+
+  unsigned int MaxInFlight() const { return m_max_in_flight; }
+
+  std::string Description() const { return "Simulated"; }
+  bool WriteDMX(const ola::DmxBuffer&, uint8_t) { return true; }
+
+  void SendRDMRequest(RDMRequest *request, RDMCallback *callback) {
+    m_in_flight++;
+    m_max_in_flight = std::max(m_in_flight, m_max_in_flight);
+    m_ss->RegisterSingleTimeout(
+        m_delay,
+        NewSingleCallback(this, &SimulatedRDMPort::Respond, request,
+                          callback));
+  }
+
+  void RunFullDiscovery(RDMDiscoveryCallback *on_complete) {
+    on_complete->Run(m_uids);
+  }
+
+  void RunIncrementalDiscovery(RDMDiscoveryCallback *on_complete) {
+    on_complete->Run(m_uids);
+  }
+
+ private:
+  typedef map<UID, ola::rdm::RDMControllerInterface*> ResponderMap;
+
+  SelectServer *m_ss;
+  const TimeInterval m_delay;
+  ResponderMap m_responders;
+  UIDSet m_uids;
+  unsigned int m_in_flight;
+  unsigned int m_max_in_flight;
+
+  void Respond(RDMRequest *request, RDMCallback *callback) {
+    m_in_flight--;
+    ola::rdm::RDMControllerInterface *responder = ola::STLFindOrNull(
+        m_responders, request->DestinationUID());
+    if (responder) {
+      responder->SendRDMRequest(request, callback);
+    } else {
+      delete request;
+      ola::rdm::RunRDMCallback(callback, ola::rdm::RDM_TIMEOUT);
+    }
+  }
+};
+
+// The PIDs fetched from each responder.
+static const uint16_t PIDS[] = {
+  ola::rdm::PID_DEVICE_INFO,
+  ola::rdm::PID_SOFTWARE_VERSION_LABEL,
+  ola::rdm::PID_DEVICE_LABEL,
+  ola::rdm::PID_DMX_START_ADDRESS,
+  ola::rdm::PID_IDENTIFY_DEVICE,
+  ola::rdm::PID_DMX_PERSONALITY,
+};
+
+/**
+ * Sends the requests and counts the responses.
+ */
+class Fetcher {
+ public:
+  Fetcher(SelectServer *ss, Universe *universe, const vector<UID> &uids)
+      : m_ss(ss),
+        m_universe(universe),
+        m_uids(uids),
+        m_next(0),
+        m_outstanding(0),
+        m_acks(0) {
+  }
+
+  /*
+   * Send one request at a time, like a client that fetches each PID in turn.
+   */
+  void RunSequential() {
+    Reset();
+    SendNext();
+    m_ss->Run();
+  }
+
+  /*
+   * Send all the requests at once, and let the universe schedule them.
+   */
+  void RunScheduled() {
+    Reset();
+    while (m_next < RequestCount()) {
+      SendRequest(m_next++, NewSingleCallback(this, &Fetcher::RequestComplete,
+                                              false));
+    }
+    if (m_outstanding) {
+      m_ss->Run();
+    }
+  }
+
+  unsigned int RequestCount() const {
+    return m_uids.size() * arraysize(PIDS);
+  }
+
+  unsigned int Acks() const { return m_acks; }
+
+ private:
+  SelectServer *m_ss;
+  Universe *m_universe;
+  const vector<UID> m_uids;
+  unsigned int m_next;
+  unsigned int m_outstanding;
+  unsigned int m_acks;
+
+  void Reset() {
+    m_next = 0;
+    m_outstanding = 0;
+    m_acks = 0;
+  }
+
+  void SendRequest(unsigned int index, RDMCallback *callback) {
+    const UID &uid = m_uids[index / arraysize(PIDS)];
+    uint16_t pid = PIDS[index % arraysize(PIDS)];
+    m_outstanding++;
+    m_universe->SendRDMRequest(
+        new ola::rdm::RDMGetRequest(UID(ola::OPEN_LIGHTING_ESTA_CODE, 0), uid,
+                                    0, 1, ola::rdm::ROOT_RDM_DEVICE, pid,
+                                    NULL, 0),
+        callback,
+        Universe::RDM_PRIORITY_BACKGROUND,
+        false);  // bypass the response cache, we're timing the ports
+  }
+
+  void SendNext() {
+    SendRequest(m_next++, NewSingleCallback(this, &Fetcher::RequestComplete,
+                                            true));
+  }
+
+  void RequestComplete(bool send_next, RDMReply *reply) {
+    m_outstanding--;
+    if (reply->StatusCode() == ola::rdm::RDM_COMPLETED_OK &&
+        reply->Response() &&
+        reply->Response()->ResponseType() == ola::rdm::RDM_ACK) {
+      m_acks++;
+    }
+
+    if (send_next && m_next < RequestCount()) {
+      SendNext();
+    } else if (m_outstanding == 0) {
+      m_ss->Terminate();
+    }
+  }
+};
+
+void Time(const char *name, Fetcher *fetcher, void (Fetcher::*method)()) {
+  ola::Clock clock;
+  TimeStamp start, end;
+  clock.CurrentTime(&start);
+  (fetcher->*method)();
+  clock.CurrentTime(&end);
+
+  TimeInterval duration = end - start;
+  cout << name << ": " << fetcher->RequestCount() << " requests, "
+       << fetcher->Acks() << " acks in " << duration;
+  if (duration.AsInt()) {
+    cout << ", " << (static_cast<int64_t>(fetcher->RequestCount()) * 1000000 /
+                     duration.AsInt())
+         << " requests/s";
+  }
+  cout << endl;
+}
+
+int main(int argc, char* argv[]) {
+  ola::AppInit(&argc, argv, "[options]",
+               "Time fetching PIDs from simulated RDM responders.");
+
+  SelectServer ss;
+  ola::MemoryPreferences preferences("rdm_scheduler_loadtest");
+  ola::UniverseStore store(&preferences, NULL);
+  Universe *universe = store.GetUniverseOrCreate(1);
+
+  vector<SimulatedRDMPort*> ports;
+  vector<UID> uids;
+  uint32_t device_id = 1;
+  for (unsigned int i = 0; i < FLAGS_ports; i++) {
+    SimulatedRDMPort *port = new SimulatedRDMPort(
+        &ss, i, TimeInterval(0, FLAGS_delay));
+    for (unsigned int j = 0; j < FLAGS_responders; j++) {
+      UID uid(ola::OPEN_LIGHTING_ESTA_CODE, device_id++);
+      if (j % 2) {
+        port->AddResponder(uid, new ola::rdm::AdvancedDimmerResponder(uid));
+      } else {
+        port->AddResponder(uid, new ola::rdm::DummyResponder(uid));
+      }
+      uids.push_back(uid);
+    }
+    universe->AddPort(port);
+    port->SetUniverse(universe);
+    ports.push_back(port);
+  }
+
+  cout << FLAGS_ports << " ports, " << FLAGS_responders
+       << " responders per port, " << FLAGS_delay << "us per request" << endl;
+
+  Fetcher fetcher(&ss, universe, uids);
+  Time("Sequential", &fetcher, &Fetcher::RunSequential);
+  Time("Scheduled", &fetcher, &Fetcher::RunScheduled);
+
+  unsigned int max_in_flight = 0;
+  vector<SimulatedRDMPort*>::iterator iter = ports.begin();
+  for (; iter != ports.end(); ++iter) {
+    max_in_flight = std::max(max_in_flight, (*iter)->MaxInFlight());
+    universe->RemovePort(*iter);
+    delete *iter;
+  }
+  cout << "Max requests in flight per port: " << max_in_flight << endl;
+  return 0;
+}
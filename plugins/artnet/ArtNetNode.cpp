@@ -159,6 +159,9 @@ class ArtNetNodeImpl::InputPort {
 
   bool enabled;
   uint8_t sequence_number;
+  // The ArtDMX packet for this port, the fields that don't change from frame
+  // to frame are filled in once when the port is created.
+  artnet_packet dmx_packet;
   map<IPV4Address, TimeStamp> subscribed_nodes;
   uid_map uids;  // used to keep track of the UIDs
   // NULL if discovery isn't running, otherwise the callback to run when it
@@ -218,7 +221,12 @@ ArtNetNodeImpl::ArtNetNodeImpl(const ola::network::Interface &iface,
   }
 
   for (unsigned int i = 0; i < options.input_port_count; i++) {
-    m_input_ports.push_back(new InputPort());
+    InputPort *port = new InputPort();
+    memset(&port->dmx_packet, 0, sizeof(port->dmx_packet));
+    PopulatePacketHeader(&port->dmx_packet, ARTNET_DMX);
+    port->dmx_packet.data.dmx.version = HostToNetwork(ARTNET_VERSION);
+    port->dmx_packet.data.dmx.physical = i;
+    m_input_ports.push_back(port);
   }
 
   // reset all the port structures
@@ -536,13 +544,9 @@ bool ArtNetNodeImpl::SendDMX(uint8_t port_id, const DmxBuffer &buffer) {
     return true;
   }
 
-  artnet_packet packet;
-  PopulatePacketHeader(&packet, ARTNET_DMX);
-  memset(&packet.data.dmx, 0, sizeof(packet.data.dmx));
-
-  packet.data.poll.version = HostToNetwork(ARTNET_VERSION);
+  // Only the sequence number, addresses & slot data are written per frame.
+  artnet_packet &packet = port->dmx_packet;
   packet.data.dmx.sequence = port->sequence_number;
-  packet.data.dmx.physical = port_id;
   packet.data.dmx.universe = port->PortAddress();
   packet.data.dmx.net = m_net_address;
 
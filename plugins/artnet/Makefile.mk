@@ -31,6 +31,9 @@ noinst_PROGRAMS += plugins/artnet/artnet_loadtest
 
 plugins_artnet_artnet_loadtest_SOURCES = plugins/artnet/artnet_loadtest.cpp
 plugins_artnet_artnet_loadtest_LDADD = plugins/artnet/libolaartnetnode.la
+if USE_KINET
+plugins_artnet_artnet_loadtest_LDADD += plugins/kinet/libolakinetnode.la
+endif
 
 # TESTS
 ##################################################
@@ -14,15 +14,23 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  *
  * artnet_loadtest.cpp
- * A simple ArtNet load tester
+ * A simple ArtNet & KiNet load tester
  * Copyright (C) 2013 Simon Newton
  */
 
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdint.h>
 #include <stdlib.h>
 #include <algorithm>
+#include <iostream>
 #include <memory>
+#include <new>
 #include <string>
 #include "ola/Callback.h"
+#include "ola/Clock.h"
 #include "ola/DmxBuffer.h"
 #include "ola/Logging.h"
 #include "ola/base/Flags.h"
@@ -30,10 +38,16 @@
 #include "ola/io/SelectServer.h"
 #include "ola/network/InterfacePicker.h"
 #include "plugins/artnet/ArtNetNode.h"
+#ifdef USE_KINET
+#include "plugins/kinet/KiNetNode.h"
+#endif  // USE_KINET
 
+using ola::Clock;
 using ola::DmxBuffer;
 using ola::NewCallback;
+using ola::TimeStamp;
 using ola::io::SelectServer;
+using ola::network::IPV4Address;
 using ola::network::Interface;
 using ola::network::InterfacePicker;
 using ola::plugin::artnet::ArtNetNode;
@@ -46,20 +60,141 @@ using std::min;
 DEFINE_s_uint32(fps, f, 10, "Frames per second per universe [1 - 1000]");
 DEFINE_s_uint16(universes, u, 1, "Number of universes to send");
 DEFINE_string(iface, "", "The interface to send from");
+#ifdef USE_KINET
+DEFINE_default_bool(kinet, false,
+                    "Send KiNet rather than ArtNet. Every universe is sent to "
+                    "the address of the interface.");
+#endif  // USE_KINET
+
+namespace {
+// The number of heap allocations, used to check the send path doesn't
+// allocate.
+uint64_t allocations = 0;
+
+// This isn't inlined into operator delete, otherwise the compiler warns about
+// free() being called on memory from operator new.
+void __attribute__((noinline)) FreeMemory(void *ptr) {
+  free(ptr);
+}
+}  // namespace
+
+#if __cplusplus >= 201103L
+#define LOADTEST_THROW_BAD_ALLOC
+#define LOADTEST_NOTHROW noexcept
+#else
+#define LOADTEST_THROW_BAD_ALLOC throw(std::bad_alloc)
+#define LOADTEST_NOTHROW throw()
+#endif  // __cplusplus >= 201103L
+
+void *operator new(size_t size) LOADTEST_THROW_BAD_ALLOC {
+  __sync_fetch_and_add(&allocations, 1);
+  void *ptr = malloc(size ? size : 1);
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void *operator new[](size_t size) LOADTEST_THROW_BAD_ALLOC {
+  return operator new(size);
+}
+
+void operator delete(void *ptr) LOADTEST_NOTHROW {
+  FreeMemory(ptr);
+}
+
+void operator delete[](void *ptr) LOADTEST_NOTHROW {
+  FreeMemory(ptr);
+}
+
+#if __cplusplus >= 201402L
+void operator delete(void *ptr, size_t) LOADTEST_NOTHROW {
+  FreeMemory(ptr);
+}
+
+void operator delete[](void *ptr, size_t) LOADTEST_NOTHROW {
+  FreeMemory(ptr);
+}
+#endif  // __cplusplus >= 201402L
 
 /**
- * Send N DMX frames using ArtNet, where N is given by number_of_universes.
+ * Counts the packets sent, and once a second prints the packets/sec and the
+ * heap allocations per packet.
  */
-bool SendFrames(ArtNetNode *node, DmxBuffer *buffer,
-                uint16_t number_of_universes) {
-  for (uint16_t i = 0; i < number_of_universes; i++) {
+class PacketStats {
+ public:
+  explicit PacketStats(uint16_t universes)
+      : m_universes(universes),
+        m_packets(0),
+        m_last_packets(0),
+        m_last_allocations(allocations) {
+    m_clock.CurrentTime(&m_last_report);
+  }
+
+  uint16_t Universes() const { return m_universes; }
+
+  void FrameSent() { m_packets += m_universes; }
+
+  bool Report() {
+    TimeStamp now;
+    m_clock.CurrentTime(&now);
+    const uint64_t packets = m_packets - m_last_packets;
+    const uint64_t allocs = allocations - m_last_allocations;
+    const int64_t elapsed = (now - m_last_report).AsInt();
+
+    cout << "Sent " << packets << " packets";
+    if (elapsed > 0) {
+      cout << ", " << packets * 1000000 / elapsed << " packets/s";
+    }
+    if (packets) {
+      cout << ", " << static_cast<double>(allocs) / packets
+           << " allocations/packet";
+    }
+    cout << endl;
+
+    m_last_packets = m_packets;
+    m_last_report = now;
+    // Don't count the allocations made while printing.
+    m_last_allocations = allocations;
+    return true;
+  }
+
+ private:
+  const uint16_t m_universes;
+  Clock m_clock;
+  uint64_t m_packets;
+  uint64_t m_last_packets;
+  uint64_t m_last_allocations;
+  TimeStamp m_last_report;
+};
+
+/**
+ * Send N DMX frames using ArtNet, where N is the number of universes.
+ */
+bool SendFrames(ArtNetNode *node, DmxBuffer *buffer, PacketStats *stats) {
+  for (uint16_t i = 0; i < stats->Universes(); i++) {
     node->SendDMX(i, *buffer);
   }
+  stats->FrameSent();
   return true;
 }
 
+#ifdef USE_KINET
+/**
+ * Send N DMX frames using KiNet, where N is the number of universes.
+ */
+bool SendKiNetFrames(ola::plugin::kinet::KiNetNode *node, IPV4Address target,
+                     DmxBuffer *buffer, PacketStats *stats) {
+  for (uint16_t i = 0; i < stats->Universes(); i++) {
+    node->SendDMX(target, *buffer);
+  }
+  stats->FrameSent();
+  return true;
+}
+#endif  // USE_KINET
+
 int main(int argc, char* argv[]) {
-  ola::AppInit(&argc, argv, "", "Run the E1.31 load test.");
+  ola::AppInit(&argc, argv, "", "Run the ArtNet / KiNet load test.");
 
   if (FLAGS_universes == 0 || FLAGS_fps == 0) {
     return -1;
@@ -80,25 +215,48 @@ int main(int argc, char* argv[]) {
     }
   }
 
-  ArtNetNodeOptions options;
-  options.always_broadcast = true;
-
   SelectServer ss;
-  ArtNetNode node(iface, &ss, options);
+  PacketStats stats(universes);
+  auto_ptr<ArtNetNode> node;
+  bool use_kinet = false;
 
-  for (uint16_t i = 0; i < universes; i++) {
-    if (!node.SetInputPortUniverse(i, i)) {
-      OLA_WARN << "Failed to set port";
+#ifdef USE_KINET
+  auto_ptr<ola::plugin::kinet::KiNetNode> kinet_node;
+  use_kinet = FLAGS_kinet;
+  if (use_kinet) {
+    kinet_node.reset(new ola::plugin::kinet::KiNetNode(&ss));
+    if (!kinet_node->Start()) {
+      return -1;
     }
+
+    ss.RegisterRepeatingTimeout(
+        1000 / fps,
+        NewCallback(&SendKiNetFrames, kinet_node.get(), iface.ip_address,
+                    &output, &stats));
   }
+#endif  // USE_KINET
 
-  if (!node.Start()) {
-    return -1;
+  if (!use_kinet) {
+    ArtNetNodeOptions options;
+    options.always_broadcast = true;
+    node.reset(new ArtNetNode(iface, &ss, options));
+
+    for (uint16_t i = 0; i < universes; i++) {
+      if (!node->SetInputPortUniverse(i, i)) {
+        OLA_WARN << "Failed to set port";
+      }
+    }
+
+    if (!node->Start()) {
+      return -1;
+    }
+
+    ss.RegisterRepeatingTimeout(
+        1000 / fps,
+        NewCallback(&SendFrames, node.get(), &output, &stats));
   }
 
-  ss.RegisterRepeatingTimeout(
-      1000 / fps,
-      NewCallback(&SendFrames, &node, &output, universes));
+  ss.RegisterRepeatingTimeout(1000, NewCallback(&stats, &PacketStats::Report));
   cout << "Starting loadtester: " << universes << " universe(s), " << fps
        << " fps" << endl;
   ss.Run();
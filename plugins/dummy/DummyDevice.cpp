@@ -35,7 +35,7 @@ namespace dummy {
  * Start this device
  */
 bool DummyDevice::StartHook() {
-  DummyPort *port = new DummyPort(this, m_port_options, 0);
+  DummyPort *port = new DummyPort(this, m_port_options, 0, m_scheduler);
 
   if (!AddPort(port)) {
     delete port;
@@ -45,6 +45,10 @@ const char DummyPlugin::DEVICE_NAME[] = "Dummy Device";
 const char DummyPlugin::DIMMER_COUNT_KEY[] = "dimmer_count";
 const char DummyPlugin::DIMMER_SUBDEVICE_COUNT_KEY[] = "dimmer_subdevice_count";
 const char DummyPlugin::DUMMY_DEVICE_COUNT_KEY[] = "dummy_device_count";
+const char DummyPlugin::FARM_PACKET_LOSS_KEY[] = "farm_packet_loss";
+const char DummyPlugin::FARM_RESPONDER_COUNT_KEY[] = "farm_responder_count";
+const char DummyPlugin::FARM_RESPONSE_DELAY_KEY[] = "farm_response_delay";
+const char DummyPlugin::FARM_SEED_KEY[] = "farm_seed";
 const char DummyPlugin::MOVING_LIGHT_COUNT_KEY[] = "moving_light_count";
 const char DummyPlugin::NETWORK_COUNT_KEY[] = "network_device_count";
 const char DummyPlugin::PLUGIN_NAME[] = "Dummy";
@@ -99,8 +103,29 @@ bool DummyPlugin::StartHook() {
     options.number_of_network_responders = DEFAULT_DEVICE_COUNT;
   }
 
+  ResponderFarm::Options &farm_options = options.farm_options;
+  if (!StringToInt(m_preferences->GetValue(FARM_RESPONDER_COUNT_KEY),
+                   &farm_options.responder_count)) {
+    farm_options.responder_count = 0;
+  }
+
+  if (!StringToInt(m_preferences->GetValue(FARM_RESPONSE_DELAY_KEY),
+                   &farm_options.response_delay)) {
+    farm_options.response_delay = 0;
+  }
+
+  if (!StringToInt(m_preferences->GetValue(FARM_PACKET_LOSS_KEY),
+                   &farm_options.packet_loss)) {
+    farm_options.packet_loss = 0;
+  }
+
+  if (!StringToInt(m_preferences->GetValue(FARM_SEED_KEY),
+                   &farm_options.seed)) {
+    farm_options.seed = 1;
+  }
+
   std::auto_ptr<DummyDevice> device(
-      new DummyDevice(this, DEVICE_NAME, options));
+      new DummyDevice(this, DEVICE_NAME, options, m_plugin_adaptor));
   if (!device->Start()) {
     return false;
   }
@@ -162,6 +187,20 @@ string DummyPlugin::Description() const {
 "dummy_device_count = 1\n"
 "The number of dummy devices to create.\n"
 "\n"
+"farm_packet_loss = 0\n"
+"The percentage of responder farm transactions that are lost.\n"
+"\n"
+"farm_responder_count = 0\n"
+"The number of responders in the responder farm. The farm simulates a large\n"
+"RDM line for load testing, with a mix of the device types above, random\n"
+"UIDs and full DUB based discovery.\n"
+"\n"
+"farm_response_delay = 0\n"
+"The time in microseconds each responder farm transaction takes.\n"
+"\n"
+"farm_seed = 1\n"
+"The random seed used to pick the responder farm UIDs & lost transactions.\n"
+"\n"
 "moving_light_count = 1\n"
 "The number of moving light devices to create.\n"
 "\n"
@@ -216,6 +255,22 @@ bool DummyPlugin::SetDefaultPreferences() {
                                          IntValidator(0, 254),
                                          DEFAULT_DEVICE_COUNT);
 
+  save |= m_preferences->SetDefaultValue(FARM_RESPONDER_COUNT_KEY,
+                                         UIntValidator(0, 100000),
+                                         0);
+
+  save |= m_preferences->SetDefaultValue(FARM_RESPONSE_DELAY_KEY,
+                                         UIntValidator(0, 1000000),
+                                         0);
+
+  save |= m_preferences->SetDefaultValue(FARM_PACKET_LOSS_KEY,
+                                         UIntValidator(0, 100),
+                                         0);
+
+  save |= m_preferences->SetDefaultValue(FARM_SEED_KEY,
+                                         UIntValidator(1, 0xffffffff),
+                                         1);
+
   if (save) {
     m_preferences->Save();
   }
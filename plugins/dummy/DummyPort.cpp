@@ -72,7 +72,8 @@ void AddResponders(map<UID, ola::rdm::RDMControllerInterface*> *responders,
 
 DummyPort::DummyPort(DummyDevice *parent,
                      const Options &options,
-                     unsigned int id)
+                     unsigned int id,
+                     ola::thread::SchedulerInterface *scheduler)
     : BasicOutputPort(parent, id, true, true) {
   UID first_uid(OPEN_LIGHTING_ESTA_CODE, DummyPort::kStartAddress);
   ola::rdm::UIDAllocator allocator(first_uid);
@@ -107,6 +108,10 @@ DummyPort::DummyPort(DummyDevice *parent,
       &m_responders, &allocator, options.number_of_sensor_responders);
   AddResponders<ola::rdm::NetworkResponder>(
       &m_responders, &allocator, options.number_of_network_responders);
+
+  if (options.farm_options.responder_count) {
+    m_farm.reset(new ResponderFarm(options.farm_options, scheduler));
+  }
 }
 
 
@@ -125,11 +130,21 @@ bool DummyPort::WriteDMX(const DmxBuffer &buffer,
 }
 
 void DummyPort::RunFullDiscovery(RDMDiscoveryCallback *callback) {
-  RunDiscovery(callback);
+  if (m_farm.get()) {
+    m_farm->RunFullDiscovery(
+        NewSingleCallback(this, &DummyPort::FarmDiscoveryComplete, callback));
+  } else {
+    RunDiscovery(callback);
+  }
 }
 
 void DummyPort::RunIncrementalDiscovery(RDMDiscoveryCallback *callback) {
-  RunDiscovery(callback);
+  if (m_farm.get()) {
+    m_farm->RunIncrementalDiscovery(
+        NewSingleCallback(this, &DummyPort::FarmDiscoveryComplete, callback));
+  } else {
+    RunDiscovery(callback);
+  }
 }
 
 void DummyPort::SendRDMRequest(ola::rdm::RDMRequest *request_ptr,
@@ -138,11 +153,11 @@ void DummyPort::SendRDMRequest(ola::rdm::RDMRequest *request_ptr,
 
   UID dest = request->DestinationUID();
   if (dest.IsBroadcast()) {
-    if (m_responders.empty()) {
+    if (m_responders.empty() && !m_farm.get()) {
       RunRDMCallback(callback, ola::rdm::RDM_WAS_BROADCAST);
     } else {
       broadcast_request_tracker *tracker = new broadcast_request_tracker;
-      tracker->expected_count = m_responders.size();
+      tracker->expected_count = m_responders.size() + (m_farm.get() ? 1 : 0);
       tracker->current_count = 0;
       tracker->failed = false;
       tracker->callback = callback;
@@ -152,12 +167,19 @@ void DummyPort::SendRDMRequest(ola::rdm::RDMRequest *request_ptr,
           request->Duplicate(),
           NewSingleCallback(this, &DummyPort::HandleBroadcastAck, tracker));
       }
+      if (m_farm.get()) {
+        m_farm->SendRDMRequest(
+          request.release(),
+          NewSingleCallback(this, &DummyPort::HandleBroadcastAck, tracker));
+      }
     }
   } else {
     ola::rdm::RDMControllerInterface *controller = STLFindOrNull(
         m_responders, dest);
     if (controller) {
       controller->SendRDMRequest(request.release(), callback);
+    } else if (m_farm.get() && m_farm->Contains(dest)) {
+      m_farm->SendRDMRequest(request.release(), callback);
     } else {
       RunRDMCallback(callback, ola::rdm::RDM_UNKNOWN_UID);
     }
@@ -167,11 +189,24 @@ void DummyPort::SendRDMRequest(ola::rdm::RDMRequest *request_ptr,
 
 void DummyPort::RunDiscovery(RDMDiscoveryCallback *callback) {
   ola::rdm::UIDSet uid_set;
-  for (ResponderMap::iterator i = m_responders.begin();
+  FixedResponderUIDs(&uid_set);
+  callback->Run(uid_set);
+}
+
+
+void DummyPort::FixedResponderUIDs(ola::rdm::UIDSet *uids) const {
+  for (ResponderMap::const_iterator i = m_responders.begin();
     i != m_responders.end(); i++) {
-    uid_set.AddUID(i->first);
+    uids->AddUID(i->first);
   }
-  callback->Run(uid_set);
+}
+
+
+void DummyPort::FarmDiscoveryComplete(RDMDiscoveryCallback *callback,
+                                      const ola::rdm::UIDSet &farm_uids) {
+  ola::rdm::UIDSet uid_set;
+  FixedResponderUIDs(&uid_set);
+  callback->Run(uid_set.Union(farm_uids));
 }
 
 
@@ -194,6 +229,7 @@ void DummyPort::HandleBroadcastAck(broadcast_request_tracker *tracker,
 
 
 DummyPort::~DummyPort() {
+  m_farm.reset();
   STLDeleteValues(&m_responders);
 }
 }  // namespace dummy
@@ -24,13 +24,17 @@
 #include <stdint.h>
 #include <string>
 #include <map>
+#include <memory>
 #include <vector>
 #include "ola/Constants.h"
 #include "ola/DmxBuffer.h"
 #include "ola/rdm/RDMControllerInterface.h"
 #include "ola/rdm/RDMEnums.h"
 #include "ola/rdm/UID.h"
+#include "ola/rdm/UIDSet.h"
+#include "ola/thread/SchedulerInterface.h"
 #include "olad/Port.h"
+#include "plugins/dummy/ResponderFarm.h"
 
 namespace ola {
 namespace plugin {
@@ -59,6 +63,8 @@ class DummyPort: public BasicOutputPort {
     uint8_t number_of_advanced_dimmers;
     uint8_t number_of_sensor_responders;
     uint8_t number_of_network_responders;
+    // The simulated responders, used for load testing
+    ResponderFarm::Options farm_options;
   };
 
 
@@ -68,10 +74,13 @@ class DummyPort: public BasicOutputPort {
    * @param options the config for the DummyPort such as the number of fake RDM
    * devices to create
    * @param id the ID of this port
+   * @param scheduler the scheduler used to delay responses from the
+   * responder farm, may be NULL.
    */
   DummyPort(class DummyDevice *parent,
             const Options &options,
-            unsigned int id);
+            unsigned int id,
+            ola::thread::SchedulerInterface *scheduler = NULL);
   virtual ~DummyPort();
   bool WriteDMX(const DmxBuffer &buffer, uint8_t priority);
   std::string Description() const { return "Dummy Port"; }
@@ -97,8 +106,12 @@ class DummyPort: public BasicOutputPort {
 
   DmxBuffer m_buffer;
   ResponderMap m_responders;
+  std::auto_ptr<ResponderFarm> m_farm;
 
   void RunDiscovery(ola::rdm::RDMDiscoveryCallback *callback);
+  void FixedResponderUIDs(ola::rdm::UIDSet *uids) const;
+  void FarmDiscoveryComplete(ola::rdm::RDMDiscoveryCallback *callback,
+                             const ola::rdm::UIDSet &farm_uids);
   void HandleBroadcastAck(broadcast_request_tracker *tracker,
                           ola::rdm::RDMReply *reply);
 
@@ -0,0 +1,398 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * ResponderFarm.cpp
+ * A large number of simulated RDM responders, for load testing.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#include <string.h>
+#include <map>
+#include <memory>
+#include <vector>
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/Constants.h"
+#include "ola/Logging.h"
+#include "ola/rdm/AdvancedDimmerResponder.h"
+#include "ola/rdm/DimmerResponder.h"
+#include "ola/rdm/DummyResponder.h"
+#include "ola/rdm/MovingLightResponder.h"
+#include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/SensorResponder.h"
+#include "ola/stl/STLUtils.h"
+#include "plugins/dummy/ResponderFarm.h"
+
+namespace ola {
+namespace plugin {
+namespace dummy {
+
+using ola::rdm::RDMCallback;
+using ola::rdm::RDMDiscoveryCallback;
+using ola::rdm::RDMReply;
+using ola::rdm::RDMRequest;
+using ola::rdm::RunRDMCallback;
+using ola::rdm::UID;
+using ola::rdm::UIDSet;
+using std::auto_ptr;
+
+namespace {
+
+void DiscardReply(RDMReply*) {}
+
+/*
+ * OR a byte into the DUB response and add it to the checksum.
+ */
+void OrAndChecksum(uint8_t *data, unsigned int offset, uint8_t value,
+                   uint16_t *checksum) {
+  data[offset] |= value;
+  *checksum += value;
+}
+
+/*
+ * OR the DUB response for a UID into data, which must be at least 24 bytes.
+ */
+void AddDUBResponse(const UID &uid, uint8_t *data) {
+  uint16_t manufacturer_id = uid.ManufacturerId();
+  uint32_t device_id = uid.DeviceId();
+
+  for (unsigned int i = 0; i < 7; i++) {
+    data[i] |= 0xfe;
+  }
+  data[7] |= 0xaa;
+
+  uint16_t checksum = 0;
+  OrAndChecksum(data, 8, (manufacturer_id >> 8) | 0xaa, &checksum);
+  OrAndChecksum(data, 9, (manufacturer_id >> 8) | 0x55, &checksum);
+  OrAndChecksum(data, 10, manufacturer_id | 0xaa, &checksum);
+  OrAndChecksum(data, 11, manufacturer_id | 0x55, &checksum);
+
+  OrAndChecksum(data, 12, (device_id >> 24) | 0xaa, &checksum);
+  OrAndChecksum(data, 13, (device_id >> 24) | 0x55, &checksum);
+  OrAndChecksum(data, 14, (device_id >> 16) | 0xaa, &checksum);
+  OrAndChecksum(data, 15, (device_id >> 16) | 0x55, &checksum);
+  OrAndChecksum(data, 16, (device_id >> 8) | 0xaa, &checksum);
+  OrAndChecksum(data, 17, (device_id >> 8) | 0x55, &checksum);
+  OrAndChecksum(data, 18, device_id | 0xaa, &checksum);
+  OrAndChecksum(data, 19, device_id | 0x55, &checksum);
+
+  data[20] |= (checksum >> 8) | 0xaa;
+  data[21] |= (checksum >> 8) | 0x55;
+  data[22] |= checksum | 0xaa;
+  data[23] |= checksum | 0x55;
+}
+}  // namespace
+
+ResponderFarm::ResponderFarm(const Options &options,
+                             ola::thread::SchedulerInterface *scheduler)
+    : m_response_delay(options.response_delay),
+      m_packet_loss(options.packet_loss),
+      m_scheduler(scheduler),
+      m_random_state(options.seed ? options.seed : 1),
+      m_timeout_id(ola::thread::INVALID_TIMEOUT),
+      m_running_operations(false),
+      m_lost_count(0),
+      m_discovery_agent(this) {
+  AddResponders(options.responder_count);
+}
+
+ResponderFarm::~ResponderFarm() {
+  // Complete any discovery now, while the farm is still intact.
+  m_discovery_agent.Abort();
+
+  if (m_timeout_id != ola::thread::INVALID_TIMEOUT) {
+    m_scheduler->RemoveTimeout(m_timeout_id);
+  }
+
+  while (!m_operations.empty()) {
+    Operation operation = m_operations.front();
+    m_operations.pop();
+    if (operation.type == RDM_OPERATION) {
+      delete operation.request;
+      RunRDMCallback(operation.rdm_callback, ola::rdm::RDM_FAILED_TO_SEND);
+    }
+    // The discovery callbacks are owned by the agent.
+  }
+
+  for (ResponderMap::iterator iter = m_responders.begin();
+       iter != m_responders.end(); ++iter) {
+    delete iter->second.controller;
+  }
+}
+
+bool ResponderFarm::Contains(const UID &uid) const {
+  return STLContains(m_responders, uid);
+}
+
+void ResponderFarm::SendRDMRequest(RDMRequest *request,
+                                   RDMCallback *callback) {
+  Operation operation(RDM_OPERATION);
+  operation.request = request;
+  operation.rdm_callback = callback;
+  QueueOperation(operation);
+}
+
+void ResponderFarm::RunFullDiscovery(RDMDiscoveryCallback *callback) {
+  m_discovery_callbacks.push_back(callback);
+  if (m_discovery_callbacks.size() == 1) {
+    m_discovery_agent.StartFullDiscovery(
+        NewSingleCallback(this, &ResponderFarm::DiscoveryComplete));
+  }
+}
+
+void ResponderFarm::RunIncrementalDiscovery(RDMDiscoveryCallback *callback) {
+  m_discovery_callbacks.push_back(callback);
+  if (m_discovery_callbacks.size() == 1) {
+    m_discovery_agent.StartIncrementalDiscovery(
+        NewSingleCallback(this, &ResponderFarm::DiscoveryComplete));
+  }
+}
+
+void ResponderFarm::MuteDevice(const UID &target,
+                               MuteDeviceCallback *mute_complete) {
+  Operation operation(MUTE_OPERATION);
+  operation.uid = target;
+  operation.mute_callback = mute_complete;
+  QueueOperation(operation);
+}
+
+void ResponderFarm::UnMuteAll(UnMuteDeviceCallback *unmute_complete) {
+  Operation operation(UNMUTE_OPERATION);
+  operation.unmute_callback = unmute_complete;
+  QueueOperation(operation);
+}
+
+void ResponderFarm::Branch(const UID &lower,
+                           const UID &upper,
+                           BranchCallback *callback) {
+  Operation operation(BRANCH_OPERATION);
+  operation.uid = lower;
+  operation.upper = upper;
+  operation.branch_callback = callback;
+  QueueOperation(operation);
+}
+
+/*
+ * Create count responders with random UIDs, cycling through the responder
+ * models.
+ */
+void ResponderFarm::AddResponders(unsigned int count) {
+  unsigned int attempts = 0;
+  while (m_responders.size() < count && attempts++ < count * 2) {
+    // Skip the broadcast manufacturer id and the OLA id, which is used by the
+    // fixed responders in the DummyPort.
+    uint16_t manufacturer_id = 1 + Random() % 0x7ffe;
+    if (manufacturer_id == OPEN_LIGHTING_ESTA_CODE) {
+      continue;
+    }
+    uint32_t device_id = Random() % 0xffffffff;
+    UID uid(manufacturer_id, device_id);
+    if (STLContains(m_responders, uid)) {
+      continue;
+    }
+
+    SimulatedResponder responder;
+    responder.muted = false;
+    switch (m_responders.size() % 5) {
+      case 0:
+        responder.controller = new ola::rdm::DummyResponder(uid);
+        break;
+      case 1:
+        responder.controller = new ola::rdm::DimmerResponder(
+            uid, DIMMER_SUB_DEVICE_COUNT);
+        break;
+      case 2:
+        responder.controller = new ola::rdm::MovingLightResponder(uid);
+        break;
+      case 3:
+        responder.controller = new ola::rdm::SensorResponder(uid);
+        break;
+      default:
+        responder.controller = new ola::rdm::AdvancedDimmerResponder(uid);
+    }
+    m_responders.insert(ResponderMap::value_type(uid, responder));
+  }
+
+  if (m_responders.size() < count) {
+    OLA_WARN << "Only created " << m_responders.size() << " of " << count
+             << " farm responders";
+  }
+}
+
+/*
+ * A xorshift PRNG, so the farm is reproducible for a given seed.
+ */
+uint32_t ResponderFarm::Random() {
+  m_random_state ^= m_random_state << 13;
+  m_random_state ^= m_random_state >> 17;
+  m_random_state ^= m_random_state << 5;
+  return m_random_state;
+}
+
+bool ResponderFarm::IsLost() {
+  if (m_packet_loss && Random() % 100 < m_packet_loss) {
+    m_lost_count++;
+    return true;
+  }
+  return false;
+}
+
+/*
+ * Add an operation to the line. Operations are run in order, one every
+ * m_response_delay, or immediately if there is no delay.
+ */
+void ResponderFarm::QueueOperation(const Operation &operation) {
+  m_operations.push(operation);
+
+  if (!m_scheduler || !m_response_delay) {
+    // Run the operations in a loop, rather than recursing each time an
+    // operation's callback queues the next one.
+    if (m_running_operations) {
+      return;
+    }
+    m_running_operations = true;
+    while (!m_operations.empty()) {
+      Operation next = m_operations.front();
+      m_operations.pop();
+      RunOperation(next);
+    }
+    m_running_operations = false;
+    return;
+  }
+
+  if (m_timeout_id == ola::thread::INVALID_TIMEOUT) {
+    m_timeout_id = m_scheduler->RegisterSingleTimeout(
+        ola::TimeInterval(static_cast<int64_t>(m_response_delay)),
+        NewSingleCallback(this, &ResponderFarm::RunNextOperation));
+  }
+}
+
+void ResponderFarm::RunNextOperation() {
+  m_timeout_id = ola::thread::INVALID_TIMEOUT;
+  if (m_operations.empty()) {
+    return;
+  }
+
+  Operation operation = m_operations.front();
+  m_operations.pop();
+  RunOperation(operation);
+
+  // Running the operation may have queued another one, and started the timer.
+  if (!m_operations.empty() &&
+      m_timeout_id == ola::thread::INVALID_TIMEOUT) {
+    m_timeout_id = m_scheduler->RegisterSingleTimeout(
+        ola::TimeInterval(static_cast<int64_t>(m_response_delay)),
+        NewSingleCallback(this, &ResponderFarm::RunNextOperation));
+  }
+}
+
+void ResponderFarm::RunOperation(const Operation &operation) {
+  switch (operation.type) {
+    case RDM_OPERATION:
+      HandleRDMRequest(operation.request, operation.rdm_callback);
+      break;
+    case MUTE_OPERATION:
+      operation.mute_callback->Run(HandleMute(operation.uid));
+      break;
+    case UNMUTE_OPERATION:
+      HandleUnMuteAll();
+      operation.unmute_callback->Run();
+      break;
+    case BRANCH_OPERATION:
+      HandleBranch(operation.uid, operation.upper, operation.branch_callback);
+      break;
+  }
+}
+
+void ResponderFarm::HandleRDMRequest(RDMRequest *request_ptr,
+                                     RDMCallback *callback) {
+  auto_ptr<RDMRequest> request(request_ptr);
+
+  UID dest = request->DestinationUID();
+  if (dest.IsBroadcast()) {
+    for (ResponderMap::iterator iter = m_responders.begin();
+         iter != m_responders.end(); ++iter) {
+      if (dest.DirectedToUID(iter->first) && !IsLost()) {
+        iter->second.controller->SendRDMRequest(
+            request->Duplicate(), NewSingleCallback(&DiscardReply));
+      }
+    }
+    RunRDMCallback(callback, ola::rdm::RDM_WAS_BROADCAST);
+    return;
+  }
+
+  ResponderMap::iterator iter = m_responders.find(dest);
+  if (iter == m_responders.end() || IsLost()) {
+    RunRDMCallback(callback, ola::rdm::RDM_TIMEOUT);
+    return;
+  }
+  iter->second.controller->SendRDMRequest(request.release(), callback);
+}
+
+bool ResponderFarm::HandleMute(const UID &target) {
+  ResponderMap::iterator iter = m_responders.find(target);
+  if (iter == m_responders.end()) {
+    return false;
+  }
+  // The responder may act on the mute even though the ack is lost.
+  iter->second.muted = true;
+  return !IsLost();
+}
+
+void ResponderFarm::HandleUnMuteAll() {
+  for (ResponderMap::iterator iter = m_responders.begin();
+       iter != m_responders.end(); ++iter) {
+    iter->second.muted = false;
+  }
+}
+
+void ResponderFarm::HandleBranch(const UID &lower,
+                                 const UID &upper,
+                                 BranchCallback *callback) {
+  uint8_t data[DUB_RESPONSE_SIZE];
+  memset(data, 0, sizeof(data));
+  bool responded = false;
+
+  ResponderMap::const_iterator iter = m_responders.lower_bound(lower);
+  ResponderMap::const_iterator end = m_responders.upper_bound(upper);
+  for (; iter != end; ++iter) {
+    if (!iter->second.muted && !IsLost()) {
+      AddDUBResponse(iter->first, data);
+      responded = true;
+    }
+  }
+
+  if (responded) {
+    callback->Run(data, sizeof(data));
+  } else {
+    callback->Run(NULL, 0);
+  }
+}
+
+void ResponderFarm::DiscoveryComplete(bool ok, const UIDSet &uids) {
+  if (!ok) {
+    OLA_INFO << "Farm discovery failed";
+  }
+
+  DiscoveryCallbacks callbacks;
+  callbacks.swap(m_discovery_callbacks);
+  for (DiscoveryCallbacks::iterator iter = callbacks.begin();
+       iter != callbacks.end(); ++iter) {
+    (*iter)->Run(uids);
+  }
+}
+}  // namespace dummy
+}  // namespace plugin
+}  // namespace ola
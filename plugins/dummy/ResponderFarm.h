@@ -0,0 +1,194 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * ResponderFarm.h
+ * A large number of simulated RDM responders, for load testing.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#ifndef PLUGINS_DUMMY_RESPONDERFARM_H_
+#define PLUGINS_DUMMY_RESPONDERFARM_H_
+
+#include <stdint.h>
+#include <map>
+#include <queue>
+#include <vector>
+#include "ola/base/Macro.h"
+#include "ola/rdm/DiscoveryAgent.h"
+#include "ola/rdm/RDMControllerInterface.h"
+#include "ola/rdm/UID.h"
+#include "ola/rdm/UIDSet.h"
+#include "ola/thread/SchedulerInterface.h"
+
+namespace ola {
+namespace plugin {
+namespace dummy {
+
+/**
+ * A farm of simulated responders, all on the one RDM line.
+ *
+ * The responders are a mix of the responder models from common/rdm, with
+ * randomly chosen UIDs. Unlike a plain responder, each one also answers
+ * DUB & mute commands, so discovery runs the full binary search through a
+ * DiscoveryAgent. DUB responses from every unmuted responder in the branch
+ * are OR'ed together, the same as they would be on the wire, so collisions
+ * occur naturally. Like a real line, a collision can occasionally decode to a
+ * valid looking, phantom UID.
+ *
+ * The line is half duplex: commands are queued and each one takes
+ * response_delay to complete. If no scheduler is provided, or the delay is 0,
+ * commands complete immediately.
+ *
+ * A packet_loss percentage of transactions are lost. A lost request times
+ * out, a lost mute isn't acked and a lost DUB response from a responder
+ * isn't seen.
+ */
+class ResponderFarm: public ola::rdm::DiscoveryTargetInterface {
+ public:
+  struct Options {
+   public:
+    Options()
+        : responder_count(0),
+          response_delay(0),
+          packet_loss(0),
+          seed(1) {
+    }
+
+    unsigned int responder_count;
+    unsigned int response_delay;  // in microseconds
+    uint8_t packet_loss;  // as a percentage
+    unsigned int seed;  // used for the UIDs & packet loss
+  };
+
+  /**
+   * Create a new ResponderFarm
+   * @param options the size & behavior of the farm
+   * @param scheduler the scheduler used to delay responses, may be NULL.
+   *   Ownership is not transferred.
+   */
+  ResponderFarm(const Options &options,
+                ola::thread::SchedulerInterface *scheduler);
+  ~ResponderFarm();
+
+  unsigned int ResponderCount() const { return m_responders.size(); }
+  bool Contains(const ola::rdm::UID &uid) const;
+
+  void SendRDMRequest(ola::rdm::RDMRequest *request,
+                      ola::rdm::RDMCallback *callback);
+
+  /*
+   * If discovery is already running, the callback is run once it completes.
+   */
+  void RunFullDiscovery(ola::rdm::RDMDiscoveryCallback *callback);
+  void RunIncrementalDiscovery(ola::rdm::RDMDiscoveryCallback *callback);
+
+  /**
+   * The stats for the current, or last, discovery run.
+   */
+  const ola::rdm::DiscoveryAgent::DiscoveryStats& DiscoveryStats() const {
+    return m_discovery_agent.Stats();
+  }
+
+  /**
+   * The number of transactions that have been lost.
+   */
+  unsigned int LostCount() const { return m_lost_count; }
+
+  // DiscoveryTargetInterface methods
+  void MuteDevice(const ola::rdm::UID &target,
+                  MuteDeviceCallback *mute_complete);
+  void UnMuteAll(UnMuteDeviceCallback *unmute_complete);
+  void Branch(const ola::rdm::UID &lower,
+              const ola::rdm::UID &upper,
+              BranchCallback *callback);
+  unsigned int MaxMutesInFlight() const { return MAX_MUTES_IN_FLIGHT; }
+
+ private:
+  typedef enum {
+    RDM_OPERATION,
+    MUTE_OPERATION,
+    UNMUTE_OPERATION,
+    BRANCH_OPERATION
+  } operation_type;
+
+  struct Operation {
+   public:
+    explicit Operation(operation_type type)
+        : type(type),
+          uid(0, 0),
+          upper(0, 0),
+          request(NULL),
+          rdm_callback(NULL),
+          mute_callback(NULL),
+          unmute_callback(NULL),
+          branch_callback(NULL) {
+    }
+
+    operation_type type;
+    ola::rdm::UID uid;  // the mute target, or the lower bound of the branch
+    ola::rdm::UID upper;
+    ola::rdm::RDMRequest *request;
+    ola::rdm::RDMCallback *rdm_callback;
+    MuteDeviceCallback *mute_callback;
+    UnMuteDeviceCallback *unmute_callback;
+    BranchCallback *branch_callback;
+  };
+
+  struct SimulatedResponder {
+    ola::rdm::RDMControllerInterface *controller;
+    bool muted;
+  };
+
+  typedef std::map<ola::rdm::UID, SimulatedResponder> ResponderMap;
+  typedef std::vector<ola::rdm::RDMDiscoveryCallback*> DiscoveryCallbacks;
+
+  const unsigned int m_response_delay;
+  const uint8_t m_packet_loss;
+  ola::thread::SchedulerInterface *m_scheduler;
+  uint32_t m_random_state;
+  ResponderMap m_responders;
+  std::queue<Operation> m_operations;
+  ola::thread::timeout_id m_timeout_id;
+  bool m_running_operations;
+  unsigned int m_lost_count;
+  DiscoveryCallbacks m_discovery_callbacks;
+  ola::rdm::DiscoveryAgent m_discovery_agent;
+
+  void AddResponders(unsigned int count);
+  uint32_t Random();
+  bool IsLost();
+
+  void QueueOperation(const Operation &operation);
+  void RunNextOperation();
+  void RunOperation(const Operation &operation);
+  void HandleRDMRequest(ola::rdm::RDMRequest *request,
+                        ola::rdm::RDMCallback *callback);
+  bool HandleMute(const ola::rdm::UID &target);
+  void HandleUnMuteAll();
+  void HandleBranch(const ola::rdm::UID &lower,
+                    const ola::rdm::UID &upper,
+                    BranchCallback *callback);
+  void DiscoveryComplete(bool ok, const ola::rdm::UIDSet &uids);
+
+  static const unsigned int DUB_RESPONSE_SIZE = 24;
+  static const unsigned int MAX_MUTES_IN_FLIGHT = 8;
+  static const unsigned int DIMMER_SUB_DEVICE_COUNT = 4;
+
+  DISALLOW_COPY_AND_ASSIGN(ResponderFarm);
+};
+}  // namespace dummy
+}  // namespace plugin
+}  // namespace ola
+#endif  // PLUGINS_DUMMY_RESPONDERFARM_H_
@@ -0,0 +1,285 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * ResponderFarmTest.cpp
+ * Test fixture for the ResponderFarm
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <memory>
+
+#include "ola/Callback.h"
+#include "ola/Logging.h"
+#include "ola/io/SelectServer.h"
+#include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/RDMControllerInterface.h"
+#include "ola/rdm/RDMEnums.h"
+#include "ola/rdm/UID.h"
+#include "ola/rdm/UIDSet.h"
+#include "ola/testing/TestUtils.h"
+#include "plugins/dummy/DummyPort.h"
+#include "plugins/dummy/ResponderFarm.h"
+
+namespace ola {
+namespace plugin {
+namespace dummy {
+
+using ola::io::SelectServer;
+using ola::rdm::RDMGetRequest;
+using ola::rdm::RDMReply;
+using ola::rdm::RDMRequest;
+using ola::rdm::UID;
+using ola::rdm::UIDSet;
+
+class ResponderFarmTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(ResponderFarmTest);
+  CPPUNIT_TEST(testCreation);
+  CPPUNIT_TEST(testDiscovery);
+  CPPUNIT_TEST(testPacketLoss);
+  CPPUNIT_TEST(testResponseDelay);
+  CPPUNIT_TEST(testDummyPort);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  ResponderFarmTest()
+      : TestFixture(),
+        m_source(1, 2) {
+    ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
+  }
+
+  void setUp() {
+    m_uids.Clear();
+    m_discovery_runs = 0;
+    m_replies = 0;
+    m_timeouts = 0;
+  }
+
+  void testCreation();
+  void testDiscovery();
+  void testPacketLoss();
+  void testResponseDelay();
+  void testDummyPort();
+
+ private:
+  UID m_source;
+  UIDSet m_uids;
+  unsigned int m_discovery_runs;
+  unsigned int m_replies;
+  unsigned int m_timeouts;
+  SelectServer m_ss;
+
+  void DiscoveryComplete(const UIDSet &uids) {
+    m_uids = uids;
+    m_discovery_runs++;
+  }
+
+  void DiscoveryCompleteAndTerminate(const UIDSet &uids) {
+    DiscoveryComplete(uids);
+    m_ss.Terminate();
+  }
+
+  void HandleReply(RDMReply *reply) {
+    if (reply->StatusCode() == ola::rdm::RDM_COMPLETED_OK) {
+      m_replies++;
+    } else if (reply->StatusCode() == ola::rdm::RDM_TIMEOUT) {
+      m_timeouts++;
+    }
+  }
+
+  RDMRequest *NewDeviceInfoRequest(const UID &destination) {
+    return new RDMGetRequest(m_source, destination, 0, 1, 0,
+                             ola::rdm::PID_DEVICE_INFO, NULL, 0);
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ResponderFarmTest);
+
+
+/*
+ * Check the farm creates the responders, and the UIDs depend on the seed.
+ */
+void ResponderFarmTest::testCreation() {
+  ResponderFarm::Options options;
+  options.responder_count = 500;
+  ResponderFarm farm(options, NULL);
+  OLA_ASSERT_EQ(500u, farm.ResponderCount());
+  farm.RunFullDiscovery(
+      NewSingleCallback(this, &ResponderFarmTest::DiscoveryComplete));
+  UIDSet first_uids = m_uids;
+
+  ResponderFarm same_farm(options, NULL);
+  same_farm.RunFullDiscovery(
+      NewSingleCallback(this, &ResponderFarmTest::DiscoveryComplete));
+  OLA_ASSERT_EQ(first_uids, m_uids);
+
+  options.seed = 2;
+  ResponderFarm other_farm(options, NULL);
+  other_farm.RunFullDiscovery(
+      NewSingleCallback(this, &ResponderFarmTest::DiscoveryComplete));
+  OLA_ASSERT_EQ(500u, m_uids.Size());
+  OLA_ASSERT_NE(first_uids, m_uids);
+}
+
+
+/*
+ * Check that full & incremental discovery find the responders.
+ */
+void ResponderFarmTest::testDiscovery() {
+  ResponderFarm::Options options;
+  options.responder_count = 2000;
+  ResponderFarm farm(options, NULL);
+
+  farm.RunFullDiscovery(
+      NewSingleCallback(this, &ResponderFarmTest::DiscoveryComplete));
+  OLA_ASSERT_EQ(1u, m_discovery_runs);
+  // With this many devices there are plenty of collisions. Occasionally a
+  // collision decodes to a phantom UID, and the rest of that branch is
+  // skipped, so the first run may miss a few responders.
+  OLA_ASSERT_TRUE(farm.DiscoveryStats().collisions > 0);
+  OLA_ASSERT_TRUE(m_uids.Size() > 1900);
+  OLA_ASSERT_TRUE(m_uids.Size() <= 2000);
+  for (UIDSet::Iterator iter = m_uids.Begin(); iter != m_uids.End(); ++iter) {
+    OLA_ASSERT_TRUE(farm.Contains(*iter));
+  }
+
+  // Incremental discovery mutes the known responders, so there's only a
+  // collision if some were missed.
+  unsigned int found = m_uids.Size();
+  farm.RunIncrementalDiscovery(
+      NewSingleCallback(this, &ResponderFarmTest::DiscoveryComplete));
+  OLA_ASSERT_EQ(2u, m_discovery_runs);
+  OLA_ASSERT_TRUE(m_uids.Size() >= found);
+  OLA_ASSERT_TRUE(m_uids.Size() <= 2000);
+  if (found == 2000) {
+    OLA_ASSERT_EQ(0u, farm.DiscoveryStats().collisions);
+  }
+}
+
+
+/*
+ * Check that lost packets cause timeouts.
+ */
+void ResponderFarmTest::testPacketLoss() {
+  ResponderFarm::Options options;
+  options.responder_count = 1;
+  ResponderFarm farm(options, NULL);
+  farm.RunFullDiscovery(
+      NewSingleCallback(this, &ResponderFarmTest::DiscoveryComplete));
+  OLA_ASSERT_EQ(1u, m_uids.Size());
+  UID uid = *m_uids.Begin();
+
+  // The same seed gives the same UID.
+  options.packet_loss = 50;
+  ResponderFarm lossy_farm(options, NULL);
+  OLA_ASSERT_TRUE(lossy_farm.Contains(uid));
+
+  for (unsigned int i = 0; i < 100; i++) {
+    lossy_farm.SendRDMRequest(
+        NewDeviceInfoRequest(uid),
+        NewSingleCallback(this, &ResponderFarmTest::HandleReply));
+  }
+  OLA_ASSERT_EQ(100u, m_replies + m_timeouts);
+  OLA_ASSERT_TRUE(m_replies > 0);
+  OLA_ASSERT_TRUE(m_timeouts > 0);
+  OLA_ASSERT_EQ(m_timeouts, lossy_farm.LostCount());
+}
+
+
+/*
+ * Check that responses are delayed, concurrent discovery requests share a
+ * run, and pending requests & discovery fail when the farm is destroyed.
+ */
+void ResponderFarmTest::testResponseDelay() {
+  ResponderFarm::Options options;
+  options.responder_count = 20;
+  options.response_delay = 100;
+  std::auto_ptr<ResponderFarm> farm(new ResponderFarm(options, &m_ss));
+
+  farm->RunFullDiscovery(NewSingleCallback(
+      this, &ResponderFarmTest::DiscoveryCompleteAndTerminate));
+  // This waits for the discovery that's already running.
+  farm->RunIncrementalDiscovery(
+      NewSingleCallback(this, &ResponderFarmTest::DiscoveryComplete));
+  OLA_ASSERT_EQ(0u, m_discovery_runs);
+  m_ss.Run();
+  OLA_ASSERT_EQ(2u, m_discovery_runs);
+  OLA_ASSERT_EQ(20u, m_uids.Size());
+
+  farm->SendRDMRequest(
+      NewDeviceInfoRequest(*m_uids.Begin()),
+      NewSingleCallback(this, &ResponderFarmTest::HandleReply));
+  OLA_ASSERT_EQ(0u, m_replies);
+  m_ss.RunOnce(ola::TimeInterval(1, 0));
+  OLA_ASSERT_EQ(1u, m_replies);
+
+  farm->SendRDMRequest(
+      NewDeviceInfoRequest(*m_uids.Begin()),
+      NewSingleCallback(this, &ResponderFarmTest::HandleReply));
+  farm.reset();
+  OLA_ASSERT_EQ(1u, m_replies);
+
+  // Destroy the farm part way through a delayed discovery, once the
+  // incremental mutes are in flight.
+  farm.reset(new ResponderFarm(options, &m_ss));
+  farm->RunFullDiscovery(NewSingleCallback(
+      this, &ResponderFarmTest::DiscoveryCompleteAndTerminate));
+  m_ss.Run();
+  OLA_ASSERT_EQ(3u, m_discovery_runs);
+  OLA_ASSERT_EQ(20u, m_uids.Size());
+
+  farm->RunIncrementalDiscovery(
+      NewSingleCallback(this, &ResponderFarmTest::DiscoveryComplete));
+  for (unsigned int i = 0; i < 5; i++) {
+    m_ss.RunOnce(ola::TimeInterval(0, 1000));
+  }
+  OLA_ASSERT_EQ(3u, m_discovery_runs);
+  OLA_ASSERT_TRUE(farm->DiscoveryStats().mutes > 0);
+  farm.reset();
+  OLA_ASSERT_EQ(4u, m_discovery_runs);
+  OLA_ASSERT_EQ(0u, m_uids.Size());
+
+  // And while the unmute is queued.
+  farm.reset(new ResponderFarm(options, &m_ss));
+  farm->RunFullDiscovery(
+      NewSingleCallback(this, &ResponderFarmTest::DiscoveryComplete));
+  farm.reset();
+  OLA_ASSERT_EQ(5u, m_discovery_runs);
+}
+
+
+/*
+ * Check the DummyPort includes the farm.
+ */
+void ResponderFarmTest::testDummyPort() {
+  DummyPort::Options options;
+  options.farm_options.responder_count = 100;
+  DummyPort port(NULL, options, 0);
+
+  port.RunFullDiscovery(
+      NewSingleCallback(this, &ResponderFarmTest::DiscoveryComplete));
+  OLA_ASSERT_EQ(106u, m_uids.Size());
+  OLA_ASSERT_TRUE(m_uids.Contains(UID(OPEN_LIGHTING_ESTA_CODE, 0xffffff00)));
+
+  for (UIDSet::Iterator iter = m_uids.Begin(); iter != m_uids.End(); ++iter) {
+    port.SendRDMRequest(
+        NewDeviceInfoRequest(*iter),
+        NewSingleCallback(this, &ResponderFarmTest::HandleReply));
+  }
+  OLA_ASSERT_EQ(106u, m_replies);
+}
+}  // namespace dummy
+}  // namespace plugin
+}  // namespace ola
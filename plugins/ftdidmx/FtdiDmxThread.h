@@ -26,7 +26,9 @@
 #ifndef PLUGINS_FTDIDMX_FTDIDMXTHREAD_H_
 #define PLUGINS_FTDIDMX_FTDIDMXTHREAD_H_
 
+#include "ola/Clock.h"
 #include "ola/DmxBuffer.h"
+#include "ola/thread/DmxFrameTimer.h"
 #include "ola/thread/Thread.h"
 
 namespace ola {
@@ -43,21 +45,16 @@ class FtdiDmxThread : public ola::thread::Thread {
     bool WriteDMX(const DmxBuffer &buffer);
 
  private:
-    enum TimerGranularity { UNKNOWN, GOOD, BAD };
-
-    TimerGranularity m_granularity;
     FtdiInterface *m_interface;
     bool m_term;
     unsigned int m_frequency;
     DmxBuffer m_buffer;
     ola::thread::Mutex m_term_mutex;
     ola::thread::Mutex m_buffer_mutex;
-
-    void CheckTimeGranularity();
+    ola::thread::DmxFrameTimer m_timer;
 
     static const uint32_t DMX_MAB = 16;
     static const uint32_t DMX_BREAK = 110;
-    static const uint32_t BAD_GRANULARITY_LIMIT = 3;
 };
 }  // namespace ftdidmx
 }  // namespace plugin
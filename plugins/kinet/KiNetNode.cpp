@@ -44,8 +44,8 @@ KiNetNode::KiNetNode(ola::io::SelectServerInterface *ss,
                      ola::network::UDPSocketInterface *socket)
     : m_running(false),
       m_ss(ss),
-      m_output_stream(&m_output_queue),
       m_socket(socket) {
+  PopulateDMXHeader();
 }
 
 
@@ -89,32 +89,27 @@ bool KiNetNode::Stop() {
  * Send some DMX data
  */
 bool KiNetNode::SendDMX(const IPV4Address &target_ip, const DmxBuffer &buffer) {
-  static const uint8_t port = 0;
-  static const uint8_t flags = 0;
-  static const uint16_t timer_val = 0;
-  static const uint32_t universe = 0xffffffff;
-
   if (!buffer.Size()) {
     OLA_DEBUG << "Not sending 0 length packet";
     return true;
   }
 
-  m_output_queue.Clear();
-  PopulatePacketHeader(KINET_DMX_MSG);
-  m_output_stream << port << flags << timer_val << universe;
-  m_output_stream << DMX512_START_CODE;
-  m_output_stream.Write(buffer.GetRaw(), buffer.Size());
+  unsigned int length = DMX_UNIVERSE_SIZE;
+  buffer.Get(m_dmx_packet + KINET_DMX_HEADER_SIZE, &length);
+  const unsigned int packet_size = KINET_DMX_HEADER_SIZE + length;
 
   IPV4SocketAddress target(target_ip, KINET_PORT);
-  bool ok = m_socket->SendTo(&m_output_queue, target);
-  if (!ok)
+  ssize_t bytes_sent = m_socket->SendTo(m_dmx_packet, packet_size, target);
+  if (bytes_sent < 0) {
     OLA_WARN << "Failed to send KiNet DMX packet";
+    return false;
+  }
 
-  if (!m_output_queue.Empty()) {
+  if (static_cast<unsigned int>(bytes_sent) != packet_size) {
     OLA_WARN << "Failed to send complete KiNet packet";
-    m_output_queue.Clear();
+    return false;
   }
-  return ok;
+  return true;
 }
 
 
@@ -138,10 +133,29 @@ void KiNetNode::SocketReady() {
 /*
  * Fill in the header for a packet
  */
-void KiNetNode::PopulatePacketHeader(uint16_t msg_type) {
+void KiNetNode::PopulatePacketHeader(ola::io::BigEndianOutputStream *stream,
+                                     uint16_t msg_type) {
   uint32_t sequence_number = 0;  // everything seems to set this to 0.
-  m_output_stream << KINET_MAGIC_NUMBER << KINET_VERSION_ONE;
-  m_output_stream << msg_type << sequence_number;
+  *stream << KINET_MAGIC_NUMBER << KINET_VERSION_ONE;
+  *stream << msg_type << sequence_number;
+}
+
+
+/*
+ * Fill in the part of the DMX packet that precedes the slot data.
+ */
+void KiNetNode::PopulateDMXHeader() {
+  static const uint8_t port = 0;
+  static const uint8_t flags = 0;
+  static const uint16_t timer_val = 0;
+  static const uint32_t universe = 0xffffffff;
+
+  ola::io::IOQueue queue;
+  ola::io::BigEndianOutputStream stream(&queue);
+  PopulatePacketHeader(&stream, KINET_DMX_MSG);
+  stream << port << flags << timer_val << universe;
+  stream << DMX512_START_CODE;
+  queue.Read(m_dmx_packet, KINET_DMX_HEADER_SIZE);
 }
 
 
@@ -23,6 +23,7 @@
 
 #include <memory>
 
+#include "ola/Constants.h"
 #include "ola/DmxBuffer.h"
 #include "ola/io/BigEndianStream.h"
 #include "ola/io/IOQueue.h"
@@ -48,24 +49,29 @@ class KiNetNode {
                  const ola::DmxBuffer &buffer);
 
  private:
+    static const uint16_t KINET_PORT = 6038;
+    static const uint32_t KINET_MAGIC_NUMBER = 0x0401dc4a;
+    static const uint16_t KINET_VERSION_ONE = 0x0100;
+    static const uint16_t KINET_DMX_MSG = 0x0101;
+    // The size of the DMX packet, up to and including the start code.
+    static const unsigned int KINET_DMX_HEADER_SIZE = 21;
+
     bool m_running;
     ola::io::SelectServerInterface *m_ss;
-    ola::io::IOQueue m_output_queue;
-    ola::io::BigEndianOutputStream m_output_stream;
     ola::network::Interface m_interface;
     std::auto_ptr<ola::network::UDPSocketInterface> m_socket;
+    // The DMX packet. The header is filled in by the constructor, so only the
+    // slot data is written for each frame.
+    uint8_t m_dmx_packet[KINET_DMX_HEADER_SIZE + DMX_UNIVERSE_SIZE];
 
     KiNetNode(const KiNetNode&);
     KiNetNode& operator=(const KiNetNode&);
 
     void SocketReady();
-    void PopulatePacketHeader(uint16_t msg_type);
+    void PopulatePacketHeader(ola::io::BigEndianOutputStream *stream,
+                              uint16_t msg_type);
+    void PopulateDMXHeader();
     bool InitNetwork();
-
-    static const uint16_t KINET_PORT = 6038;
-    static const uint32_t KINET_MAGIC_NUMBER = 0x0401dc4a;
-    static const uint16_t KINET_VERSION_ONE = 0x0100;
-    static const uint16_t KINET_DMX_MSG = 0x0101;
 };
 }  // namespace kinet
 }  // namespace plugin
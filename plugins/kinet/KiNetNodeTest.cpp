@@ -86,5 +86,19 @@ void KiNetNodeTest::testSendDMX() {
   buffer.SetFromString("1,5,8,10,14,45,100,255");
   OLA_ASSERT_TRUE(node.SendDMX(target_ip, buffer));
   m_socket->Verify();
+
+  // The packet is reused, check a shorter frame is sent correctly.
+  const uint8_t expected_data2[] = {
+    0x04, 0x01, 0xdc, 0x4a, 0x01, 0x00,
+    0x01, 0x01, 0, 0, 0, 0,
+    0, 0, 0, 0, 0xff, 0xff, 0xff, 0xff,
+    0, 7, 9
+  };
+
+  m_socket->AddExpectedData(expected_data2, sizeof(expected_data2),
+                            target_ip, KINET_PORT);
+  buffer.SetFromString("7,9");
+  OLA_ASSERT_TRUE(node.SendDMX(target_ip, buffer));
+  m_socket->Verify();
   OLA_ASSERT(node.Stop());
 }
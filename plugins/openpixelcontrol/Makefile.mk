@@ -27,6 +27,15 @@ plugins_openpixelcontrol_libolaopenpixelcontrol_la_LIBADD = \
     olad/plugin_api/libolaserverplugininterface.la \
     plugins/openpixelcontrol/libolaopc.la
 
+# PROGRAMS
+##################################################
+noinst_PROGRAMS += plugins/openpixelcontrol/opc_loadtest
+
+plugins_openpixelcontrol_opc_loadtest_SOURCES = \
+    plugins/openpixelcontrol/opc_loadtest.cpp
+plugins_openpixelcontrol_opc_loadtest_LDADD = \
+    plugins/openpixelcontrol/libolaopc.la
+
 # TESTS
 ##################################################
 test_programs += \
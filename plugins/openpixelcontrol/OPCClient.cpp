@@ -24,8 +24,6 @@
 #include "ola/Logging.h"
 #include "ola/base/Array.h"
 #include "ola/io/BigEndianStream.h"
-#include "ola/io/IOQueue.h"
-#include "ola/io/NonBlockingSender.h"
 #include "ola/network/SocketAddress.h"
 #include "ola/util/Utils.h"
 #include "plugins/openpixelcontrol/OPCConstants.h"
@@ -44,29 +42,39 @@ OPCClient::OPCClient(ola::io::SelectServerInterface *ss,
       m_backoff(TimeInterval(1, 0), TimeInterval(300, 0)),
       m_pool(OPC_FRAME_SIZE),
       m_socket_factory(NewCallback(this, &OPCClient::SocketConnected)),
-      m_tcp_connector(ss, &m_socket_factory, TimeInterval(3, 0)) {
+      m_tcp_connector(ss, &m_socket_factory, TimeInterval(3, 0)),
+      m_output_queue(&m_pool),
+      m_write_registered(false),
+      m_dropped_frames(0) {
   m_tcp_connector.AddEndpoint(target, &m_backoff);
 }
 
 OPCClient::~OPCClient() {
   if (m_client_socket.get()) {
+    UnregisterForWrites();
     m_ss->RemoveReadDescriptor(m_client_socket.get());
     m_tcp_connector.Disconnect(m_target, true);
   }
 }
 
 bool OPCClient::SendDmx(uint8_t channel, const DmxBuffer &buffer) {
-  if (!m_sender.get()) {
+  if (!m_client_socket.get()) {
     return false;  // not connected
   }
 
-  ola::io::IOQueue queue(&m_pool);
-  ola::io::BigEndianOutputStream stream(&queue);
-  stream << channel;
-  stream << SET_PIXEL_COMMAND;
-  stream << static_cast<uint16_t>(buffer.Size());
-  stream.Write(buffer.GetRaw(), buffer.Size());
-  return m_sender->SendMessage(&queue);
+  std::pair<PendingFrames::iterator, bool> p = m_pending_frames.insert(
+      PendingFrames::value_type(channel, buffer));
+  if (!p.second) {
+    // The last frame for this channel hasn't been sent yet.
+    p.first->second = buffer;
+    m_dropped_frames++;
+  }
+
+  if (!m_write_registered) {
+    m_ss->AddWriteDescriptor(m_client_socket.get());
+    m_write_registered = true;
+  }
+  return true;
 }
 
 void OPCClient::SetSocketCallback(SocketEventCallback *callback) {
@@ -78,10 +86,12 @@ void OPCClient::SocketConnected(TCPSocket *socket) {
   m_client_socket->SetOnData(NewCallback(this, &OPCClient::NewData));
   m_client_socket->SetOnClose(
       NewSingleCallback(this, &OPCClient::SocketClosed));
+  m_client_socket->SetOnWritable(
+      NewCallback(this, &OPCClient::SocketWritable));
+  // The frames are already batched, so don't let Nagle delay them.
+  m_client_socket->SetNoDelay();
   m_ss->AddReadDescriptor(socket);
 
-  m_sender.reset(
-      new ola::io::NonBlockingSender(socket, m_ss, &m_pool, OPC_FRAME_SIZE));
   if (m_socket_callback.get()) {
     m_socket_callback->Run(true);
   }
@@ -98,14 +108,50 @@ void OPCClient::NewData() {
   m_client_socket->Receive(discard, arraysize(discard), data_received);
 }
 
+void OPCClient::SocketWritable() {
+  if (m_output_queue.Empty()) {
+    PackPendingFrames();
+  }
+
+  m_client_socket->Send(&m_output_queue);
+  if (m_output_queue.Empty() && m_pending_frames.empty()) {
+    UnregisterForWrites();
+  }
+}
+
 void OPCClient::SocketClosed() {
-  m_sender.reset();
+  UnregisterForWrites();
   m_client_socket.reset();
+  m_pending_frames.clear();
+  m_output_queue.Clear();
 
   if (m_socket_callback.get()) {
     m_socket_callback->Run(false);
   }
 }
+
+/*
+ * Serialize all the pending frames into the output queue.
+ */
+void OPCClient::PackPendingFrames() {
+  ola::io::BigEndianOutputStream stream(&m_output_queue);
+  PendingFrames::const_iterator iter = m_pending_frames.begin();
+  for (; iter != m_pending_frames.end(); ++iter) {
+    const DmxBuffer &buffer = iter->second;
+    stream << iter->first;
+    stream << SET_PIXEL_COMMAND;
+    stream << static_cast<uint16_t>(buffer.Size());
+    stream.Write(buffer.GetRaw(), buffer.Size());
+  }
+  m_pending_frames.clear();
+}
+
+void OPCClient::UnregisterForWrites() {
+  if (m_write_registered) {
+    m_ss->RemoveWriteDescriptor(m_client_socket.get());
+    m_write_registered = false;
+  }
+}
 }  // namespace openpixelcontrol
 }  // namespace plugin
 }  // namespace ola
@@ -21,10 +21,12 @@
 #ifndef PLUGINS_OPENPIXELCONTROL_OPCCLIENT_H_
 #define PLUGINS_OPENPIXELCONTROL_OPCCLIENT_H_
 
+#include <map>
 #include <memory>
 #include <string>
 
 #include "ola/DmxBuffer.h"
+#include "ola/io/IOQueue.h"
 #include "ola/io/MemoryBlockPool.h"
 #include "ola/io/SelectServerInterface.h"
 #include "ola/network/AdvancedTCPConnector.h"
@@ -34,10 +36,6 @@
 
 namespace ola {
 
-namespace io {
-class NonBlockingSender;
-}  // namespace io
-
 namespace plugin {
 namespace openpixelcontrol {
 
@@ -45,6 +43,12 @@ namespace openpixelcontrol {
  * @brief An Open Pixel Control client.
  *
  * The OPC client connects to a remote IP:port and sends OPC messages.
+ *
+ * Frames aren't written immediately. The frames for every channel that are
+ * sent in the same iteration of the SelectServer loop are written with a
+ * single scatter-gather write once the socket is writable, which avoids a
+ * small TCP write per channel. If the socket can't keep up, only the latest
+ * frame for each channel is kept.
  */
 class OPCClient {
  public:
@@ -76,6 +80,8 @@ class OPCClient {
    * @brief Send a DMX frame.
    * @param channel the OPC channel to use.
    * @param buffer the DMX data.
+   * @returns true if the frame was queued, false if the client isn't
+   *   connected.
    */
   bool SendDmx(uint8_t channel, const DmxBuffer &buffer);
 
@@ -86,7 +92,15 @@ class OPCClient {
    */
   void SetSocketCallback(SocketEventCallback *callback);
 
+  /**
+   * @brief The number of frames that were replaced by a newer frame for the
+   *   same channel before they could be sent.
+   */
+  unsigned int DroppedFrames() const { return m_dropped_frames; }
+
  private:
+  typedef std::map<uint8_t, DmxBuffer> PendingFrames;
+
   ola::io::SelectServerInterface *m_ss;
   const ola::network::IPV4SocketAddress m_target;
 
@@ -95,12 +109,18 @@ class OPCClient {
   ola::network::TCPSocketFactory m_socket_factory;
   ola::network::AdvancedTCPConnector m_tcp_connector;
   std::auto_ptr<ola::network::TCPSocket> m_client_socket;
-  std::auto_ptr<ola::io::NonBlockingSender> m_sender;
   std::auto_ptr<SocketEventCallback> m_socket_callback;
+  PendingFrames m_pending_frames;
+  ola::io::IOQueue m_output_queue;
+  bool m_write_registered;
+  unsigned int m_dropped_frames;
 
   void SocketConnected(ola::network::TCPSocket *socket);
   void NewData();
+  void SocketWritable();
   void SocketClosed();
+  void PackPendingFrames();
+  void UnregisterForWrites();
 
   DISALLOW_COPY_AND_ASSIGN(OPCClient);
 };
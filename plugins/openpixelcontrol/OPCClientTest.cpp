@@ -44,22 +44,27 @@ using std::auto_ptr;
 class OPCClientTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(OPCClientTest);
   CPPUNIT_TEST(testTransmit);
+  CPPUNIT_TEST(testBatchedTransmit);
   CPPUNIT_TEST_SUITE_END();
 
  public:
   OPCClientTest()
       : CppUnit::TestFixture(),
-        m_ss(NULL) {
+        m_ss(NULL),
+        m_frames_received(0) {
   }
   void setUp();
 
   void testTransmit();
+  void testBatchedTransmit();
 
  private:
   ola::io::SelectServer m_ss;
   auto_ptr<OPCServer> m_server;
   DmxBuffer m_received_data;
+  DmxBuffer m_batched_data;
   uint8_t m_command;
+  unsigned int m_frames_received;
 
   void CaptureData(uint8_t command, const uint8_t *data, unsigned int length) {
     m_received_data.Set(data, length);
@@ -67,6 +72,15 @@ class OPCClientTest: public CppUnit::TestFixture {
     m_ss.Terminate();
   }
 
+  void CaptureBatchedData(uint8_t command, const uint8_t *data,
+                          unsigned int length) {
+    m_batched_data.Set(data, length);
+    m_command = command;
+    if (++m_frames_received == 2) {
+      m_ss.Terminate();
+    }
+  }
+
   void SendDMX(OPCClient *client, DmxBuffer *buffer, bool connected) {
     if (connected) {
       OLA_ASSERT_TRUE(client->SendDmx(CHANNEL, *buffer));
@@ -75,7 +89,22 @@ class OPCClientTest: public CppUnit::TestFixture {
     }
   }
 
+  void SendBatch(OPCClient *client, DmxBuffer *buffer, bool connected) {
+    if (connected) {
+      // Both the frames for CHANNEL are sent in the same write, only the
+      // second should be delivered.
+      DmxBuffer old_frame;
+      old_frame.SetFromString("9,9");
+      OLA_ASSERT_TRUE(client->SendDmx(CHANNEL, old_frame));
+      OLA_ASSERT_TRUE(client->SendDmx(OTHER_CHANNEL, *buffer));
+      OLA_ASSERT_TRUE(client->SendDmx(CHANNEL, *buffer));
+    } else {
+      m_ss.Terminate();
+    }
+  }
+
   static const uint8_t CHANNEL = 1;
+  static const uint8_t OTHER_CHANNEL = 2;
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(OPCClientTest);
@@ -111,3 +140,24 @@ void OPCClientTest::testTransmit() {
   // Now sends should fail since there is no connection
   OLA_ASSERT_FALSE(client.SendDmx(CHANNEL, buffer));
 }
+
+void OPCClientTest::testBatchedTransmit() {
+  m_server->SetCallback(
+      CHANNEL,
+      ola::NewCallback(this, &OPCClientTest::CaptureBatchedData));
+  m_server->SetCallback(
+      OTHER_CHANNEL,
+      ola::NewCallback(this, &OPCClientTest::CaptureBatchedData));
+
+  OPCClient client(&m_ss, m_server->ListenAddress());
+  DmxBuffer buffer;
+  buffer.SetFromString("1,2,3,4");
+
+  client.SetSocketCallback(
+      ola::NewCallback(this, &OPCClientTest::SendBatch, &client, &buffer));
+
+  m_ss.Run();
+  OLA_ASSERT_EQ(2u, m_frames_received);
+  OLA_ASSERT_EQ(m_batched_data, buffer);
+  OLA_ASSERT_EQ(1u, client.DroppedFrames());
+}
@@ -20,6 +20,7 @@
 
 #include "plugins/openpixelcontrol/OPCServer.h"
 
+#include <string.h>
 #include <string>
 #include "ola/Callback.h"
 #include "ola/Logging.h"
@@ -45,16 +46,15 @@ void CleanupSocket(TCPSocket *socket) {
 }
 }  // namespace
 
-void OPCServer::RxState::CheckSize() {
-  expected_size = utils::JoinUInt8(data[2], data[3]);
-  if (static_cast<unsigned int>(expected_size) + OPC_HEADER_SIZE >
-      buffer_size) {
-    uint8_t *new_buffer = new uint8_t[expected_size + OPC_HEADER_SIZE];
-    memcpy(new_buffer, data, offset);
-    delete[] data;
-    data = new_buffer;
-    buffer_size = expected_size + OPC_HEADER_SIZE;
+void OPCServer::RxState::Reserve(unsigned int size) {
+  if (size <= buffer_size) {
+    return;
   }
+  uint8_t *new_buffer = new uint8_t[size];
+  memcpy(new_buffer, data, offset);
+  delete[] data;
+  data = new_buffer;
+  buffer_size = size;
 }
 
 OPCServer::OPCServer(ola::io::SelectServerInterface *ss,
@@ -132,26 +132,44 @@ void OPCServer::SocketReady(TCPSocket *socket, RxState *rx_state) {
   }
 
   rx_state->offset += data_received;
-  if (rx_state->offset < OPC_HEADER_SIZE) {
-    return;
+  const unsigned int consumed = ProcessMessages(rx_state->data,
+                                                rx_state->offset);
+  if (consumed) {
+    // Move the start of the next message to the front of the buffer.
+    rx_state->offset -= consumed;
+    memmove(rx_state->data, rx_state->data + consumed, rx_state->offset);
   }
 
-  rx_state->CheckSize();
-  if (rx_state->offset <
-      static_cast<unsigned int>(rx_state->expected_size) + OPC_HEADER_SIZE) {
-    return;
+  if (rx_state->offset >= OPC_HEADER_SIZE) {
+    // Make sure the rest of a large message will fit.
+    rx_state->Reserve(
+        utils::JoinUInt8(rx_state->data[2], rx_state->data[3]) +
+        OPC_HEADER_SIZE);
   }
+}
 
-  ChannelCallback *cb = STLFindOrNull(m_callbacks, rx_state->data[0]);
-  if (cb) {
-    DmxBuffer buffer(rx_state->data + OPC_HEADER_SIZE,
-                     rx_state->offset - OPC_HEADER_SIZE);
-    cb->Run(rx_state->data[1],
-            rx_state->data + OPC_HEADER_SIZE,
-            rx_state->expected_size);
+/*
+ * Run the callbacks for each complete message in the buffer.
+ * @returns the number of bytes consumed.
+ */
+unsigned int OPCServer::ProcessMessages(const uint8_t *data,
+                                        unsigned int size) {
+  unsigned int offset = 0;
+  while (size - offset >= OPC_HEADER_SIZE) {
+    const uint8_t *message = data + offset;
+    const uint16_t message_size = utils::JoinUInt8(message[2], message[3]);
+    if (size - offset <
+        static_cast<unsigned int>(message_size) + OPC_HEADER_SIZE) {
+      break;
+    }
+
+    ChannelCallback *cb = STLFindOrNull(m_callbacks, message[0]);
+    if (cb) {
+      cb->Run(message[1], message + OPC_HEADER_SIZE, message_size);
+    }
+    offset += message_size + OPC_HEADER_SIZE;
   }
-  rx_state->offset = 0;
-  rx_state->expected_size = 0;
+  return offset;
 }
 
 void OPCServer::SocketClosed(TCPSocket *socket) {
@@ -39,7 +39,9 @@ namespace openpixelcontrol {
 /**
  * @brief An Open Pixel Control server.
  *
- * The server listens on a TCP port and receives OPC data.
+ * The server listens on a TCP port and receives OPC data. Clients may send
+ * a batch of messages in a single write, each read processes every complete
+ * message in the buffer.
  */
 class OPCServer {
  public:
@@ -88,14 +90,12 @@ class OPCServer {
   struct RxState {
    public:
     unsigned int offset;
-    uint16_t expected_size;
     uint8_t *data;
     unsigned int buffer_size;
 
     RxState()
         : offset(0),
-          expected_size(0) {
-      buffer_size = OPC_FRAME_SIZE,
+          buffer_size(RX_BUFFER_SIZE) {
       data = new uint8_t[buffer_size];
     }
 
@@ -103,7 +103,7 @@ class OPCServer {
       delete[] data;
     }
 
-    void CheckSize();
+    void Reserve(unsigned int size);
   };
 
   typedef std::map<ola::network::TCPSocket*, RxState*> ClientMap;
@@ -119,6 +119,11 @@ class OPCServer {
   void NewTCPConnection(ola::network::TCPSocket *socket);
   void SocketReady(ola::network::TCPSocket *socket, RxState *rx_state);
   void SocketClosed(ola::network::TCPSocket *socket);
+  unsigned int ProcessMessages(const uint8_t *data, unsigned int size);
+
+  // Enough for a number of full frames, so a single read can drain a batch of
+  // messages from a client.
+  static const unsigned int RX_BUFFER_SIZE = 8 * OPC_FRAME_SIZE;
 
   DISALLOW_COPY_AND_ASSIGN(OPCServer);
 };
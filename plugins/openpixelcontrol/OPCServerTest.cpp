@@ -47,6 +47,7 @@ class OPCServerTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testUnknownCommand);
   CPPUNIT_TEST(testLargeFrame);
   CPPUNIT_TEST(testHangingFrame);
+  CPPUNIT_TEST(testBatchedFrames);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -60,12 +61,14 @@ class OPCServerTest: public CppUnit::TestFixture {
   void testUnknownCommand();
   void testLargeFrame();
   void testHangingFrame();
+  void testBatchedFrames();
 
  private:
   ola::io::SelectServer m_ss;
   auto_ptr<OPCServer> m_server;
   auto_ptr<TCPSocket> m_client_socket;
   DmxBuffer m_received_data;
+  DmxBuffer m_other_data;
   uint8_t m_command;
 
   void SendDataAndCheck(uint8_t channel,
@@ -77,7 +80,12 @@ class OPCServerTest: public CppUnit::TestFixture {
     m_ss.Terminate();
   }
 
+  void CaptureOtherData(uint8_t, const uint8_t *data, unsigned int length) {
+    m_other_data.Set(data, length);
+  }
+
   static const uint8_t CHANNEL = 1;
+  static const uint8_t OTHER_CHANNEL = 2;
   static const uint8_t SET_PIXELS_COMMAND = 0;
 };
 
@@ -151,3 +159,34 @@ void OPCServerTest::testHangingFrame() {
   uint8_t data[] = {1, 0};
   m_client_socket->Send(data, arraysize(data));
 }
+
+/*
+ * Check all the messages in a single write are processed.
+ */
+void OPCServerTest::testBatchedFrames() {
+  m_server->SetCallback(
+      OTHER_CHANNEL,
+      ola::NewCallback(this, &OPCServerTest::CaptureOtherData));
+
+  // Two complete messages, followed by the start of a third.
+  uint8_t data[] = {
+    2, 0, 0, 3, 7, 8, 9,
+    1, 0, 0, 2, 3, 4,
+    1, 0, 0, 2, 5
+  };
+  m_client_socket->Send(data, arraysize(data));
+  m_ss.Run();
+
+  DmxBuffer buffer;
+  buffer.SetFromString("7,8,9");
+  OLA_ASSERT_EQ(m_other_data, buffer);
+  buffer.SetFromString("3,4");
+  OLA_ASSERT_EQ(m_received_data, buffer);
+
+  // Now complete the third message.
+  uint8_t remainder[] = {6};
+  m_client_socket->Send(remainder, arraysize(remainder));
+  m_ss.Run();
+  buffer.SetFromString("5,6");
+  OLA_ASSERT_EQ(m_received_data, buffer);
+}
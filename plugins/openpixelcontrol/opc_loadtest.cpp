@@ -0,0 +1,164 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * opc_loadtest.cpp
+ * Measure the throughput of the OPC client & server over the loopback
+ * interface.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#include <stdint.h>
+
+#include <iostream>
+
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/Logging.h"
+#include "ola/base/Flags.h"
+#include "ola/base/Init.h"
+#include "ola/io/SelectServer.h"
+#include "ola/network/IPV4Address.h"
+#include "ola/network/SocketAddress.h"
+#include "plugins/openpixelcontrol/OPCClient.h"
+#include "plugins/openpixelcontrol/OPCServer.h"
+
+using ola::Clock;
+using ola::DmxBuffer;
+using ola::TimeStamp;
+using ola::io::SelectServer;
+using ola::network::IPV4Address;
+using ola::network::IPV4SocketAddress;
+using ola::plugin::openpixelcontrol::OPCClient;
+using ola::plugin::openpixelcontrol::OPCServer;
+using std::cout;
+using std::endl;
+
+DEFINE_s_uint8(channels, c, 16, "The number of OPC channels to send");
+DEFINE_s_uint32(frames, f, 10000, "The number of frames per channel");
+DEFINE_s_uint16(slots, s, ola::DMX_UNIVERSE_SIZE,
+                "The number of slots in each frame");
+
+/**
+ * Sends a frame on every channel, then waits for the server to receive them
+ * all before sending the next set.
+ */
+class LoadTester {
+ public:
+  LoadTester(SelectServer *ss, OPCClient *client, uint8_t channels,
+             unsigned int frames, uint16_t slots)
+      : m_ss(ss),
+        m_client(client),
+        m_channels(channels),
+        m_frames(frames),
+        m_frames_sent(0),
+        m_messages_received(0),
+        m_bytes_received(0) {
+    uint8_t data[ola::DMX_UNIVERSE_SIZE];
+    for (unsigned int i = 0; i < slots; i++) {
+      data[i] = i;
+    }
+    m_buffer.Set(data, slots);
+  }
+
+  void SocketEvent(bool connected) {
+    if (!connected) {
+      OLA_WARN << "Connection to the server closed";
+      m_ss->Terminate();
+      return;
+    }
+    m_clock.CurrentTime(&m_start);
+    SendFrames();
+  }
+
+  void Receive(uint8_t, const uint8_t*, unsigned int length) {
+    m_messages_received++;
+    m_bytes_received += length;
+    if (m_messages_received % m_channels) {
+      return;
+    }
+
+    if (m_frames_sent == m_frames) {
+      m_clock.CurrentTime(&m_end);
+      m_ss->Terminate();
+    } else {
+      SendFrames();
+    }
+  }
+
+  void PrintStats() const {
+    const int64_t duration = (m_end - m_start).AsInt();
+    cout << "Received " << m_messages_received << " messages ("
+         << m_bytes_received << " bytes) in " << (m_end - m_start) << endl;
+    cout << "Dropped " << m_client->DroppedFrames() << " frames" << endl;
+    if (duration > 0) {
+      cout << "Throughput " << m_messages_received * 1000000 / duration
+           << " messages/s, " << m_frames_sent * 1000000 / duration
+           << " frames/s per channel" << endl;
+    }
+  }
+
+ private:
+  SelectServer *m_ss;
+  OPCClient *m_client;
+  const uint8_t m_channels;
+  const uint64_t m_frames;
+  uint64_t m_frames_sent;
+  uint64_t m_messages_received;
+  uint64_t m_bytes_received;
+  DmxBuffer m_buffer;
+  Clock m_clock;
+  TimeStamp m_start, m_end;
+
+  void SendFrames() {
+    for (unsigned int channel = 0; channel < m_channels; channel++) {
+      m_client->SendDmx(channel, m_buffer);
+    }
+    m_frames_sent++;
+  }
+};
+
+
+int main(int argc, char* argv[]) {
+  ola::AppInit(&argc, argv, "[options]",
+               "Measure the throughput of the OPC client & server.");
+
+  if (FLAGS_channels == 0 || FLAGS_frames == 0 ||
+      FLAGS_slots > ola::DMX_UNIVERSE_SIZE) {
+    ola::DisplayUsageAndExit();
+  }
+
+  SelectServer ss;
+  OPCServer server(&ss, IPV4SocketAddress(IPV4Address::Loopback(), 0));
+  if (!server.Init()) {
+    return -1;
+  }
+
+  OPCClient client(&ss, server.ListenAddress());
+  LoadTester tester(&ss, &client, FLAGS_channels, FLAGS_frames, FLAGS_slots);
+  for (unsigned int channel = 0; channel < FLAGS_channels; channel++) {
+    server.SetCallback(channel,
+                       ola::NewCallback(&tester, &LoadTester::Receive));
+  }
+  client.SetSocketCallback(
+      ola::NewCallback(&tester, &LoadTester::SocketEvent));
+
+  cout << "Sending " << FLAGS_frames << " frames on "
+       << static_cast<int>(FLAGS_channels) << " channels" << endl;
+  ss.Run();
+  tester.PrintStats();
+  return 0;
+}
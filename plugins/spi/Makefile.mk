@@ -4,12 +4,16 @@ if USE_SPI
 # This is a library which isn't coupled to olad
 lib_LTLIBRARIES += plugins/spi/libolaspicore.la plugins/spi/libolaspi.la
 plugins_spi_libolaspicore_la_SOURCES = \
+    plugins/spi/PixelConverter.cpp \
+    plugins/spi/PixelConverter.h \
     plugins/spi/SPIBackend.cpp \
     plugins/spi/SPIBackend.h \
     plugins/spi/SPIOutput.cpp \
     plugins/spi/SPIOutput.h \
     plugins/spi/SPIWriter.cpp \
-    plugins/spi/SPIWriter.h
+    plugins/spi/SPIWriter.h \
+    plugins/spi/TripleBuffer.cpp \
+    plugins/spi/TripleBuffer.h
 plugins_spi_libolaspicore_la_LIBADD = common/libolacommon.la
 
 plugins_spi_libolaspi_la_SOURCES = \
@@ -24,13 +28,26 @@ plugins_spi_libolaspi_la_LIBADD = \
     olad/plugin_api/libolaserverplugininterface.la \
     plugins/spi/libolaspicore.la
 
+# PROGRAMS
+##################################################
+noinst_PROGRAMS += plugins/spi/pixel_converter_loadtest
+
+plugins_spi_pixel_converter_loadtest_SOURCES = \
+    plugins/spi/pixel_converter_loadtest.cpp
+plugins_spi_pixel_converter_loadtest_LDADD = \
+    common/libolacommon.la \
+    plugins/spi/libolaspicore.la
+
 # TESTS
 ##################################################
 test_programs += plugins/spi/SPITester
 
 plugins_spi_SPITester_SOURCES = \
+    plugins/spi/PixelConverterTest.cpp \
     plugins/spi/SPIBackendTest.cpp \
     plugins/spi/SPIOutputTest.cpp \
+    plugins/spi/SPIWriterTest.cpp \
+    plugins/spi/TripleBufferTest.cpp \
     plugins/spi/FakeSPIWriter.cpp \
     plugins/spi/FakeSPIWriter.h
 plugins_spi_SPITester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
@@ -0,0 +1,178 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * PixelConverter.cpp
+ * Convert RGB DMX data to the format used by the various pixel chips.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include "plugins/spi/PixelConverter.h"
+
+namespace ola {
+namespace plugin {
+namespace spi {
+
+PixelConverter::PixelConverter(Chip chip, uint8_t brightness, float gamma)
+    : m_chip(chip) {
+  switch (m_chip) {
+    case LPD8806:
+      // GRB
+      m_bytes_per_pixel = 3;
+      m_offsets[RED] = 1;
+      m_offsets[GREEN] = 0;
+      m_offsets[BLUE] = 2;
+      break;
+    case P9813:
+    case APA102:
+      // A header byte followed by BGR
+      m_bytes_per_pixel = 4;
+      m_offsets[RED] = 3;
+      m_offsets[GREEN] = 2;
+      m_offsets[BLUE] = 1;
+      break;
+    case WS2801:
+    default:
+      m_bytes_per_pixel = 3;
+      m_offsets[RED] = 0;
+      m_offsets[GREEN] = 1;
+      m_offsets[BLUE] = 2;
+  }
+
+  for (unsigned int i = 0; i < sizeof(m_table); i++) {
+    double value = i / 255.0;
+    if (gamma != 1.0) {
+      value = pow(value, static_cast<double>(gamma));
+    }
+    uint8_t output = static_cast<uint8_t>(value * brightness + 0.5);
+    if (m_chip == LPD8806) {
+      // The LPD8806 uses 7 bit values, with the high bit set.
+      output = LPD8806_PIXEL_FLAG | (output >> 1);
+    }
+    m_table[i] = output;
+  }
+}
+
+void PixelConverter::Convert(const uint8_t *rgb, unsigned int slot_count,
+                             uint8_t *output, unsigned int pixel_count) const {
+  const unsigned int pixels = std::min(slot_count / SLOTS_PER_PIXEL,
+                                       pixel_count);
+  ConvertPixels(rgb, output, pixels);
+  if (pixels == pixel_count) {
+    return;
+  }
+
+  rgb += pixels * SLOTS_PER_PIXEL;
+  output += pixels * m_bytes_per_pixel;
+  switch (m_chip) {
+    case WS2801:
+      for (unsigned int i = 0; i < slot_count % SLOTS_PER_PIXEL; i++) {
+        output[m_offsets[i]] = m_table[rgb[i]];
+      }
+      break;
+    case P9813:
+      for (unsigned int i = pixels; i < pixel_count; i++) {
+        const uint8_t black[SLOTS_PER_PIXEL] = {0, 0, 0};
+        ConvertPixel(black, output);
+        output += m_bytes_per_pixel;
+      }
+      break;
+    case APA102:
+      for (unsigned int i = pixels; i < pixel_count; i++) {
+        output[0] = APA102_PIXEL_HEADER;
+        output += m_bytes_per_pixel;
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+void PixelConverter::Fill(const uint8_t *rgb, uint8_t *output,
+                          unsigned int pixel_count) const {
+  if (!pixel_count) {
+    return;
+  }
+
+  ConvertPixel(rgb, output);
+  for (unsigned int i = 1; i < pixel_count; i++) {
+    memcpy(output + i * m_bytes_per_pixel, output, m_bytes_per_pixel);
+  }
+}
+
+void PixelConverter::ConvertPixel(const uint8_t *rgb, uint8_t *output) const {
+  ConvertPixels(rgb, output, 1);
+}
+
+/*
+ * The main conversion loop. The switch is outside the loop so that each
+ * inner loop is just table lookups & stores.
+ */
+void PixelConverter::ConvertPixels(const uint8_t *rgb, uint8_t *output,
+                                   unsigned int pixel_count) const {
+  const unsigned int red_offset = m_offsets[RED];
+  const unsigned int green_offset = m_offsets[GREEN];
+  const unsigned int blue_offset = m_offsets[BLUE];
+  const unsigned int step = m_bytes_per_pixel;
+  const uint8_t *end = rgb + pixel_count * SLOTS_PER_PIXEL;
+
+  switch (m_chip) {
+    case P9813:
+      for (; rgb != end; rgb += SLOTS_PER_PIXEL, output += step) {
+        const uint8_t red = m_table[rgb[RED]];
+        const uint8_t green = m_table[rgb[GREEN]];
+        const uint8_t blue = m_table[rgb[BLUE]];
+        output[0] = P9813Flag(red, green, blue);
+        output[red_offset] = red;
+        output[green_offset] = green;
+        output[blue_offset] = blue;
+      }
+      break;
+    case APA102:
+      for (; rgb != end; rgb += SLOTS_PER_PIXEL, output += step) {
+        // 3 bits start mark (111) + 5 bits global brightness, we fix the
+        // global brightness at 31 since that reduces flickering.
+        output[0] = APA102_PIXEL_HEADER;
+        output[red_offset] = m_table[rgb[RED]];
+        output[green_offset] = m_table[rgb[GREEN]];
+        output[blue_offset] = m_table[rgb[BLUE]];
+      }
+      break;
+    default:
+      for (; rgb != end; rgb += SLOTS_PER_PIXEL, output += step) {
+        output[red_offset] = m_table[rgb[RED]];
+        output[green_offset] = m_table[rgb[GREEN]];
+        output[blue_offset] = m_table[rgb[BLUE]];
+      }
+  }
+}
+
+/**
+ * The P9813 flag byte is the inverse of the top two bits of each colour.
+ * For more information please visit:
+ * https://github.com/CoolNeon/elinux-tcl/blob/master/README.txt
+ */
+uint8_t PixelConverter::P9813Flag(uint8_t red, uint8_t green, uint8_t blue) {
+  uint8_t flag = 0;
+  flag =  (red & 0xc0) >> 6;
+  flag |= (green & 0xc0) >> 4;
+  flag |= (blue & 0xc0) >> 2;
+  return ~flag;
+}
+}  // namespace spi
+}  // namespace plugin
+}  // namespace ola
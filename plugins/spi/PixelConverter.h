@@ -0,0 +1,121 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * PixelConverter.h
+ * Convert RGB DMX data to the format used by the various pixel chips.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#ifndef PLUGINS_SPI_PIXELCONVERTER_H_
+#define PLUGINS_SPI_PIXELCONVERTER_H_
+
+#include <stdint.h>
+#include "ola/base/Macro.h"
+
+namespace ola {
+namespace plugin {
+namespace spi {
+
+/**
+ * Converts RGB data to the on-the-wire format of a pixel chip.
+ *
+ * Brightness, gamma and any per-chip value encoding (e.g. the 7 bit values
+ * of the LPD8806) are folded into a single 256 entry lookup table, and the
+ * colour order is a table of byte offsets, so each pixel is converted in a
+ * single pass without any per-byte branches.
+ *
+ * The per-pixel framing (the P9813 checksum byte and the APA102 header byte)
+ * is added as part of the same pass. Start frames and latch bytes are left
+ * to the caller.
+ */
+class PixelConverter {
+ public:
+  enum Chip {
+    WS2801,
+    LPD8806,
+    P9813,
+    APA102
+  };
+
+  /**
+   * @brief Create a new PixelConverter.
+   * @param chip the type of chip to convert for.
+   * @param brightness the brightness to scale each colour by, 255 is full
+   *   brightness.
+   * @param gamma the gamma correction to apply, 1.0 means no correction.
+   */
+  explicit PixelConverter(Chip chip,
+                          uint8_t brightness = 255,
+                          float gamma = 1.0);
+
+  Chip GetChip() const { return m_chip; }
+
+  /**
+   * @brief The number of bytes each pixel uses on the SPI bus.
+   */
+  unsigned int BytesPerPixel() const { return m_bytes_per_pixel; }
+
+  /**
+   * @brief Convert RGB data.
+   * @param rgb the RGB data, 3 slots per pixel.
+   * @param slot_count the number of slots in rgb.
+   * @param output the buffer to write to, must be at least pixel_count *
+   *   BytesPerPixel() bytes.
+   * @param pixel_count the number of pixels in the output.
+   *
+   * If there is less data than pixels, the remaining pixels are left as they
+   * were, with the following exceptions: WS2801 pixels are updated with
+   * whatever partial data exists, P9813 pixels are set to black and APA102
+   * pixels have their header byte set.
+   */
+  void Convert(const uint8_t *rgb, unsigned int slot_count,
+               uint8_t *output, unsigned int pixel_count) const;
+
+  /**
+   * @brief Set every pixel to the same colour.
+   * @param rgb the RGB value, 3 bytes.
+   * @param output the buffer to write to, must be at least pixel_count *
+   *   BytesPerPixel() bytes.
+   * @param pixel_count the number of pixels in the output.
+   */
+  void Fill(const uint8_t *rgb, uint8_t *output,
+            unsigned int pixel_count) const;
+
+  static const unsigned int SLOTS_PER_PIXEL = 3;
+
+ private:
+  enum { RED, GREEN, BLUE };
+
+  const Chip m_chip;
+  unsigned int m_bytes_per_pixel;
+  // The offset of the red, green & blue bytes within each output pixel.
+  unsigned int m_offsets[SLOTS_PER_PIXEL];
+  uint8_t m_table[256];
+
+  void ConvertPixel(const uint8_t *rgb, uint8_t *output) const;
+  void ConvertPixels(const uint8_t *rgb, uint8_t *output,
+                     unsigned int pixel_count) const;
+
+  static uint8_t P9813Flag(uint8_t red, uint8_t green, uint8_t blue);
+
+  static const uint8_t APA102_PIXEL_HEADER = 0xff;
+  static const uint8_t LPD8806_PIXEL_FLAG = 0x80;
+
+  DISALLOW_COPY_AND_ASSIGN(PixelConverter);
+};
+}  // namespace spi
+}  // namespace plugin
+}  // namespace ola
+#endif  // PLUGINS_SPI_PIXELCONVERTER_H_
@@ -0,0 +1,180 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * PixelConverterTest.cpp
+ * Test fixture for the PixelConverter.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#include <string.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "ola/base/Array.h"
+#include "ola/testing/TestUtils.h"
+#include "plugins/spi/PixelConverter.h"
+
+using ola::plugin::spi::PixelConverter;
+
+class PixelConverterTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(PixelConverterTest);
+  CPPUNIT_TEST(testConvert);
+  CPPUNIT_TEST(testPartialData);
+  CPPUNIT_TEST(testFill);
+  CPPUNIT_TEST(testBrightnessAndGamma);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void testConvert();
+  void testPartialData();
+  void testFill();
+  void testBrightnessAndGamma();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PixelConverterTest);
+
+
+/*
+ * Check the wire format of each chip type.
+ */
+void PixelConverterTest::testConvert() {
+  const uint8_t RGB[] = {0xff, 0x40, 0x00, 0x10, 0x20, 0x30};
+  uint8_t output[8];
+
+  PixelConverter ws2801(PixelConverter::WS2801);
+  OLA_ASSERT_EQ(3u, ws2801.BytesPerPixel());
+  ws2801.Convert(RGB, arraysize(RGB), output, 2);
+  OLA_ASSERT_DATA_EQUALS(RGB, arraysize(RGB), output, 6);
+
+  PixelConverter lpd8806(PixelConverter::LPD8806);
+  OLA_ASSERT_EQ(3u, lpd8806.BytesPerPixel());
+  const uint8_t EXPECTED_LPD8806[] = {0xa0, 0xff, 0x80, 0x90, 0x88, 0x98};
+  lpd8806.Convert(RGB, arraysize(RGB), output, 2);
+  OLA_ASSERT_DATA_EQUALS(EXPECTED_LPD8806, arraysize(EXPECTED_LPD8806),
+                         output, 6);
+
+  PixelConverter p9813(PixelConverter::P9813);
+  OLA_ASSERT_EQ(4u, p9813.BytesPerPixel());
+  const uint8_t EXPECTED_P9813[] = {
+    0xf8, 0x00, 0x40, 0xff,
+    0xff, 0x30, 0x20, 0x10
+  };
+  p9813.Convert(RGB, arraysize(RGB), output, 2);
+  OLA_ASSERT_DATA_EQUALS(EXPECTED_P9813, arraysize(EXPECTED_P9813),
+                         output, 8);
+
+  PixelConverter apa102(PixelConverter::APA102);
+  OLA_ASSERT_EQ(4u, apa102.BytesPerPixel());
+  const uint8_t EXPECTED_APA102[] = {
+    0xff, 0x00, 0x40, 0xff,
+    0xff, 0x30, 0x20, 0x10
+  };
+  apa102.Convert(RGB, arraysize(RGB), output, 2);
+  OLA_ASSERT_DATA_EQUALS(EXPECTED_APA102, arraysize(EXPECTED_APA102),
+                         output, 8);
+}
+
+
+/*
+ * Check what happens when there is less data than pixels.
+ */
+void PixelConverterTest::testPartialData() {
+  const uint8_t RGB[] = {1, 2, 3, 4, 5};
+  uint8_t output[8];
+
+  // WS2801 uses the partial pixel
+  PixelConverter ws2801(PixelConverter::WS2801);
+  memset(output, 0xaa, sizeof(output));
+  ws2801.Convert(RGB, arraysize(RGB), output, 2);
+  const uint8_t EXPECTED_WS2801[] = {1, 2, 3, 4, 5, 0xaa};
+  OLA_ASSERT_DATA_EQUALS(EXPECTED_WS2801, arraysize(EXPECTED_WS2801),
+                         output, 6);
+
+  // LPD8806 leaves the remaining pixels alone
+  PixelConverter lpd8806(PixelConverter::LPD8806);
+  memset(output, 0xaa, sizeof(output));
+  lpd8806.Convert(RGB, arraysize(RGB), output, 2);
+  const uint8_t EXPECTED_LPD8806[] = {0x81, 0x80, 0x81, 0xaa, 0xaa, 0xaa};
+  OLA_ASSERT_DATA_EQUALS(EXPECTED_LPD8806, arraysize(EXPECTED_LPD8806),
+                         output, 6);
+
+  // P9813 sets the remaining pixels to black
+  PixelConverter p9813(PixelConverter::P9813);
+  memset(output, 0xaa, sizeof(output));
+  p9813.Convert(RGB, arraysize(RGB), output, 2);
+  const uint8_t EXPECTED_P9813[] = {0xff, 3, 2, 1, 0xff, 0, 0, 0};
+  OLA_ASSERT_DATA_EQUALS(EXPECTED_P9813, arraysize(EXPECTED_P9813),
+                         output, 8);
+
+  // APA102 only sets the header byte
+  PixelConverter apa102(PixelConverter::APA102);
+  memset(output, 0xaa, sizeof(output));
+  apa102.Convert(RGB, arraysize(RGB), output, 2);
+  const uint8_t EXPECTED_APA102[] = {0xff, 3, 2, 1, 0xff, 0xaa, 0xaa, 0xaa};
+  OLA_ASSERT_DATA_EQUALS(EXPECTED_APA102, arraysize(EXPECTED_APA102),
+                         output, 8);
+}
+
+
+/*
+ * Check that Fill() sets every pixel.
+ */
+void PixelConverterTest::testFill() {
+  const uint8_t RGB[] = {0x10, 0x20, 0x30};
+  uint8_t output[12];
+
+  PixelConverter apa102(PixelConverter::APA102);
+  apa102.Fill(RGB, output, 3);
+  const uint8_t EXPECTED[] = {
+    0xff, 0x30, 0x20, 0x10,
+    0xff, 0x30, 0x20, 0x10,
+    0xff, 0x30, 0x20, 0x10
+  };
+  OLA_ASSERT_DATA_EQUALS(EXPECTED, arraysize(EXPECTED), output,
+                         sizeof(output));
+
+  // Zero pixels is a no-op
+  memset(output, 0xaa, sizeof(output));
+  apa102.Fill(RGB, output, 0);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(0xaa), output[0]);
+}
+
+
+/*
+ * Check brightness & gamma are applied.
+ */
+void PixelConverterTest::testBrightnessAndGamma() {
+  const uint8_t RGB[] = {0, 100, 255, 128, 0, 0};
+  uint8_t output[6];
+
+  PixelConverter dimmed(PixelConverter::WS2801, 128);
+  dimmed.Convert(RGB, arraysize(RGB), output, 2);
+  const uint8_t EXPECTED_DIMMED[] = {0, 50, 128, 64, 0, 0};
+  OLA_ASSERT_DATA_EQUALS(EXPECTED_DIMMED, arraysize(EXPECTED_DIMMED),
+                         output, sizeof(output));
+
+  PixelConverter gamma(PixelConverter::WS2801, 255, 2.0);
+  gamma.Convert(RGB, arraysize(RGB), output, 2);
+  const uint8_t EXPECTED_GAMMA[] = {0, 39, 255, 64, 0, 0};
+  OLA_ASSERT_DATA_EQUALS(EXPECTED_GAMMA, arraysize(EXPECTED_GAMMA),
+                         output, sizeof(output));
+
+  // The LPD8806 encoding is applied after the correction.
+  PixelConverter lpd8806(PixelConverter::LPD8806, 128);
+  lpd8806.Convert(RGB, 3, output, 1);
+  const uint8_t EXPECTED_LPD8806[] = {0x99, 0x80, 0xc0};
+  OLA_ASSERT_DATA_EQUALS(EXPECTED_LPD8806, arraysize(EXPECTED_LPD8806),
+                         output, 3);
+}
+
@@ -26,6 +26,7 @@
 #include <string.h>
 #include <sys/ioctl.h>
 
+#include <algorithm>
 #include <numeric>
 #include <sstream>
 #include <string>
@@ -35,6 +36,7 @@
 #include "ola/io/IOUtils.h"
 #include "ola/network/SocketCloser.h"
 #include "ola/stl/STLUtils.h"
+#include "ola/thread/Utils.h"
 #include "plugins/spi/SPIBackend.h"
 
 namespace ola {
@@ -45,68 +47,80 @@ using ola::thread::MutexLocker;
 using std::string;
 using std::vector;
 
-const char SPIBackendInterface::SPI_DROP_VAR[] = "spi-drops";
-const char SPIBackendInterface::SPI_DROP_VAR_KEY[] = "device";
+const char SPIOutputStats::SPI_DROP_VAR[] = "spi-drops";
+const char SPIOutputStats::SPI_DROP_VAR_KEY[] = "device";
+const char SPIOutputStats::SPI_OUTPUT_DROP_VAR[] = "spi-output-drops";
+const char SPIOutputStats::SPI_WRITE_LATENCY_VAR[] = "spi-write-latency-us";
+const char SPIOutputStats::SPI_OUTPUT_VAR_KEY[] = "output";
 
-uint8_t *HardwareBackend::OutputData::Resize(unsigned int length) {
-  if (length < m_size) {
-    m_size = length;
-    return m_data;
-  } else if (length == m_size) {
-    return m_data;
+SPIOutputStats::SPIOutputStats(ExportMap *export_map,
+                               const string &device_path,
+                               uint8_t output_count)
+    : m_device_path(device_path),
+      m_drop_map(NULL),
+      m_output_drop_map(NULL),
+      m_latency_map(NULL),
+      m_latency(output_count, 0) {
+  for (unsigned int i = 0; i < output_count; i++) {
+    std::ostringstream str;
+    str << device_path << ":" << i;
+    m_keys.push_back(str.str());
   }
 
-  if (length <= m_actual_size) {
-    m_size = length;
-    return m_data;
+  if (!export_map) {
+    return;
+  }
+  m_drop_map = export_map->GetUIntMapVar(SPI_DROP_VAR, SPI_DROP_VAR_KEY);
+  (*m_drop_map)[m_device_path] = 0;
+  m_output_drop_map = export_map->GetUIntMapVar(SPI_OUTPUT_DROP_VAR,
+                                                SPI_OUTPUT_VAR_KEY);
+  m_latency_map = export_map->GetUIntMapVar(SPI_WRITE_LATENCY_VAR,
+                                            SPI_OUTPUT_VAR_KEY);
+  vector<string>::const_iterator iter = m_keys.begin();
+  for (; iter != m_keys.end(); ++iter) {
+    (*m_output_drop_map)[*iter] = 0;
+    (*m_latency_map)[*iter] = 0;
   }
+}
 
-  delete[] m_data;
-  m_data = new uint8_t[length];
-  if (m_data) {
-    m_size = m_data ? length : 0;
-    m_actual_size = m_size;
-    memset(m_data, 0, length);
+void SPIOutputStats::FrameDropped() {
+  if (m_drop_map) {
+    (*m_drop_map)[m_device_path]++;
   }
-  return m_data;
 }
 
-void HardwareBackend::OutputData::SetPending() {
-  m_write_pending = true;
+void SPIOutputStats::OutputDropped(uint8_t output) {
+  if (m_output_drop_map && output < m_keys.size()) {
+    (*m_output_drop_map)[m_keys[output]]++;
+  }
 }
 
-void HardwareBackend::OutputData::SetLatchBytes(unsigned int latch_bytes) {
-  m_latch_bytes = latch_bytes;
+void SPIOutputStats::RecordWrite(uint8_t output,
+                                 const TimeInterval &latency) {
+  if (output < m_latency.size()) {
+    __sync_lock_test_and_set(&m_latency[output],
+                             static_cast<uint32_t>(latency.AsInt()));
+  }
 }
 
-HardwareBackend::OutputData& HardwareBackend::OutputData::operator=(
-    const HardwareBackend::OutputData &other) {
-  if (this != &other) {
-    uint8_t *data = Resize(other.m_size + other.m_latch_bytes);
-    if (data) {
-      memcpy(data, other.m_data, other.m_size);
-      memset(data + other.m_size, 0, other.m_latch_bytes);
-      m_write_pending = true;
-    } else {
-      m_write_pending = false;
-    }
+void SPIOutputStats::Update(uint8_t output) {
+  if (m_latency_map && output < m_keys.size()) {
+    (*m_latency_map)[m_keys[output]] = __sync_fetch_and_add(
+        &m_latency[output], 0);
   }
-  return *this;
 }
 
 HardwareBackend::HardwareBackend(const Options &options,
                                  SPIWriterInterface *writer,
                                  ExportMap *export_map)
-    : m_spi_writer(writer),
-      m_drop_map(NULL),
+    : Thread(ola::thread::OutputThreadOptions("spi-hardware")),
+      m_spi_writer(writer),
       m_output_count(1 << options.gpio_pins.size()),
+      m_stats(export_map, writer->DevicePath(), m_output_count),
       m_exit(false),
       m_gpio_pins(options.gpio_pins) {
-  SetupOutputs(&m_output_data);
-  if (export_map) {
-    m_drop_map = export_map->GetUIntMapVar(SPI_DROP_VAR,
-                                           SPI_DROP_VAR_KEY);
-    (*m_drop_map)[m_spi_writer->DevicePath()] = 0;
+  for (unsigned int i = 0; i < m_output_count; i++) {
+    m_output_data.push_back(new TripleBuffer());
   }
 }
 
@@ -143,14 +157,8 @@ uint8_t *HardwareBackend::Checkout(uint8_t output_id,
     return NULL;
   }
 
-  m_mutex.Lock();
-  uint8_t *output = m_output_data[output_id]->Resize(length);
-  if (!output) {
-    m_mutex.Unlock();
-  }
-  m_output_data[output_id]->SetLatchBytes(latch_bytes);
-  // We return with the Mutex locked, the caller must then call Commit()
-  // coverity[LOCK]
+  uint8_t *output = m_output_data[output_id]->Resize(length + latch_bytes);
+  memset(output + length, 0, latch_bytes);
   return output;
 }
 
@@ -159,77 +167,64 @@ void HardwareBackend::Commit(uint8_t output) {
     return;
   }
 
-  OutputData *output_data = m_output_data[output];
-  if (output_data->IsPending() && m_drop_map) {
-    // There was already another write pending which we're now stomping on
-    (*m_drop_map)[m_spi_writer->DevicePath()]++;
+  TimeStamp now;
+  m_clock.CurrentTime(&now);
+  if (m_output_data[output]->Publish(now)) {
+    // There was already another write pending which we've now replaced.
+    m_stats.FrameDropped();
+    m_stats.OutputDropped(output);
+  }
+  m_stats.Update(output);
+
+  // Taking the lock ensures the writer thread is either waiting or yet to
+  // check for new frames.
+  {
+    MutexLocker lock(&m_mutex);
   }
-  output_data->SetPending();
-  m_mutex.Unlock();
   m_cond_var.Signal();
 }
 
 void *HardwareBackend::Run() {
-  Outputs outputs;
-  SetupOutputs(&outputs);
-
   while (true) {
-    m_mutex.Lock();
-
-    if (m_exit) {
-      m_mutex.Unlock();
-      STLDeleteElements(&outputs);
-      return NULL;
-    }
-
-    bool action_pending = false;
-    Outputs::const_iterator iter = m_output_data.begin();
-    for (; iter != m_output_data.end(); ++iter) {
-      if ((*iter)->IsPending()) {
-        action_pending = true;
-        break;
+    {
+      MutexLocker lock(&m_mutex);
+      while (!m_exit && !HasNewFrame()) {
+        m_cond_var.Wait(&m_mutex);
       }
-    }
-    if (!action_pending) {
-      m_cond_var.Wait(&m_mutex);
-    }
-
-    if (m_exit) {
-      m_mutex.Unlock();
-      STLDeleteElements(&outputs);
-      return NULL;
-    }
-
-    for (unsigned int i = 0; i < m_output_data.size(); i++) {
-      if (m_output_data[i]->IsPending()) {
-        // take a copy
-        *outputs[i] = *m_output_data[i];
-        m_output_data[i]->ResetPending();
+      if (m_exit) {
+        return NULL;
       }
     }
-    m_mutex.Unlock();
 
-    for (unsigned int i = 0; i < outputs.size(); i++) {
-      if (outputs[i]->IsPending()) {
-        WriteOutput(i, outputs[i]);
-        outputs[i]->ResetPending();
+    for (unsigned int i = 0; i < m_output_data.size(); i++) {
+      TripleBuffer *output = m_output_data[i];
+      if (output->Acquire()) {
+        WriteOutput(i, *output);
+        TimeStamp now;
+        m_clock.CurrentTime(&now);
+        m_stats.RecordWrite(i, now - output->FrontPublishTime());
       }
     }
   }
 }
 
-void HardwareBackend::SetupOutputs(Outputs *outputs) {
-  for (unsigned int i = 0; i < m_output_count; i++) {
-    outputs->push_back(new OutputData());
+bool HardwareBackend::HasNewFrame() const {
+  Outputs::const_iterator iter = m_output_data.begin();
+  for (; iter != m_output_data.end(); ++iter) {
+    if ((*iter)->HasNewFrame()) {
+      return true;
+    }
   }
+  return false;
 }
 
-void HardwareBackend::WriteOutput(uint8_t output_id, OutputData *output) {
+void HardwareBackend::WriteOutput(uint8_t output_id,
+                                  const TripleBuffer &output) {
   const string on("1");
   const string off("0");
 
   for (unsigned int i = 0; i < m_gpio_fds.size(); i++) {
-    uint8_t pin = output_id & (1 << i);
+    const bool pin = output_id & (1 << i);
 
     if (i >= m_gpio_pin_state.size()) {
       m_gpio_pin_state.push_back(!pin);
@@ -247,7 +242,7 @@ void HardwareBackend::WriteOutput(uint8_t output_id, OutputData *output) {
     }
   }
 
-  m_spi_writer->WriteSPIData(output->GetData(), output->Size());
+  m_spi_writer->WriteSPIData(output.Front(), output.FrontSize());
 }
 
 bool HardwareBackend::SetupGPIO() {
@@ -303,20 +298,15 @@ void HardwareBackend::CloseGPIOFDs() {
 SoftwareBackend::SoftwareBackend(const Options &options,
                                  SPIWriterInterface *writer,
                                  ExportMap *export_map)
-    : m_spi_writer(writer),
-      m_drop_map(NULL),
-      m_write_pending(false),
+    : Thread(ola::thread::OutputThreadOptions("spi-software")),
+      m_spi_writer(writer),
+      m_stats(export_map, writer->DevicePath(), options.outputs),
       m_exit(false),
       m_sync_output(options.sync_output),
       m_output_sizes(options.outputs, 0),
       m_latch_bytes(options.outputs, 0),
-      m_output(NULL),
-      m_length(0) {
-  if (export_map) {
-    m_drop_map = export_map->GetUIntMapVar(SPI_DROP_VAR,
-                                           SPI_DROP_VAR_KEY);
-    (*m_drop_map)[m_spi_writer->DevicePath()] = 0;
-  }
+      m_committed(options.outputs, false),
+      m_published(options.outputs, false) {
 }
 
 SoftwareBackend::~SoftwareBackend() {
@@ -327,8 +317,6 @@ SoftwareBackend::~SoftwareBackend() {
 
   m_cond_var.Signal();
   Join();
-
-  delete[] m_output;
 }
 
 bool SoftwareBackend::Init() {
@@ -350,8 +338,6 @@ uint8_t *SoftwareBackend::Checkout(uint8_t output,
     return NULL;
   }
 
-  m_mutex.Lock();
-
   unsigned int leading = 0;
   unsigned int trailing = 0;
   for (uint8_t i = 0; i < m_output_sizes.size(); i++) {
@@ -369,19 +355,18 @@ uint8_t *SoftwareBackend::Checkout(uint8_t output,
       leading + length + trailing + total_latch_bytes);
 
   // Check if the current buffer is large enough to hold our data.
-  if (required_size != m_length) {
-    // The length changed
-    uint8_t *new_output = new uint8_t[required_size];
-    memcpy(new_output, m_output, leading);
-    memset(new_output + leading, 0, length);
-    memcpy(new_output + leading + length, m_output + leading, trailing);
-    memset(new_output + leading + length + trailing, 0, total_latch_bytes);
-    delete[] m_output;
-    m_output = new_output;
-    m_length = required_size;
+  if (required_size != m_buffer.BackSize()) {
+    // The length changed, move the trailing outputs & clear ours.
+    const unsigned int old_length = m_output_sizes[output];
+    uint8_t *data = m_buffer.Resize(
+        std::max(required_size, m_buffer.BackSize()));
+    memmove(data + leading + length, data + leading + old_length, trailing);
+    memset(data + leading, 0, length);
+    data = m_buffer.Resize(required_size);
+    memset(data + leading + length + trailing, 0, total_latch_bytes);
     m_output_sizes[output] = length;
   }
-  return m_output + leading;
+  return m_buffer.Back() + leading;
 }
 
 void SoftwareBackend::Commit(uint8_t output) {
@@ -390,59 +375,58 @@ void SoftwareBackend::Commit(uint8_t output) {
     return;
   }
 
+  m_committed[output] = true;
   bool should_write = m_sync_output < 0 || output == m_sync_output;
-  if (should_write) {
-    if (m_write_pending && m_drop_map) {
-      // There was already another write pending which we're now stomping on
-      (*m_drop_map)[m_spi_writer->DevicePath()]++;
+  if (!should_write) {
+    return;
+  }
+
+  TimeStamp now;
+  m_clock.CurrentTime(&now);
+  if (m_buffer.Publish(now)) {
+    // There was already another write pending which we've now replaced.
+    m_stats.FrameDropped();
+    for (uint8_t i = 0; i < m_published.size(); i++) {
+      if (m_published[i]) {
+        m_stats.OutputDropped(i);
+      }
     }
-    m_write_pending = should_write;
   }
-  m_mutex.Unlock();
-  if (should_write) {
-    m_cond_var.Signal();
+  m_published.swap(m_committed);
+  std::fill(m_committed.begin(), m_committed.end(), false);
+  for (uint8_t i = 0; i < m_published.size(); i++) {
+    m_stats.Update(i);
+  }
+
+  // Taking the lock ensures the writer thread is either waiting or yet to
+  // check for new frames.
+  {
+    MutexLocker lock(&m_mutex);
   }
+  m_cond_var.Signal();
 }
 
 void *SoftwareBackend::Run() {
-  uint8_t *output_data = NULL;
-  unsigned int length = 0;
-
   while (true) {
-    m_mutex.Lock();
-
-    if (m_exit) {
-      m_mutex.Unlock();
-      delete output_data;
-      return NULL;
-    }
-
-    if (!m_write_pending) {
-      m_cond_var.Wait(&m_mutex);
-    }
-
-    if (m_exit) {
-      m_mutex.Unlock();
-      delete[] output_data;
-      return NULL;
-    }
-
-    bool write_pending = m_write_pending;
-    m_write_pending = false;
-    if (write_pending) {
-      if (length < m_length) {
-        delete[] output_data;
-        output_data = new uint8_t[m_length];
-        length = m_length;
+    {
+      MutexLocker lock(&m_mutex);
+      while (!m_exit && !m_buffer.HasNewFrame()) {
+        m_cond_var.Wait(&m_mutex);
+      }
+      if (m_exit) {
+        return NULL;
       }
-      // TODO(simon) Add an actual size here
-      length = m_length;
-      memcpy(output_data, m_output, m_length);
     }
-    m_mutex.Unlock();
 
-    if (write_pending) {
-      m_spi_writer->WriteSPIData(output_data, length);
+    if (m_buffer.Acquire()) {
+      m_spi_writer->WriteSPIData(m_buffer.Front(), m_buffer.FrontSize());
+      TimeStamp now;
+      m_clock.CurrentTime(&now);
+      // All outputs are sent in the same transfer.
+      const TimeInterval latency = now - m_buffer.FrontPublishTime();
+      for (uint8_t i = 0; i < m_output_sizes.size(); i++) {
+        m_stats.RecordWrite(i, latency);
+      }
     }
   }
 }
@@ -28,7 +28,11 @@
 #include <string>
 #include <vector>
 
+#include "ola/Clock.h"
+#include "ola/ExportMap.h"
+#include "ola/base/Macro.h"
 #include "plugins/spi/SPIWriter.h"
+#include "plugins/spi/TripleBuffer.h"
 
 namespace ola {
 namespace plugin {
@@ -50,15 +54,67 @@ class SPIBackendInterface {
   virtual std::string DevicePath() const = 0;
 
   virtual bool Init() = 0;
+};
+
+
+/**
+ * The drop counts and write latency for each output of a backend.
+ *
+ * The writer thread records the latency with RecordWrite(), the exported
+ * variables are then updated from the olad thread by Update(), so the writer
+ * thread never touches the ExportMap.
+ */
+class SPIOutputStats {
+ public:
+  SPIOutputStats(ExportMap *export_map, const std::string &device_path,
+                 uint8_t output_count);
+
+  /**
+   * @brief Record that a frame was replaced before it was written.
+   */
+  void FrameDropped();
+
+  /**
+   * @brief Record that the data for an output was never written.
+   */
+  void OutputDropped(uint8_t output);
+
+  /**
+   * @brief Record a write. This can be called from any thread.
+   * @param output the output that was written.
+   * @param latency the time between the Commit() and the write completing.
+   */
+  void RecordWrite(uint8_t output, const TimeInterval &latency);
+
+  /**
+   * @brief Update the exported write latency for an output.
+   */
+  void Update(uint8_t output);
 
- protected:
   static const char SPI_DROP_VAR[];
   static const char SPI_DROP_VAR_KEY[];
+  static const char SPI_OUTPUT_DROP_VAR[];
+  static const char SPI_WRITE_LATENCY_VAR[];
+  static const char SPI_OUTPUT_VAR_KEY[];
+
+ private:
+  const std::string m_device_path;
+  UIntMap *m_drop_map;
+  UIntMap *m_output_drop_map;
+  UIntMap *m_latency_map;
+  std::vector<std::string> m_keys;
+  // Written by the writer thread, in microseconds.
+  std::vector<uint32_t> m_latency;
+
+  DISALLOW_COPY_AND_ASSIGN(SPIOutputStats);
 };
 
 
 /**
- * A HardwareBackend which uses GPIO pins and an external de-multiplexer
+ * A HardwareBackend which uses GPIO pins and an external de-multiplexer.
+ *
+ * Each output is triple buffered, so Checkout() & Commit() never wait for
+ * the writer thread.
  */
 class HardwareBackend : public ola::thread::Thread,
                         public SPIBackendInterface {
@@ -91,47 +147,17 @@ class HardwareBackend : public ola::thread::Thread,
   void* Run();
 
  private:
-  class OutputData {
-   public:
-    OutputData()
-        : m_data(NULL),
-          m_write_pending(false),
-          m_size(0),
-          m_actual_size(0),
-          m_latch_bytes(0) {
-    }
-
-    ~OutputData() { delete[] m_data; }
-
-    uint8_t *Resize(unsigned int length);
-    void SetLatchBytes(unsigned int latch_bytes);
-    void SetPending();
-    bool IsPending() const { return m_write_pending; }
-    void ResetPending() { m_write_pending = false; }
-    const uint8_t *GetData() const { return m_data; }
-    unsigned int Size() const { return m_size; }
-
-    OutputData& operator=(const OutputData &other);
-
-   private:
-    uint8_t *m_data;
-    bool m_write_pending;
-    unsigned int m_size;
-    unsigned int m_actual_size;
-    unsigned int m_latch_bytes;
-
-    OutputData(const OutputData&);
-  };
-
   typedef std::vector<int> GPIOFds;
-  typedef std::vector<OutputData*> Outputs;
+  typedef std::vector<TripleBuffer*> Outputs;
 
   SPIWriterInterface *m_spi_writer;
-  UIntMap *m_drop_map;
   const uint8_t m_output_count;
+  SPIOutputStats m_stats;
+  ola::Clock m_clock;
+  // Only used to wake the writer thread.
   ola::thread::Mutex m_mutex;
   ola::thread::ConditionVariable m_cond_var;
-  bool m_exit;
+  bool m_exit;  // GUARDED_BY(m_mutex)
 
   Outputs m_output_data;
 
@@ -140,8 +166,8 @@ class HardwareBackend : public ola::thread::Thread,
   const std::vector<uint8_t> m_gpio_pins;
   std::vector<bool> m_gpio_pin_state;
 
-  void SetupOutputs(Outputs *outputs);
-  void WriteOutput(uint8_t output_id, OutputData *output);
+  bool HasNewFrame() const;
+  void WriteOutput(uint8_t output_id, const TripleBuffer &output);
   bool SetupGPIO();
   void CloseGPIOFDs();
 };
@@ -149,7 +175,8 @@ class HardwareBackend : public ola::thread::Thread,
 
 /**
  * An SPI Backend which uses a software multipliexer. This accumulates all data
- * into a single buffer and then writes it to the SPI bus.
+ * into a single buffer and then writes it to the SPI bus. The buffer is
+ * triple buffered, so Checkout() & Commit() never wait for the writer thread.
  */
 class SoftwareBackend : public SPIBackendInterface,
                         public ola::thread::Thread {
@@ -192,17 +219,22 @@ class SoftwareBackend : public SPIBackendInterface,
 
  private:
   SPIWriterInterface *m_spi_writer;
-  UIntMap *m_drop_map;
+  SPIOutputStats m_stats;
+  ola::Clock m_clock;
+  // Only used to wake the writer thread.
   ola::thread::Mutex m_mutex;
   ola::thread::ConditionVariable m_cond_var;
-  bool m_write_pending;
-  bool m_exit;
+  bool m_exit;  // GUARDED_BY(m_mutex)
 
   const int16_t m_sync_output;
+  // These are only used by the olad thread.
   std::vector<unsigned int> m_output_sizes;
   std::vector<unsigned int> m_latch_bytes;
-  uint8_t *m_output;
-  unsigned int m_length;
+  // The outputs committed since the last frame was published, and the
+  // outputs in the last published frame.
+  std::vector<bool> m_committed;
+  std::vector<bool> m_published;
+  TripleBuffer m_buffer;
 };
 
 
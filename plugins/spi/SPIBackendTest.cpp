@@ -20,6 +20,7 @@
 
 #include <string.h>
 #include <cppunit/extensions/HelperMacros.h>
+#include <string>
 
 #include "ola/base/Array.h"
 #include "ola/DmxBuffer.h"
@@ -36,6 +37,7 @@ using ola::plugin::spi::HardwareBackend;
 using ola::plugin::spi::SoftwareBackend;
 using ola::plugin::spi::SPIBackendInterface;
 using ola::UIntMap;
+using std::string;
 
 class SPIBackendTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(SPIBackendTest);
@@ -44,6 +46,7 @@ class SPIBackendTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testInvalidOutputs);
   CPPUNIT_TEST(testSoftwareDrops);
   CPPUNIT_TEST(testSoftwareVariousFrameLengths);
+  CPPUNIT_TEST(testOutputStats);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -51,6 +54,7 @@ class SPIBackendTest: public CppUnit::TestFixture {
 
   void setUp();
   unsigned int DropCount();
+  unsigned int OutputDropCount(const string &output);
   bool SendSomeData(SPIBackendInterface *backend,
                     uint8_t output,
                     const uint8_t *data,
@@ -63,6 +67,7 @@ class SPIBackendTest: public CppUnit::TestFixture {
   void testInvalidOutputs();
   void testSoftwareDrops();
   void testSoftwareVariousFrameLengths();
+  void testOutputStats();
 
  private:
   ExportMap m_export_map;
@@ -135,6 +140,12 @@ unsigned int SPIBackendTest::DropCount() {
   return (*drop_map)[DEVICE_NAME];
 }
 
+unsigned int SPIBackendTest::OutputDropCount(const string &output) {
+  UIntMap *drop_map = m_export_map.GetUIntMapVar("spi-output-drops",
+                                                 "output");
+  return (*drop_map)[output];
+}
+
 bool SPIBackendTest::SendSomeData(SPIBackendInterface *backend,
                                   uint8_t output,
                                   const uint8_t *data,
@@ -324,3 +335,40 @@ void SPIBackendTest::testSoftwareVariousFrameLengths() {
   m_writer.CheckDataMatches(OLA_SOURCELINE(), EXPECTED3, arraysize(EXPECTED3));
   m_writer.ResetWrite();
 }
+
+
+/**
+ * Check the per-output drop counts.
+ */
+void SPIBackendTest::testOutputStats() {
+  SoftwareBackend::Options options;
+  options.outputs = 2;
+  options.sync_output = 1;
+  SoftwareBackend backend(options, &m_writer, &m_export_map);
+  OLA_ASSERT(backend.Init());
+
+  UIntMap *latency_map = m_export_map.GetUIntMapVar("spi-write-latency-us",
+                                                    "output");
+  OLA_ASSERT_NE(string::npos, latency_map->Value().find("Fake Device:1"));
+
+  m_writer.BlockWriter();
+  OLA_ASSERT(SendSomeData(&backend, 0, DATA1, arraysize(DATA1), 10));
+  OLA_ASSERT(SendSomeData(&backend, 1, DATA2, arraysize(DATA2), 6));
+  m_writer.WaitForWrite();  // now we know the writer is blocked
+  OLA_ASSERT_EQ(1u, m_writer.WriteCount());
+  m_writer.CheckDataMatches(OLA_SOURCELINE(), DATA3, arraysize(DATA3));
+
+  // Only output 1 is in the next frame, which is then replaced.
+  OLA_ASSERT(SendSomeData(&backend, 1, DATA2, arraysize(DATA2), 6));
+  OLA_ASSERT(SendSomeData(&backend, 0, DATA1, arraysize(DATA1), 10));
+  OLA_ASSERT(SendSomeData(&backend, 1, DATA2, arraysize(DATA2), 6));
+  OLA_ASSERT_EQ(1u, DropCount());
+  OLA_ASSERT_EQ(0u, OutputDropCount("Fake Device:0"));
+  OLA_ASSERT_EQ(1u, OutputDropCount("Fake Device:1"));
+
+  m_writer.ResetWrite();
+  m_writer.UnblockWriter();
+  m_writer.WaitForWrite();
+  OLA_ASSERT_EQ(2u, m_writer.WriteCount());
+  m_writer.CheckDataMatches(OLA_SOURCELINE(), DATA3, arraysize(DATA3));
+}
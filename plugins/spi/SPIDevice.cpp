@@ -102,8 +102,15 @@ SPIDevice::SPIDevice(SPIPlugin *owner,
              << " ports";
   }
 
+  unsigned int frame_timeout = SPIOutput::DEFAULT_FRAME_TIMEOUT;
+  if (!StringToInt(m_preferences->GetValue(FrameTimeoutKey()),
+                   &frame_timeout)) {
+    OLA_WARN << "Invalid integer value for " << FrameTimeoutKey();
+  }
+
   for (uint8_t i = 0; i < port_count; i++) {
     SPIOutput::Options spi_output_options(i, m_spi_device_name);
+    spi_output_options.frame_timeout = frame_timeout;
 
     if (m_preferences->HasKey(DeviceLabelKey(i))) {
       spi_output_options.device_label =
@@ -115,6 +122,32 @@ SPIDevice::SPIDevice(SPIPlugin *owner,
       spi_output_options.pixel_count = pixel_count;
     }
 
+    uint8_t universe_count;
+    if (StringToInt(m_preferences->GetValue(UniverseCountKey(i)),
+                    &universe_count)) {
+      if (universe_count == 0 || universe_count > MAX_UNIVERSE_COUNT) {
+        OLA_WARN << "Invalid universe count " << static_cast<int>(
+            universe_count) << " for SPI port " << static_cast<int>(i);
+      } else {
+        spi_output_options.universe_count = universe_count;
+      }
+    }
+
+    uint8_t brightness;
+    if (StringToInt(m_preferences->GetValue(BrightnessKey(i)), &brightness)) {
+      spi_output_options.brightness = brightness;
+    }
+
+    uint8_t gamma;
+    if (StringToInt(m_preferences->GetValue(GammaKey(i)), &gamma)) {
+      if (gamma == 0) {
+        OLA_WARN << "Invalid gamma " << static_cast<int>(gamma)
+                 << " for SPI port " << static_cast<int>(i);
+      } else {
+        spi_output_options.gamma = gamma;
+      }
+    }
+
     auto_ptr<UID> uid(uid_allocator->AllocateNext());
     if (!uid.get()) {
       OLA_WARN << "Insufficient UIDs remaining to allocate a UID for SPI port "
@@ -122,13 +155,26 @@ SPIDevice::SPIDevice(SPIPlugin *owner,
       continue;
     }
 
-    m_spi_ports.push_back(
-        new SPIOutputPort(this, m_backend.get(), *uid.get(),
-                          spi_output_options));
+    SPIOutput *output = new SPIOutput(*uid.get(), m_backend.get(),
+                                      spi_output_options, plugin_adaptor);
+    m_spi_outputs.push_back(output);
+
+    // One port for each universe, which all write to the same SPIOutput.
+    for (uint8_t universe = 0; universe < output->UniverseCount();
+         universe++) {
+      m_spi_ports.push_back(new SPIOutputPort(
+          this, PortId(port_count, i, universe), output, universe));
+    }
   }
 }
 
 
+SPIDevice::~SPIDevice() {
+  // The ports have been deleted by Stop()
+  STLDeleteElements(&m_spi_outputs);
+}
+
+
 string SPIDevice::DeviceId() const {
   return m_spi_device_name;
 }
@@ -143,8 +189,8 @@ bool SPIDevice::StartHook() {
     return false;
   }
 
-  SPIPorts::iterator iter = m_spi_ports.begin();
-  for (uint8_t i = 0; iter != m_spi_ports.end(); iter++, i++) {
+  SPIOutputs::iterator iter = m_spi_outputs.begin();
+  for (uint8_t i = 0; iter != m_spi_outputs.end(); iter++, i++) {
     uint8_t personality;
     if (StringToInt(m_preferences->GetValue(PersonalityKey(i)),
                     &personality)) {
@@ -156,16 +202,19 @@ bool SPIDevice::StartHook() {
                                             &dmx_address)) {
       (*iter)->SetStartAddress(dmx_address);
     }
+  }
 
-    AddPort(*iter);
+  SPIPorts::iterator port_iter = m_spi_ports.begin();
+  for (; port_iter != m_spi_ports.end(); port_iter++) {
+    AddPort(*port_iter);
   }
   return true;
 }
 
 
 void SPIDevice::PrePortStop() {
-  SPIPorts::iterator iter = m_spi_ports.begin();
-  for (uint8_t i = 0; iter != m_spi_ports.end(); iter++, i++) {
+  SPIOutputs::iterator iter = m_spi_outputs.begin();
+  for (uint8_t i = 0; iter != m_spi_outputs.end(); iter++, i++) {
     ostringstream str;
     m_preferences->SetValue(DeviceLabelKey(i), (*iter)->GetDeviceLabel());
     str << static_cast<int>((*iter)->GetPersonality());
@@ -176,6 +225,15 @@ void SPIDevice::PrePortStop() {
     str.str("");
     str << (*iter)->PixelCount();
     m_preferences->SetValue(PixelCountKey(i), str.str());
+    str.str("");
+    str << static_cast<int>((*iter)->UniverseCount());
+    m_preferences->SetValue(UniverseCountKey(i), str.str());
+    str.str("");
+    str << static_cast<int>((*iter)->Brightness());
+    m_preferences->SetValue(BrightnessKey(i), str.str());
+    str.str("");
+    str << static_cast<int>((*iter)->Gamma());
+    m_preferences->SetValue(GammaKey(i), str.str());
   }
   m_preferences->Save();
 }
@@ -204,10 +262,22 @@ string SPIDevice::GPIOPinKey() const {
   return m_spi_device_name + "-gpio-pin";
 }
 
+string SPIDevice::FrameTimeoutKey() const {
+  return m_spi_device_name + "-frame-timeout";
+}
+
+string SPIDevice::BrightnessKey(uint8_t port) const {
+  return GetPortKey("brightness", port);
+}
+
 string SPIDevice::DeviceLabelKey(uint8_t port) const {
   return GetPortKey("device-label", port);
 }
 
+string SPIDevice::GammaKey(uint8_t port) const {
+  return GetPortKey("gamma", port);
+}
+
 string SPIDevice::PersonalityKey(uint8_t port) const {
   return GetPortKey("personality", port);
 }
@@ -220,6 +290,10 @@ string SPIDevice::PixelCountKey(uint8_t port) const {
   return GetPortKey("pixel-count", port);
 }
 
+string SPIDevice::UniverseCountKey(uint8_t port) const {
+  return GetPortKey("universe-count", port);
+}
+
 string SPIDevice::GetPortKey(const string &suffix, uint8_t port) const {
   std::ostringstream str;
   str << m_spi_device_name << "-" << static_cast<int>(port) << "-" << suffix;
@@ -239,6 +313,8 @@ void SPIDevice::SetDefaults() {
   m_preferences->SetDefaultValue(SPICEKey(), BoolValidator(), false);
   m_preferences->SetDefaultValue(PortCountKey(), UIntValidator(1, 8), 1);
   m_preferences->SetDefaultValue(SyncPortKey(), IntValidator(-2, 8), 0);
+  m_preferences->SetDefaultValue(FrameTimeoutKey(), UIntValidator(1, 1000),
+                                 SPIOutput::DEFAULT_FRAME_TIMEOUT);
   m_preferences->Save();
 }
 
@@ -289,6 +365,21 @@ void SPIDevice::PopulateWriterOptions(SPIWriter::Options *options) {
     options->cs_enable_high = ce_high;
   }
 }
+
+
+/*
+ * The first universe of each output keeps the output's index as the port id.
+ * The additional universes of each output get their own fixed range after
+ * those, so changing one output's universe-count doesn't renumber the ports,
+ * and the universe patches, of the others.
+ */
+unsigned int SPIDevice::PortId(uint8_t output_count, uint8_t output,
+                               uint8_t universe) {
+  if (universe == 0) {
+    return output;
+  }
+  return output_count + output * (MAX_UNIVERSE_COUNT - 1) + universe - 1;
+}
 }  // namespace spi
 }  // namespace plugin
 }  // namespace ola
@@ -44,6 +44,7 @@ class SPIDevice: public ola::Device {
             class PluginAdaptor *plugin_adaptor,
             const std::string &spi_device,
             ola::rdm::UIDAllocator *uid_allocator);
+  ~SPIDevice();
 
   std::string DeviceId() const;
 
@@ -55,11 +56,13 @@ class SPIDevice: public ola::Device {
 
  private:
   typedef std::vector<class SPIOutputPort*> SPIPorts;
+  typedef std::vector<class SPIOutput*> SPIOutputs;
 
   std::auto_ptr<SPIWriterInterface> m_writer;
   std::auto_ptr<SPIBackendInterface> m_backend;
   class Preferences *m_preferences;
   class PluginAdaptor *m_plugin_adaptor;
+  SPIOutputs m_spi_outputs;
   SPIPorts m_spi_ports;
   std::string m_spi_device_name;
 
@@ -70,12 +73,16 @@ class SPIDevice: public ola::Device {
   std::string PortCountKey() const;
   std::string SyncPortKey() const;
   std::string GPIOPinKey() const;
+  std::string FrameTimeoutKey() const;
 
   // Per port options
+  std::string BrightnessKey(uint8_t port) const;
   std::string DeviceLabelKey(uint8_t port) const;
+  std::string GammaKey(uint8_t port) const;
   std::string PersonalityKey(uint8_t port) const;
   std::string PixelCountKey(uint8_t port) const;
   std::string StartAddressKey(uint8_t port) const;
+  std::string UniverseCountKey(uint8_t port) const;
   std::string GetPortKey(const std::string &suffix, uint8_t port) const;
 
   void SetDefaults();
@@ -83,10 +90,14 @@ class SPIDevice: public ola::Device {
   void PopulateSoftwareBackendOptions(SoftwareBackend::Options *options);
   void PopulateWriterOptions(SPIWriter::Options *options);
 
+  static unsigned int PortId(uint8_t output_count, uint8_t output,
+                             uint8_t universe);
+
   static const char SPI_DEVICE_NAME[];
   static const char HARDWARE_BACKEND[];
   static const char SOFTWARE_BACKEND[];
   static const uint8_t MAX_GPIO_PIN = 25;
+  static const uint8_t MAX_UNIVERSE_COUNT = 32;
 };
 }  // namespace spi
 }  // namespace plugin
@@ -80,21 +80,22 @@ const uint8_t SPIOutput::SPI_MODE = 0;
 
 /**
  * These constants are used to determine the number of DMX Slots per pixel
- * The p9813 uses another byte preceding each of the three bytes as a kind
- * of header.
  */
 const uint16_t SPIOutput::WS2801_SLOTS_PER_PIXEL = 3;
 const uint16_t SPIOutput::LPD8806_SLOTS_PER_PIXEL = 3;
 const uint16_t SPIOutput::P9813_SLOTS_PER_PIXEL = 3;
 const uint16_t SPIOutput::APA102_SLOTS_PER_PIXEL = 3;
 
-// Number of bytes that each pixel uses on the SPI wires
-// (if it differs from 1:1 with colors)
-const uint16_t SPIOutput::P9813_SPI_BYTES_PER_PIXEL = 4;
-const uint16_t SPIOutput::APA102_SPI_BYTES_PER_PIXEL = 4;
+// The P9813 needs 4 bytes of zeros in the beginning and 8 bytes at the end.
+const uint16_t SPIOutput::P9813_START_FRAME_BYTES = 4;
+const uint16_t SPIOutput::P9813_END_FRAME_BYTES = 8;
 
+// The APA102 start frame is 32 bits of zeros, the end frame depends on the
+// number of pixels, see CalculateAPA102LatchBytes().
 const uint16_t SPIOutput::APA102_START_FRAME_BYTES = 4;
 
+const unsigned int SPIOutput::DEFAULT_FRAME_TIMEOUT = 30;
+
 SPIOutput::RDMOps *SPIOutput::RDMOps::instance = NULL;
 
 const ola::rdm::ResponderOps<SPIOutput>::ParamHandler
@@ -169,11 +170,24 @@ const ola::rdm::ResponderOps<SPIOutput>::ParamHandler
 
 
 SPIOutput::SPIOutput(const UID &uid, SPIBackendInterface *backend,
-                     const Options &options)
+                     const Options &options,
+                     ola::thread::SchedulerInterface *scheduler)
     : m_backend(backend),
       m_output_number(options.output_number),
       m_uid(uid),
       m_pixel_count(options.pixel_count),
+      m_universe_count(std::max(options.universe_count,
+                                static_cast<uint8_t>(1))),
+      m_brightness(options.brightness),
+      m_gamma(std::max(options.gamma, static_cast<uint8_t>(1))),
+      m_frame_timeout(static_cast<int64_t>(options.frame_timeout) *
+                      ola::ONE_THOUSAND),
+      m_scheduler(scheduler),
+      m_frame_timeout_id(ola::thread::INVALID_TIMEOUT),
+      m_universe_data(m_universe_count),
+      m_received(m_universe_count, false),
+      m_received_count(0),
+      m_incomplete_frames(0),
       m_device_label(options.device_label),
       m_start_address(1),
       m_identify_mode(false) {
@@ -211,10 +225,25 @@ SPIOutput::SPIOutput(const UID &uid, SPIBackendInterface *backend,
 #endif
 
   m_network_manager.reset(new ola::rdm::NetworkManager());
+
+  // This must match the order of the personalities above.
+  const float gamma = m_gamma / 10.0;
+  m_converters.push_back(
+      new PixelConverter(PixelConverter::WS2801, m_brightness, gamma));
+  m_converters.push_back(
+      new PixelConverter(PixelConverter::LPD8806, m_brightness, gamma));
+  m_converters.push_back(
+      new PixelConverter(PixelConverter::P9813, m_brightness, gamma));
+  m_converters.push_back(
+      new PixelConverter(PixelConverter::APA102, m_brightness, gamma));
 }
 
 SPIOutput::~SPIOutput() {
+  if (m_frame_timeout_id != ola::thread::INVALID_TIMEOUT) {
+    m_scheduler->RemoveTimeout(m_frame_timeout_id);
+  }
   STLDeleteElements(&m_sensors);
+  STLDeleteElements(&m_converters);
 }
 
 
@@ -254,7 +283,12 @@ string SPIOutput::Description() const {
   str << "Output " << static_cast<int>(m_output_number) << ", "
       << m_personality_manager->ActivePersonalityDescription() << ", "
       << m_personality_manager->ActivePersonalityFootprint()
-      << " slots @ " << m_start_address << ". (" << m_uid << ")";
+      << " slots @ " << m_start_address;
+  if (m_universe_count > 1) {
+    str << " in each of " << static_cast<int>(m_universe_count)
+        << " universes";
+  }
+  str << ". (" << m_uid << ")";
   return str.str();
 }
 
@@ -262,10 +296,37 @@ string SPIOutput::Description() const {
  * Send DMX data over SPI.
  */
 bool SPIOutput::WriteDMX(const DmxBuffer &buffer) {
-  if (m_identify_mode) {
-    return true;
+  return WriteDMX(0, buffer);
+}
+
+
+/*
+ * Store the data for one universe, and send the frame once we have all of
+ * them. If a universe arrives twice before the frame is complete, one of the
+ * other sources has fallen behind, so send what we have.
+ */
+bool SPIOutput::WriteDMX(uint8_t universe, const DmxBuffer &buffer) {
+  if (universe >= m_universe_count) {
+    return false;
+  }
+
+  if (m_received[universe]) {
+    m_incomplete_frames++;
+    SendFrame();
   }
-  return InternalWriteDMX(buffer);
+
+  m_universe_data[universe] = buffer;
+  m_received[universe] = true;
+  m_received_count++;
+
+  if (m_received_count == m_universe_count) {
+    SendFrame();
+  } else if (m_received_count == 1 && m_scheduler) {
+    m_frame_timeout_id = m_scheduler->RegisterSingleTimeout(
+        m_frame_timeout,
+        NewSingleCallback(this, &SPIOutput::FrameTimeout));
+  }
+  return true;
 }
 
 
@@ -290,350 +351,180 @@ void SPIOutput::SendRDMRequest(RDMRequest *request,
                                        request, callback);
 }
 
-bool SPIOutput::InternalWriteDMX(const DmxBuffer &buffer) {
-  switch (m_personality_manager->ActivePersonalityNumber()) {
-    case 1:
-      IndividualWS2801Control(buffer);
-      break;
-    case 2:
-      CombinedWS2801Control(buffer);
-      break;
-    case 3:
-      IndividualLPD8806Control(buffer);
-      break;
-    case 4:
-      CombinedLPD8806Control(buffer);
-      break;
-    case 5:
-      IndividualP9813Control(buffer);
-      break;
-    case 6:
-      CombinedP9813Control(buffer);
-      break;
-    case 7:
-      IndividualAPA102Control(buffer);
-      break;
-    case 8:
-      CombinedAPA102Control(buffer);
-      break;
-    default:
-      break;
-  }
-  return true;
-}
-
-void SPIOutput::IndividualWS2801Control(const DmxBuffer &buffer) {
-  // We always check out the entire string length, even if we only have data
-  // for part of it
-  const unsigned int output_length = m_pixel_count * WS2801_SLOTS_PER_PIXEL;
-  uint8_t *output = m_backend->Checkout(m_output_number, output_length);
-  if (!output) {
-    return;
-  }
-
-  unsigned int new_length = output_length;
-  buffer.GetRange(m_start_address - 1, output, &new_length);
-  m_backend->Commit(m_output_number);
-}
-
-void SPIOutput::CombinedWS2801Control(const DmxBuffer &buffer) {
-  unsigned int pixel_data_length = WS2801_SLOTS_PER_PIXEL;
-  uint8_t pixel_data[WS2801_SLOTS_PER_PIXEL];
-  buffer.GetRange(m_start_address - 1, pixel_data, &pixel_data_length);
-  if (pixel_data_length != WS2801_SLOTS_PER_PIXEL) {
-    OLA_INFO << "Insufficient DMX data, required " << WS2801_SLOTS_PER_PIXEL
-             << ", got " << pixel_data_length;
-    return;
+/*
+ * Send the current data for all universes, and start a new frame.
+ */
+void SPIOutput::SendFrame() {
+  if (m_frame_timeout_id != ola::thread::INVALID_TIMEOUT) {
+    m_scheduler->RemoveTimeout(m_frame_timeout_id);
+    m_frame_timeout_id = ola::thread::INVALID_TIMEOUT;
   }
 
-  const unsigned int length = m_pixel_count * WS2801_SLOTS_PER_PIXEL;
-  uint8_t *output = m_backend->Checkout(m_output_number, length);
-  if (!output) {
-    return;
-  }
+  std::fill(m_received.begin(), m_received.end(), false);
+  m_received_count = 0;
 
-  for (unsigned int i = 0; i < m_pixel_count; i++) {
-    memcpy(output + (i * WS2801_SLOTS_PER_PIXEL), pixel_data,
-           pixel_data_length);
+  if (!m_identify_mode) {
+    InternalWriteDMX(m_universe_data);
   }
-  m_backend->Commit(m_output_number);
 }
 
-void SPIOutput::IndividualLPD8806Control(const DmxBuffer &buffer) {
-  const uint8_t latch_bytes = (m_pixel_count + 31) / 32;
-  const unsigned int first_slot = m_start_address - 1;  // 0 offset
-  if (buffer.Size() - first_slot < LPD8806_SLOTS_PER_PIXEL) {
-    // not even 3 bytes of data, don't bother updating
-    return;
-  }
-
-  // We always check out the entire string length, even if we only have data
-  // for part of it
-  const unsigned int output_length = m_pixel_count * LPD8806_SLOTS_PER_PIXEL;
-  uint8_t *output = m_backend->Checkout(m_output_number, output_length,
-                                        latch_bytes);
-  if (!output)
-    return;
-
-  const unsigned int length = std::min(m_pixel_count * LPD8806_SLOTS_PER_PIXEL,
-                                       buffer.Size() - first_slot);
-
-  for (unsigned int i = 0; i < length / LPD8806_SLOTS_PER_PIXEL; i++) {
-    // Convert RGB to GRB
-    unsigned int offset = first_slot + i * LPD8806_SLOTS_PER_PIXEL;
-    uint8_t r = buffer.Get(offset);
-    uint8_t g = buffer.Get(offset + 1);
-    uint8_t b = buffer.Get(offset + 2);
-    output[i * LPD8806_SLOTS_PER_PIXEL] = 0x80 | (g >> 1);
-    output[i * LPD8806_SLOTS_PER_PIXEL + 1] = 0x80 | (r >> 1);
-    output[i * LPD8806_SLOTS_PER_PIXEL + 2] = 0x80 | (b >> 1);
-  }
-  m_backend->Commit(m_output_number);
+void SPIOutput::FrameTimeout() {
+  m_frame_timeout_id = ola::thread::INVALID_TIMEOUT;
+  m_incomplete_frames++;
+  SendFrame();
 }
 
-void SPIOutput::CombinedLPD8806Control(const DmxBuffer &buffer) {
-  const uint8_t latch_bytes = (m_pixel_count + 31) / 32;
-  unsigned int pixel_data_length = LPD8806_SLOTS_PER_PIXEL;
-
-  uint8_t pixel_data[LPD8806_SLOTS_PER_PIXEL];
-  buffer.GetRange(m_start_address - 1, pixel_data, &pixel_data_length);
-  if (pixel_data_length != LPD8806_SLOTS_PER_PIXEL) {
-    OLA_INFO << "Insufficient DMX data, required " << LPD8806_SLOTS_PER_PIXEL
-             << ", got " << pixel_data_length;
-    return;
+bool SPIOutput::InternalWriteDMX(const vector<DmxBuffer> &universes) {
+  // Odd personalities are individual control, even ones are combined.
+  const unsigned int personality =
+      m_personality_manager->ActivePersonalityNumber();
+  if (personality == 0 || personality > 2 * m_converters.size()) {
+    return true;
   }
 
-  // The leds are GRB format so convert here
-  uint8_t temp = pixel_data[1];
-  pixel_data[1] = pixel_data[0];
-  pixel_data[0] = temp;
-
-  const unsigned int length = m_pixel_count * LPD8806_SLOTS_PER_PIXEL;
-  uint8_t *output = m_backend->Checkout(m_output_number, length, latch_bytes);
-  if (!output)
-    return;
-
-  for (unsigned int i = 0; i < m_pixel_count; i++) {
-    for (unsigned int j = 0; j < LPD8806_SLOTS_PER_PIXEL; j++) {
-      output[i * LPD8806_SLOTS_PER_PIXEL + j] = 0x80 | (pixel_data[j] >> 1);
-    }
+  const PixelConverter *converter = m_converters[(personality - 1) / 2];
+  if (personality % 2) {
+    IndividualControl(*converter, universes);
+  } else {
+    CombinedControl(*converter, universes);
   }
-  m_backend->Commit(m_output_number);
+  return true;
 }
 
-void SPIOutput::IndividualP9813Control(const DmxBuffer &buffer) {
-  // We need 4 bytes of zeros in the beginning and 8 bytes at
-  // the end
-  const uint8_t latch_bytes = 3 * P9813_SPI_BYTES_PER_PIXEL;
+/*
+ * Each universe fills its own section of the string. Sections without enough
+ * data are left as they were.
+ */
+void SPIOutput::IndividualControl(const PixelConverter &converter,
+                                  const vector<DmxBuffer> &universes) {
   const unsigned int first_slot = m_start_address - 1;  // 0 offset
-  if (buffer.Size() - first_slot < P9813_SLOTS_PER_PIXEL) {
-    // not even 3 bytes of data, don't bother updating
+  // The WS2801 takes whatever data there is, the other chips need at least
+  // one full pixel.
+  const unsigned int min_slots = (
+      converter.GetChip() == PixelConverter::WS2801 ? 0 :
+      PixelConverter::SLOTS_PER_PIXEL);
+
+  vector<DmxBuffer>::const_iterator iter = universes.begin();
+  bool have_data = false;
+  for (; iter != universes.end(); ++iter) {
+    if (AvailableSlots(*iter) >= min_slots) {
+      have_data = true;
+      break;
+    }
+  }
+  if (!have_data) {
     return;
   }
 
   // We always check out the entire string length, even if we only have data
   // for part of it
-  const unsigned int output_length = m_pixel_count * P9813_SPI_BYTES_PER_PIXEL;
-  uint8_t *output = m_backend->Checkout(m_output_number, output_length,
-                                        latch_bytes);
-
+  uint8_t *output = CheckoutPixels(converter);
   if (!output) {
     return;
   }
 
-  for (unsigned int i = 0; i < m_pixel_count; i++) {
-    // Convert RGB to P9813 Pixel
-    unsigned int offset = first_slot + i * P9813_SLOTS_PER_PIXEL;
-    // We need to avoid the first 4 bytes of the buffer since that acts as a
-    // start of frame delimiter
-    unsigned int spi_offset = (i + 1) * P9813_SPI_BYTES_PER_PIXEL;
-    uint8_t r = 0;
-    uint8_t b = 0;
-    uint8_t g = 0;
-    if (buffer.Size() - offset >= P9813_SLOTS_PER_PIXEL) {
-      r = buffer.Get(offset);
-      g = buffer.Get(offset + 1);
-      b = buffer.Get(offset + 2);
+  const unsigned int section_size = m_pixel_count * converter.BytesPerPixel();
+  for (iter = universes.begin(); iter != universes.end();
+       ++iter, output += section_size) {
+    const unsigned int slots = AvailableSlots(*iter);
+    if (slots < min_slots) {
+      continue;
     }
-    output[spi_offset] = P9813CreateFlag(r, g, b);
-    output[spi_offset + 1] = b;
-    output[spi_offset + 2] = g;
-    output[spi_offset + 3] = r;
+    converter.Convert(iter->GetRaw() + first_slot, slots, output,
+                      m_pixel_count);
   }
   m_backend->Commit(m_output_number);
 }
 
-void SPIOutput::CombinedP9813Control(const DmxBuffer &buffer) {
-  const uint8_t latch_bytes = 3 * P9813_SPI_BYTES_PER_PIXEL;
+/*
+ * Each universe sets the colour of its own section of the string.
+ */
+void SPIOutput::CombinedControl(const PixelConverter &converter,
+                                const vector<DmxBuffer> &universes) {
   const unsigned int first_slot = m_start_address - 1;  // 0 offset
-
-  if (buffer.Size() - first_slot < P9813_SLOTS_PER_PIXEL) {
-    OLA_INFO << "Insufficient DMX data, required " << P9813_SLOTS_PER_PIXEL
-             << ", got " << buffer.Size() - first_slot;
+  vector<DmxBuffer>::const_iterator iter = universes.begin();
+  bool have_data = false;
+  for (; iter != universes.end(); ++iter) {
+    const unsigned int slots = AvailableSlots(*iter);
+    if (slots >= PixelConverter::SLOTS_PER_PIXEL) {
+      have_data = true;
+    } else {
+      OLA_INFO << "Insufficient DMX data, required "
+               << PixelConverter::SLOTS_PER_PIXEL << ", got " << slots;
+    }
+  }
+  if (!have_data) {
     return;
   }
 
-  uint8_t pixel_data[P9813_SPI_BYTES_PER_PIXEL];
-  pixel_data[3] = buffer.Get(first_slot);  // Get Red
-  pixel_data[2] = buffer.Get(first_slot + 1);  // Get Green
-  pixel_data[1] = buffer.Get(first_slot + 2);  // Get Blue
-  pixel_data[0] = P9813CreateFlag(pixel_data[3], pixel_data[2],
-                                  pixel_data[1]);
-
-  const unsigned int length = m_pixel_count * P9813_SPI_BYTES_PER_PIXEL;
-  uint8_t *output = m_backend->Checkout(m_output_number, length, latch_bytes);
+  uint8_t *output = CheckoutPixels(converter);
   if (!output) {
     return;
   }
 
-  for (unsigned int i = 0; i < m_pixel_count; i++) {
-    memcpy(&output[(i + 1) * P9813_SPI_BYTES_PER_PIXEL], pixel_data,
-           P9813_SPI_BYTES_PER_PIXEL);
+  const unsigned int section_size = m_pixel_count * converter.BytesPerPixel();
+  for (iter = universes.begin(); iter != universes.end();
+       ++iter, output += section_size) {
+    if (AvailableSlots(*iter) >= PixelConverter::SLOTS_PER_PIXEL) {
+      converter.Fill(iter->GetRaw() + first_slot, output, m_pixel_count);
+    }
   }
   m_backend->Commit(m_output_number);
 }
 
-/**
- * For more information please visit:
- * https://github.com/CoolNeon/elinux-tcl/blob/master/README.txt
+/*
+ * Checkout the buffer for the entire string, and clear the start frame.
+ * @returns a pointer to the first pixel, or NULL if the checkout failed.
  */
-uint8_t SPIOutput::P9813CreateFlag(uint8_t red, uint8_t green, uint8_t blue) {
-  uint8_t flag = 0;
-  flag =  (red & 0xc0) >> 6;
-  flag |= (green & 0xc0) >> 4;
-  flag |= (blue & 0xc0) >> 2;
-  return ~flag;
-}
-
-
-void SPIOutput::IndividualAPA102Control(const DmxBuffer &buffer) {
-  // some detailed information on the protocol:
-  // https://cpldcpu.wordpress.com/2014/11/30/understanding-the-apa102-superled/
-  // Data-Struct
-  // StartFrame: 4 bytes = 32 bits zeros (APA102_START_FRAME_BYTES)
-  // LEDFrame: 1 byte FF ; 3 bytes color info (Blue, Green, Red)
-  // EndFrame: (n/2)bits; n = pixel_count
-
-  // calculate DMX-start-address
-  const unsigned int first_slot = m_start_address - 1;  // 0 offset
-
-  // only do something if at least 1 pixel can be updated..
-  if (buffer.Size() - first_slot < APA102_SLOTS_PER_PIXEL) {
-    OLA_INFO << "Insufficient DMX data, required " << APA102_SLOTS_PER_PIXEL
-             << ", got " << buffer.Size() - first_slot;
-    return;
-  }
-
-  // We always check out the entire string length, even if we only have data
-  // for part of it
-  uint16_t output_length = (m_pixel_count * APA102_SPI_BYTES_PER_PIXEL);
-  // only add the APA102_START_FRAME_BYTES on the first port!!
-  if (m_output_number == 0) {
-    output_length += APA102_START_FRAME_BYTES;
-  }
+uint8_t *SPIOutput::CheckoutPixels(const PixelConverter &converter) {
+  const unsigned int start_frame = StartFrameBytes(converter);
   uint8_t *output = m_backend->Checkout(
       m_output_number,
-      output_length,
-      CalculateAPA102LatchBytes(m_pixel_count));
-
-  // only update SPI data if possible
+      start_frame + TotalPixelCount() * converter.BytesPerPixel(),
+      LatchBytes(converter));
   if (!output) {
-    return;
-  }
-
-  // only write to APA102_START_FRAME_BYTES on the first port!!
-  if (m_output_number == 0) {
-    // set APA102_START_FRAME_BYTES to zero
-    memset(output, 0, APA102_START_FRAME_BYTES);
+    return NULL;
   }
-
-  for (uint16_t i = 0; i < m_pixel_count; i++) {
-    // Convert RGB to APA102 Pixel
-    uint16_t offset = first_slot + (i * APA102_SLOTS_PER_PIXEL);
-
-
-    uint16_t spi_offset = (i * APA102_SPI_BYTES_PER_PIXEL);
-    // only skip APA102_START_FRAME_BYTES on the first port!!
-    if (m_output_number == 0) {
-      // We need to avoid the first 4 bytes of the buffer since that acts as a
-      // start of frame delimiter
-      spi_offset += APA102_START_FRAME_BYTES;
-    }
-    // set pixel data
-    // first Byte contains:
-    // 3 bits start mark (111) + 5 bits global brightness
-    // set global brightness fixed to 31 --> that reduces flickering
-    // that can be written as 0xE0 & 0x1F
-    output[spi_offset] = 0xFF;
-    // only write pixel data if buffer has complete data for this pixel:
-    if ((buffer.Size() - offset) >= APA102_SLOTS_PER_PIXEL) {
-      // Convert RGB to APA102 Pixel
-      // skip spi_offset + 0 (is already set)
-      output[spi_offset + 1] = buffer.Get(offset + 2);  // blue
-      output[spi_offset + 2] = buffer.Get(offset + 1);  // green
-      output[spi_offset + 3] = buffer.Get(offset);      // red
-    }
+  memset(output, 0, start_frame);
+  return output + start_frame;
+}
+
+unsigned int SPIOutput::StartFrameBytes(
+    const PixelConverter &converter) const {
+  switch (converter.GetChip()) {
+    case PixelConverter::P9813:
+      return P9813_START_FRAME_BYTES;
+    case PixelConverter::APA102:
+      // only add the APA102_START_FRAME_BYTES on the first port!!
+      return m_output_number == 0 ? APA102_START_FRAME_BYTES : 0;
+    default:
+      return 0;
   }
-
-  // write output back
-  m_backend->Commit(m_output_number);
 }
 
-void SPIOutput::CombinedAPA102Control(const DmxBuffer &buffer) {
-  // for Protocol details see IndividualAPA102Control
-
-  // calculate DMX-start-address
-  const uint16_t first_slot = m_start_address - 1;  // 0 offset
-
-  // check if enough data is there.
-  if (buffer.Size() - first_slot < APA102_SLOTS_PER_PIXEL) {
-    OLA_INFO << "Insufficient DMX data, required " << APA102_SLOTS_PER_PIXEL
-             << ", got " << buffer.Size() - first_slot;
-    return;
-  }
-
-  // We always check out the entire string length, even if we only have data
-  // for part of it
-  uint16_t output_length = (m_pixel_count * APA102_SPI_BYTES_PER_PIXEL);
-  // only add the APA102_START_FRAME_BYTES on the first port!!
-  if (m_output_number == 0) {
-    output_length += APA102_START_FRAME_BYTES;
-  }
-  uint8_t *output = m_backend->Checkout(
-      m_output_number,
-      output_length,
-      CalculateAPA102LatchBytes(m_pixel_count));
-
-  // only update SPI data if possible
-  if (!output) {
-    return;
-  }
-
-  // only write to APA102_START_FRAME_BYTES on the first port!!
-  if (m_output_number == 0) {
-    // set APA102_START_FRAME_BYTES to zero
-    memset(output, 0, APA102_START_FRAME_BYTES);
+unsigned int SPIOutput::LatchBytes(const PixelConverter &converter) const {
+  switch (converter.GetChip()) {
+    case PixelConverter::LPD8806:
+      return (TotalPixelCount() + 31) / 32;
+    case PixelConverter::P9813:
+      return P9813_END_FRAME_BYTES;
+    case PixelConverter::APA102:
+      return CalculateAPA102LatchBytes(TotalPixelCount());
+    default:
+      return 0;
   }
+}
 
-  // create Pixel Data
-  uint8_t pixel_data[APA102_SPI_BYTES_PER_PIXEL];
-  pixel_data[0] = 0xFF;
-  pixel_data[1] = buffer.Get(first_slot + 2);  // Get Blue
-  pixel_data[2] = buffer.Get(first_slot + 1);  // Get Green
-  pixel_data[3] = buffer.Get(first_slot);      // Get Red
-
-  // set all pixel to same value
-  for (uint16_t i = 0; i < m_pixel_count; i++) {
-    uint16_t spi_offset = (i * APA102_SPI_BYTES_PER_PIXEL);
-    if (m_output_number == 0) {
-      spi_offset += APA102_START_FRAME_BYTES;
-    }
-    memcpy(&output[spi_offset], pixel_data,
-           APA102_SPI_BYTES_PER_PIXEL);
-  }
+/*
+ * The number of slots in the buffer from the start address onwards.
+ */
+unsigned int SPIOutput::AvailableSlots(const DmxBuffer &buffer) const {
+  const unsigned int first_slot = m_start_address - 1;  // 0 offset
+  return first_slot < buffer.Size() ? buffer.Size() - first_slot : 0;
+}
 
-  // write output back...
-  m_backend->Commit(m_output_number);
+unsigned int SPIOutput::TotalPixelCount() const {
+  return m_pixel_count * m_universe_count;
 }
 
 /**
@@ -642,14 +533,11 @@ void SPIOutput::CombinedAPA102Control(const DmxBuffer &buffer) {
  * round up to next full byte count.
  * datasheet says endframe should consist of 4 bytes -
  * but thats only valid for up to 64 pixels/leds. (4Byte*8Bit*2=64)
- *
- * the function is valid up to 4080 pixels. (255*8*2)
- * ( otherwise the return type must be changed to uint16_t)
  */
-uint8_t SPIOutput::CalculateAPA102LatchBytes(uint16_t pixel_count) {
+unsigned int SPIOutput::CalculateAPA102LatchBytes(unsigned int pixel_count) {
   // round up so that we get definitely enough bits
-  const uint8_t latch_bits = (pixel_count + 1) / 2;
-  const uint8_t latch_bytes = (latch_bits + 7) / 8;
+  const unsigned int latch_bits = (pixel_count + 1) / 2;
+  const unsigned int latch_bytes = (latch_bits + 7) / 8;
   return latch_bytes;
 }
 
@@ -734,7 +622,7 @@ RDMResponse *SPIOutput::SetIdentify(const RDMRequest *request) {
     } else {
       identify_buffer.Blackout();
     }
-    InternalWriteDMX(identify_buffer);
+    InternalWriteDMX(vector<DmxBuffer>(m_universe_count, identify_buffer));
   }
   return response;
 }
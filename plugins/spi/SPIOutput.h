@@ -14,7 +14,7 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  *
  * SPIOutput.h
- * An RDM-controllable SPI device. Takes up to one universe of DMX.
+ * An RDM-controllable SPI device. Takes one or more universes of DMX.
  * Copyright (C) 2013 Simon Newton
  */
 
@@ -23,14 +23,17 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 #include "common/rdm/NetworkManager.h"
 #include "ola/DmxBuffer.h"
+#include "ola/thread/SchedulerInterface.h"
 #include "ola/rdm/RDMControllerInterface.h"
 #include "ola/rdm/UID.h"
 #include "ola/stl/STLUtils.h"
 #include "ola/rdm/ResponderOps.h"
 #include "ola/rdm/ResponderPersonality.h"
 #include "ola/rdm/ResponderSensor.h"
+#include "plugins/spi/PixelConverter.h"
 
 namespace ola {
 namespace plugin {
@@ -40,19 +43,42 @@ class SPIOutput: public ola::rdm::DiscoverableRDMControllerInterface {
  public:
   struct Options {
     std::string device_label;
+    // The number of pixels in each universe.
     uint8_t pixel_count;
     uint8_t output_number;
+    // The number of universes that make up the string. Each universe uses
+    // the same personality & start address.
+    uint8_t universe_count;
+    // How long to wait for the rest of the universes in a frame, in ms.
+    unsigned int frame_timeout;
+    // The brightness of the pixels, 255 is full brightness.
+    uint8_t brightness;
+    // The gamma correction, in tenths. 10 means no correction.
+    uint8_t gamma;
 
     explicit Options(uint8_t output_number, const std::string &spi_device_name)
         : device_label("SPI Device - " + spi_device_name),
           pixel_count(25),  // For the https://www.adafruit.com/products/738
-          output_number(output_number) {
+          output_number(output_number),
+          universe_count(1),
+          frame_timeout(DEFAULT_FRAME_TIMEOUT),
+          brightness(255),
+          gamma(10) {
     }
   };
 
+  /**
+   * @brief Create a new SPIOutput.
+   * @param uid the UID of the RDM responder.
+   * @param backend the SPIBackend to write to.
+   * @param options the Options for this output.
+   * @param scheduler the scheduler used for the frame timeout. If NULL,
+   *   incomplete frames are only sent when the next frame starts.
+   */
   SPIOutput(const ola::rdm::UID &uid,
             class SPIBackendInterface *backend,
-            const Options &options);
+            const Options &options,
+            ola::thread::SchedulerInterface *scheduler = NULL);
   ~SPIOutput();
 
   std::string GetDeviceLabel() const;
@@ -62,10 +88,32 @@ class SPIOutput: public ola::rdm::DiscoverableRDMControllerInterface {
   uint16_t GetStartAddress() const;
   bool SetStartAddress(uint16_t start_address);
   unsigned int PixelCount() const { return m_pixel_count; }
+  uint8_t OutputNumber() const { return m_output_number; }
+  uint8_t UniverseCount() const { return m_universe_count; }
+  uint8_t Brightness() const { return m_brightness; }
+  uint8_t Gamma() const { return m_gamma; }
 
   std::string Description() const;
   bool WriteDMX(const DmxBuffer &buffer);
 
+  /**
+   * @brief Write the data for one of the universes.
+   * @param universe the universe index, from 0 to UniverseCount() - 1.
+   * @param buffer the DMX data.
+   *
+   * The SPI data is sent once all universes have arrived, or when the frame
+   * times out.
+   */
+  bool WriteDMX(uint8_t universe, const DmxBuffer &buffer);
+
+  /**
+   * @brief The number of frames that were sent before all the universes had
+   *   arrived.
+   */
+  unsigned int IncompleteFrames() const { return m_incomplete_frames; }
+
+  static const unsigned int DEFAULT_FRAME_TIMEOUT;
+
   void RunFullDiscovery(ola::rdm::RDMDiscoveryCallback *callback);
   void RunIncrementalDiscovery(ola::rdm::RDMDiscoveryCallback *callback);
   void SendRDMRequest(ola::rdm::RDMRequest *request,
@@ -94,6 +142,17 @@ class SPIOutput: public ola::rdm::DiscoverableRDMControllerInterface {
   std::string m_spi_device_name;
   const ola::rdm::UID m_uid;
   const unsigned int m_pixel_count;
+  const uint8_t m_universe_count;
+  const uint8_t m_brightness;
+  const uint8_t m_gamma;
+  const ola::TimeInterval m_frame_timeout;
+  ola::thread::SchedulerInterface *m_scheduler;
+  ola::thread::timeout_id m_frame_timeout_id;
+  // The latest data for each universe, and if it's arrived in this frame.
+  std::vector<DmxBuffer> m_universe_data;
+  std::vector<bool> m_received;
+  unsigned int m_received_count;
+  unsigned int m_incomplete_frames;
   std::string m_device_label;
   uint16_t m_start_address;  // starts from 1
   bool m_identify_mode;
@@ -101,21 +160,19 @@ class SPIOutput: public ola::rdm::DiscoverableRDMControllerInterface {
   std::auto_ptr<ola::rdm::PersonalityManager> m_personality_manager;
   ola::rdm::Sensors m_sensors;
   std::auto_ptr<ola::rdm::NetworkManagerInterface> m_network_manager;
+  // One converter for each chip type, indexed by (personality - 1) / 2
+  std::vector<PixelConverter*> m_converters;
 
   // DMX methods
-  bool InternalWriteDMX(const DmxBuffer &buffer);
-
-  void IndividualWS2801Control(const DmxBuffer &buffer);
-  void CombinedWS2801Control(const DmxBuffer &buffer);
-  void IndividualLPD8806Control(const DmxBuffer &buffer);
-  void CombinedLPD8806Control(const DmxBuffer &buffer);
-  void IndividualP9813Control(const DmxBuffer &buffer);
-  void CombinedP9813Control(const DmxBuffer &buffer);
-  void IndividualAPA102Control(const DmxBuffer &buffer);
-  void CombinedAPA102Control(const DmxBuffer &buffer);
+  void SendFrame();
+  void FrameTimeout();
+  bool InternalWriteDMX(const std::vector<DmxBuffer> &universes);
 
-  unsigned int LPD8806BufferSize() const;
-  void WriteSPIData(const uint8_t *data, unsigned int length);
+  void IndividualControl(const PixelConverter &converter,
+                         const std::vector<DmxBuffer> &universes);
+  void CombinedControl(const PixelConverter &converter,
+                       const std::vector<DmxBuffer> &universes);
+  uint8_t *CheckoutPixels(const PixelConverter &converter);
 
   // RDM methods
   ola::rdm::RDMResponse *GetDeviceInfo(
@@ -172,8 +229,11 @@ class SPIOutput: public ola::rdm::DiscoverableRDMControllerInterface {
       const ola::rdm::RDMRequest *request);
 
   // Helpers
-  uint8_t P9813CreateFlag(uint8_t red, uint8_t green, uint8_t blue);
-  static uint8_t CalculateAPA102LatchBytes(uint16_t pixel_count);
+  unsigned int StartFrameBytes(const PixelConverter &converter) const;
+  unsigned int LatchBytes(const PixelConverter &converter) const;
+  unsigned int AvailableSlots(const DmxBuffer &buffer) const;
+  unsigned int TotalPixelCount() const;
+  static unsigned int CalculateAPA102LatchBytes(unsigned int pixel_count);
 
   static const uint8_t SPI_MODE;
   static const uint8_t SPI_BITS_PER_WORD;
@@ -182,9 +242,9 @@ class SPIOutput: public ola::rdm::DiscoverableRDMControllerInterface {
   static const uint16_t WS2801_SLOTS_PER_PIXEL;
   static const uint16_t LPD8806_SLOTS_PER_PIXEL;
   static const uint16_t P9813_SLOTS_PER_PIXEL;
-  static const uint16_t P9813_SPI_BYTES_PER_PIXEL;
+  static const uint16_t P9813_START_FRAME_BYTES;
+  static const uint16_t P9813_END_FRAME_BYTES;
   static const uint16_t APA102_SLOTS_PER_PIXEL;
-  static const uint16_t APA102_SPI_BYTES_PER_PIXEL;
   static const uint16_t APA102_START_FRAME_BYTES;
 
   static const ola::rdm::ResponderOps<SPIOutput>::ParamHandler
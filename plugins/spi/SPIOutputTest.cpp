@@ -22,8 +22,10 @@
 #include <string>
 
 #include "ola/base/Array.h"
+#include "ola/Clock.h"
 #include "ola/DmxBuffer.h"
 #include "ola/Logging.h"
+#include "ola/io/SelectServer.h"
 #include "ola/rdm/UID.h"
 #include "ola/testing/TestUtils.h"
 #include "plugins/spi/SPIBackend.h"
@@ -47,6 +49,10 @@ class SPIOutputTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testCombinedP9813Control);
   CPPUNIT_TEST(testIndividualAPA102Control);
   CPPUNIT_TEST(testCombinedAPA102Control);
+  CPPUNIT_TEST(testMultipleUniverses);
+  CPPUNIT_TEST(testCombinedMultipleUniverses);
+  CPPUNIT_TEST(testFrameTimeout);
+  CPPUNIT_TEST(testBrightnessAndGamma);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -65,6 +71,10 @@ class SPIOutputTest: public CppUnit::TestFixture {
   void testCombinedP9813Control();
   void testIndividualAPA102Control();
   void testCombinedAPA102Control();
+  void testMultipleUniverses();
+  void testCombinedMultipleUniverses();
+  void testFrameTimeout();
+  void testBrightnessAndGamma();
 
  private:
   UID m_uid;
@@ -738,3 +748,168 @@ void SPIOutputTest::testCombinedAPA102Control() {
   // check if the output writes are 1
   OLA_ASSERT_EQ(1u, backend.Writes(1));
 }
+
+
+/**
+ * Test an output which spans more than one universe.
+ */
+void SPIOutputTest::testMultipleUniverses() {
+  FakeSPIBackend backend(1);
+  SPIOutput::Options options(0, "Test SPI Device");
+  options.pixel_count = 2;
+  options.universe_count = 3;
+  SPIOutput output(m_uid, &backend, options);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(3), output.UniverseCount());
+  OLA_ASSERT_EQ(
+      string("Output 0, WS2801 Individual Control, 6 slots @ 1 in each of 3"
+             " universes. (707a:00000000)"),
+      output.Description());
+
+  DmxBuffer buffer;
+  unsigned int length = 0;
+  const uint8_t *data = NULL;
+
+  // Nothing is sent until all universes have arrived, in any order.
+  buffer.SetFromString("1,2,3,4,5,6");
+  OLA_ASSERT_TRUE(output.WriteDMX(0, buffer));
+  buffer.SetFromString("13,14,15,16,17,18");
+  OLA_ASSERT_TRUE(output.WriteDMX(2, buffer));
+  OLA_ASSERT_EQ(0u, backend.Writes(0));
+
+  buffer.SetFromString("7,8,9,10,11,12");
+  OLA_ASSERT_TRUE(output.WriteDMX(1, buffer));
+  OLA_ASSERT_EQ(1u, backend.Writes(0));
+  data = backend.GetData(0, &length);
+  const uint8_t EXPECTED0[] = {
+    1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18
+  };
+  OLA_ASSERT_DATA_EQUALS(EXPECTED0, arraysize(EXPECTED0), data, length);
+  OLA_ASSERT_EQ(0u, output.IncompleteFrames());
+
+  // Invalid universe
+  OLA_ASSERT_FALSE(output.WriteDMX(3, buffer));
+
+  // If a universe repeats, the incomplete frame is sent.
+  buffer.SetFromString("20,21,22");
+  output.WriteDMX(0, buffer);
+  OLA_ASSERT_EQ(1u, backend.Writes(0));
+  buffer.SetFromString("30,31,32");
+  output.WriteDMX(0, buffer);
+  OLA_ASSERT_EQ(2u, backend.Writes(0));
+  OLA_ASSERT_EQ(1u, output.IncompleteFrames());
+  data = backend.GetData(0, &length);
+  const uint8_t EXPECTED1[] = {
+    20, 21, 22, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18
+  };
+  OLA_ASSERT_DATA_EQUALS(EXPECTED1, arraysize(EXPECTED1), data, length);
+
+  // Complete the new frame
+  buffer.SetFromString("40,41,42,43,44,45");
+  output.WriteDMX(1, buffer);
+  output.WriteDMX(2, buffer);
+  OLA_ASSERT_EQ(3u, backend.Writes(0));
+  data = backend.GetData(0, &length);
+  const uint8_t EXPECTED2[] = {
+    30, 31, 32, 4, 5, 6, 40, 41, 42, 43, 44, 45, 40, 41, 42, 43, 44, 45
+  };
+  OLA_ASSERT_DATA_EQUALS(EXPECTED2, arraysize(EXPECTED2), data, length);
+}
+
+
+/**
+ * Test the combined personalities with more than one universe.
+ */
+void SPIOutputTest::testCombinedMultipleUniverses() {
+  FakeSPIBackend backend(1);
+  SPIOutput::Options options(0, "Test SPI Device");
+  options.pixel_count = 2;
+  options.universe_count = 2;
+  SPIOutput output(m_uid, &backend, options);
+  output.SetPersonality(8);
+
+  DmxBuffer buffer;
+  unsigned int length = 0;
+  const uint8_t *data = NULL;
+
+  buffer.SetFromString("1,2,3");
+  output.WriteDMX(0, buffer);
+  buffer.SetFromString("4,5,6");
+  output.WriteDMX(1, buffer);
+  OLA_ASSERT_EQ(1u, backend.Writes(0));
+
+  // Start frame, 4 pixels & the latch byte.
+  data = backend.GetData(0, &length);
+  const uint8_t EXPECTED[] = {
+    0, 0, 0, 0,
+    0xff, 3, 2, 1, 0xff, 3, 2, 1,
+    0xff, 6, 5, 4, 0xff, 6, 5, 4,
+    0
+  };
+  OLA_ASSERT_DATA_EQUALS(EXPECTED, arraysize(EXPECTED), data, length);
+}
+
+
+/**
+ * Check that incomplete frames are sent once the timeout expires.
+ */
+void SPIOutputTest::testFrameTimeout() {
+  ola::MockClock clock;
+  ola::io::SelectServer ss(NULL, &clock);
+  FakeSPIBackend backend(1);
+  SPIOutput::Options options(0, "Test SPI Device");
+  options.pixel_count = 1;
+  options.universe_count = 2;
+  options.frame_timeout = 30;
+  SPIOutput output(m_uid, &backend, options, &ss);
+
+  DmxBuffer buffer;
+  buffer.SetFromString("1,2,3");
+  output.WriteDMX(1, buffer);
+
+  clock.AdvanceTime(0, 20000);
+  ss.RunOnce(ola::TimeInterval(0, 0));
+  OLA_ASSERT_EQ(0u, backend.Writes(0));
+
+  clock.AdvanceTime(0, 20000);
+  ss.RunOnce(ola::TimeInterval(0, 0));
+  OLA_ASSERT_EQ(1u, backend.Writes(0));
+  OLA_ASSERT_EQ(1u, output.IncompleteFrames());
+
+  unsigned int length = 0;
+  const uint8_t *data = backend.GetData(0, &length);
+  const uint8_t EXPECTED[] = {0, 0, 0, 1, 2, 3};
+  OLA_ASSERT_DATA_EQUALS(EXPECTED, arraysize(EXPECTED), data, length);
+
+  // A complete frame cancels the timeout.
+  output.WriteDMX(0, buffer);
+  output.WriteDMX(1, buffer);
+  OLA_ASSERT_EQ(2u, backend.Writes(0));
+  clock.AdvanceTime(0, 40000);
+  ss.RunOnce(ola::TimeInterval(0, 0));
+  OLA_ASSERT_EQ(2u, backend.Writes(0));
+  OLA_ASSERT_EQ(1u, output.IncompleteFrames());
+}
+
+
+/**
+ * Check the brightness & gamma options are applied to the pixels.
+ */
+void SPIOutputTest::testBrightnessAndGamma() {
+  FakeSPIBackend backend(1);
+  SPIOutput::Options options(0, "Test SPI Device");
+  options.pixel_count = 1;
+  options.brightness = 128;
+  options.gamma = 20;
+  SPIOutput output(m_uid, &backend, options);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(128), output.Brightness());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(20), output.Gamma());
+
+  DmxBuffer buffer;
+  buffer.SetFromString("255,128,0");
+  output.WriteDMX(buffer);
+
+  unsigned int length = 0;
+  const uint8_t *data = backend.GetData(0, &length);
+  const uint8_t EXPECTED[] = {128, 32, 0};
+  OLA_ASSERT_DATA_EQUALS(EXPECTED, arraysize(EXPECTED), data, length);
+}
@@ -164,20 +164,39 @@ string SPIPlugin::Description() const {
 "the SPI data is written when any port changes. This can result in a lot of\n"
 "data writes (slow) and partial frames. If set to -2, the last port is used.\n"
 "\n"
+"<device>-frame-timeout = <int>\n"
+"For ports which span more than one universe, how long to wait in ms for\n"
+"the rest of the universes in a frame to arrive before sending the data.\n"
+"\n"
 "--- Per Port Settings ---\n"
 "Ports are indexed from 0.\n"
 "\n"
 "<device>-<port>-dmx-address = <int>\n"
 "The DMX address to use. e.g. spidev0.1-0-dmx-address = 1\n"
 "\n"
+"<device>-<port>-brightness = <int>\n"
+"The brightness of the pixels, from 0 to 255. 255 is full brightness.\n"
+"\n"
 "<device>-<port>-device-label = <string>\n"
 "The RDM device label to use.\n"
 "\n"
+"<device>-<port>-gamma = <int>\n"
+"The gamma correction to apply, in tenths. e.g. 22 is a gamma of 2.2. The\n"
+"default of 10 means no correction.\n"
+"\n"
 "<device>-<port>-personality = <int>\n"
 "The RDM personality to use.\n"
 "\n"
 "<device>-<port>-pixel-count = <int>\n"
 "The number of pixels for this port. e.g. spidev0.1-1-pixel-count = 20.\n"
+"If the port uses more than one universe, this is the number of pixels in\n"
+"each universe.\n"
+"\n"
+"<device>-<port>-universe-count = <int>\n"
+"The number of universes used by this port, from 1 to 32. Each universe is\n"
+"patched to its own OLA port and fills the next section of the string. The\n"
+"data is sent in a single SPI transfer once every universe has been\n"
+"received.\n"
 "\n";
 }
 
@@ -18,6 +18,7 @@
  * Copyright (C) 2013 Simon Newton
  */
 
+#include <sstream>
 #include <string>
 #include "ola/Constants.h"
 #include "ola/rdm/RDMCommand.h"
@@ -36,61 +37,76 @@ using ola::rdm::RDMRequest;
 using ola::rdm::UID;
 using std::string;
 
-SPIOutputPort::SPIOutputPort(SPIDevice *parent, SPIBackendInterface *backend,
-                             const UID &uid,
-                             const SPIOutput::Options &options)
-    : BasicOutputPort(parent, options.output_number, true),
-      m_spi_output(uid, backend, options) {
+SPIOutputPort::SPIOutputPort(SPIDevice *parent, unsigned int port_id,
+                             SPIOutput *output, uint8_t universe)
+    : BasicOutputPort(parent, port_id, universe == 0),
+      m_spi_output(output),
+      m_universe(universe) {
 }
 
 
 string SPIOutputPort::GetDeviceLabel() const {
-  return m_spi_output.GetDeviceLabel();
+  return m_spi_output->GetDeviceLabel();
 }
 
 bool SPIOutputPort::SetDeviceLabel(const string &device_label) {
-  return m_spi_output.SetDeviceLabel(device_label);
+  return m_spi_output->SetDeviceLabel(device_label);
 }
 
 uint8_t SPIOutputPort::GetPersonality() const {
-  return m_spi_output.GetPersonality();
+  return m_spi_output->GetPersonality();
 }
 
 bool SPIOutputPort::SetPersonality(uint16_t personality) {
-  return m_spi_output.SetPersonality(personality);
+  return m_spi_output->SetPersonality(personality);
 }
 
 uint16_t SPIOutputPort::GetStartAddress() const {
-  return m_spi_output.GetStartAddress();
+  return m_spi_output->GetStartAddress();
 }
 
 bool SPIOutputPort::SetStartAddress(uint16_t address) {
-  return m_spi_output.SetStartAddress(address);
+  return m_spi_output->SetStartAddress(address);
 }
 
 unsigned int SPIOutputPort::PixelCount() const {
-  return m_spi_output.PixelCount();
+  return m_spi_output->PixelCount();
 }
 
 string SPIOutputPort::Description() const {
-  return m_spi_output.Description();
+  if (m_universe) {
+    std::ostringstream str;
+    str << "Output " << static_cast<int>(m_spi_output->OutputNumber())
+        << ", universe " << static_cast<int>(m_universe) + 1;
+    return str.str();
+  }
+  return m_spi_output->Description();
 }
 
 bool SPIOutputPort::WriteDMX(const DmxBuffer &buffer, uint8_t) {
-  return m_spi_output.WriteDMX(buffer);
+  return m_spi_output->WriteDMX(m_universe, buffer);
 }
 
 void SPIOutputPort::RunFullDiscovery(RDMDiscoveryCallback *callback) {
-  return m_spi_output.RunFullDiscovery(callback);
+  if (m_universe) {
+    return BasicOutputPort::RunFullDiscovery(callback);
+  }
+  return m_spi_output->RunFullDiscovery(callback);
 }
 
 void SPIOutputPort::RunIncrementalDiscovery(RDMDiscoveryCallback *callback) {
-  return m_spi_output.RunIncrementalDiscovery(callback);
+  if (m_universe) {
+    return BasicOutputPort::RunIncrementalDiscovery(callback);
+  }
+  return m_spi_output->RunIncrementalDiscovery(callback);
 }
 
 void SPIOutputPort::SendRDMRequest(ola::rdm::RDMRequest *request,
                                    ola::rdm::RDMCallback *callback) {
-  return m_spi_output.SendRDMRequest(request, callback);
+  if (m_universe) {
+    return BasicOutputPort::SendRDMRequest(request, callback);
+  }
+  return m_spi_output->SendRDMRequest(request, callback);
 }
 }  // namespace spi
 }  // namespace plugin
@@ -33,8 +33,16 @@ namespace spi {
 
 class SPIOutputPort: public BasicOutputPort {
  public:
-  SPIOutputPort(SPIDevice *parent, class SPIBackendInterface *backend,
-                const ola::rdm::UID &uid, const SPIOutput::Options &options);
+  /**
+   * @brief Create a new SPIOutputPort.
+   * @param parent the SPIDevice this port belongs to.
+   * @param port_id the id of the port.
+   * @param output the SPIOutput to write to, ownership is not transferred.
+   * @param universe the index of the universe within the SPIOutput. Only
+   *   the port for the first universe handles RDM.
+   */
+  SPIOutputPort(SPIDevice *parent, unsigned int port_id, SPIOutput *output,
+                uint8_t universe);
   ~SPIOutputPort() {}
 
   std::string GetDeviceLabel() const;
@@ -54,7 +62,8 @@ class SPIOutputPort: public BasicOutputPort {
                       ola::rdm::RDMCallback *callback);
 
  private:
-  SPIOutput m_spi_output;
+  SPIOutput *m_spi_output;
+  const uint8_t m_universe;
 };
 }  // namespace spi
 }  // namespace plugin
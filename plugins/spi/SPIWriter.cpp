@@ -26,11 +26,14 @@
 #include <string.h>
 #include <sys/ioctl.h>
 
+#include <algorithm>
+#include <fstream>
 #include <numeric>
 #include <sstream>
 #include <string>
 #include "ola/io/IOUtils.h"
 #include "ola/Logging.h"
+#include "ola/StringUtils.h"
 #include "ola/network/SocketCloser.h"
 #include "plugins/spi/SPIWriter.h"
 
@@ -46,6 +49,9 @@ const uint8_t SPIWriter::SPI_MODE = 0;
 const char SPIWriter::SPI_DEVICE_KEY[] = "device";
 const char SPIWriter::SPI_ERROR_VAR[] = "spi-write-errors";
 const char SPIWriter::SPI_WRITE_VAR[] = "spi-writes";
+const unsigned int SPIWriter::DEFAULT_MAX_MESSAGE_SIZE;
+const char SPIWriter::SPIDEV_BUFSIZ_FILE[] =
+    "/sys/module/spidev/parameters/bufsiz";
 
 SPIWriter::SPIWriter(const string &spi_device,
                      const Options &options,
@@ -53,6 +59,10 @@ SPIWriter::SPIWriter(const string &spi_device,
     : m_device_path(spi_device),
       m_spi_speed(options.spi_speed),
       m_cs_enable_high(options.cs_enable_high),
+      m_detect_message_size(options.max_message_size == 0),
+      m_max_message_size(options.max_message_size ?
+                         options.max_message_size :
+                         DEFAULT_MAX_MESSAGE_SIZE),
       m_fd(-1),
       m_error_map_var(NULL),
       m_write_map_var(NULL) {
@@ -100,30 +110,63 @@ bool SPIWriter::Init() {
     OLA_WARN << "Failed to set SPI_IOC_WR_MAX_SPEED_HZ for " << m_device_path;
     return false;
   }
+  if (m_detect_message_size) {
+    m_max_message_size = SPIDevBufferSize();
+  }
+  OLA_DEBUG << "Max SPI message size for " << m_device_path << " is "
+            << m_max_message_size;
+
   m_fd = closer.Release();
   return true;
 }
 
 bool SPIWriter::WriteSPIData(const uint8_t *data, unsigned int length) {
+  if (m_write_map_var) {
+    (*m_write_map_var)[m_device_path]++;
+  }
+
+  unsigned int offset = 0;
+  do {
+    const unsigned int chunk_length = std::min(length - offset,
+                                               m_max_message_size);
+    if (!WriteSPIMessage(data + offset, chunk_length)) {
+      if (m_error_map_var) {
+        (*m_error_map_var)[m_device_path]++;
+      }
+      return false;
+    }
+    offset += chunk_length;
+  } while (offset < length);
+  return true;
+}
+
+bool SPIWriter::WriteSPIMessage(const uint8_t *data, unsigned int length) {
   struct spi_ioc_transfer spi;
   memset(&spi, 0, sizeof(spi));
   spi.tx_buf = reinterpret_cast<__u64>(data);
   spi.len = length;
 
-  if (m_write_map_var) {
-    (*m_write_map_var)[m_device_path]++;
-  }
-
   int bytes_written = ioctl(m_fd, SPI_IOC_MESSAGE(1), &spi);
   if (bytes_written != static_cast<int>(length)) {
     OLA_WARN << "Failed to write all the SPI data: " << strerror(errno);
-    if (m_error_map_var) {
-      (*m_error_map_var)[m_device_path]++;
-    }
     return false;
   }
   return true;
 }
+
+/*
+ * The spidev driver limits the size of each message to bufsiz bytes.
+ */
+unsigned int SPIWriter::SPIDevBufferSize() const {
+  std::ifstream file(SPIDEV_BUFSIZ_FILE);
+  string line;
+  unsigned int bufsiz;
+  if (file.is_open() && std::getline(file, line) &&
+      StringToInt(line, &bufsiz, true) && bufsiz) {
+    return bufsiz;
+  }
+  return DEFAULT_MAX_MESSAGE_SIZE;
+}
 }  // namespace spi
 }  // namespace plugin
 }  // namespace ola
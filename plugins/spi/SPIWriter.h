@@ -53,8 +53,17 @@ class SPIWriter : public SPIWriterInterface {
   struct Options {
     uint32_t spi_speed;
     bool cs_enable_high;
+    /*
+     * The maximum number of bytes in a single SPI message. If 0, the bufsiz
+     * of the spidev module is used.
+     */
+    unsigned int max_message_size;
 
-    Options() : spi_speed(1000000), cs_enable_high(false) {}
+    Options()
+        : spi_speed(1000000),
+          cs_enable_high(false),
+          max_message_size(0) {
+    }
   };
 
   SPIWriter(const std::string &spi_device, const Options &options,
@@ -69,12 +78,29 @@ class SPIWriter : public SPIWriterInterface {
    */
   bool Init();
 
+  /**
+   * @brief Write data to the SPI device.
+   *
+   * The spidev driver limits each message to bufsiz bytes, so larger frames
+   * are written as a number of messages.
+   */
   bool WriteSPIData(const uint8_t *data, unsigned int length);
 
+  static const unsigned int DEFAULT_MAX_MESSAGE_SIZE = 4096;
+
+ protected:
+  /**
+   * @brief Write a single SPI message, of at most the max message size.
+   * @returns true if all the data was written.
+   */
+  virtual bool WriteSPIMessage(const uint8_t *data, unsigned int length);
+
  private:
   const std::string m_device_path;
   const uint32_t m_spi_speed;
   const bool m_cs_enable_high;
+  const bool m_detect_message_size;
+  unsigned int m_max_message_size;
   int m_fd;
   UIntMap *m_error_map_var;
   UIntMap *m_write_map_var;
@@ -84,6 +110,9 @@ class SPIWriter : public SPIWriterInterface {
   static const char SPI_DEVICE_KEY[];
   static const char SPI_ERROR_VAR[];
   static const char SPI_WRITE_VAR[];
+  static const char SPIDEV_BUFSIZ_FILE[];
+
+  unsigned int SPIDevBufferSize() const;
 };
 }  // namespace spi
 }  // namespace plugin
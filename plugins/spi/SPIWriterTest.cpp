@@ -0,0 +1,144 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * SPIWriterTest.cpp
+ * Test fixture for the SPIWriter message splitting.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+#include <vector>
+
+#include "ola/ExportMap.h"
+#include "ola/testing/TestUtils.h"
+#include "plugins/spi/SPIWriter.h"
+
+using ola::ExportMap;
+using ola::UIntMap;
+using ola::plugin::spi::SPIWriter;
+using std::string;
+using std::vector;
+
+namespace {
+
+/*
+ * Records each SPI message rather than writing it to a device.
+ */
+class MessageRecordingWriter : public SPIWriter {
+ public:
+  MessageRecordingWriter(const Options &options, ExportMap *export_map)
+      : SPIWriter("/dev/spidev0.0", options, export_map),
+        m_fail_after(-1) {
+  }
+
+  // Fail the message after this many have been written.
+  void FailAfter(int messages) { m_fail_after = messages; }
+
+  vector<const uint8_t*> data;
+  vector<unsigned int> lengths;
+
+ protected:
+  bool WriteSPIMessage(const uint8_t *message, unsigned int length) {
+    if (m_fail_after == static_cast<int>(lengths.size())) {
+      return false;
+    }
+    data.push_back(message);
+    lengths.push_back(length);
+    return true;
+  }
+
+ private:
+  int m_fail_after;
+};
+}  // namespace
+
+class SPIWriterTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(SPIWriterTest);
+  CPPUNIT_TEST(testSingleMessage);
+  CPPUNIT_TEST(testSplitMessages);
+  CPPUNIT_TEST(testWriteFailure);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void setUp() {
+    m_options.max_message_size = 32;
+  }
+
+  void testSingleMessage();
+  void testSplitMessages();
+  void testWriteFailure();
+
+ private:
+  SPIWriter::Options m_options;
+  uint8_t m_data[100];
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SPIWriterTest);
+
+
+/*
+ * Check that frames up to the max message size are sent in one message.
+ */
+void SPIWriterTest::testSingleMessage() {
+  MessageRecordingWriter writer(m_options, NULL);
+  OLA_ASSERT_TRUE(writer.WriteSPIData(m_data, 10));
+  OLA_ASSERT_TRUE(writer.WriteSPIData(m_data, 32));
+
+  OLA_ASSERT_EQ(static_cast<size_t>(2), writer.lengths.size());
+  OLA_ASSERT_EQ(static_cast<const uint8_t*>(m_data), writer.data[0]);
+  OLA_ASSERT_EQ(10u, writer.lengths[0]);
+  OLA_ASSERT_EQ(static_cast<const uint8_t*>(m_data), writer.data[1]);
+  OLA_ASSERT_EQ(32u, writer.lengths[1]);
+}
+
+
+/*
+ * Check that larger frames are split into max message size messages.
+ */
+void SPIWriterTest::testSplitMessages() {
+  ExportMap export_map;
+  MessageRecordingWriter writer(m_options, &export_map);
+  OLA_ASSERT_TRUE(writer.WriteSPIData(m_data, 100));
+
+  // 32 | 32 | 32 | 4
+  OLA_ASSERT_EQ(static_cast<size_t>(4), writer.lengths.size());
+  for (unsigned int i = 0; i < 3; i++) {
+    OLA_ASSERT_EQ(static_cast<const uint8_t*>(m_data + 32 * i),
+                  writer.data[i]);
+    OLA_ASSERT_EQ(32u, writer.lengths[i]);
+  }
+  OLA_ASSERT_EQ(static_cast<const uint8_t*>(m_data + 96), writer.data[3]);
+  OLA_ASSERT_EQ(4u, writer.lengths[3]);
+
+  // A frame is counted as a single write.
+  UIntMap *writes = export_map.GetUIntMapVar("spi-writes");
+  OLA_ASSERT_EQ(1u, (*writes)["/dev/spidev0.0"]);
+}
+
+
+/*
+ * Check that a failed message stops the rest of the frame being written.
+ */
+void SPIWriterTest::testWriteFailure() {
+  ExportMap export_map;
+  MessageRecordingWriter writer(m_options, &export_map);
+  writer.FailAfter(1);
+  OLA_ASSERT_FALSE(writer.WriteSPIData(m_data, 100));
+
+  OLA_ASSERT_EQ(static_cast<size_t>(1), writer.lengths.size());
+  UIntMap *errors = export_map.GetUIntMapVar("spi-write-errors");
+  OLA_ASSERT_EQ(1u, (*errors)["/dev/spidev0.0"]);
+}
@@ -0,0 +1,115 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * TripleBuffer.cpp
+ * Hand frames from one thread to another without locking.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#include <string.h>
+#include <algorithm>
+#include "plugins/spi/TripleBuffer.h"
+
+namespace ola {
+namespace plugin {
+namespace spi {
+
+TripleBuffer::TripleBuffer()
+    : m_back(0),
+      m_front(1),
+      m_middle(2) {
+  for (unsigned int i = 0; i < BUFFER_COUNT; i++) {
+    m_buffers[i].data = NULL;
+    m_buffers[i].size = 0;
+    m_buffers[i].capacity = 0;
+  }
+}
+
+TripleBuffer::~TripleBuffer() {
+  for (unsigned int i = 0; i < BUFFER_COUNT; i++) {
+    delete[] m_buffers[i].data;
+  }
+}
+
+uint8_t *TripleBuffer::Resize(unsigned int size) {
+  Resize(&m_buffers[m_back], size);
+  return m_buffers[m_back].data;
+}
+
+bool TripleBuffer::Publish(const TimeStamp &now) {
+  const Buffer &published = m_buffers[m_back];
+  m_buffers[m_back].published = now;
+  const unsigned int old_middle = Exchange(&m_middle, m_back | NEW_FRAME);
+  m_back = old_middle & INDEX_MASK;
+
+  // The consumer only ever reads the published buffer, so it's safe to copy
+  // from it even if it's been acquired already.
+  Buffer *back = &m_buffers[m_back];
+  Resize(back, published.size);
+  if (published.size) {
+    memcpy(back->data, published.data, published.size);
+  }
+  return old_middle & NEW_FRAME;
+}
+
+bool TripleBuffer::HasNewFrame() const {
+  return __sync_fetch_and_add(const_cast<unsigned int*>(&m_middle), 0) &
+      NEW_FRAME;
+}
+
+bool TripleBuffer::Acquire() {
+  if (!HasNewFrame()) {
+    return false;
+  }
+  // Only the consumer clears NEW_FRAME, so the exchange always returns a new
+  // frame.
+  m_front = Exchange(&m_middle, m_front) & INDEX_MASK;
+  return true;
+}
+
+void TripleBuffer::Resize(Buffer *buffer, unsigned int size) {
+  if (size > buffer->capacity) {
+    uint8_t *data = new uint8_t[size];
+    if (buffer->size) {
+      memcpy(data, buffer->data, buffer->size);
+    }
+    delete[] buffer->data;
+    buffer->data = data;
+    buffer->capacity = size;
+  }
+  if (size > buffer->size) {
+    memset(buffer->data + buffer->size, 0, size - buffer->size);
+  }
+  buffer->size = size;
+}
+
+/*
+ * An atomic exchange, with a full memory barrier.
+ */
+unsigned int TripleBuffer::Exchange(unsigned int *value,
+                                    unsigned int new_value) {
+  unsigned int old_value = *value;
+  while (true) {
+    const unsigned int actual = __sync_val_compare_and_swap(value, old_value,
+                                                            new_value);
+    if (actual == old_value) {
+      return old_value;
+    }
+    old_value = actual;
+  }
+}
+}  // namespace spi
+}  // namespace plugin
+}  // namespace ola
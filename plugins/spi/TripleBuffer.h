@@ -0,0 +1,137 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * TripleBuffer.h
+ * Hand frames from one thread to another without locking.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#ifndef PLUGINS_SPI_TRIPLEBUFFER_H_
+#define PLUGINS_SPI_TRIPLEBUFFER_H_
+
+#include <stdint.h>
+#include "ola/Clock.h"
+#include "ola/base/Macro.h"
+
+namespace ola {
+namespace plugin {
+namespace spi {
+
+/**
+ * @brief A single producer, single consumer triple buffer.
+ *
+ * The producer owns the back buffer, the consumer owns the front buffer and
+ * the third buffer holds the most recently published frame. Publish() and
+ * Acquire() swap buffers with an atomic exchange, so neither side ever waits
+ * for the other. If the producer publishes faster than the consumer can
+ * keep up, the unread frame is replaced and Publish() reports the drop.
+ *
+ * After each Publish() the back buffer is refreshed with the frame that was
+ * just published, so the producer can update part of a frame and leave the
+ * rest as it was.
+ *
+ * The buffers are only reallocated when they need to grow.
+ */
+class TripleBuffer {
+ public:
+  TripleBuffer();
+  ~TripleBuffer();
+
+  // Producer methods
+
+  /**
+   * @brief Resize the back buffer.
+   * @param size the new size.
+   * @returns the back buffer. The existing data is kept, any new bytes are
+   *   set to 0.
+   */
+  uint8_t *Resize(unsigned int size);
+
+  /**
+   * @brief Return the back buffer.
+   */
+  uint8_t *Back() { return m_buffers[m_back].data; }
+
+  /**
+   * @brief The size of the back buffer.
+   */
+  unsigned int BackSize() const { return m_buffers[m_back].size; }
+
+  /**
+   * @brief Make the back buffer available to the consumer.
+   * @param now the time the frame was published.
+   * @returns true if this replaced a frame the consumer hadn't acquired yet.
+   */
+  bool Publish(const TimeStamp &now);
+
+  // Consumer methods
+
+  /**
+   * @brief Check if there is a new frame.
+   */
+  bool HasNewFrame() const;
+
+  /**
+   * @brief Take the most recently published frame.
+   * @returns true if there was a new frame, false otherwise. If false is
+   *   returned the front buffer is unchanged.
+   */
+  bool Acquire();
+
+  /**
+   * @brief The front buffer.
+   */
+  const uint8_t *Front() const { return m_buffers[m_front].data; }
+
+  /**
+   * @brief The size of the front buffer.
+   */
+  unsigned int FrontSize() const { return m_buffers[m_front].size; }
+
+  /**
+   * @brief The time the front buffer was published.
+   */
+  const TimeStamp &FrontPublishTime() const {
+    return m_buffers[m_front].published;
+  }
+
+ private:
+  struct Buffer {
+    uint8_t *data;
+    unsigned int size;
+    unsigned int capacity;
+    TimeStamp published;
+  };
+
+  enum { BUFFER_COUNT = 3 };
+
+  Buffer m_buffers[BUFFER_COUNT];
+  unsigned int m_back;  // only used by the producer
+  unsigned int m_front;  // only used by the consumer
+  // The index of the middle buffer, combined with the NEW_FRAME flag.
+  unsigned int m_middle;
+
+  static void Resize(Buffer *buffer, unsigned int size);
+  static unsigned int Exchange(unsigned int *value, unsigned int new_value);
+
+  static const unsigned int INDEX_MASK = 0x3;
+  static const unsigned int NEW_FRAME = 0x4;
+
+  DISALLOW_COPY_AND_ASSIGN(TripleBuffer);
+};
+}  // namespace spi
+}  // namespace plugin
+}  // namespace ola
+#endif  // PLUGINS_SPI_TRIPLEBUFFER_H_
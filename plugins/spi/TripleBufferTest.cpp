@@ -0,0 +1,200 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * TripleBufferTest.cpp
+ * Test fixture for the TripleBuffer.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#include <string.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "ola/Clock.h"
+#include "ola/base/Array.h"
+#include "ola/testing/TestUtils.h"
+#include "ola/thread/Thread.h"
+#include "plugins/spi/TripleBuffer.h"
+
+using ola::TimeStamp;
+using ola::plugin::spi::TripleBuffer;
+
+namespace {
+
+/*
+ * Acquires frames as fast as possible, and checks that each frame is
+ * consistent and newer than the last.
+ */
+class Consumer : public ola::thread::Thread {
+ public:
+  Consumer(TripleBuffer *buffer, uint32_t last_frame)
+      : Thread(Thread::Options("triple-buffer-consumer")),
+        m_buffer(buffer),
+        m_last_frame(last_frame),
+        frames(0),
+        errors(0) {
+  }
+
+  void *Run() {
+    uint32_t previous = 0;
+    while (previous != m_last_frame) {
+      if (!m_buffer->Acquire()) {
+        continue;
+      }
+      frames++;
+      const uint8_t *data = m_buffer->Front();
+      uint32_t frame;
+      memcpy(&frame, data, sizeof(frame));
+      if (frame <= previous) {
+        errors++;
+      }
+      // The rest of the frame is filled with the low byte of the frame
+      // number.
+      for (unsigned int i = sizeof(frame); i < m_buffer->FrontSize(); i++) {
+        if (data[i] != (frame & 0xff)) {
+          errors++;
+          break;
+        }
+      }
+      previous = frame;
+    }
+    return NULL;
+  }
+
+ private:
+  TripleBuffer *m_buffer;
+  const uint32_t m_last_frame;
+
+ public:
+  unsigned int frames;
+  unsigned int errors;
+};
+}  // namespace
+
+
+class TripleBufferTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(TripleBufferTest);
+  CPPUNIT_TEST(testPublishAndAcquire);
+  CPPUNIT_TEST(testResize);
+  CPPUNIT_TEST(testThreaded);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void testPublishAndAcquire();
+  void testResize();
+  void testThreaded();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TripleBufferTest);
+
+
+/*
+ * Check frames are handed over & drops are reported.
+ */
+void TripleBufferTest::testPublishAndAcquire() {
+  TripleBuffer buffer;
+  TimeStamp now;
+  OLA_ASSERT_FALSE(buffer.HasNewFrame());
+  OLA_ASSERT_FALSE(buffer.Acquire());
+  OLA_ASSERT_EQ(0u, buffer.FrontSize());
+
+  uint8_t *data = buffer.Resize(4);
+  const uint8_t FRAME1[] = {1, 2, 3, 4};
+  memcpy(data, FRAME1, sizeof(FRAME1));
+  OLA_ASSERT_FALSE(buffer.Publish(now));
+  OLA_ASSERT_TRUE(buffer.HasNewFrame());
+
+  // The back buffer keeps the last frame.
+  OLA_ASSERT_DATA_EQUALS(FRAME1, arraysize(FRAME1), buffer.Back(),
+                         buffer.BackSize());
+
+  OLA_ASSERT_TRUE(buffer.Acquire());
+  OLA_ASSERT_FALSE(buffer.HasNewFrame());
+  OLA_ASSERT_DATA_EQUALS(FRAME1, arraysize(FRAME1), buffer.Front(),
+                         buffer.FrontSize());
+  OLA_ASSERT_FALSE(buffer.Acquire());
+
+  // Publish twice, the first frame is dropped
+  buffer.Back()[0] = 10;
+  OLA_ASSERT_FALSE(buffer.Publish(now));
+  buffer.Back()[1] = 20;
+  OLA_ASSERT_TRUE(buffer.Publish(now));
+
+  // The front buffer is untouched until the next Acquire()
+  OLA_ASSERT_DATA_EQUALS(FRAME1, arraysize(FRAME1), buffer.Front(),
+                         buffer.FrontSize());
+
+  OLA_ASSERT_TRUE(buffer.Acquire());
+  const uint8_t FRAME3[] = {10, 20, 3, 4};
+  OLA_ASSERT_DATA_EQUALS(FRAME3, arraysize(FRAME3), buffer.Front(),
+                         buffer.FrontSize());
+}
+
+
+/*
+ * Check that resizing keeps the data.
+ */
+void TripleBufferTest::testResize() {
+  TripleBuffer buffer;
+  TimeStamp now;
+
+  uint8_t *data = buffer.Resize(2);
+  data[0] = 1;
+  data[1] = 2;
+  data = buffer.Resize(4);
+  const uint8_t EXPECTED1[] = {1, 2, 0, 0};
+  OLA_ASSERT_DATA_EQUALS(EXPECTED1, arraysize(EXPECTED1), data,
+                         buffer.BackSize());
+  buffer.Publish(now);
+
+  // Shrink, then grow again within the capacity, the new bytes are zeroed.
+  data = buffer.Resize(1);
+  data = buffer.Resize(3);
+  const uint8_t EXPECTED2[] = {1, 0, 0};
+  OLA_ASSERT_DATA_EQUALS(EXPECTED2, arraysize(EXPECTED2), data,
+                         buffer.BackSize());
+  buffer.Publish(now);
+
+  OLA_ASSERT_TRUE(buffer.Acquire());
+  OLA_ASSERT_DATA_EQUALS(EXPECTED2, arraysize(EXPECTED2), buffer.Front(),
+                         buffer.FrontSize());
+}
+
+
+/*
+ * Publish frames from one thread and consume them in another.
+ */
+void TripleBufferTest::testThreaded() {
+  const uint32_t FRAME_COUNT = 50000;
+  TripleBuffer buffer;
+  Consumer consumer(&buffer, FRAME_COUNT);
+  OLA_ASSERT_TRUE(consumer.Start());
+
+  TimeStamp now;
+  unsigned int drops = 0;
+  for (uint32_t frame = 1; frame <= FRAME_COUNT; frame++) {
+    // Vary the size to exercise the resizing
+    uint8_t *data = buffer.Resize(sizeof(frame) + 16 + frame % 64);
+    memcpy(data, &frame, sizeof(frame));
+    memset(data + sizeof(frame), frame & 0xff,
+           buffer.BackSize() - sizeof(frame));
+    if (buffer.Publish(now)) {
+      drops++;
+    }
+  }
+  consumer.Join();
+
+  OLA_ASSERT_EQ(0u, consumer.errors);
+  OLA_ASSERT_EQ(FRAME_COUNT, consumer.frames + drops);
+}
@@ -0,0 +1,101 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * pixel_converter_loadtest.cpp
+ * Measure the rate the PixelConverter converts RGB data for each chip.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#include <stdint.h>
+
+#include <iostream>
+#include <vector>
+
+#include "ola/Clock.h"
+#include "ola/base/Array.h"
+#include "ola/base/Flags.h"
+#include "ola/base/Init.h"
+#include "plugins/spi/PixelConverter.h"
+
+using ola::Clock;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::plugin::spi::PixelConverter;
+using std::cout;
+using std::endl;
+using std::vector;
+
+DEFINE_s_uint32(frames, f, 20000, "The number of frames to convert");
+DEFINE_s_uint16(pixels, p, 170, "The number of pixels in each frame");
+DEFINE_s_uint8(brightness, b, 200, "The brightness to convert with");
+DEFINE_s_uint8(gamma, g, 22, "The gamma to convert with, in tenths");
+
+namespace {
+
+const char *ChipName(PixelConverter::Chip chip) {
+  switch (chip) {
+    case PixelConverter::WS2801:
+      return "WS2801";
+    case PixelConverter::LPD8806:
+      return "LPD8806";
+    case PixelConverter::P9813:
+      return "P9813";
+    case PixelConverter::APA102:
+      return "APA102";
+    default:
+      return "Unknown";
+  }
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  ola::AppInit(&argc, argv, "[options]",
+               "Measure the PixelConverter throughput for each chip.");
+
+  const PixelConverter::Chip CHIPS[] = {
+    PixelConverter::WS2801, PixelConverter::LPD8806,
+    PixelConverter::P9813, PixelConverter::APA102
+  };
+  const unsigned int pixel_count = FLAGS_pixels;
+
+  vector<uint8_t> rgb(pixel_count * PixelConverter::SLOTS_PER_PIXEL);
+  for (unsigned int i = 0; i < rgb.size(); i++) {
+    rgb[i] = i & 0xff;
+  }
+
+  Clock clock;
+  for (unsigned int i = 0; i < arraysize(CHIPS); i++) {
+    PixelConverter converter(CHIPS[i], FLAGS_brightness, FLAGS_gamma / 10.0);
+    vector<uint8_t> output(pixel_count * converter.BytesPerPixel());
+
+    TimeStamp start, end;
+    clock.CurrentTime(&start);
+    for (unsigned int j = 0; j < FLAGS_frames; j++) {
+      converter.Convert(&rgb[0], rgb.size(), &output[0], pixel_count);
+    }
+    clock.CurrentTime(&end);
+
+    TimeInterval duration = end - start;
+    cout << ChipName(CHIPS[i]) << ": converted " << FLAGS_frames
+         << " frames in " << duration;
+    if (duration.AsInt()) {
+      cout << ", " << static_cast<int64_t>(FLAGS_frames) * pixel_count *
+                      ola::USEC_IN_SECONDS / duration.AsInt()
+           << " pixels/s";
+    }
+    cout << endl;
+  }
+  return 0;
+}
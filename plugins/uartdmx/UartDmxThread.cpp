@@ -19,12 +19,12 @@
  * Copyright (C) 2014 Richard Ash
  */
 
-#include <math.h>
-#include <unistd.h>
 #include <string>
 #include "ola/Clock.h"
 #include "ola/Logging.h"
 #include "ola/StringUtils.h"
+#include "ola/thread/DmxFrameTimer.h"
+#include "ola/thread/Utils.h"
 #include "plugins/uartdmx/UartWidget.h"
 #include "plugins/uartdmx/UartDmxThread.h"
 
@@ -34,11 +34,14 @@ namespace uartdmx {
 
 UartDmxThread::UartDmxThread(UartWidget *widget, unsigned int breakt,
                              unsigned int malft)
-  : m_granularity(UNKNOWN),
+  : Thread(ola::thread::OutputThreadOptions("uart-dmx")),
     m_widget(widget),
     m_term(false),
     m_breakt(breakt),
-    m_malft(malft) {
+    m_malft(malft),
+    m_timer(widget->Description(),
+            ola::thread::DmxFrameTimer::Options(),
+            MutableSchedulingStatistics()) {
 }
 
 UartDmxThread::~UartDmxThread() {
@@ -72,9 +75,7 @@ bool UartDmxThread::WriteDMX(const DmxBuffer &buffer) {
  * The method called by the thread
  */
 void *UartDmxThread::Run() {
-  TimeStamp ts1, ts2;
-  Clock clock;
-  CheckTimeGranularity();
+  m_timer.CheckGranularity();
   DmxBuffer buffer;
 
   // Setup the widget
@@ -93,49 +94,27 @@ void *UartDmxThread::Run() {
       buffer.Set(m_buffer);
     }
 
+    m_timer.StartFrame();
+
     if (!m_widget->SetBreak(true))
       goto framesleep;
 
-    if (m_granularity == GOOD)
-      usleep(m_breakt);
+    m_timer.Break(m_breakt);
 
     if (!m_widget->SetBreak(false))
       goto framesleep;
 
-    if (m_granularity == GOOD)
-      usleep(DMX_MAB);
+    m_timer.MarkAfterBreak(DMX_MAB);
 
     if (!m_widget->Write(buffer))
       goto framesleep;
 
   framesleep:
-    // Sleep for the remainder of the DMX frame time
-    usleep(m_malft);
+    // Sleep for the mark after last frame
+    m_timer.Sleep(m_malft);
   }
   return NULL;
 }
-
-
-/**
- * Check the granularity of usleep.
- */
-void UartDmxThread::CheckTimeGranularity() {
-  TimeStamp ts1, ts2;
-  Clock clock;
-  /** If sleeping for 1ms takes longer than this, don't trust
-   * usleep for this session
-   */
-  const int threshold = 3;
-
-  clock.CurrentTime(&ts1);
-  usleep(1000);
-  clock.CurrentTime(&ts2);
-
-  TimeInterval interval = ts2 - ts1;
-  m_granularity = interval.InMilliSeconds() > threshold ? BAD : GOOD;
-  OLA_INFO << "Granularity for UART thread is "
-           << (m_granularity == GOOD ? "GOOD" : "BAD");
-}
 }  // namespace uartdmx
 }  // namespace plugin
 }  // namespace ola
@@ -22,7 +22,9 @@
 #ifndef PLUGINS_UARTDMX_UARTDMXTHREAD_H_
 #define PLUGINS_UARTDMX_UARTDMXTHREAD_H_
 
+#include "ola/Clock.h"
 #include "ola/DmxBuffer.h"
+#include "ola/thread/DmxFrameTimer.h"
 #include "ola/thread/Thread.h"
 
 namespace ola {
@@ -39,9 +41,6 @@ class UartDmxThread : public ola::thread::Thread {
   bool WriteDMX(const DmxBuffer &buffer);
 
  private:
-  enum TimerGranularity { UNKNOWN, GOOD, BAD };
-
-  TimerGranularity m_granularity;
   UartWidget *m_widget;
   bool m_term;
   unsigned int m_breakt;
@@ -49,8 +48,7 @@ class UartDmxThread : public ola::thread::Thread {
   DmxBuffer m_buffer;
   ola::thread::Mutex m_term_mutex;
   ola::thread::Mutex m_buffer_mutex;
-
-  void CheckTimeGranularity();
+  ola::thread::DmxFrameTimer m_timer;
 
   static const uint32_t DMX_MAB = 16;
 
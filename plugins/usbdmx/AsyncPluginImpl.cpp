@@ -46,6 +46,7 @@
 #include "plugins/usbdmx/GenericDevice.h"
 #include "plugins/usbdmx/JaRuleDevice.h"
 #include "plugins/usbdmx/JaRuleFactory.h"
+#include "plugins/usbdmx/PipelinedAsyncUsbSender.h"
 #include "plugins/usbdmx/ScanlimeFadecandy.h"
 #include "plugins/usbdmx/ScanlimeFadecandyFactory.h"
 #include "plugins/usbdmx/SunliteFactory.h"
@@ -96,7 +97,8 @@ AsyncPluginImpl::AsyncPluginImpl(PluginAdaptor *plugin_adaptor,
       m_debug_level(debug_level),
       m_preferences(preferences),
       m_widget_observer(this, plugin_adaptor),
-      m_usb_adaptor(NULL) {
+      m_usb_adaptor(NULL),
+      m_stats_timeout(ola::thread::INVALID_TIMEOUT) {
 }
 
 AsyncPluginImpl::~AsyncPluginImpl() {
@@ -134,6 +136,8 @@ bool AsyncPluginImpl::Start() {
   }
 
   m_agent.reset(agent.release());
+  m_stats_timeout = m_plugin_adaptor->RegisterRepeatingTimeout(
+      STATS_INTERVAL_MS, NewCallback(this, &AsyncPluginImpl::ExportStats));
   return true;
 }
 
@@ -142,6 +146,8 @@ bool AsyncPluginImpl::Stop() {
     return true;
   }
 
+  m_plugin_adaptor->RemoveTimeout(m_stats_timeout);
+  m_stats_timeout = ola::thread::INVALID_TIMEOUT;
   m_agent->HaltNotifications();
 
   // Now we're free to use m_device_map.
@@ -334,6 +340,17 @@ void AsyncPluginImpl::ShutdownDevice(Device *device, Future<void> *f) {
     f->Set();
   }
 }
+
+/*
+ * @brief Export the frame counts & rates of the pipelined senders.
+ * @returns true, so the repeating timeout keeps running.
+ *
+ * This is run within the main thread, every STATS_INTERVAL_MS.
+ */
+bool AsyncPluginImpl::ExportStats() {
+  PipelinedAsyncUsbSender::ExportStats(m_plugin_adaptor->GetExportMap());
+  return true;
+}
 }  // namespace usbdmx
 }  // namespace plugin
 }  // namespace ola
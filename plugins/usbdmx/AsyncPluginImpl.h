@@ -100,6 +100,7 @@ class AsyncPluginImpl: public PluginImplInterface, public WidgetObserver {
   ola::usb::AsyncronousLibUsbAdaptor *m_usb_adaptor;  // not owned
   WidgetFactories m_widget_factories;
   USBDeviceMap m_device_map;
+  ola::thread::timeout_id m_stats_timeout;
 
   void DeviceEvent(ola::usb::HotplugAgent::EventType event,
                    struct libusb_device *device);
@@ -109,6 +110,9 @@ class AsyncPluginImpl: public PluginImplInterface, public WidgetObserver {
   bool StartAndRegisterDevice(Widget *widget, Device *device);
 
   void ShutdownDevice(Device *device, ola::thread::Future<void> *f);
+  bool ExportStats();
+
+  static const unsigned int STATS_INTERVAL_MS = 1000;
 
   DISALLOW_COPY_AND_ASSIGN(AsyncPluginImpl);
 };
@@ -104,6 +104,15 @@ void AsyncUsbTransceiverBase::FillBulkTransfer(unsigned char endpoint,
                               length, &AsyncCallback, this, timeout);
 }
 
+void AsyncUsbTransceiverBase::FillBulkTransfer(struct libusb_transfer *transfer,
+                                               unsigned char endpoint,
+                                               unsigned char *buffer,
+                                               int length,
+                                               unsigned int timeout) {
+  m_adaptor->FillBulkTransfer(transfer, m_usb_handle, endpoint, buffer,
+                              length, &AsyncCallback, this, timeout);
+}
+
 void AsyncUsbTransceiverBase::FillInterruptTransfer(unsigned char endpoint,
                                                     unsigned char *buffer,
                                                     int length,
@@ -114,6 +114,16 @@ class AsyncUsbTransceiverBase {
   void FillBulkTransfer(unsigned char endpoint, unsigned char *buffer,
                         int length, unsigned int timeout);
 
+  /**
+   * @brief Fill a bulk transfer other than the default one.
+   *
+   * This is used by senders which have more than one transfer in flight.
+   * TransferComplete() will be called with the transfer once it completes.
+   */
+  void FillBulkTransfer(struct libusb_transfer *transfer,
+                        unsigned char endpoint, unsigned char *buffer,
+                        int length, unsigned int timeout);
+
   /**
    * @brief Fill an interrupt transfer.
    */
@@ -137,7 +147,7 @@ class AsyncUsbTransceiverBase {
   struct libusb_transfer *m_transfer;
 
   TransferState m_transfer_state;  // GUARDED_BY(m_mutex);
-  ola::thread::Mutex m_mutex;
+  mutable ola::thread::Mutex m_mutex;
 
  private:
   DISALLOW_COPY_AND_ASSIGN(AsyncUsbTransceiverBase);
@@ -26,6 +26,8 @@ plugins_usbdmx_libolausbdmxwidget_la_SOURCES = \
     plugins/usbdmx/Flags.cpp \
     plugins/usbdmx/JaRuleFactory.cpp \
     plugins/usbdmx/JaRuleFactory.h \
+    plugins/usbdmx/PipelinedAsyncUsbSender.cpp \
+    plugins/usbdmx/PipelinedAsyncUsbSender.h \
     plugins/usbdmx/ScanlimeFadecandy.cpp \
     plugins/usbdmx/ScanlimeFadecandy.h \
     plugins/usbdmx/ScanlimeFadecandyFactory.cpp \
@@ -82,6 +84,18 @@ plugins_usbdmx_libolausbdmx_la_CXXFLAGS = $(COMMON_CXXFLAGS) $(libusb_CFLAGS)
 plugins_usbdmx_libolausbdmx_la_LIBADD = \
     olad/plugin_api/libolaserverplugininterface.la \
     plugins/usbdmx/libolausbdmxwidget.la
+
+# TESTS
+##################################################
+test_programs += plugins/usbdmx/UsbDmxTester
+
+plugins_usbdmx_UsbDmxTester_SOURCES = \
+    plugins/usbdmx/PipelinedAsyncUsbSenderTest.cpp
+plugins_usbdmx_UsbDmxTester_CXXFLAGS = $(COMMON_TESTING_FLAGS) \
+                                       $(libusb_CFLAGS)
+plugins_usbdmx_UsbDmxTester_LDADD = $(COMMON_TESTING_LIBS) \
+                                    $(libusb_LIBS) \
+                                    plugins/usbdmx/libolausbdmxwidget.la
 endif
 
 EXTRA_DIST += plugins/usbdmx/README.md
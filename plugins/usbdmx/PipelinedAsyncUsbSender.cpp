@@ -0,0 +1,283 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * PipelinedAsyncUsbSender.cpp
+ * An Asynchronous DMX USB sender which keeps multiple frames in flight.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#include "plugins/usbdmx/PipelinedAsyncUsbSender.h"
+
+#include <algorithm>
+#include <set>
+#include <string>
+
+#include "libs/usb/LibUsbAdaptor.h"
+#include "ola/Logging.h"
+
+namespace ola {
+namespace plugin {
+namespace usbdmx {
+
+using ola::thread::Mutex;
+using ola::thread::MutexLocker;
+using ola::usb::LibUsbAdaptor;
+using std::string;
+
+namespace {
+
+// The senders that currently exist, used to export the stats.
+Mutex senders_mutex;
+std::set<PipelinedAsyncUsbSender*> senders;
+std::set<string> exported_senders;
+
+const char K_FRAMES_VAR[] = "usb-dmx-frames";
+const char K_DROPPED_FRAMES_VAR[] = "usb-dmx-dropped-frames";
+const char K_FRAME_RATE_VAR[] = "usb-dmx-frames-per-second";
+const char K_DEVICE_VAR_LABEL[] = "device";
+}  // namespace
+
+const unsigned int PipelinedAsyncUsbSender::DEFAULT_MAX_IN_FLIGHT;
+
+PipelinedAsyncUsbSender::PipelinedAsyncUsbSender(LibUsbAdaptor *adaptor,
+                                                 libusb_device *usb_device,
+                                                 const string &name,
+                                                 unsigned char endpoint,
+                                                 unsigned int timeout,
+                                                 unsigned int frame_size,
+                                                 unsigned int max_in_flight)
+    : AsyncUsbTransceiverBase(adaptor, usb_device),
+      m_name(name),
+      m_endpoint(endpoint),
+      m_timeout(timeout),
+      m_frame_size(frame_size),
+      m_in_flight(0),
+      m_disconnected(false),
+      m_shutting_down(false),
+      m_pending_tx(false),
+      m_frames_sent(0),
+      m_frames_dropped(0),
+      m_last_export_frames(0) {
+  for (unsigned int i = 0; i < std::max(max_in_flight, 1u); i++) {
+    Slot slot;
+    slot.transfer = m_adaptor->AllocTransfer(0);
+    slot.data = new uint8_t[m_frame_size];
+    slot.in_flight = false;
+    m_slots.push_back(slot);
+  }
+
+  MutexLocker locker(&senders_mutex);
+  senders.insert(this);
+}
+
+PipelinedAsyncUsbSender::~PipelinedAsyncUsbSender() {
+  {
+    MutexLocker locker(&senders_mutex);
+    senders.erase(this);
+  }
+
+  {
+    MutexLocker locker(&m_mutex);
+    m_shutting_down = true;
+    Slots::iterator iter = m_slots.begin();
+    for (; iter != m_slots.end(); ++iter) {
+      if (!iter->in_flight) {
+        continue;
+      }
+      // LIBUSB_ERROR_NOT_FOUND means the transfer has already completed, but
+      // the callback may still be waiting for m_mutex, so we have to wait for
+      // it. Only a disconnected device means the callback won't run.
+      if (m_adaptor->CancelTransfer(iter->transfer) == LIBUSB_ERROR_NO_DEVICE) {
+        iter->in_flight = false;
+        m_in_flight--;
+      }
+    }
+    while (m_in_flight) {
+      m_idle.Wait(&m_mutex);
+    }
+  }
+
+  Slots::iterator iter = m_slots.begin();
+  for (; iter != m_slots.end(); ++iter) {
+    m_adaptor->FreeTransfer(iter->transfer);
+    delete[] iter->data;
+  }
+  m_adaptor->Close(m_usb_handle);
+}
+
+bool PipelinedAsyncUsbSender::SendDMX(const DmxBuffer &buffer) {
+  if (!m_usb_handle) {
+    OLA_WARN << "PipelinedAsyncUsbSender hasn't been initialized";
+    return false;
+  }
+
+  MutexLocker locker(&m_mutex);
+  if (m_disconnected) {
+    return false;
+  }
+
+  Slot *slot = FreeSlot();
+  if (slot) {
+    return SubmitFrame(slot, buffer);
+  }
+
+  // Everything is in flight, keep the latest frame until a transfer
+  // completes.
+  if (m_pending_tx) {
+    m_frames_dropped++;
+  }
+  m_pending_tx = true;
+  m_tx_buffer.Set(buffer);
+  return true;
+}
+
+void PipelinedAsyncUsbSender::TransferComplete(
+    struct libusb_transfer *transfer) {
+  MutexLocker locker(&m_mutex);
+
+  Slot *slot = NULL;
+  Slots::iterator iter = m_slots.begin();
+  for (; iter != m_slots.end(); ++iter) {
+    if (iter->transfer == transfer) {
+      slot = &(*iter);
+      break;
+    }
+  }
+
+  if (!slot || !slot->in_flight) {
+    OLA_WARN << "Unknown libusb transfer for " << m_name << ": " << transfer;
+    return;
+  }
+
+  slot->in_flight = false;
+  m_in_flight--;
+
+  switch (transfer->status) {
+    case LIBUSB_TRANSFER_COMPLETED:
+      m_frames_sent++;
+      break;
+    case LIBUSB_TRANSFER_CANCELLED:
+      break;
+    case LIBUSB_TRANSFER_NO_DEVICE:
+      m_disconnected = true;
+      break;
+    default:
+      OLA_WARN << "Transfer for " << m_name << " returned "
+               << transfer->status;
+  }
+
+  if (m_shutting_down) {
+    if (!m_in_flight) {
+      m_idle.Signal();
+    }
+    return;
+  }
+
+  if (m_pending_tx && !m_disconnected) {
+    m_pending_tx = false;
+    SubmitFrame(slot, m_tx_buffer);
+  }
+}
+
+uint64_t PipelinedAsyncUsbSender::FramesSent() const {
+  MutexLocker locker(&m_mutex);
+  return m_frames_sent;
+}
+
+uint64_t PipelinedAsyncUsbSender::FramesDropped() const {
+  MutexLocker locker(&m_mutex);
+  return m_frames_dropped;
+}
+
+void PipelinedAsyncUsbSender::ExportStats(ExportMap *export_map) {
+  UIntMap *frames = export_map->GetUIntMapVar(K_FRAMES_VAR,
+                                              K_DEVICE_VAR_LABEL);
+  UIntMap *dropped = export_map->GetUIntMapVar(K_DROPPED_FRAMES_VAR,
+                                               K_DEVICE_VAR_LABEL);
+  UIntMap *frame_rate = export_map->GetUIntMapVar(K_FRAME_RATE_VAR,
+                                                  K_DEVICE_VAR_LABEL);
+
+  TimeStamp now;
+  Clock clock;
+  clock.CurrentTime(&now);
+
+  MutexLocker locker(&senders_mutex);
+  std::set<string> exported;
+  std::set<PipelinedAsyncUsbSender*>::iterator iter = senders.begin();
+  for (; iter != senders.end(); ++iter) {
+    PipelinedAsyncUsbSender *sender = *iter;
+    const string &key = sender->Name();
+    const uint64_t frames_sent = sender->FramesSent();
+    exported.insert(key);
+
+    frames->Set(key, static_cast<unsigned int>(frames_sent));
+    dropped->Set(key, static_cast<unsigned int>(sender->FramesDropped()));
+
+    if (sender->m_last_export_time.IsSet()) {
+      const int64_t elapsed = (now - sender->m_last_export_time).AsInt();
+      if (elapsed > 0) {
+        frame_rate->Set(key, static_cast<unsigned int>(
+            (frames_sent - sender->m_last_export_frames) * USEC_IN_SECONDS /
+            elapsed));
+      }
+    }
+    sender->m_last_export_frames = frames_sent;
+    sender->m_last_export_time = now;
+  }
+
+  // Remove the senders that have been deleted.
+  std::set<string>::const_iterator key_iter = exported_senders.begin();
+  for (; key_iter != exported_senders.end(); ++key_iter) {
+    if (exported.find(*key_iter) == exported.end()) {
+      frames->Remove(*key_iter);
+      dropped->Remove(*key_iter);
+      frame_rate->Remove(*key_iter);
+    }
+  }
+  exported_senders.swap(exported);
+}
+
+PipelinedAsyncUsbSender::Slot *PipelinedAsyncUsbSender::FreeSlot() {
+  Slots::iterator iter = m_slots.begin();
+  for (; iter != m_slots.end(); ++iter) {
+    if (!iter->in_flight) {
+      return &(*iter);
+    }
+  }
+  return NULL;
+}
+
+bool PipelinedAsyncUsbSender::SubmitFrame(Slot *slot,
+                                          const DmxBuffer &buffer) {
+  PackFrame(buffer, slot->data);
+  FillBulkTransfer(slot->transfer, m_endpoint, slot->data, m_frame_size,
+                   m_timeout);
+
+  int ret = m_adaptor->SubmitTransfer(slot->transfer);
+  if (ret) {
+    OLA_WARN << "libusb_submit_transfer for " << m_name << " returned "
+             << m_adaptor->ErrorCodeToString(ret);
+    if (ret == LIBUSB_ERROR_NO_DEVICE) {
+      m_disconnected = true;
+    }
+    return false;
+  }
+  slot->in_flight = true;
+  m_in_flight++;
+  return true;
+}
+}  // namespace usbdmx
+}  // namespace plugin
+}  // namespace ola
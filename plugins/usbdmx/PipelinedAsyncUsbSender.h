@@ -0,0 +1,175 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * PipelinedAsyncUsbSender.h
+ * An Asynchronous DMX USB sender which keeps multiple frames in flight.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#ifndef PLUGINS_USBDMX_PIPELINEDASYNCUSBSENDER_H_
+#define PLUGINS_USBDMX_PIPELINEDASYNCUSBSENDER_H_
+
+#include <libusb.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "libs/usb/LibUsbAdaptor.h"
+#include "ola/Clock.h"
+#include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
+#include "ola/base/Macro.h"
+#include "ola/thread/Mutex.h"
+#include "plugins/usbdmx/AsyncUsbTransceiverBase.h"
+
+namespace ola {
+namespace plugin {
+namespace usbdmx {
+
+/**
+ * @brief Send DMX data asynchronously, with more than one frame in flight.
+ *
+ * AsyncUsbSender waits for each transfer to complete before it submits the
+ * next one, so the frame rate is limited by the USB round trip time. This
+ * sender queues up to max_in_flight bulk transfers with the host controller,
+ * so the next frame is ready to go as soon as the last one completes.
+ *
+ * The libusb_transfers and their buffers are allocated once and reused. If
+ * all the transfers are in flight, only the most recent frame is kept and
+ * the older one is counted as dropped.
+ *
+ * The frames sent, frames dropped and achieved frames/sec of each sender are
+ * exported by ExportStats().
+ *
+ * Subclasses implement SetupHandle() and PackFrame().
+ */
+class PipelinedAsyncUsbSender: public AsyncUsbTransceiverBase {
+ public:
+  /**
+   * @brief Create a new PipelinedAsyncUsbSender.
+   * @param adaptor the LibUsbAdaptor to use.
+   * @param usb_device the libusb_device to use for the widget.
+   * @param name the name used to export the statistics.
+   * @param endpoint the bulk endpoint to send the frames to.
+   * @param timeout the timeout for each transfer in milliseconds.
+   * @param frame_size the size of each frame in bytes.
+   * @param max_in_flight the maximum number of transfers in flight.
+   */
+  PipelinedAsyncUsbSender(ola::usb::LibUsbAdaptor* const adaptor,
+                          libusb_device *usb_device,
+                          const std::string &name,
+                          unsigned char endpoint,
+                          unsigned int timeout,
+                          unsigned int frame_size,
+                          unsigned int max_in_flight = DEFAULT_MAX_IN_FLIGHT);
+
+  /**
+   * @brief Destructor.
+   *
+   * This cancels any transfers in flight and waits for their callbacks to
+   * run, unless the device has been disconnected.
+   */
+  virtual ~PipelinedAsyncUsbSender();
+
+  /**
+   * @brief Send one frame of DMX data.
+   * @param buffer the DMX data to send.
+   * @returns true if the frame was sent or queued, false otherwise.
+   */
+  bool SendDMX(const DmxBuffer &buffer);
+
+  /**
+   * @brief Called from the libusb callback when a transfer completes.
+   * @param transfer the completed transfer.
+   */
+  void TransferComplete(struct libusb_transfer *transfer);
+
+  /**
+   * @brief The name of this sender.
+   */
+  const std::string &Name() const { return m_name; }
+
+  /**
+   * @brief The number of frames that have been sent.
+   */
+  uint64_t FramesSent() const;
+
+  /**
+   * @brief The number of frames that were replaced by a newer frame before
+   *   they could be sent.
+   */
+  uint64_t FramesDropped() const;
+
+  /**
+   * @brief Export the statistics of all senders.
+   * @param export_map the ExportMap to update.
+   *
+   * This must be called from the thread that owns the ExportMap. The frame
+   * rate is calculated from the frames sent since the last call.
+   */
+  static void ExportStats(ExportMap *export_map);
+
+  static const unsigned int DEFAULT_MAX_IN_FLIGHT = 2;
+
+ protected:
+  /**
+   * @brief Convert a DMX frame into the wire format of the device.
+   * @param buffer the DMX data.
+   * @param[out] data the location to write the frame, this is frame_size
+   *   bytes long.
+   *
+   * This is called with the mutex held, from either the thread calling
+   * SendDMX() or the libusb thread.
+   */
+  virtual void PackFrame(const DmxBuffer &buffer, uint8_t *data) = 0;
+
+ private:
+  struct Slot {
+    struct libusb_transfer *transfer;
+    uint8_t *data;
+    bool in_flight;
+  };
+
+  typedef std::vector<Slot> Slots;
+
+  const std::string m_name;
+  const unsigned char m_endpoint;
+  const unsigned int m_timeout;
+  const unsigned int m_frame_size;
+
+  Slots m_slots;  // GUARDED_BY(m_mutex)
+  unsigned int m_in_flight;  // GUARDED_BY(m_mutex)
+  bool m_disconnected;  // GUARDED_BY(m_mutex)
+  bool m_shutting_down;  // GUARDED_BY(m_mutex)
+  bool m_pending_tx;  // GUARDED_BY(m_mutex)
+  DmxBuffer m_tx_buffer;  // GUARDED_BY(m_mutex)
+  uint64_t m_frames_sent;  // GUARDED_BY(m_mutex)
+  uint64_t m_frames_dropped;  // GUARDED_BY(m_mutex)
+  ola::thread::ConditionVariable m_idle;
+
+  // Only used by ExportStats()
+  uint64_t m_last_export_frames;
+  TimeStamp m_last_export_time;
+
+  Slot *FreeSlot();
+  bool SubmitFrame(Slot *slot, const DmxBuffer &buffer);
+
+  DISALLOW_COPY_AND_ASSIGN(PipelinedAsyncUsbSender);
+};
+}  // namespace usbdmx
+}  // namespace plugin
+}  // namespace ola
+#endif  // PLUGINS_USBDMX_PIPELINEDASYNCUSBSENDER_H_
@@ -0,0 +1,274 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * PipelinedAsyncUsbSenderTest.cpp
+ * Test fixture for the PipelinedAsyncUsbSender.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <libusb.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include "libs/usb/LibUsbAdaptor.h"
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/Logging.h"
+#include "ola/testing/TestUtils.h"
+#include "ola/thread/Mutex.h"
+#include "ola/thread/Thread.h"
+#include "plugins/usbdmx/PipelinedAsyncUsbSender.h"
+
+using ola::DMX_UNIVERSE_SIZE;
+using ola::DmxBuffer;
+using ola::plugin::usbdmx::PipelinedAsyncUsbSender;
+using ola::thread::Mutex;
+using ola::thread::MutexLocker;
+using std::vector;
+
+namespace {
+
+/*
+ * A LibUsbAdaptor that records the submitted transfers instead of sending
+ * them.
+ */
+class MockLibUsbAdaptor : public ola::usb::BaseLibUsbAdaptor {
+ public:
+  MockLibUsbAdaptor() : m_cancel_result(0) {}
+
+  libusb_device* RefDevice(libusb_device *dev) { return dev; }
+  void UnrefDevice(libusb_device*) {}
+
+  bool OpenDevice(libusb_device*, libusb_device_handle**) { return false; }
+  bool OpenDeviceAndClaimInterface(libusb_device*, int,
+                                   libusb_device_handle**) {
+    return false;
+  }
+  void Close(libusb_device_handle*) {}
+
+  struct libusb_transfer* AllocTransfer(int) {
+    return reinterpret_cast<struct libusb_transfer*>(
+        calloc(1, sizeof(struct libusb_transfer)));
+  }
+
+  void FreeTransfer(struct libusb_transfer *transfer) { free(transfer); }
+
+  int SubmitTransfer(struct libusb_transfer *transfer) {
+    MutexLocker locker(&m_mutex);
+    m_submitted.push_back(transfer);
+    return 0;
+  }
+
+  int CancelTransfer(struct libusb_transfer*) {
+    MutexLocker locker(&m_mutex);
+    return m_cancel_result;
+  }
+
+  void FillBulkTransfer(struct libusb_transfer *transfer,
+                        libusb_device_handle*,
+                        unsigned char endpoint,
+                        unsigned char *buffer,
+                        int length,
+                        libusb_transfer_cb_fn callback,
+                        void *user_data,
+                        unsigned int timeout) {
+    transfer->endpoint = endpoint;
+    transfer->buffer = buffer;
+    transfer->length = length;
+    transfer->callback = callback;
+    transfer->user_data = user_data;
+    transfer->timeout = timeout;
+  }
+
+  void SetCancelResult(int result) {
+    MutexLocker locker(&m_mutex);
+    m_cancel_result = result;
+  }
+
+  unsigned int SubmittedCount() {
+    MutexLocker locker(&m_mutex);
+    return m_submitted.size();
+  }
+
+  struct libusb_transfer *Submitted(unsigned int i) {
+    MutexLocker locker(&m_mutex);
+    return m_submitted[i];
+  }
+
+  /*
+   * Run the libusb callback for a transfer, as libusb would.
+   */
+  static void Complete(struct libusb_transfer *transfer,
+                       enum libusb_transfer_status status) {
+    transfer->status = status;
+    transfer->actual_length = transfer->length;
+    transfer->callback(transfer);
+  }
+
+ private:
+  Mutex m_mutex;
+  int m_cancel_result;
+  vector<struct libusb_transfer*> m_submitted;
+};
+
+/*
+ * A sender with a fake handle, that sends the DMX data as is.
+ */
+class MockSender : public PipelinedAsyncUsbSender {
+ public:
+  explicit MockSender(ola::usb::LibUsbAdaptor *adaptor)
+      : PipelinedAsyncUsbSender(adaptor, NULL, "mock", 1, 100,
+                                DMX_UNIVERSE_SIZE) {
+  }
+
+ protected:
+  libusb_device_handle* SetupHandle() {
+    return reinterpret_cast<libusb_device_handle*>(this);
+  }
+
+  void PackFrame(const DmxBuffer &buffer, uint8_t *data) {
+    unsigned int length = DMX_UNIVERSE_SIZE;
+    buffer.GetRange(0, data, &length);
+  }
+};
+
+/*
+ * Completes a transfer from another thread, like the libusb thread does.
+ */
+class CompletionThread : public ola::thread::Thread {
+ public:
+  explicit CompletionThread(struct libusb_transfer *transfer)
+      : Thread(Options("completion")),
+        m_transfer(transfer),
+        m_completed(false) {
+  }
+
+  bool Completed() {
+    MutexLocker locker(&m_mutex);
+    return m_completed;
+  }
+
+ protected:
+  void *Run() {
+    // Give the destructor time to start waiting.
+    usleep(20000);
+    {
+      MutexLocker locker(&m_mutex);
+      m_completed = true;
+    }
+    MockLibUsbAdaptor::Complete(m_transfer, LIBUSB_TRANSFER_COMPLETED);
+    return NULL;
+  }
+
+ private:
+  struct libusb_transfer *m_transfer;
+  Mutex m_mutex;
+  bool m_completed;
+};
+}  // namespace
+
+
+class PipelinedAsyncUsbSenderTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(PipelinedAsyncUsbSenderTest);
+  CPPUNIT_TEST(testPipelining);
+  CPPUNIT_TEST(testDestroyWhileCompleting);
+  CPPUNIT_TEST(testDestroyDisconnected);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void setUp() {
+    ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
+    m_buffer.SetFromString("1,2,3,4");
+  }
+
+  void testPipelining();
+  void testDestroyWhileCompleting();
+  void testDestroyDisconnected();
+
+ private:
+  MockLibUsbAdaptor m_adaptor;
+  DmxBuffer m_buffer;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PipelinedAsyncUsbSenderTest);
+
+
+/*
+ * Check that frames are pipelined, and the latest frame is kept once every
+ * transfer is in flight.
+ */
+void PipelinedAsyncUsbSenderTest::testPipelining() {
+  MockSender sender(&m_adaptor);
+  OLA_ASSERT_TRUE(sender.Init());
+
+  OLA_ASSERT_TRUE(sender.SendDMX(m_buffer));
+  OLA_ASSERT_TRUE(sender.SendDMX(m_buffer));
+  OLA_ASSERT_EQ(2u, m_adaptor.SubmittedCount());
+
+  // Both transfers are in flight, so these are held back.
+  OLA_ASSERT_TRUE(sender.SendDMX(m_buffer));
+  OLA_ASSERT_TRUE(sender.SendDMX(m_buffer));
+  OLA_ASSERT_EQ(2u, m_adaptor.SubmittedCount());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1), sender.FramesDropped());
+
+  // Completing a transfer sends the held frame.
+  MockLibUsbAdaptor::Complete(m_adaptor.Submitted(0),
+                              LIBUSB_TRANSFER_COMPLETED);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1), sender.FramesSent());
+  OLA_ASSERT_EQ(3u, m_adaptor.SubmittedCount());
+
+  MockLibUsbAdaptor::Complete(m_adaptor.Submitted(1),
+                              LIBUSB_TRANSFER_COMPLETED);
+  MockLibUsbAdaptor::Complete(m_adaptor.Submitted(2),
+                              LIBUSB_TRANSFER_COMPLETED);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(3), sender.FramesSent());
+  OLA_ASSERT_EQ(3u, m_adaptor.SubmittedCount());
+}
+
+
+/*
+ * Check the destructor waits for the callback of a transfer that completed
+ * while it was being cancelled.
+ */
+void PipelinedAsyncUsbSenderTest::testDestroyWhileCompleting() {
+  MockSender *sender = new MockSender(&m_adaptor);
+  OLA_ASSERT_TRUE(sender->Init());
+  OLA_ASSERT_TRUE(sender->SendDMX(m_buffer));
+  OLA_ASSERT_EQ(1u, m_adaptor.SubmittedCount());
+
+  m_adaptor.SetCancelResult(LIBUSB_ERROR_NOT_FOUND);
+  CompletionThread thread(m_adaptor.Submitted(0));
+  OLA_ASSERT_TRUE(thread.Start());
+  delete sender;
+  OLA_ASSERT_TRUE(thread.Completed());
+  thread.Join();
+}
+
+
+/*
+ * Check the destructor doesn't wait for transfers once the device has gone.
+ */
+void PipelinedAsyncUsbSenderTest::testDestroyDisconnected() {
+  MockSender *sender = new MockSender(&m_adaptor);
+  OLA_ASSERT_TRUE(sender->Init());
+  OLA_ASSERT_TRUE(sender->SendDMX(m_buffer));
+  OLA_ASSERT_TRUE(sender->SendDMX(m_buffer));
+
+  m_adaptor.SetCancelResult(LIBUSB_ERROR_NO_DEVICE);
+  delete sender;
+}
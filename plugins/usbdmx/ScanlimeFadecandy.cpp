@@ -33,7 +33,7 @@
 #include "ola/StringUtils.h"
 #include "ola/strings/Format.h"
 #include "ola/util/Utils.h"
-#include "plugins/usbdmx/AsyncUsbSender.h"
+#include "plugins/usbdmx/PipelinedAsyncUsbSender.h"
 #include "plugins/usbdmx/ThreadedUsbSender.h"
 
 namespace ola {
@@ -281,20 +281,26 @@ bool SynchronousScanlimeFadecandy::SendDMX(const DmxBuffer &buffer) {
 
 // FadecandyAsyncUsbSender
 // -----------------------------------------------------------------------------
-class FadecandyAsyncUsbSender : public AsyncUsbSender {
+
+/*
+ * Each frame is 25 packets, so we keep more than one frame in flight to avoid
+ * waiting a USB round trip between frames.
+ */
+class FadecandyAsyncUsbSender : public PipelinedAsyncUsbSender {
  public:
   FadecandyAsyncUsbSender(LibUsbAdaptor *adaptor,
-                          libusb_device *usb_device)
-      : AsyncUsbSender(adaptor, usb_device) {
+                          libusb_device *usb_device,
+                          const string &name)
+      : PipelinedAsyncUsbSender(
+          adaptor, usb_device, name, ENDPOINT, URB_TIMEOUT_MS,
+          sizeof(fadecandy_packet) * PACKETS_PER_UPDATE) {
   }
 
   libusb_device_handle* SetupHandle();
 
-  bool PerformTransfer(const DmxBuffer &buffer);
+  void PackFrame(const DmxBuffer &buffer, uint8_t *data);
 
  private:
-  fadecandy_packet m_data_packets[PACKETS_PER_UPDATE];
-
   DISALLOW_COPY_AND_ASSIGN(FadecandyAsyncUsbSender);
 };
 
@@ -312,15 +318,11 @@ libusb_device_handle* FadecandyAsyncUsbSender::SetupHandle() {
   return usb_handle;
 }
 
-bool FadecandyAsyncUsbSender::PerformTransfer(const DmxBuffer &buffer) {
-  UpdatePacketsWithDMX(m_data_packets, buffer);
+void FadecandyAsyncUsbSender::PackFrame(const DmxBuffer &buffer,
+                                        uint8_t *data) {
   // We do a single bulk transfer of the entire data, rather than one transfer
   // for each 64 bytes.
-  FillBulkTransfer(ENDPOINT,
-                   reinterpret_cast<unsigned char*>(&m_data_packets),
-                   sizeof(m_data_packets),
-                   URB_TIMEOUT_MS);
-  return (SubmitTransfer() == 0);
+  UpdatePacketsWithDMX(reinterpret_cast<fadecandy_packet*>(data), buffer);
 }
 
 // AsynchronousScanlimeFadecandy
@@ -331,7 +333,8 @@ AsynchronousScanlimeFadecandy::AsynchronousScanlimeFadecandy(
     libusb_device *usb_device,
     const std::string &serial)
     : ScanlimeFadecandy(adaptor, usb_device, serial) {
-  m_sender.reset(new FadecandyAsyncUsbSender(m_adaptor, usb_device));
+  m_sender.reset(new FadecandyAsyncUsbSender(m_adaptor, usb_device,
+                                             "fadecandy-" + serial));
 }
 
 bool AsynchronousScanlimeFadecandy::Init() {
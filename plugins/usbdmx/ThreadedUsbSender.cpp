@@ -22,6 +22,7 @@
 
 #include <unistd.h>
 #include "ola/Logging.h"
+#include "ola/thread/Utils.h"
 
 namespace ola {
 namespace plugin {
@@ -30,7 +31,8 @@ namespace usbdmx {
 ThreadedUsbSender::ThreadedUsbSender(libusb_device *usb_device,
                                      libusb_device_handle *usb_handle,
                                      int interface_number)
-    : m_term(false),
+    : Thread(ola::thread::OutputThreadOptions("usbdmx-sender")),
+      m_term(false),
       m_usb_device(usb_device),
       m_usb_handle(usb_handle),
       m_interface_number(interface_number) {
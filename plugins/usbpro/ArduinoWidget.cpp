@@ -56,15 +56,17 @@ const uint8_t ArduinoWidgetImpl::RESPONSE_INVALID_COMMAND = 5;
 
 /*
  * New ArduinoWidget device
+ * @param ss the SelectServer to use for queued writes.
  * @param descriptor the ConnectedDescriptor for this widget.
  * @param esta_id the ESTA id.
  * @param serial the 4 byte serial which forms part of the UID
  */
 ArduinoWidgetImpl::ArduinoWidgetImpl(
+    ola::io::SelectServerInterface *ss,
     ola::io::ConnectedDescriptor *descriptor,
     uint16_t esta_id,
     uint32_t serial)
-    : BaseUsbProWidget(descriptor),
+    : BaseUsbProWidget(descriptor, ss),
       m_transaction_id(0),
       m_uid(esta_id, serial),
       m_rdm_request_callback(NULL) {
@@ -227,11 +229,12 @@ void ArduinoWidgetImpl::GetUidSet(ola::rdm::RDMDiscoveryCallback *callback) {
 /**
  * ArduinoWidget Constructor
  */
-ArduinoWidget::ArduinoWidget(ola::io::ConnectedDescriptor *descriptor,
+ArduinoWidget::ArduinoWidget(ola::io::SelectServerInterface *ss,
+                             ola::io::ConnectedDescriptor *descriptor,
                              uint16_t esta_id,
                              uint32_t serial,
                              unsigned int queue_size) {
-  m_impl = new ArduinoWidgetImpl(descriptor, esta_id, serial);
+  m_impl = new ArduinoWidgetImpl(ss, descriptor, esta_id, serial);
   m_controller = new ola::rdm::DiscoverableQueueingRDMController(m_impl,
                                                                  queue_size);
 }
@@ -22,7 +22,9 @@
 #define PLUGINS_USBPRO_ARDUINOWIDGET_H_
 
 #include <memory>
+#include <string>
 #include "ola/DmxBuffer.h"
+#include "ola/io/SelectServerInterface.h"
 #include "ola/rdm/UID.h"
 #include "ola/rdm/UIDSet.h"
 #include "ola/rdm/RDMControllerInterface.h"
@@ -41,7 +43,8 @@ namespace usbpro {
 class ArduinoWidgetImpl: public BaseUsbProWidget,
                          public ola::rdm::DiscoverableRDMControllerInterface {
  public:
-    ArduinoWidgetImpl(ola::io::ConnectedDescriptor *descriptor,
+    ArduinoWidgetImpl(ola::io::SelectServerInterface *ss,
+                      ola::io::ConnectedDescriptor *descriptor,
                       uint16_t esta_id,
                       uint32_t serial);
     ~ArduinoWidgetImpl();
@@ -89,7 +92,8 @@ class ArduinoWidgetImpl: public BaseUsbProWidget,
 class ArduinoWidget: public SerialWidgetInterface,
                      public ola::rdm::DiscoverableRDMControllerInterface {
  public:
-    ArduinoWidget(ola::io::ConnectedDescriptor *descriptor,
+    ArduinoWidget(ola::io::SelectServerInterface *ss,
+                  ola::io::ConnectedDescriptor *descriptor,
                   uint16_t esta_id,
                   uint32_t serial,
                   unsigned int queue_size = 20);
@@ -114,6 +118,10 @@ class ArduinoWidget: public SerialWidgetInterface,
       m_impl->RunIncrementalDiscovery(callback);
     }
 
+    void SetExportMap(ExportMap *export_map, const std::string &key) {
+      m_impl->SetExportMap(export_map, key);
+    }
+
     ola::io::ConnectedDescriptor *GetDescriptor() const {
       return m_impl->GetDescriptor();
     }
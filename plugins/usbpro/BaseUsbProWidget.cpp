@@ -41,24 +41,63 @@ namespace usbpro {
 
 using std::string;
 
-
-const unsigned int BaseUsbProWidget::HEADER_SIZE =
-  sizeof(BaseUsbProWidget::message_header);
+const char BaseUsbProWidget::USBPRO_COALESCED_VAR[] =
+    "usbpro-coalesced-frames";
+const char BaseUsbProWidget::USBPRO_DROPPED_VAR[] = "usbpro-dropped-frames";
+const char BaseUsbProWidget::USBPRO_VAR_KEY[] = "device";
 
 
 BaseUsbProWidget::BaseUsbProWidget(
-    ola::io::ConnectedDescriptor *descriptor)
+    ola::io::ConnectedDescriptor *descriptor,
+    ola::io::SelectServerInterface *ss)
     : m_descriptor(descriptor),
-      m_state(PRE_SOM),
-      m_bytes_received(0) {
-  memset(&m_header, 0, sizeof(m_header));
+      m_ss(ss),
+      m_parser(NewCallback(this, &BaseUsbProWidget::HandleMessage)),
+      m_write_registered(false),
+      m_coalesced_frames(0),
+      m_dropped_frames(0),
+      m_coalesced_map(NULL),
+      m_dropped_map(NULL) {
   m_descriptor->SetOnData(
       NewCallback(this, &BaseUsbProWidget::DescriptorReady));
+  if (m_ss) {
+    m_descriptor->SetOnWritable(
+        NewCallback(this, &BaseUsbProWidget::DescriptorWritable));
+  }
+  AddDMXLabel(DMX_LABEL);
 }
 
 
 BaseUsbProWidget::~BaseUsbProWidget() {
+  if (m_write_registered) {
+    m_ss->RemoveWriteDescriptor(m_descriptor);
+  }
+  if (m_ss) {
+    m_descriptor->SetOnWritable(NULL);
+  }
   m_descriptor->SetOnData(NULL);
+  const uint32_t coalesced = __sync_fetch_and_add(&m_coalesced_frames, 0);
+  const uint32_t dropped = __sync_fetch_and_add(&m_dropped_frames, 0);
+  if (coalesced || dropped) {
+    OLA_INFO << "Usb Pro widget coalesced " << coalesced
+             << " frames, dropped " << dropped;
+  }
+}
+
+
+void BaseUsbProWidget::SetExportMap(ExportMap *export_map,
+                                    const string &key) {
+  if (!export_map) {
+    return;
+  }
+  m_stats_key = key;
+  m_coalesced_map = export_map->GetUIntMapVar(USBPRO_COALESCED_VAR,
+                                              USBPRO_VAR_KEY);
+  (*m_coalesced_map)[m_stats_key] = __sync_fetch_and_add(
+      &m_coalesced_frames, 0);
+  m_dropped_map = export_map->GetUIntMapVar(USBPRO_DROPPED_VAR,
+                                            USBPRO_VAR_KEY);
+  (*m_dropped_map)[m_stats_key] = __sync_fetch_and_add(&m_dropped_frames, 0);
 }
 
 
@@ -66,9 +105,7 @@ BaseUsbProWidget::~BaseUsbProWidget() {
  * Read data from the widget
  */
 void BaseUsbProWidget::DescriptorReady() {
-  while (m_descriptor->DataRemaining() > 0) {
-    ReceiveMessage();
-  }
+  m_parser.Read(m_descriptor);
 }
 
 
@@ -93,34 +130,149 @@ bool BaseUsbProWidget::SendDMX(const DmxBuffer &buffer) {
 
 /*
  * Send the msg
- * @return true if successful, false otherwise
+ * @return true if the message was sent or queued, false otherwise
  */
 bool BaseUsbProWidget::SendMessage(uint8_t label,
                                    const uint8_t *data,
-                                   unsigned int length) const {
+                                   unsigned int length) {
   if (length && !data)
     return false;
 
-  ssize_t frame_size = HEADER_SIZE + length + 1;
-  uint8_t frame[frame_size];
-  message_header *header = reinterpret_cast<message_header*>(frame);
-  header->som = SOM;
-  header->label = label;
-  header->len = length & 0xFF;
-  header->len_hi = (length & 0xFF00) >> 8;
+  if (!m_ss) {
+    BuildFrame(label, data, length, &m_frame);
+    ssize_t bytes_sent = m_descriptor->Send(m_frame.data(), m_frame.size());
+    if (bytes_sent != static_cast<ssize_t>(m_frame.size())) {
+      // we've probably screwed framing at this point
+      FrameDropped();
+      return false;
+    }
+    return true;
+  }
+
+  if (!m_output_queue.Empty() && m_dmx_labels.count(label)) {
+    // The widget is behind, replace any frame that hasn't been sent yet.
+    ola::io::ByteString &pending = m_pending_frames[label];
+    if (!pending.empty()) {
+      FrameCoalesced();
+    }
+    BuildFrame(label, data, length, &pending);
+    return true;
+  }
+
+  if (m_output_queue.Size() >= MAX_QUEUE_SIZE) {
+    OLA_WARN << "Usb Pro output queue full, dropping message with label "
+             << static_cast<int>(label);
+    FrameDropped();
+    return false;
+  }
+
+  BuildFrame(label, data, length, &m_frame);
+  return WriteFrame(m_frame);
+}
+
 
-  memcpy(frame + sizeof(message_header), data, length);
-  frame[frame_size - 1] = EOM;
+/*
+ * Pack a message into a Usb Pro frame.
+ */
+void BaseUsbProWidget::BuildFrame(uint8_t label,
+                                  const uint8_t *data,
+                                  unsigned int length,
+                                  ola::io::ByteString *frame) {
+  message_header header;
+  header.som = SOM;
+  header.label = label;
+  header.len = length & 0xFF;
+  header.len_hi = (length & 0xFF00) >> 8;
+
+  frame->assign(reinterpret_cast<uint8_t*>(&header), sizeof(header));
+  if (length) {
+    frame->append(data, length);
+  }
+  frame->push_back(EOM);
+}
 
-  ssize_t bytes_sent = m_descriptor->Send(frame, frame_size);
-  if (bytes_sent != frame_size)
-    // we've probably screwed framing at this point
+
+/*
+ * Write as much of a frame as we can, and queue the rest.
+ * @return false if the write failed.
+ */
+bool BaseUsbProWidget::WriteFrame(const ola::io::ByteString &frame) {
+  if (!m_descriptor->ValidWriteDescriptor()) {
+    FrameDropped();
     return false;
+  }
+
+  unsigned int offset = 0;
+  if (m_output_queue.Empty()) {
+    ssize_t bytes_sent = m_descriptor->Send(frame.data(), frame.size());
+    if (bytes_sent < 0) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        FrameDropped();
+        return false;
+      }
+    } else {
+      offset = bytes_sent;
+    }
+  }
 
+  if (offset < frame.size()) {
+    m_output_queue.Write(frame.data() + offset, frame.size() - offset);
+  }
+  UpdateWriteRegistration();
   return true;
 }
 
 
+/*
+ * Called when the descriptor is writable. Once the queue is empty the newest
+ * DMX frames are sent.
+ */
+void BaseUsbProWidget::DescriptorWritable() {
+  if (!m_output_queue.Empty()) {
+    m_descriptor->Send(&m_output_queue);
+  }
+
+  PendingFrames::iterator iter = m_pending_frames.begin();
+  for (; iter != m_pending_frames.end() && m_output_queue.Empty(); ++iter) {
+    if (!iter->second.empty()) {
+      WriteFrame(iter->second);
+      iter->second.clear();
+    }
+  }
+  UpdateWriteRegistration();
+}
+
+
+/*
+ * Only ask for write events while there is queued data.
+ */
+void BaseUsbProWidget::UpdateWriteRegistration() {
+  bool data_pending = !m_output_queue.Empty();
+  if (data_pending && !m_write_registered) {
+    m_write_registered = m_ss->AddWriteDescriptor(m_descriptor);
+  } else if (!data_pending && m_write_registered) {
+    m_ss->RemoveWriteDescriptor(m_descriptor);
+    m_write_registered = false;
+  }
+}
+
+
+void BaseUsbProWidget::FrameCoalesced() {
+  const uint32_t count = __sync_add_and_fetch(&m_coalesced_frames, 1);
+  if (m_coalesced_map) {
+    (*m_coalesced_map)[m_stats_key] = count;
+  }
+}
+
+
+void BaseUsbProWidget::FrameDropped() {
+  const uint32_t count = __sync_add_and_fetch(&m_dropped_frames, 1);
+  if (m_dropped_map) {
+    (*m_dropped_map)[m_stats_key] = count;
+  }
+}
+
+
 /**
  * Open a path and apply the settings required for talking to widgets.
  */
@@ -142,84 +294,6 @@ ola::io::ConnectedDescriptor *BaseUsbProWidget::OpenDevice(
 
   return new ola::io::DeviceDescriptor(fd);
 }
-
-/*
- * Read the data and handle the messages.
- */
-void BaseUsbProWidget::ReceiveMessage() {
-  unsigned int count, packet_length;
-
-  switch (m_state) {
-    case PRE_SOM:
-      do {
-        m_descriptor->Receive(&m_header.som, 1, count);
-        if (count != 1)
-          return;
-      } while (m_header.som != SOM);
-      m_state = RECV_LABEL;
-      // fall through
-    case RECV_LABEL:
-      m_descriptor->Receive(&m_header.label, 1, count);
-      if (count != 1)
-        return;
-      m_state = RECV_SIZE_LO;
-      // fall through
-    case RECV_SIZE_LO:
-      m_descriptor->Receive(&m_header.len, 1, count);
-      if (count != 1)
-        return;
-      m_state = RECV_SIZE_HI;
-      // fall through
-    case RECV_SIZE_HI:
-      m_descriptor->Receive(&m_header.len_hi, 1, count);
-      if (count != 1)
-        return;
-
-      packet_length = (m_header.len_hi << 8) + m_header.len;
-      if (packet_length == 0) {
-        m_state = RECV_EOM;
-        return;
-      } else if (packet_length > MAX_DATA_SIZE) {
-        m_state = PRE_SOM;
-        return;
-      }
-
-      m_bytes_received = 0;
-      m_state = RECV_BODY;
-      // fall through
-    case RECV_BODY:
-      packet_length = (m_header.len_hi << 8) + m_header.len;
-      m_descriptor->Receive(
-          reinterpret_cast<uint8_t*>(&m_recv_buffer) + m_bytes_received,
-          packet_length - m_bytes_received,
-          count);
-
-      if (!count)
-        return;
-
-      m_bytes_received += count;
-      if (m_bytes_received != packet_length)
-        return;
-
-      m_state = RECV_EOM;
-      // fall through
-    case RECV_EOM:
-      // check this is a valid frame with an end byte
-      uint8_t eom;
-      m_descriptor->Receive(&eom, 1, count);
-      if (count != 1)
-        return;
-
-      packet_length = (m_header.len_hi << 8) + m_header.len;
-
-      if (eom == EOM)
-        HandleMessage(m_header.label,
-                      packet_length ? m_recv_buffer : NULL,
-                      packet_length);
-      m_state = PRE_SOM;
-  }
-  return;
-}
 }  // namespace usbpro
 }  // namespace plugin
 }  // namespace ola
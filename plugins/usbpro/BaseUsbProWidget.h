@@ -23,11 +23,18 @@
 #define PLUGINS_USBPRO_BASEUSBPROWIDGET_H_
 
 #include <stdint.h>
+#include <map>
+#include <set>
 #include <string>
 #include "ola/Callback.h"
 #include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
+#include "ola/io/ByteString.h"
 #include "ola/io/Descriptor.h"
+#include "ola/io/IOQueue.h"
+#include "ola/io/SelectServerInterface.h"
 #include "plugins/usbpro/SerialWidgetInterface.h"
+#include "plugins/usbpro/UsbProFrameParser.h"
 
 namespace ola {
 namespace plugin {
@@ -36,10 +43,23 @@ namespace usbpro {
 
 /*
  * A widget that implements the Usb Pro frame format.
+ *
+ * If a SelectServer is provided, messages that can't be written immediately
+ * are queued and sent once the descriptor becomes writable. While the queue
+ * is draining, only the newest frame for each DMX label is kept, older ones
+ * are discarded and counted as coalesced. Other messages are queued up to
+ * MAX_QUEUE_SIZE bytes, after which they're dropped.
+ *
+ * Without a SelectServer, a message that can't be written in full is
+ * dropped.
+ *
+ * The coalesced & dropped counts are exported once SetExportMap() has been
+ * called.
  */
 class BaseUsbProWidget: public SerialWidgetInterface {
  public:
-  explicit BaseUsbProWidget(ola::io::ConnectedDescriptor *descriptor);
+  explicit BaseUsbProWidget(ola::io::ConnectedDescriptor *descriptor,
+                            ola::io::SelectServerInterface *ss = NULL);
   virtual ~BaseUsbProWidget();
 
   ola::io::ConnectedDescriptor *GetDescriptor() const {
@@ -52,7 +72,23 @@ class BaseUsbProWidget: public SerialWidgetInterface {
 
   bool SendMessage(uint8_t label,
                    const uint8_t *data,
-                   unsigned int length) const;
+                   unsigned int length);
+
+  // The number of DMX frames replaced by a newer frame before being sent.
+  unsigned int CoalescedFrames() const { return m_coalesced_frames; }
+
+  // The number of messages that couldn't be sent or queued.
+  unsigned int DroppedFrames() const { return m_dropped_frames; }
+
+  /**
+   * @brief Export the coalesced & dropped frame counts.
+   * @param export_map the ExportMap to use.
+   * @param key the key to export the counts under, usually the device id.
+   *
+   * This must be called from the thread that owns the ExportMap, which must
+   * be the thread running the SelectServer passed to the constructor.
+   */
+  void SetExportMap(ExportMap *export_map, const std::string &key);
 
   static ola::io::ConnectedDescriptor *OpenDevice(const std::string &path);
 
@@ -63,18 +99,20 @@ class BaseUsbProWidget: public SerialWidgetInterface {
   static const uint8_t MANUFACTURER_LABEL = 77;
   static const uint8_t SERIAL_LABEL = 10;
 
- private:
-  typedef enum {
-    PRE_SOM,
-    RECV_LABEL,
-    RECV_SIZE_LO,
-    RECV_SIZE_HI,
-    RECV_BODY,
-    RECV_EOM,
-  } receive_state;
+  static const unsigned int MAX_QUEUE_SIZE = 2048;
+
+  static const char USBPRO_COALESCED_VAR[];
+  static const char USBPRO_DROPPED_VAR[];
+  static const char USBPRO_VAR_KEY[];
 
-  enum {MAX_DATA_SIZE = 600};
+ protected:
+  /**
+   * Mark a label as carrying DMX data. Frames with these labels are
+   * coalesced when the output is backed up.
+   */
+  void AddDMXLabel(uint8_t label) { m_dmx_labels.insert(label); }
 
+ private:
   typedef struct {
     uint8_t som;
     uint8_t label;
@@ -82,20 +120,38 @@ class BaseUsbProWidget: public SerialWidgetInterface {
     uint8_t len_hi;
   } message_header;
 
+  typedef std::map<uint8_t, ola::io::ByteString> PendingFrames;
+
   ola::io::ConnectedDescriptor *m_descriptor;
-  receive_state m_state;
-  unsigned int m_bytes_received;
-  message_header m_header;
-  uint8_t m_recv_buffer[MAX_DATA_SIZE];
+  ola::io::SelectServerInterface *m_ss;
+  UsbProFrameParser m_parser;
+  std::set<uint8_t> m_dmx_labels;
+  ola::io::ByteString m_frame;
+  ola::io::IOQueue m_output_queue;
+  PendingFrames m_pending_frames;
+  bool m_write_registered;
+  // The detector thread may delete the widget, so these are updated
+  // atomically.
+  uint32_t m_coalesced_frames;
+  uint32_t m_dropped_frames;
+  std::string m_stats_key;
+  UIntMap *m_coalesced_map;
+  UIntMap *m_dropped_map;
 
-  void ReceiveMessage();
   virtual void HandleMessage(uint8_t label,
                              const uint8_t *data,
                              unsigned int length) = 0;
 
+  void BuildFrame(uint8_t label, const uint8_t *data, unsigned int length,
+                  ola::io::ByteString *frame);
+  bool WriteFrame(const ola::io::ByteString &frame);
+  void DescriptorWritable();
+  void UpdateWriteRegistration();
+  void FrameCoalesced();
+  void FrameDropped();
+
   static const uint8_t EOM = 0xe7;
   static const uint8_t SOM = 0x7e;
-  static const unsigned int HEADER_SIZE;
 };
 
 
@@ -110,8 +166,9 @@ class DispatchingUsbProWidget: public BaseUsbProWidget {
                          const uint8_t*,
                          unsigned int> MessageCallback;
   DispatchingUsbProWidget(ola::io::ConnectedDescriptor *descriptor,
-                          MessageCallback *callback)
-      : BaseUsbProWidget(descriptor),
+                          MessageCallback *callback,
+                          ola::io::SelectServerInterface *ss = NULL)
+      : BaseUsbProWidget(descriptor, ss),
         m_callback(callback) {
   }
 
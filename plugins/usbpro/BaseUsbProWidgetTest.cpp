@@ -21,28 +21,38 @@
 #include <cppunit/extensions/HelperMacros.h>
 #include <memory>
 #include <queue>
+#include <utility>
+#include <vector>
 
 #include "ola/testing/TestUtils.h"
 
 #include "ola/Callback.h"
+#include "ola/Clock.h"
 #include "ola/Constants.h"
 #include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
 #include "ola/Logging.h"
 #include "ola/network/NetworkUtils.h"
 #include "plugins/usbpro/BaseUsbProWidget.h"
 #include "plugins/usbpro/CommonWidgetTest.h"
+#include "plugins/usbpro/UsbProFrameParser.h"
 
 
 using ola::DmxBuffer;
+using ola::ExportMap;
+using ola::plugin::usbpro::BaseUsbProWidget;
 using std::auto_ptr;
 using std::queue;
+using std::vector;
 
 
 class BaseUsbProWidgetTest: public CommonWidgetTest {
   CPPUNIT_TEST_SUITE(BaseUsbProWidgetTest);
   CPPUNIT_TEST(testSend);
   CPPUNIT_TEST(testSendDMX);
+  CPPUNIT_TEST(testQueuedSend);
   CPPUNIT_TEST(testReceive);
+  CPPUNIT_TEST(testReceiveManyFrames);
   CPPUNIT_TEST(testRemove);
   CPPUNIT_TEST_SUITE_END();
 
@@ -51,12 +61,16 @@ class BaseUsbProWidgetTest: public CommonWidgetTest {
 
     void testSend();
     void testSendDMX();
+    void testQueuedSend();
     void testReceive();
+    void testReceiveManyFrames();
     void testRemove();
 
  private:
     auto_ptr<ola::plugin::usbpro::DispatchingUsbProWidget> m_widget;
     bool m_removed;
+    // the label and first data byte of each frame written by the widget
+    vector<std::pair<uint8_t, uint8_t> > m_sent_frames;
 
     typedef struct {
       uint8_t label;
@@ -73,12 +87,16 @@ class BaseUsbProWidgetTest: public CommonWidgetTest {
     void ReceiveMessage(uint8_t label,
                         const uint8_t *data,
                         unsigned int size);
+    void RecordFrame(uint8_t label, const uint8_t *data, unsigned int size) {
+      m_sent_frames.push_back(std::make_pair(label, size > 1 ? data[1] : 0));
+    }
     void DeviceRemoved() {
       m_removed = true;
       m_ss.Terminate();
     }
 
     static const uint8_t DMX_FRAME_LABEL = 0x06;
+    static const uint8_t SERIAL_LABEL = 0x0a;
 };
 
 
@@ -171,6 +189,91 @@ void BaseUsbProWidgetTest::testSend() {
 }
 
 
+/*
+ * Check that messages are queued, and DMX frames coalesced, once the
+ * descriptor stops accepting data.
+ */
+void BaseUsbProWidgetTest::testQueuedSend() {
+  m_widget.reset();
+  m_widget.reset(
+      new ola::plugin::usbpro::DispatchingUsbProWidget(
+        &m_descriptor,
+        ola::NewCallback(this, &BaseUsbProWidgetTest::ReceiveMessage),
+        &m_ss));
+  ExportMap export_map;
+  m_widget->SetExportMap(&export_map, "1-1");
+  ola::io::ConnectedDescriptor::SetNonBlocking(m_descriptor.WriteDescriptor());
+  // Read the other end ourselves.
+  m_ss.RemoveReadDescriptor(m_other_end.get());
+
+  // Enough DMX frames to fill the pipe.
+  const unsigned int DMX_FRAMES = 250;
+  DmxBuffer buffer;
+  buffer.Blackout();
+  for (unsigned int i = 0; i < DMX_FRAMES; i++) {
+    buffer.SetChannel(0, i);
+    OLA_ASSERT_TRUE(m_widget->SendDMX(buffer));
+  }
+  OLA_ASSERT_TRUE(m_widget->CoalescedFrames() > 0);
+  OLA_ASSERT_EQ(0u, m_widget->DroppedFrames());
+
+  // Other messages are queued until the queue is full.
+  uint8_t data[500];
+  memset(data, 0, sizeof(data));
+  unsigned int queued_messages = 0;
+  while (m_widget->SendMessage(SERIAL_LABEL, data, sizeof(data))) {
+    queued_messages++;
+  }
+  OLA_ASSERT_TRUE(queued_messages > 0);
+  OLA_ASSERT_EQ(1u, m_widget->DroppedFrames());
+
+  // Drain the pipe.
+  ola::plugin::usbpro::UsbProFrameParser parser(
+      ola::NewCallback(this, &BaseUsbProWidgetTest::RecordFrame));
+  unsigned int idle_loops = 0;
+  while (idle_loops < 3) {
+    size_t frames = m_sent_frames.size();
+    parser.Read(m_other_end.get());
+    m_ss.RunOnce(ola::TimeInterval(0, 0));
+    idle_loops = m_sent_frames.size() == frames ? idle_loops + 1 : 0;
+  }
+  m_ss.AddReadDescriptor(m_other_end.get());
+
+  // Every DMX frame was either written or replaced by a later one.
+  unsigned int dmx_frames = 0;
+  unsigned int serial_frames = 0;
+  uint8_t last_dmx_value = 0;
+  vector<std::pair<uint8_t, uint8_t> >::const_iterator iter =
+      m_sent_frames.begin();
+  for (; iter != m_sent_frames.end(); ++iter) {
+    if (iter->first == DMX_FRAME_LABEL) {
+      if (dmx_frames) {
+        OLA_ASSERT_TRUE(iter->second > last_dmx_value);
+      }
+      last_dmx_value = iter->second;
+      dmx_frames++;
+    } else {
+      OLA_ASSERT_EQ(static_cast<int>(SERIAL_LABEL),
+                    static_cast<int>(iter->first));
+      serial_frames++;
+    }
+  }
+  OLA_ASSERT_EQ(DMX_FRAMES, dmx_frames + m_widget->CoalescedFrames());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(DMX_FRAMES - 1), last_dmx_value);
+  OLA_ASSERT_EQ(queued_messages, serial_frames);
+
+  // The counts are exported.
+  OLA_ASSERT_EQ(m_widget->CoalescedFrames(),
+                (*export_map.GetUIntMapVar(
+                    BaseUsbProWidget::USBPRO_COALESCED_VAR,
+                    BaseUsbProWidget::USBPRO_VAR_KEY))["1-1"]);
+  OLA_ASSERT_EQ(1u, (*export_map.GetUIntMapVar(
+                    BaseUsbProWidget::USBPRO_DROPPED_VAR,
+                    BaseUsbProWidget::USBPRO_VAR_KEY))["1-1"]);
+  m_widget.reset();
+}
+
+
 /**
  * Check that we can send DMX
  */
@@ -236,6 +339,37 @@ void BaseUsbProWidgetTest::testReceive() {
 }
 
 
+/*
+ * Test receiving more data than the widget reads at once.
+ */
+void BaseUsbProWidgetTest::testReceiveManyFrames() {
+  const unsigned int FRAME_COUNT = 20;
+  uint8_t dmx_data[FRAME_COUNT][ola::DMX_UNIVERSE_SIZE + 1];
+  uint8_t stream[FRAME_COUNT * (ola::DMX_UNIVERSE_SIZE + 1 + HEADER_SIZE +
+                                FOOTER_SIZE)];
+  unsigned int stream_size = 0;
+
+  for (unsigned int i = 0; i < FRAME_COUNT; i++) {
+    dmx_data[i][0] = ola::DMX512_START_CODE;
+    memset(dmx_data[i] + 1, i, ola::DMX_UNIVERSE_SIZE);
+    AddExpectedMessage(DMX_FRAME_LABEL, sizeof(dmx_data[i]), dmx_data[i]);
+
+    unsigned int frame_size;
+    uint8_t *frame = BuildUsbProMessage(DMX_FRAME_LABEL, dmx_data[i],
+                                        sizeof(dmx_data[i]), &frame_size);
+    memcpy(stream + stream_size, frame, frame_size);
+    stream_size += frame_size;
+    delete[] frame;
+  }
+
+  ssize_t bytes_sent = m_other_end->Send(stream, stream_size);
+  OLA_ASSERT_EQ(static_cast<ssize_t>(stream_size), bytes_sent);
+  m_ss.Run();
+
+  OLA_ASSERT_EQ(static_cast<size_t>(0), m_messages.size());
+}
+
+
 /**
  * Test on remove works.
  */
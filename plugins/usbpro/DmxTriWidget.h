@@ -29,6 +29,7 @@
 #include "ola/rdm/QueueingRDMController.h"
 #include "ola/rdm/RDMControllerInterface.h"
 #include "ola/rdm/UIDSet.h"
+#include "ola/io/SelectServerInterface.h"
 #include "ola/thread/SchedulerInterface.h"
 #include "plugins/usbpro/BaseUsbProWidget.h"
 
@@ -43,7 +44,7 @@ namespace usbpro {
 class DmxTriWidgetImpl: public BaseUsbProWidget,
                         public ola::rdm::DiscoverableRDMControllerInterface {
  public:
-    DmxTriWidgetImpl(ola::thread::SchedulerInterface *executor,
+    DmxTriWidgetImpl(ola::io::SelectServerInterface *ss,
                      ola::io::ConnectedDescriptor *descriptor,
                      bool use_raw_rdm);
     ~DmxTriWidgetImpl();
@@ -207,7 +208,7 @@ class DmxTriWidgetImpl: public BaseUsbProWidget,
 class DmxTriWidget: public SerialWidgetInterface,
                     public ola::rdm::DiscoverableRDMControllerInterface {
  public:
-    DmxTriWidget(ola::thread::SchedulerInterface *ss,
+    DmxTriWidget(ola::io::SelectServerInterface *ss,
                  ola::io::ConnectedDescriptor *descriptor,
                  unsigned int queue_size = 20,
                  bool use_raw_rdm = false);
@@ -233,6 +234,10 @@ class DmxTriWidget: public SerialWidgetInterface,
       m_controller->RunIncrementalDiscovery(callback);
     }
 
+    void SetExportMap(ExportMap *export_map, const std::string &key) {
+      m_impl->SetExportMap(export_map, key);
+    }
+
     ola::io::ConnectedDescriptor *GetDescriptor() const {
       return m_impl->GetDescriptor();
     }
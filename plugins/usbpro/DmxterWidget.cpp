@@ -61,10 +61,11 @@ const uint8_t DmxterWidgetImpl::SHUTDOWN_LABAEL = 0xf0;
  * @param serial the 4 byte serial which forms part of the UID
  */
 DmxterWidgetImpl::DmxterWidgetImpl(
+    ola::io::SelectServerInterface *ss,
     ola::io::ConnectedDescriptor *descriptor,
     uint16_t esta_id,
     uint32_t serial)
-    : BaseUsbProWidget(descriptor),
+    : BaseUsbProWidget(descriptor, ss),
       m_uid(esta_id, serial),
       m_discovery_callback(NULL),
       m_rdm_request_callback(NULL),
@@ -427,11 +428,12 @@ void DmxterWidgetImpl::HandleShutdown(const uint8_t *data,
 /**
  * DmxterWidget Constructor
  */
-DmxterWidget::DmxterWidget(ola::io::ConnectedDescriptor *descriptor,
+DmxterWidget::DmxterWidget(ola::io::SelectServerInterface *ss,
+                           ola::io::ConnectedDescriptor *descriptor,
                            uint16_t esta_id,
                            uint32_t serial,
                            unsigned int queue_size) {
-  m_impl = new DmxterWidgetImpl(descriptor, esta_id, serial);
+  m_impl = new DmxterWidgetImpl(ss, descriptor, esta_id, serial);
   m_controller = new ola::rdm::DiscoverableQueueingRDMController(m_impl,
                                                                  queue_size);
 }
@@ -22,6 +22,7 @@
 #define PLUGINS_USBPRO_DMXTERWIDGET_H_
 
 #include <memory>
+#include <string>
 #include "ola/io/SelectServerInterface.h"
 #include "ola/rdm/UID.h"
 #include "ola/rdm/UIDSet.h"
@@ -41,7 +42,8 @@ namespace usbpro {
 class DmxterWidgetImpl: public BaseUsbProWidget,
                         public ola::rdm::DiscoverableRDMControllerInterface {
  public:
-    DmxterWidgetImpl(ola::io::ConnectedDescriptor *descriptor,
+    DmxterWidgetImpl(ola::io::SelectServerInterface *ss,
+                     ola::io::ConnectedDescriptor *descriptor,
                      uint16_t esta_id,
                      uint32_t serial);
     ~DmxterWidgetImpl();
@@ -130,7 +132,8 @@ class DmxterWidgetImpl: public BaseUsbProWidget,
 class DmxterWidget: public SerialWidgetInterface,
                     public ola::rdm::DiscoverableRDMControllerInterface {
  public:
-    DmxterWidget(ola::io::ConnectedDescriptor *descriptor,
+    DmxterWidget(ola::io::SelectServerInterface *ss,
+                 ola::io::ConnectedDescriptor *descriptor,
                  uint16_t esta_id,
                  uint32_t serial,
                  unsigned int queue_size = 20);
@@ -151,6 +154,10 @@ class DmxterWidget: public SerialWidgetInterface,
       m_controller->RunIncrementalDiscovery(callback);
     }
 
+    void SetExportMap(ExportMap *export_map, const std::string &key) {
+      m_impl->SetExportMap(export_map, key);
+    }
+
     ola::io::ConnectedDescriptor *GetDescriptor() const {
       return m_impl->GetDescriptor();
     }
@@ -713,7 +713,7 @@ void EnttecPort::RunIncrementalDiscovery(
 class EnttecUsbProWidgetImpl : public BaseUsbProWidget {
  public:
     EnttecUsbProWidgetImpl(
-        ola::thread::SchedulerInterface *scheduler,
+        ola::io::SelectServerInterface *ss,
         ola::io::ConnectedDescriptor *descriptor,
         const EnttecUsbProWidget::EnttecUsbProWidgetOptions &options);
     ~EnttecUsbProWidgetImpl();
@@ -762,11 +762,11 @@ class EnttecUsbProWidgetImpl : public BaseUsbProWidget {
  * This also works for the RDM Pro with the standard firmware loaded.
  */
 EnttecUsbProWidgetImpl::EnttecUsbProWidgetImpl(
-  ola::thread::SchedulerInterface *scheduler,
+  ola::io::SelectServerInterface *ss,
   ola::io::ConnectedDescriptor *descriptor,
   const EnttecUsbProWidget::EnttecUsbProWidgetOptions &options)
-    : BaseUsbProWidget(descriptor),
-      m_scheduler(scheduler),
+    : BaseUsbProWidget(descriptor, ss),
+      m_scheduler(ss),
       m_watchdog_timer_id(ola::thread::INVALID_TIMEOUT),
       m_send_cb(NewCallback(this, &EnttecUsbProWidgetImpl::SendCommand)),
       m_uid(options.esta_id ? options.esta_id :
@@ -919,6 +919,7 @@ void EnttecUsbProWidgetImpl::AddPort(const OperationLabels &ops,
                                      unsigned int queue_size,
                                      bool enable_rdm) {
   EnttecPortImpl *impl = new EnttecPortImpl(ops, m_uid, m_send_cb.get());
+  AddDMXLabel(ops.send_dmx);
   m_port_impls.push_back(impl);
   EnttecPort *port = new EnttecPort(impl, queue_size, enable_rdm);
   m_ports.push_back(port);
@@ -947,10 +948,10 @@ bool EnttecUsbProWidgetImpl::Watchdog() {
  * EnttecUsbProWidget Constructor
  */
 EnttecUsbProWidget::EnttecUsbProWidget(
-    ola::thread::SchedulerInterface *scheduler,
+    ola::io::SelectServerInterface *ss,
     ola::io::ConnectedDescriptor *descriptor,
     const EnttecUsbProWidgetOptions &options) {
-  m_impl = new EnttecUsbProWidgetImpl(scheduler, descriptor, options);
+  m_impl = new EnttecUsbProWidgetImpl(ss, descriptor, options);
 }
 
 
@@ -981,6 +982,12 @@ EnttecPort *EnttecUsbProWidget::GetPort(unsigned int i) {
 ola::io::ConnectedDescriptor *EnttecUsbProWidget::GetDescriptor() const {
   return m_impl->GetDescriptor();
 }
+
+
+void EnttecUsbProWidget::SetExportMap(ExportMap *export_map,
+                                      const string &key) {
+  m_impl->SetExportMap(export_map, key);
+}
 }  // namespace usbpro
 }  // namespace plugin
 }  // namespace ola
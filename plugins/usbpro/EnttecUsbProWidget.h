@@ -26,7 +26,7 @@
 #include <string>
 #include "ola/Callback.h"
 #include "ola/DmxBuffer.h"
-#include "ola/thread/SchedulerInterface.h"
+#include "ola/io/SelectServerInterface.h"
 #include "ola/rdm/DiscoveryAgent.h"
 #include "ola/rdm/QueueingRDMController.h"
 #include "ola/rdm/RDMControllerInterface.h"
@@ -115,7 +115,7 @@ class EnttecUsbProWidget: public SerialWidgetInterface {
       }
     };
 
-    EnttecUsbProWidget(ola::thread::SchedulerInterface *ss,
+    EnttecUsbProWidget(ola::io::SelectServerInterface *ss,
                        ola::io::ConnectedDescriptor *descriptor,
                        const EnttecUsbProWidgetOptions &options);
     ~EnttecUsbProWidget();
@@ -126,6 +126,7 @@ class EnttecUsbProWidget: public SerialWidgetInterface {
     unsigned int PortCount() const;
     EnttecPort *GetPort(unsigned int i);
     ola::io::ConnectedDescriptor *GetDescriptor() const;
+    void SetExportMap(ExportMap *export_map, const std::string &key);
 
     static const uint16_t ENTTEC_ESTA_ID;
 
@@ -35,8 +35,9 @@ namespace usbpro {
  * This also works for the RDM Pro with the standard firmware loaded.
  */
 GenericUsbProWidget::GenericUsbProWidget(
+  ola::io::SelectServerInterface *ss,
   ola::io::ConnectedDescriptor *descriptor)
-    : BaseUsbProWidget(descriptor),
+    : BaseUsbProWidget(descriptor, ss),
       m_active(true),
       m_dmx_callback(NULL) {
 }
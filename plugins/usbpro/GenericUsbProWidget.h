@@ -26,6 +26,7 @@
 #include <string>
 #include "ola/Callback.h"
 #include "ola/DmxBuffer.h"
+#include "ola/io/SelectServerInterface.h"
 #include "ola/thread/SchedulerInterface.h"
 #include "plugins/usbpro/BaseUsbProWidget.h"
 
@@ -52,7 +53,8 @@ typedef ola::SingleUseCallback2<void, bool, const usb_pro_parameters&>
  */
 class GenericUsbProWidget: public BaseUsbProWidget {
  public:
-    explicit GenericUsbProWidget(ola::io::ConnectedDescriptor *descriptor);
+    GenericUsbProWidget(ola::io::SelectServerInterface *ss,
+                        ola::io::ConnectedDescriptor *descriptor);
     ~GenericUsbProWidget();
 
     void SetDMXCallback(ola::Callback0<void> *callback);
@@ -28,6 +28,8 @@ plugins_usbpro_libolausbprowidget_la_SOURCES = \
     plugins/usbpro/SerialWidgetInterface.h \
     plugins/usbpro/UltraDMXProWidget.cpp \
     plugins/usbpro/UltraDMXProWidget.h \
+    plugins/usbpro/UsbProFrameParser.cpp \
+    plugins/usbpro/UsbProFrameParser.h \
     plugins/usbpro/UsbProWidgetDetector.cpp \
     plugins/usbpro/UsbProWidgetDetector.h \
     plugins/usbpro/WidgetDetectorInterface.h \
@@ -97,6 +99,7 @@ plugins_usbpro_BaseRobeWidgetTester_LDADD = $(COMMON_USBPRO_TEST_LDADD)
 
 plugins_usbpro_BaseUsbProWidgetTester_SOURCES = \
     plugins/usbpro/BaseUsbProWidgetTest.cpp \
+    plugins/usbpro/UsbProFrameParserTest.cpp \
     $(common_test_sources)
 plugins_usbpro_BaseUsbProWidgetTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 plugins_usbpro_BaseUsbProWidgetTester_LDADD = $(COMMON_USBPRO_TEST_LDADD)
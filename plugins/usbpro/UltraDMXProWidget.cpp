@@ -29,8 +29,11 @@ namespace usbpro {
  * UltraDMXProWidget Constructor
  */
 UltraDMXProWidget::UltraDMXProWidget(
+  ola::io::SelectServerInterface *ss,
   ola::io::ConnectedDescriptor *descriptor)
-    : GenericUsbProWidget(descriptor) {
+    : GenericUsbProWidget(ss, descriptor) {
+  AddDMXLabel(DMX_PRIMARY_PORT);
+  AddDMXLabel(DMX_SECONDARY_PORT);
 }
 
 
@@ -37,7 +37,8 @@ namespace usbpro {
  */
 class UltraDMXProWidget: public GenericUsbProWidget {
  public:
-    explicit UltraDMXProWidget(ola::io::ConnectedDescriptor *descriptor);
+    UltraDMXProWidget(ola::io::SelectServerInterface *ss,
+                      ola::io::ConnectedDescriptor *descriptor);
     ~UltraDMXProWidget() {}
     void Stop() { GenericStop(); }
 
@@ -0,0 +1,115 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * UsbProFrameParser.cpp
+ * Extract Enttec Usb Pro frames from a stream of bytes.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#include <string.h>
+#include <algorithm>
+#include "plugins/usbpro/UsbProFrameParser.h"
+
+namespace ola {
+namespace plugin {
+namespace usbpro {
+
+UsbProFrameParser::UsbProFrameParser(FrameHandler *handler)
+    : m_handler(handler),
+      m_size(0) {
+}
+
+
+void UsbProFrameParser::Read(ola::io::ConnectedDescriptor *descriptor) {
+  while (true) {
+    unsigned int space = BUFFER_SIZE - m_size;
+    unsigned int count = 0;
+    int ret = descriptor->Receive(m_buffer + m_size, space, count);
+    if (count) {
+      m_size += count;
+      ExtractFrames();
+    }
+    // Receive() only returns less than we asked for once the descriptor has
+    // been drained.
+    if (ret < 0 || count < space) {
+      return;
+    }
+  }
+}
+
+
+void UsbProFrameParser::Parse(const uint8_t *data, unsigned int length) {
+  while (length) {
+    unsigned int count = std::min(length, BUFFER_SIZE - m_size);
+    memcpy(m_buffer + m_size, data, count);
+    m_size += count;
+    data += count;
+    length -= count;
+    ExtractFrames();
+  }
+}
+
+
+/*
+ * Run the handler for each complete frame in the buffer.
+ */
+void UsbProFrameParser::ExtractFrames() {
+  unsigned int offset = 0;
+  while (offset < m_size) {
+    if (m_buffer[offset] != SOM) {
+      const uint8_t *som = reinterpret_cast<const uint8_t*>(
+          memchr(m_buffer + offset, SOM, m_size - offset));
+      if (!som) {
+        offset = m_size;
+        break;
+      }
+      offset = som - m_buffer;
+    }
+
+    if (m_size - offset < HEADER_SIZE) {
+      break;
+    }
+
+    const uint8_t label = m_buffer[offset + 1];
+    const unsigned int data_size = (m_buffer[offset + 3] << 8) +
+                                   m_buffer[offset + 2];
+    if (data_size > MAX_DATA_SIZE) {
+      // Skip the header and look for the next SOM.
+      offset += HEADER_SIZE;
+      continue;
+    }
+
+    const unsigned int frame_size = HEADER_SIZE + data_size + 1;
+    if (m_size - offset < frame_size) {
+      break;
+    }
+
+    if (m_buffer[offset + frame_size - 1] == EOM) {
+      m_handler->Run(label,
+                     data_size ? m_buffer + offset + HEADER_SIZE : NULL,
+                     data_size);
+    }
+    offset += frame_size;
+  }
+
+  // Keep any partial frame for next time.
+  if (offset) {
+    m_size -= offset;
+    memmove(m_buffer, m_buffer + offset, m_size);
+  }
+}
+}  // namespace usbpro
+}  // namespace plugin
+}  // namespace ola
@@ -0,0 +1,86 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * UsbProFrameParser.h
+ * Extract Enttec Usb Pro frames from a stream of bytes.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#ifndef PLUGINS_USBPRO_USBPROFRAMEPARSER_H_
+#define PLUGINS_USBPRO_USBPROFRAMEPARSER_H_
+
+#include <stdint.h>
+#include <memory>
+#include "ola/Callback.h"
+#include "ola/base/Macro.h"
+#include "ola/io/Descriptor.h"
+
+namespace ola {
+namespace plugin {
+namespace usbpro {
+
+/*
+ * Extracts Usb Pro frames from a byte stream.
+ *
+ * Rather than reading the header a byte at a time, the parser reads
+ * everything the descriptor has available into a buffer and then runs the
+ * handler for each complete frame. Frames are passed to the handler in
+ * place, so there is no copying. Any trailing partial frame is moved to the
+ * start of the buffer and completed on the next read.
+ */
+class UsbProFrameParser {
+ public:
+  typedef ola::Callback3<void, uint8_t, const uint8_t*, unsigned int>
+      FrameHandler;
+
+  /**
+   * Create a new parser.
+   * @param handler the handler to run for each frame, ownership is
+   *   transferred.
+   */
+  explicit UsbProFrameParser(FrameHandler *handler);
+
+  /**
+   * Read all the available data from a descriptor and handle any complete
+   * frames.
+   */
+  void Read(ola::io::ConnectedDescriptor *descriptor);
+
+  /**
+   * Parse a block of data and handle any complete frames.
+   */
+  void Parse(const uint8_t *data, unsigned int length);
+
+  enum {MAX_DATA_SIZE = 600};
+
+ private:
+  enum {BUFFER_SIZE = 4096};
+
+  std::auto_ptr<FrameHandler> m_handler;
+  unsigned int m_size;
+  uint8_t m_buffer[BUFFER_SIZE];
+
+  void ExtractFrames();
+
+  static const uint8_t EOM = 0xe7;
+  static const uint8_t SOM = 0x7e;
+  static const unsigned int HEADER_SIZE = 4;
+
+  DISALLOW_COPY_AND_ASSIGN(UsbProFrameParser);
+};
+}  // namespace usbpro
+}  // namespace plugin
+}  // namespace ola
+#endif  // PLUGINS_USBPRO_USBPROFRAMEPARSER_H_
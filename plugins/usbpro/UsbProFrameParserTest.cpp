@@ -0,0 +1,363 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * UsbProFrameParserTest.cpp
+ * Fuzz and throughput tests for the UsbProFrameParser.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdint.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/Logging.h"
+#include "ola/testing/TestUtils.h"
+#include "plugins/usbpro/UsbProFrameParser.h"
+
+using ola::plugin::usbpro::UsbProFrameParser;
+using std::string;
+using std::vector;
+
+namespace {
+
+const uint8_t SOM = 0x7e;
+const uint8_t EOM = 0xe7;
+
+/*
+ * Frames are recorded as the label followed by the data.
+ */
+class FrameRecorder {
+ public:
+  void Record(uint8_t label, const uint8_t *data, unsigned int length) {
+    string frame(1, static_cast<char>(label));
+    frame.append(reinterpret_cast<const char*>(data), length);
+    frames.push_back(frame);
+  }
+
+  vector<string> frames;
+};
+
+class FrameCounter {
+ public:
+  FrameCounter() : frames(0) {}
+
+  void Count(uint8_t, const uint8_t*, unsigned int) {
+    frames++;
+  }
+
+  unsigned int frames;
+};
+
+/*
+ * The original parser, which processes one byte at a time. The new parser
+ * should produce the same frames for any input.
+ */
+class ReferenceParser {
+ public:
+  ReferenceParser() : m_state(PRE_SOM), m_label(0), m_length(0) {}
+
+  void Parse(const string &data) {
+    for (unsigned int i = 0; i < data.size(); i++) {
+      Consume(data[i]);
+    }
+  }
+
+  vector<string> frames;
+
+ private:
+  enum {
+    PRE_SOM,
+    RECV_LABEL,
+    RECV_SIZE_LO,
+    RECV_SIZE_HI,
+    RECV_BODY,
+    RECV_EOM,
+  } m_state;
+  uint8_t m_label;
+  unsigned int m_length;
+  string m_body;
+
+  void Consume(uint8_t byte) {
+    switch (m_state) {
+      case PRE_SOM:
+        if (byte == SOM) {
+          m_state = RECV_LABEL;
+        }
+        break;
+      case RECV_LABEL:
+        m_label = byte;
+        m_state = RECV_SIZE_LO;
+        break;
+      case RECV_SIZE_LO:
+        m_length = byte;
+        m_state = RECV_SIZE_HI;
+        break;
+      case RECV_SIZE_HI:
+        m_length += byte << 8;
+        m_body.clear();
+        if (m_length == 0) {
+          m_state = RECV_EOM;
+        } else if (m_length > UsbProFrameParser::MAX_DATA_SIZE) {
+          m_state = PRE_SOM;
+        } else {
+          m_state = RECV_BODY;
+        }
+        break;
+      case RECV_BODY:
+        m_body.push_back(byte);
+        if (m_body.size() == m_length) {
+          m_state = RECV_EOM;
+        }
+        break;
+      case RECV_EOM:
+        if (byte == EOM) {
+          frames.push_back(string(1, static_cast<char>(m_label)) + m_body);
+        }
+        m_state = PRE_SOM;
+        break;
+    }
+  }
+};
+
+/*
+ * A deterministic PRNG so failures can be reproduced.
+ */
+class XorShift {
+ public:
+  explicit XorShift(uint32_t seed) : m_value(seed) {}
+
+  uint32_t Next() {
+    m_value ^= m_value << 13;
+    m_value ^= m_value >> 17;
+    m_value ^= m_value << 5;
+    return m_value;
+  }
+
+  unsigned int Range(unsigned int lower, unsigned int upper) {
+    return lower + Next() % (upper - lower + 1);
+  }
+
+ private:
+  uint32_t m_value;
+};
+
+void AssertFramesEqual(const vector<string> &expected,
+                       const vector<string> &actual) {
+  OLA_ASSERT_EQ(expected.size(), actual.size());
+  for (unsigned int i = 0; i < expected.size(); i++) {
+    OLA_ASSERT_EQ(expected[i], actual[i]);
+  }
+}
+
+string BuildFrame(uint8_t label, const string &data, uint8_t eom = EOM) {
+  string frame;
+  frame.push_back(SOM);
+  frame.push_back(label);
+  frame.push_back(data.size() & 0xff);
+  frame.push_back(data.size() >> 8);
+  frame.append(data);
+  frame.push_back(eom);
+  return frame;
+}
+
+string RandomData(XorShift *random, unsigned int length) {
+  string data;
+  for (unsigned int i = 0; i < length; i++) {
+    // Bias towards SOM & EOM to exercise resyncing.
+    switch (random->Range(0, 7)) {
+      case 0:
+        data.push_back(SOM);
+        break;
+      case 1:
+        data.push_back(EOM);
+        break;
+      default:
+        data.push_back(random->Next() & 0xff);
+    }
+  }
+  return data;
+}
+
+/*
+ * Build a stream of valid frames, truncated frames, bad frames and noise.
+ */
+string RandomStream(XorShift *random) {
+  string stream;
+  unsigned int pieces = random->Range(1, 30);
+  for (unsigned int i = 0; i < pieces; i++) {
+    uint8_t label = random->Next() & 0xff;
+    switch (random->Range(0, 9)) {
+      case 0:
+        stream.append(RandomData(random, random->Range(1, 10)));
+        break;
+      case 1:
+        stream.append(BuildFrame(label, RandomData(random, 4), 0xaa));
+        break;
+      case 2: {
+        string frame = BuildFrame(label, RandomData(random, 20));
+        stream.append(frame.substr(0, random->Range(1, frame.size() - 1)));
+        break;
+      }
+      case 3:
+        // Too large
+        stream.push_back(SOM);
+        stream.push_back(label);
+        stream.push_back(random->Next() & 0xff);
+        stream.push_back(random->Range(3, 255));
+        break;
+      case 4:
+        stream.append(BuildFrame(
+            label,
+            RandomData(random, random->Range(
+                UsbProFrameParser::MAX_DATA_SIZE - 10,
+                UsbProFrameParser::MAX_DATA_SIZE))));
+        break;
+      default:
+        stream.append(BuildFrame(
+            label, RandomData(random, random->Range(0, 40))));
+    }
+  }
+  return stream;
+}
+}  // namespace
+
+
+class UsbProFrameParserTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(UsbProFrameParserTest);
+  CPPUNIT_TEST(testParse);
+  CPPUNIT_TEST(testFuzz);
+  CPPUNIT_TEST(testThroughput);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void testParse();
+  void testFuzz();
+  void testThroughput();
+
+ private:
+  void ParseInChunks(UsbProFrameParser *parser, const string &data,
+                     XorShift *random);
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(UsbProFrameParserTest);
+
+
+/*
+ * Feed data to the parser in random sized chunks.
+ */
+void UsbProFrameParserTest::ParseInChunks(UsbProFrameParser *parser,
+                                          const string &data,
+                                          XorShift *random) {
+  const uint8_t *ptr = reinterpret_cast<const uint8_t*>(data.data());
+  unsigned int remaining = data.size();
+  while (remaining) {
+    // Mostly small reads, with the occasional one larger than the buffer.
+    unsigned int chunk = random->Range(0, 15) ?
+        random->Range(1, 64) : random->Range(1, 10000);
+    chunk = std::min(chunk, remaining);
+    parser->Parse(ptr, chunk);
+    ptr += chunk;
+    remaining -= chunk;
+  }
+}
+
+
+/*
+ * Check that frames split at every position are parsed.
+ */
+void UsbProFrameParserTest::testParse() {
+  string stream;
+  stream.append(BuildFrame(0, ""));
+  stream.append(BuildFrame(0x0b, string("\xde\xad\xbe\xef", 4)));
+  stream.append("\xaa\xbb");
+  stream.append(BuildFrame(0x0a, string("\xe7\xe7\x7e\xe7", 4)));
+  stream.append(BuildFrame(
+      6, string(UsbProFrameParser::MAX_DATA_SIZE, '\x7e')));
+
+  vector<string> expected;
+  expected.push_back(string(1, '\0'));
+  expected.push_back(string("\x0b\xde\xad\xbe\xef", 5));
+  expected.push_back(string("\x0a\xe7\xe7\x7e\xe7", 5));
+  expected.push_back(
+      "\x06" + string(UsbProFrameParser::MAX_DATA_SIZE, '\x7e'));
+
+  for (unsigned int split = 0; split <= stream.size(); split++) {
+    FrameRecorder recorder;
+    UsbProFrameParser parser(
+        ola::NewCallback(&recorder, &FrameRecorder::Record));
+    const uint8_t *data = reinterpret_cast<const uint8_t*>(stream.data());
+    parser.Parse(data, split);
+    parser.Parse(data + split, stream.size() - split);
+    AssertFramesEqual(expected, recorder.frames);
+  }
+}
+
+
+/*
+ * Compare the frames against the byte at a time parser for random input.
+ */
+void UsbProFrameParserTest::testFuzz() {
+  XorShift random(0x4f4c41);
+  for (unsigned int i = 0; i < 500; i++) {
+    string stream = RandomStream(&random);
+
+    ReferenceParser reference;
+    reference.Parse(stream);
+
+    FrameRecorder recorder;
+    UsbProFrameParser parser(
+        ola::NewCallback(&recorder, &FrameRecorder::Record));
+    ParseInChunks(&parser, stream, &random);
+
+    AssertFramesEqual(reference.frames, recorder.frames);
+  }
+}
+
+
+/*
+ * Parse a large number of DMX frames and report the rate.
+ */
+void UsbProFrameParserTest::testThroughput() {
+  const unsigned int FRAME_COUNT = 20000;
+  string frame = BuildFrame(6, string(513, '\x80'));
+  string stream;
+  for (unsigned int i = 0; i < 16; i++) {
+    stream.append(frame);
+  }
+
+  FrameCounter counter;
+  UsbProFrameParser parser(ola::NewCallback(&counter, &FrameCounter::Count));
+
+  ola::Clock clock;
+  ola::TimeStamp start, end;
+  clock.CurrentTime(&start);
+  const uint8_t *data = reinterpret_cast<const uint8_t*>(stream.data());
+  for (unsigned int i = 0; i < FRAME_COUNT / 16; i++) {
+    parser.Parse(data, stream.size());
+  }
+  clock.CurrentTime(&end);
+
+  OLA_ASSERT_EQ(FRAME_COUNT, counter.frames);
+  ola::TimeInterval duration = end - start;
+  if (duration.AsInt()) {
+    OLA_INFO << "Parsed " << FRAME_COUNT << " frames in " << duration << ", "
+             << static_cast<int64_t>(FRAME_COUNT) * 1000000 / duration.AsInt()
+             << " frames/s";
+  }
+}
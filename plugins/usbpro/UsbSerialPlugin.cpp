@@ -142,7 +142,7 @@ void UsbSerialPlugin::DeviceRemoved(UsbSerialDevice *device) {
 void UsbSerialPlugin::NewWidget(
     ArduinoWidget *widget,
     const UsbProWidgetInformation &information) {
-  AddDevice(new ArduinoRGBDevice(
+  AddWidgetDevice(widget, new ArduinoRGBDevice(
       m_plugin_adaptor,
       this,
       GetDeviceName(information),
@@ -164,9 +164,9 @@ void UsbSerialPlugin::NewWidget(
     device_name = USBPRO_DEVICE_NAME;
   }
 
-  AddDevice(new UsbProDevice(m_plugin_adaptor, this, device_name, widget,
-                             information.serial, information.firmware_version,
-                             GetProFrameLimit()));
+  AddWidgetDevice(widget, new UsbProDevice(
+      m_plugin_adaptor, this, device_name, widget, information.serial,
+      information.firmware_version, GetProFrameLimit()));
 }
 
 
@@ -178,7 +178,7 @@ void UsbSerialPlugin::NewWidget(
     const UsbProWidgetInformation &information) {
   widget->UseRawRDM(
       m_preferences->GetValueAsBool(TRI_USE_RAW_RDM_KEY));
-  AddDevice(new DmxTriDevice(
+  AddWidgetDevice(widget, new DmxTriDevice(
       this,
       GetDeviceName(information),
       widget,
@@ -195,7 +195,7 @@ void UsbSerialPlugin::NewWidget(
 void UsbSerialPlugin::NewWidget(
     DmxterWidget *widget,
     const UsbProWidgetInformation &information) {
-  AddDevice(new DmxterDevice(
+  AddWidgetDevice(widget, new DmxterDevice(
       this,
       GetDeviceName(information),
       widget,
@@ -223,7 +223,7 @@ void UsbSerialPlugin::NewWidget(
  */
 void UsbSerialPlugin::NewWidget(UltraDMXProWidget *widget,
                                 const UsbProWidgetInformation &information) {
-  AddDevice(new UltraDMXProDevice(
+  AddWidgetDevice(widget, new UltraDMXProDevice(
       m_plugin_adaptor,
       this,
       GetDeviceName(information),
@@ -236,6 +236,20 @@ void UsbSerialPlugin::NewWidget(UltraDMXProWidget *widget,
 }
 
 
+/*
+ * Export the widget's frame counts under the device's id, and then add the
+ * device.
+ * @param widget the Usb Pro widget used by the device
+ * @param device the new UsbSerialDevice
+ */
+template <typename Widget>
+void UsbSerialPlugin::AddWidgetDevice(Widget *widget,
+                                      UsbSerialDevice *device) {
+  widget->SetExportMap(m_plugin_adaptor->GetExportMap(), device->UniqueId());
+  AddDevice(device);
+}
+
+
 /*
  * Add a new device to the list
  * @param device the new UsbSerialDevice
@@ -58,6 +58,8 @@ class UsbSerialPlugin: public ola::Plugin, public NewWidgetHandler {
 
  private:
     void AddDevice(UsbSerialDevice *device);
+    template <typename Widget>
+    void AddWidgetDevice(Widget *widget, UsbSerialDevice *device);
     bool StartHook();
     bool StopHook();
     bool SetDefaultPreferences();
@@ -256,7 +256,7 @@ void WidgetDetectorThread::UsbProWidgetReady(
       if (information->device_id == DMX_KING_ULTRA_PRO_ID) {
         // The Ultra device has two outputs
         DispatchWidget(
-            new UltraDMXProWidget(descriptor),
+            new UltraDMXProWidget(m_other_ss, descriptor),
             information);
         return;
       } else {
@@ -277,6 +277,7 @@ void WidgetDetectorThread::UsbProWidgetReady(
           information->device_id == GODDARD_MINI_DMXTER4_ID) {
         DispatchWidget(
             new DmxterWidget(
+              m_other_ss,
               descriptor,
               information->esta_id,
               information->serial),
@@ -303,6 +304,7 @@ void WidgetDetectorThread::UsbProWidgetReady(
           information->device_id == OPEN_LIGHTING_PACKETHEADS_ID) {
         DispatchWidget(
             new ArduinoWidget(
+              m_other_ss,
               descriptor,
               information->esta_id,
               information->serial),